@@ -38,6 +38,14 @@ typedef struct LLVMOpaqueDIBuilder * LLVMDIBuilderRef;
 struct LLVMOpaqueTargetMachine;
 void SetUseFastIsel(LLVMOpaqueTargetMachine * pLtmachine);
 
+// host cpu queries, returned strings should be freed with LLVMDisposeMessage
+char * PChzCreateHostCpuName();
+char * PChzCreateHostCpuFeatures();
+
+// clone a function (and its debug info) into the same module
+LLVMValueRef LLVMCloneFunction(LLVMValueRef pLvalFunction, const char * pChzName);
+void LLVMDeleteFunctionBody(LLVMValueRef pLvalFunction);
+
 LLVMDIBuilderRef LLVMCreateDIBuilder(LLVMModuleRef pMod);
 void LLVMDisposeDIBuilder(LLVMDIBuilderRef pDib);
 void LLVMDIBuilderFinalize(LLVMDIBuilderRef pDib);
@@ -51,7 +59,8 @@ LLVMValueRef LLVMDIBuilderCreateCompileUnit(
 				const char * pChzProducer,
 				LLVMBool fIsOptimized,
 				const char * pChzFlags,
-				unsigned nRuntimeVersion);
+				unsigned nRuntimeVersion,
+				LLVMBool fLineTablesOnly);
 
 LLVMValueRef LLVMDIBuilderCreateFile(LLVMDIBuilderRef pDib, const char * pChzFilename, const char * pChzDirectory);
 LLVMValueRef LLVMCreateDebugLocation(LLVMBuilderRef pLbuild, int nLine, int nCol, LLVMValueRef pLvalScope);
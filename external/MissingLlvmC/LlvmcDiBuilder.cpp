@@ -33,7 +33,9 @@
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Metadata.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/Host.h"
 #include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/Cloning.h"
 #ifdef _WINDOWS
 #pragma warning ( push )
 #endif
@@ -97,6 +99,47 @@ void SetUseFastIsel(LLVMOpaqueTargetMachine * pLtmachine)
 	unwrap(pLtmachine)->setO0WantsFastISel(true);
 }
 
+char * PChzCreateHostCpuName()
+{
+	return LLVMCreateMessage(sys::getHostCPUName().str().c_str());
+}
+
+char * PChzCreateHostCpuFeatures()
+{
+	std::string strFeatures;
+	StringMap<bool> mpStrFEnabled;
+	if (sys::getHostCPUFeatures(mpStrFEnabled))
+	{
+		for (auto & entry : mpStrFEnabled)
+		{
+			if (!strFeatures.empty())
+				strFeatures += ",";
+
+			strFeatures += (entry.second) ? "+" : "-";
+			strFeatures += entry.first().str();
+		}
+	}
+
+	return LLVMCreateMessage(strFeatures.c_str());
+}
+
+LLVMValueRef LLVMCloneFunction(LLVMValueRef pLvalFunction, const char * pChzName)
+{
+	ValueToValueMapTy vmap;
+	Function * pFunctionClone = CloneFunction(unwrap<Function>(pLvalFunction), vmap);
+	pFunctionClone->setName(pChzName);
+	return wrap(pFunctionClone);
+}
+
+void LLVMDeleteFunctionBody(LLVMValueRef pLvalFunction)
+{
+	// deleteBody drops the function's linkage back to external, preserve it.
+	Function * pFunction = unwrap<Function>(pLvalFunction);
+	auto linkage = pFunction->getLinkage();
+	pFunction->deleteBody();
+	pFunction->setLinkage(linkage);
+}
+
 LLVMDIBuilderRef LLVMCreateDIBuilder(LLVMModuleRef pMod)
 {
 	Module * pModule = unwrap(pMod);
@@ -149,7 +192,8 @@ LLVMValueRef LLVMDIBuilderCreateCompileUnit(
 		const char * pChzProducer,
 		LLVMBool fIsOptimized,
 		const char * pChzFlags,
-		unsigned nRuntimeVersion)
+		unsigned nRuntimeVersion,
+		LLVMBool fLineTablesOnly)
 {
 	StringRef strrProducer(pChzProducer);
 	StringRef strrFlags(pChzFlags);
@@ -161,7 +205,9 @@ LLVMValueRef LLVMDIBuilderCreateCompileUnit(
 											strrProducer,
 											fIsOptimized,
 											strrFlags,
-											nRuntimeVersion);
+											nRuntimeVersion,
+											StringRef(),
+											(fLineTablesOnly) ? DICompileUnit::LineTablesOnly : DICompileUnit::FullDebug);
 
 	LLVMValueRef pLvalCU = wrap(pCU);
 	assert(pCU == cast<DIScope>(PMdnodeExtract(pLvalCU)));
@@ -111,6 +111,44 @@ void CalculateStructAlignment(SDataLayout * pDlay, STypeInfoStruct * pTinstruct)
 	pTinstruct->m_cBAlign = cBAlignStruct;
 }
 
+static void CalculateSoaByteSizeAndAlign(SDataLayout * pDlay, STypeInfoArray * pTinary, u64 * pcB, u64 * pcBAlign)
+{
+	// matches the layout of the storage struct built by PTinstructEnsureSoa, computed directly as this may
+	//  be called before codegen has built the storage struct
+
+	*pcB = 0;
+	*pcBAlign = 1;
+	auto pTinstruct = PTinRtiCast<STypeInfoStruct *>(PTinStripQualifiers(pTinary->m_pTin));
+	if (!EWC_FVERIFY(pTinstruct, "SOA array with non-struct element type"))
+		return;
+
+	u64 cB = 0;
+	u64 cBAlignStruct = 1;
+	if (pTinary->m_aryk == ARYK_Reference)
+	{
+		cB = sizeof(s64);
+		cBAlignStruct = sizeof(s64);
+	}
+
+	auto pTypemembMac = pTinstruct->m_aryTypemembField.PMac();
+	for (auto pTypememb = pTinstruct->m_aryTypemembField.A(); pTypememb != pTypemembMac; ++pTypememb)
+	{
+		u64 cBField = pDlay->m_cBPointer;
+		u64 cBAlignField = pDlay->m_cBPointer;
+		if (pTinary->m_aryk == ARYK_Fixed)
+		{
+			CalculateByteSizeAndAlign(pDlay, pTypememb->m_pTin, &cBField, &cBAlignField);
+			cBField *= pTinary->m_c;
+		}
+
+		cB = CBAlign(cB, cBAlignField) + cBField;
+		cBAlignStruct = ewcMax(cBAlignStruct, cBAlignField);
+	}
+
+	*pcB = EWC::CBAlign(cB, cBAlignStruct);
+	*pcBAlign = cBAlignStruct;
+}
+
 void CalculateByteSizeAndAlign(SDataLayout * pDlay, STypeInfo * pTin, u64 * pcB, u64 * pcBAlign)
 {
 	// return the embeded size of a type (ie. how many bytes would be needed to include it in a struct)
@@ -145,6 +183,12 @@ void CalculateByteSizeAndAlign(SDataLayout * pDlay, STypeInfo * pTin, u64 * pcB,
     case TINK_Array:
 	{
 		auto pTinary = (STypeInfoArray *)pTin;
+		if (pTinary->m_fIsSoa)
+		{
+			CalculateSoaByteSizeAndAlign(pDlay, pTinary, pcB, pcBAlign);
+			return;
+		}
+
 		switch (pTinary->m_aryk)
 		{
 		case ARYK_Fixed: 
@@ -160,7 +204,11 @@ void CalculateByteSizeAndAlign(SDataLayout * pDlay, STypeInfo * pTin, u64 * pcB,
 			return;
 		}
 		case ARYK_Dynamic:
-			EWC_ASSERT(false, "dyn array is TBD");
+		{
+			*pcB = EWC::CBAlign(sizeof(s64) + pDlay->m_cBPointer, sizeof(s64)) + sizeof(s64);	//(count, pointer, capacity)
+			*pcBAlign = ewcMax<u64>(pDlay->m_cBPointer, sizeof(s64));
+			return;
+		}
 		} break;
 	}
 
@@ -268,12 +316,31 @@ inline bool FUseLargeOperand(IROP irop)
 	case IROP_Load:
 	case IROP_StoreToIdx:
 	case IROP_StoreToReg:
+	case IROP_LaneOp:
+	case IROP_LaneShuffle:
+	case IROP_LaneSelect:
 		return true;
 	default:
 		return false;
 	}
 }
 
+// lane ops pack the scalar opcode and lane count into one ExArgs word
+static inline u64 NPackLaneArgs(IROP irop, int cLane)
+{
+	return u64(u8(irop)) | (u64(cLane) << 32);
+}
+
+static inline IROP IropFromLaneArgs(const SWord & word)
+{
+	return IROP(s8(word.m_u64 & 0xFF));
+}
+
+static inline int CLaneFromLaneArgs(const SWord & word)
+{
+	return int(word.m_u64 >> 32);
+}
+
 // number of bytes used by this instruction's operands
 static inline s32 CBOperand(const SInstruction * pInst)
 {
@@ -379,6 +446,7 @@ SProcedureSignature::SProcedureSignature(STypeInfoProcedure * pTinproc)
 SProcedure::SProcedure(EWC::CAlloc * pAlloc)
 :SValue(VALK_Procedure)
 ,m_pProcsig(nullptr)
+,m_pProcAlias(nullptr)
 ,m_cBStack(0)
 ,m_pBlockLocals(nullptr)
 ,m_pBlockFirst(nullptr)
@@ -389,7 +457,6 @@ SProcedure::SProcedure(EWC::CAlloc * pAlloc)
 
 CBuilder::CBuilder(CWorkspace * pWork, SDataLayout * pDlay, EWC::CHash<HV, void*> * pHashHvPFnForeign)
 :CBuilderBase(pWork)
-,m_pSymtab(pWork->m_pSymtab)
 ,m_pAlloc(pWork->m_pAlloc)
 ,m_pBerrctx(nullptr)
 ,m_pDlay(pDlay)
@@ -402,6 +469,7 @@ CBuilder::CBuilder(CWorkspace * pWork, SDataLayout * pDlay, EWC::CHash<HV, void*
 ,m_hashPSymPVal(pWork->m_pAlloc, BK_ByteCodeCreator, 256)
 ,m_hashPTinlitPGlob(pWork->m_pAlloc, BK_ByteCodeCreator, 256)
 ,m_hashPTinstructPCgstruct(pWork->m_pAlloc, BK_ByteCodeCreator, 32)
+,m_hashPTinaryPGlobInit(pWork->m_pAlloc, BK_ByteCodeCreator, 32)
 ,m_hashPTinprocPProcsig(pWork->m_pAlloc, BK_ByteCodeCreator, 32)
 ,m_phashHvPFnForeign(pHashHvPFnForeign)
 ,m_blistConst(pWork->m_pAlloc, BK_ByteCodeCreator)
@@ -446,6 +514,7 @@ void CBuilder::Clear()
 		}
 
 		m_hashPTinstructPCgstruct.Clear(0);
+		m_hashPTinaryPGlobInit.Clear(0);
 	}
 
 	{
@@ -879,6 +948,16 @@ void CDataSegment::AddDeepCopyPointers(SDataLayout * pDlay, STypeInfo * pTin, s3
 		case TINK_Array:
 			{
 				auto pTinary = (STypeInfoArray *)pTin;
+				if (pTinary->m_fIsSoa)
+				{
+					if (EWC_FVERIFY(pTinary->m_pTinstructSoa, "SOA storage should be built before copying constants"))
+					{
+						AddDeepCopyPointers(pDlay, pTinary->m_pTinstructSoa, iBDst, iBSrc);
+					}
+					pTin = nullptr;
+					break;
+				}
+
 				s64 cElement = 0;
 				switch (pTinary->m_aryk)
 				{
@@ -893,6 +972,11 @@ void CDataSegment::AddDeepCopyPointers(SDataLayout * pDlay, STypeInfo * pTin, s3
 						AddRelocatedPointer(pDlay, iBDst, *(s32*)pBSrc);
 
 					} break;
+				case ARYK_Dynamic:
+					{
+						// constant dynamic arrays are always empty, there's no storage to relocate
+						EWC_ASSERT(*(s64*)PBFromIndex(iBSrc) == 0, "expected empty constant dynamic array");
+					} break;
 				case ARYK_Fixed:
 					{
 						cElement = pTinary->m_c;
@@ -1193,6 +1277,41 @@ void CBuilder::PrintDump()
 					PrintIntOperand(&strbuf, 8, pInst->m_opkLhs, pInst->m_wordLhs, true);
 					AppendCoz(&strbuf, " bytes");
 				} break;
+			case IROP_LaneOp:
+			case IROP_LaneShuffle:
+			case IROP_LaneReduce:
+			case IROP_LaneSelect:
+				{
+					AppendToCch(&strbuf, ' ', s_operandPos);
+					PrintIntOperand(&strbuf, cBLhs, pInst->m_opkLhs, pInst->m_wordLhs, true);
+
+					auto iropLane = pInst->m_irop;
+					auto iBStackOut = pInst->m_iBStackOut;
+					++pInst; 
+					if (!EWC_FVERIFY(pInst->m_irop == IROP_ExArgs, "expected exArgs"))
+						break;
+
+					switch (iropLane)
+					{
+					case IROP_LaneShuffle:	FormatCoz(&strbuf, ", lanes(0x%llx)", pInst->m_wordLhs.m_u64);	break;
+					case IROP_LaneSelect:
+						{
+							AppendCoz(&strbuf, ", ");
+							PrintIntOperand(&strbuf, 4, pInst->m_opkLhs, pInst->m_wordLhs, true);
+							AppendCoz(&strbuf, ", ");
+							PrintIntOperand(&strbuf, 4, pInst->m_opkRhs, pInst->m_wordRhs, true);
+						} break;
+					default:
+						FormatCoz(&strbuf, " %s x%d", PChzFromIrop(IropFromLaneArgs(pInst->m_wordRhs)), CLaneFromLaneArgs(pInst->m_wordRhs));
+						if (iropLane == IROP_LaneOp)
+						{
+							AppendCoz(&strbuf, ", ");
+							PrintIntOperand(&strbuf, 4, pInst->m_opkLhs, pInst->m_wordLhs, true);
+						}
+						break;
+					}
+					FormatCoz(&strbuf, " %d byte lanes ->[%d]", pInst->m_cBRegister, iBStackOut);
+				} break;
 			case IROP_TraceStore:
 				{
 					AppendToCch(&strbuf, ' ', s_operandPos);
@@ -1328,6 +1447,169 @@ void CBuilder::PrintDump()
 
 void CBuilder::FinalizeBuild(CWorkspace * pWork)
 {
+	MergeIdenticalProcedures();
+}
+
+static inline bool FIsDirectCall(const SInstruction * pInst)
+{
+	if (pInst->m_irop != IROP_Call || FIsRegister(pInst->m_opkLhs))
+		return false;
+
+	auto pProcsig = (SProcedureSignature *)pInst->m_wordRhs.m_pV;
+	return !pProcsig->m_pTinproc->FIsForeign();
+}
+
+static inline SProcedure * PProcResolveAlias(SProcedure * pProc)
+{
+	while (pProc->m_pProcAlias)
+	{
+		pProc = pProc->m_pProcAlias;
+	}
+	return pProc;
+}
+
+static bool FAreParametersEqual(const SParameter * aParamA, const SParameter * aParamB, size_t cParam)
+{
+	for (size_t iParam = 0; iParam < cParam; ++iParam)
+	{
+		if (aParamA[iParam].m_cB != aParamB[iParam].m_cB || 
+			aParamA[iParam].m_cBAlign != aParamB[iParam].m_cBAlign || 
+			aParamA[iParam].m_iBStack != aParamB[iParam].m_iBStack)
+			return false;
+	}
+	return true;
+}
+
+static bool FAreProcsigLayoutsEqual(SProcedureSignature * pProcsigA, SProcedureSignature * pProcsigB)
+{
+	if (pProcsigA->m_sIBStackVariadic != pProcsigB->m_sIBStackVariadic ||
+		pProcsigA->m_cBArgReturn != pProcsigB->m_cBArgReturn ||
+		pProcsigA->m_cBArgNamed != pProcsigB->m_cBArgNamed)
+		return false;
+
+	auto pTinprocA = pProcsigA->m_pTinproc;
+	auto pTinprocB = pProcsigB->m_pTinproc;
+	if (pTinprocA->m_grftinproc != pTinprocB->m_grftinproc ||
+		pTinprocA->m_arypTinParams.C() != pTinprocB->m_arypTinParams.C() ||
+		pTinprocA->m_arypTinReturns.C() != pTinprocB->m_arypTinReturns.C())
+		return false;
+
+	return FAreParametersEqual(pProcsigA->m_aParamArg, pProcsigB->m_aParamArg, pTinprocA->m_arypTinParams.C()) &&
+		FAreParametersEqual(pProcsigA->m_aParamRet, pProcsigB->m_aParamRet, pTinprocA->m_arypTinReturns.C());
+}
+
+static HV HvFromProcBody(SProcedure * pProc)
+{
+	HV hv = HvFromPBFVN(&pProc->m_cBStack, sizeof(pProc->m_cBStack));
+	auto pInstMac = pProc->m_aryInst.PMac();
+	for (auto pInst = pProc->m_aryInst.A(); pInst != pInstMac; ++pInst)
+	{
+		// direct call targets are left out so procedures that recurse into themselves can still match
+		size_t cB = FIsDirectCall(pInst) ? EWC_OFFSET_OF(SInstruction, m_wordLhs) : sizeof(SInstruction);
+		hv = HvConcatPBFVN(hv, pInst, cB);
+	}
+	return hv;
+}
+
+static bool FAreProcBodiesEqual(SProcedure * pProcA, SProcedure * pProcB)
+{
+	if (pProcA->m_cBStack != pProcB->m_cBStack || pProcA->m_aryInst.C() != pProcB->m_aryInst.C())
+		return false;
+
+	if (!FAreProcsigLayoutsEqual(pProcA->m_pProcsig, pProcB->m_pProcsig))
+		return false;
+
+	auto pInstB = pProcB->m_aryInst.A();
+	auto pInstMac = pProcA->m_aryInst.PMac();
+	for (auto pInstA = pProcA->m_aryInst.A(); pInstA != pInstMac; ++pInstA, ++pInstB)
+	{
+		if (!FIsDirectCall(pInstA))
+		{
+			if (memcmp(pInstA, pInstB, sizeof(SInstruction)) != 0)
+				return false;
+			continue;
+		}
+
+		if (memcmp(pInstA, pInstB, EWC_OFFSET_OF(SInstruction, m_wordLhs)) != 0 || !FIsDirectCall(pInstB))
+			return false;
+
+		// a call into itself matches the other procedure's call into itself. Call sites that were routed to an alias 
+		//  keep their original signature (for tracing), so signatures only need matching layouts.
+		auto pProcCalleeA = (SProcedure *)pInstA->m_wordLhs.m_pV;
+		auto pProcCalleeB = (SProcedure *)pInstB->m_wordLhs.m_pV;
+		bool fIsSelfCall = pProcCalleeA == pProcA && pProcCalleeB == pProcB;
+		if (!fIsSelfCall && pProcCalleeA != pProcCalleeB)
+			return false;
+
+		auto pProcsigA = (SProcedureSignature *)pInstA->m_wordRhs.m_pV;
+		auto pProcsigB = (SProcedureSignature *)pInstB->m_wordRhs.m_pV;
+		if (pProcsigA != pProcsigB && !FAreProcsigLayoutsEqual(pProcsigA, pProcsigB))
+			return false;
+	}
+	return true;
+}
+
+void CBuilder::MergeIdenticalProcedures()
+{
+	// Generic instantiations frequently generate identical bytecode (ie. a container of &Foo and a container 
+	//  of &Bar). Procedures with matching bodies and argument layout are aliased to a single copy and every direct 
+	//  call is routed to it. Merging a set of callees can make their callers identical, so we iterate until nothing 
+	//  new is merged. Alias bodies are kept intact as they can still be reached through procedure pointers.
+
+	EWC::CDynAry<SProcedure *> arypProc(m_pAlloc, BK_ByteCodeCreator, m_hashHvMangledPProc.C());
+	EWC::CHash<HV, SProcedure *>::CIterator iterProc(&m_hashHvMangledPProc);
+	while (SProcedure ** ppProc = iterProc.Next())
+	{
+		auto pProc = *ppProc;
+		if (pProc->m_pProcAlias || pProc->m_aryInst.FIsEmpty() || pProc->m_pProcsig->m_pTinproc->FIsForeign())
+			continue;
+
+		arypProc.Append(pProc);
+	}
+
+	EWC::CHash<HV, SProcedure *> hashHvPProc(m_pAlloc, BK_ByteCodeCreator, (u32)arypProc.C());
+	bool fMergedAny;
+	do
+	{
+		fMergedAny = false;
+		hashHvPProc.Clear(0);
+
+		for (size_t ipProc = 0; ipProc < arypProc.C(); )
+		{
+			auto pProc = arypProc[ipProc];
+
+			SProcedure ** ppProcMatch = nullptr;
+			if (hashHvPProc.FinsEnsureKey(HvFromProcBody(pProc), &ppProcMatch) == FINS_Inserted)
+			{
+				*ppProcMatch = pProc;
+			}
+			else if (*ppProcMatch != pProc && FAreProcBodiesEqual(*ppProcMatch, pProc))
+			{
+				pProc->m_pProcAlias = *ppProcMatch;
+				arypProc.RemoveFastByI(ipProc);
+				fMergedAny = true;
+				continue;
+			}
+
+			++ipProc;
+		}
+
+		if (!fMergedAny)
+			break;
+
+		SProcedure ** ppProcMac = arypProc.PMac();
+		for (SProcedure ** ppProc = arypProc.A(); ppProc != ppProcMac; ++ppProc)
+		{
+			auto pInstMac = (*ppProc)->m_aryInst.PMac();
+			for (auto pInst = (*ppProc)->m_aryInst.A(); pInst != pInstMac; ++pInst)
+			{
+				if (FIsDirectCall(pInst))
+				{
+					pInst->m_wordLhs.m_pV = PProcResolveAlias((SProcedure *)pInst->m_wordLhs.m_pV);
+				}
+			}
+		}
+	} while (fMergedAny);
 }
 
 CBuilder::LType * CBuilder::PLtypeVoid()
@@ -1445,6 +1727,13 @@ CBuilder::Instruction * CBuilder::PInstCreateGEP(SValue * pValLhs, SValue ** apL
 		case TINK_Array:
 			{
 				auto pTinary = (STypeInfoArray*)pTin;
+				if (pTinary->m_fIsSoa)
+				{
+					// SOA arrays are addressed through their storage struct, make sure its offsets are computed
+					pTinstruct = PTinstructEnsureSoa(m_pSymtab, pTinary);
+					CalculateByteSizeAndAlign(m_pDlay, pTinstruct, &cB, &cBAlign);
+					break;
+				}
 
 				switch (pTinary->m_aryk)
 				{
@@ -1455,6 +1744,7 @@ CBuilder::Instruction * CBuilder::PInstCreateGEP(SValue * pValLhs, SValue ** apL
 						cBStride = U32Coerce(EWC::CBAlign(cB, cBAlign));
 					} break;
 				case ARYK_Reference:
+				case ARYK_Dynamic:
 					{
 						pTinaryRef = pTinary;
 					} break;
@@ -1535,6 +1825,12 @@ CBuilder::Instruction * CBuilder::PInstCreateGEP(SValue * pValLhs, SValue ** apL
 								// NOTE: ptr to pTin, not pTin... need one more GEP index for array element
 								pTin = m_pSymtab->PTinptrAllocate(pTinaryRef->m_pTin);
 							} break;
+						case ARYMEMB_Capacity:
+							{
+								EWC_ASSERT(pTinaryRef->m_aryk == ARYK_Dynamic, "only dynamic arrays have a capacity");
+								dBOffset += EWC::CBAlign(sizeof(s64) + m_pDlay->m_cBPointer, sizeof(s64));
+								pTin = m_pSymtab->PTinBuiltin(CSymbolTable::s_strS64);
+							} break;
 						}
 					}
 				}
@@ -1985,6 +2281,122 @@ SInstructionValue * CBuilder::PInstCreateTraceStore(SValue * pVal, STypeInfo * p
 	return PInstCreateRaw(IROP_TraceStore, pVal, PConstPointer(pTin));
 }
 
+void CBuilder::CreateBoundsCheck(SValue * pValIndex, SValue * pValCount)
+{
+	(void) PInstCreateRaw(IROP_BoundsCheck, pValIndex, pValCount);
+}
+
+SInstruction * CBuilder::PInstCreateLaneRaw(IROP irop, SValue * pValLhs, STypeInfo * pTinOut, s32 cBLane, SInstructionValue ** ppInstval)
+{
+	// lane instructions are followed by an ExArgs block describing the lanes, the simd structure operands and 
+	//  results live in large registers (like Load/Store)
+
+	if (!EWC_FVERIFY(m_pBlockCur && !m_pBlockCur->FIsFinalized(), "creating lane instruction with no active block"))
+	{
+		*ppInstval = PInstCreateError();
+		return nullptr;
+	}
+
+	u64 cBOut;
+	u64 cBAlignOut;
+	CalculateByteSizeAndAlign(m_pDlay, pTinOut, &cBOut, &cBAlignOut);
+
+	auto pOpsig = POpsig(irop);
+	auto pInstval = PInstAlloc();
+	auto pInst = pInstval->m_pInst;
+	pInst->m_irop = irop;
+
+	SValueOutput valout;
+	SetOperandFromValue(m_pDlay, pValLhs, &pInst->m_opkLhs, &pInst->m_wordLhs, pOpsig->m_opszLhs, &valout);
+	AllocateStackOut(this, pInst, cBOut, cBAlignOut);
+
+	if (FUseLargeOperand(irop))
+	{
+		pInst->m_wordRhs.m_s32 = S32Coerce(cBOut);
+	}
+	else
+	{
+		pInst->m_cBRegister = U8Coerce(cBOut);
+	}
+	pInstval->m_pTinOperand = pTinOut;
+	*ppInstval = pInstval;
+
+	auto pInstEx = PInstAlloc()->m_pInst;
+	pInstEx->m_irop = IROP_ExArgs;
+	pInstEx->m_cBRegister = U8Coerce(cBLane);
+	pInstEx->m_wordLhs.m_u64 = 0;
+	pInstEx->m_wordRhs.m_u64 = 0;
+	return pInstEx;
+}
+
+static inline s32 CBLane(SDataLayout * pDlay, STypeInfoStruct * pTinstruct)
+{
+	u64 cBLane;
+	u64 cBAlignLane;
+	CalculateByteSizeAndAlign(pDlay, pTinstruct->PTinLane(), &cBLane, &cBAlignLane);
+	return S32Coerce(cBLane);
+}
+
+SInstructionValue * CBuilder::PInstCreateLaneOp(IROP irop, s32 pred, STypeInfoStruct * pTinstruct, SValue * pValLhs, SValue * pValRhs, const char * pChzName)
+{
+	bool fIsCmp = (irop == IROP_NCmp) | (irop == IROP_GCmp);
+	STypeInfo * pTinOut = (fIsCmp) ? m_pSymtab->PTinBuiltin(CSymbolTable::s_strU32) : pTinstruct;
+
+	SInstructionValue * pInstval;
+	auto pInstEx = PInstCreateLaneRaw(IROP_LaneOp, pValLhs, pTinOut, CBLane(m_pDlay, pTinstruct), &pInstval);
+	if (!pInstEx)
+		return pInstval;
+
+	SValueOutput valout;
+	if (pValRhs)
+	{
+		SetOperandFromValue(m_pDlay, pValRhs, &pInstEx->m_opkLhs, &pInstEx->m_wordLhs, OPSZ_RegIdx, &valout);
+	}
+	pInstEx->m_wordRhs.m_u64 = NPackLaneArgs(irop, pTinstruct->CLane());
+	pInstEx->m_pred = pred;
+	return pInstval;
+}
+
+SInstructionValue * CBuilder::PInstCreateLaneShuffle(STypeInfoStruct * pTinstruct, SValue * pVal, const s32 * aiLane, const char * pChzName)
+{
+	SInstructionValue * pInstval;
+	auto pInstEx = PInstCreateLaneRaw(IROP_LaneShuffle, pVal, pTinstruct, CBLane(m_pDlay, pTinstruct), &pInstval);
+	if (!pInstEx)
+		return pInstval;
+
+	int cLane = pTinstruct->CLane();
+	for (int iLane = 0; iLane < cLane; ++iLane)
+	{
+		pInstEx->m_wordLhs.m_u64 |= u64(aiLane[iLane] & 0xF) << (iLane * 4);
+	}
+	return pInstval;
+}
+
+SInstructionValue * CBuilder::PInstCreateLaneReduce(IROP irop, s32 pred, STypeInfoStruct * pTinstruct, SValue * pVal, const char * pChzName)
+{
+	SInstructionValue * pInstval;
+	auto pInstEx = PInstCreateLaneRaw(IROP_LaneReduce, pVal, pTinstruct->PTinLane(), CBLane(m_pDlay, pTinstruct), &pInstval);
+	if (!pInstEx)
+		return pInstval;
+
+	pInstEx->m_wordRhs.m_u64 = NPackLaneArgs(irop, pTinstruct->CLane());
+	pInstEx->m_pred = pred;
+	return pInstval;
+}
+
+SInstructionValue * CBuilder::PInstCreateLaneSelect(STypeInfoStruct * pTinstruct, SValue * pValMask, SValue * pValTrue, SValue * pValFalse, const char * pChzName)
+{
+	SInstructionValue * pInstval;
+	auto pInstEx = PInstCreateLaneRaw(IROP_LaneSelect, pValMask, pTinstruct, CBLane(m_pDlay, pTinstruct), &pInstval);
+	if (!pInstEx)
+		return pInstval;
+
+	SValueOutput valout;
+	SetOperandFromValue(m_pDlay, pValTrue, &pInstEx->m_opkLhs, &pInstEx->m_wordLhs, OPSZ_RegIdx, &valout);
+	SetOperandFromValue(m_pDlay, pValFalse, &pInstEx->m_opkRhs, &pInstEx->m_wordRhs, OPSZ_RegIdx, &valout);
+	return pInstval;
+}
+
 void CBuilder::CreateBranch(SBlock * pBlock)
 {
 	EWC_ASSERT(m_pBlockCur && !m_pBlockCur->FIsFinalized(), "cannot allocate instructions without a unfinalized basic block");
@@ -2695,25 +3107,30 @@ static inline void ReadCastOpcodes(CVirtualMachine * pVm, SInstruction * pInst,
 	}
 }
 
-static inline void * PVReadAddressLhs(CVirtualMachine * pVm, SInstruction * pInst, SWord * pWordTemp)
+static inline void * PVReadAddress(CVirtualMachine * pVm, OPK opk, SWord * pWord)
 {
-	switch (pInst->m_opkLhs)
+	switch (opk)
 	{
 	case OPK_Literal:
 	case OPK_LiteralArg:	
-		return &pInst->m_wordLhs;
+		return pWord;
 	case OPK_Register:
 	case OPK_RegisterArg:	
-		return &pVm->m_pBStack[pInst->m_wordLhs.m_s32];
+		return &pVm->m_pBStack[pWord->m_s32];
 	case OPK_GlobalVal:
 	case OPK_Global:		
-		return &pVm->m_pBGlobal[pInst->m_wordLhs.m_s32];
+		return &pVm->m_pBGlobal[pWord->m_s32];
 	default: 
 		EWC_ASSERT(false, "unhandled OPK");
 		return nullptr;
 	}
 }
 
+static inline void * PVReadAddressLhs(CVirtualMachine * pVm, SInstruction * pInst, SWord * pWordTemp)
+{
+	return PVReadAddress(pVm, pInst->m_opkLhs, &pInst->m_wordLhs);
+}
+
 // partial specialization to help write op handlers
 template <s32 CB> struct SWordOpsize			{ };
 template <> struct SWordOpsize<1>			
@@ -2777,6 +3194,196 @@ bool FEvaluateGCmp(GPRED gpred, SWord & wordLhs, SWord & wordRhs)
 	return false;
 }
 
+template <s32 CB>
+SWord WordEvaluateNLane(IROP irop, SWord & wordLhs, SWord & wordRhs)
+{
+	// evaluate in 64 bits from the sign/zero extended operands, the caller truncates to the lane size
+	s64 nSLhs = SWordOpsize<CB>::Signed(wordLhs);
+	s64 nSRhs = SWordOpsize<CB>::Signed(wordRhs);
+	u64 nULhs = SWordOpsize<CB>::Unsigned(wordLhs);
+	u64 nURhs = SWordOpsize<CB>::Unsigned(wordRhs);
+
+	SWord wordOut;
+	wordOut.m_u64 = 0;
+	switch (irop)
+	{
+	case IROP_NAdd:	wordOut.m_u64 = nULhs + nURhs;		break;
+	case IROP_NSub:	wordOut.m_u64 = nULhs - nURhs;		break;
+	case IROP_NMul:	wordOut.m_u64 = nULhs * nURhs;		break;
+	case IROP_SDiv:	wordOut.m_s64 = nSLhs / nSRhs;		break;
+	case IROP_UDiv:	wordOut.m_u64 = nULhs / nURhs;		break;
+	case IROP_SRem:	wordOut.m_s64 = nSLhs % nSRhs;		break;
+	case IROP_URem:	wordOut.m_u64 = nULhs % nURhs;		break;
+	case IROP_Shl:	wordOut.m_u64 = nULhs << nURhs;		break;
+	case IROP_AShr:	wordOut.m_s64 = nSLhs >> nURhs;		break;
+	case IROP_LShr:	wordOut.m_u64 = nULhs >> nURhs;		break;
+	case IROP_And:	wordOut.m_u64 = nULhs & nURhs;		break;
+	case IROP_Or:	wordOut.m_u64 = nULhs | nURhs;		break;
+	case IROP_Xor:	wordOut.m_u64 = nULhs ^ nURhs;		break;
+	case IROP_NNeg:	wordOut.m_s64 = -nSLhs;				break;
+	case IROP_Not:	wordOut.m_u64 = ~nULhs;				break;
+	default: EWC_ASSERT(false, "unhandled integer lane op IROP_%s", PChzFromIrop(irop));
+	}
+	return wordOut;
+}
+
+template <s32 CB>
+SWord WordEvaluateGLane(IROP irop, SWord & wordLhs, SWord & wordRhs)
+{
+	auto gLhs = SWordOpsize<CB>::Float(wordLhs);
+	auto gRhs = SWordOpsize<CB>::Float(wordRhs);
+	decltype(gLhs) gOut = 0;
+
+	switch (irop)
+	{
+	case IROP_GAdd:	gOut = gLhs + gRhs;						break;
+	case IROP_GSub:	gOut = gLhs - gRhs;						break;
+	case IROP_GMul:	gOut = gLhs * gRhs;						break;
+	case IROP_GDiv:	gOut = gLhs / gRhs;						break;
+	case IROP_GRem:	gOut = decltype(gLhs)(fmod(gLhs, gRhs));	break;
+	case IROP_GNeg:	gOut = -gLhs;							break;
+	default: EWC_ASSERT(false, "unhandled float lane op IROP_%s", PChzFromIrop(irop));
+	}
+
+	SWord wordOut;
+	wordOut.m_u64 = 0;
+	memcpy(&wordOut, &gOut, sizeof(gOut));
+	return wordOut;
+}
+
+static inline bool FIsFloatLaneOp(IROP irop)
+{
+	switch (irop)
+	{
+	case IROP_GAdd:
+	case IROP_GSub:
+	case IROP_GMul:
+	case IROP_GDiv:
+	case IROP_GRem:
+	case IROP_GNeg:
+	case IROP_GCmp:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static SWord WordEvaluateLane(IROP irop, s32 cBLane, SWord & wordLhs, SWord & wordRhs)
+{
+	if (FIsFloatLaneOp(irop))
+	{
+		switch (cBLane)
+		{
+		case 4: return WordEvaluateGLane<4>(irop, wordLhs, wordRhs);
+		case 8: return WordEvaluateGLane<8>(irop, wordLhs, wordRhs);
+		}
+	}
+	else
+	{
+		switch (cBLane)
+		{
+		case 1: return WordEvaluateNLane<1>(irop, wordLhs, wordRhs);
+		case 2: return WordEvaluateNLane<2>(irop, wordLhs, wordRhs);
+		case 4: return WordEvaluateNLane<4>(irop, wordLhs, wordRhs);
+		case 8: return WordEvaluateNLane<8>(irop, wordLhs, wordRhs);
+		}
+	}
+
+	EWC_ASSERT(false, "unhandled lane size %d for IROP_%s", cBLane, PChzFromIrop(irop));
+	return wordLhs;
+}
+
+static bool FEvaluateLaneCmp(IROP irop, s32 pred, s32 cBLane, SWord & wordLhs, SWord & wordRhs)
+{
+	if (irop == IROP_GCmp)
+	{
+		switch (cBLane)
+		{
+		case 4: return FEvaluateGCmp<4>((GPRED)pred, wordLhs, wordRhs);
+		case 8: return FEvaluateGCmp<8>((GPRED)pred, wordLhs, wordRhs);
+		}
+	}
+	else
+	{
+		switch (cBLane)
+		{
+		case 1: return FEvaluateNCmp<1>((NPRED)pred, wordLhs, wordRhs);
+		case 2: return FEvaluateNCmp<2>((NPRED)pred, wordLhs, wordRhs);
+		case 4: return FEvaluateNCmp<4>((NPRED)pred, wordLhs, wordRhs);
+		case 8: return FEvaluateNCmp<8>((NPRED)pred, wordLhs, wordRhs);
+		}
+	}
+
+	EWC_ASSERT(false, "unhandled lane size %d for compare", cBLane);
+	return false;
+}
+
+static inline void LoadLane(SWord * pWord, const u8 * pBLanes, int iLane, s32 cBLane)
+{
+	pWord->m_u64 = 0;
+	memcpy(pWord, &pBLanes[iLane * cBLane], cBLane);
+}
+
+static void EvaluateLaneOp(IROP irop, s32 pred, s32 cBLane, int cLane, const u8 * pBLhs, const u8 * pBRhs, u8 * pBOut)
+{
+	// the output may alias an operand, each lane is read before it is written
+	SWord wordLhs, wordRhs;
+	wordRhs.m_u64 = 0;
+
+	if ((irop == IROP_NCmp) | (irop == IROP_GCmp))
+	{
+		u32 grfLane = 0;
+		for (int iLane = 0; iLane < cLane; ++iLane)
+		{
+			LoadLane(&wordLhs, pBLhs, iLane, cBLane);
+			LoadLane(&wordRhs, pBRhs, iLane, cBLane);
+			if (FEvaluateLaneCmp(irop, pred, cBLane, wordLhs, wordRhs))
+			{
+				grfLane |= 0x1 << iLane;
+			}
+		}
+		memcpy(pBOut, &grfLane, sizeof(grfLane));
+		return;
+	}
+
+	for (int iLane = 0; iLane < cLane; ++iLane)
+	{
+		LoadLane(&wordLhs, pBLhs, iLane, cBLane);
+		if (pBRhs)
+		{
+			LoadLane(&wordRhs, pBRhs, iLane, cBLane);
+		}
+
+		SWord wordOut = WordEvaluateLane(irop, cBLane, wordLhs, wordRhs);
+		memcpy(&pBOut[iLane * cBLane], &wordOut, cBLane);
+	}
+}
+
+static void EvaluateLaneReduce(IROP irop, s32 pred, s32 cBLane, int cLane, const u8 * pBLhs, u8 * pBOut)
+{
+	SWord wordAcc, wordLane;
+	LoadLane(&wordAcc, pBLhs, 0, cBLane);
+
+	for (int iLane = 1; iLane < cLane; ++iLane)
+	{
+		LoadLane(&wordLane, pBLhs, iLane, cBLane);
+		if ((irop == IROP_NCmp) | (irop == IROP_GCmp))
+		{
+			// min/max: keep the accumulator while pred(acc, lane) holds
+			if (!FEvaluateLaneCmp(irop, pred, cBLane, wordAcc, wordLane))
+			{
+				wordAcc = wordLane;
+			}
+		}
+		else
+		{
+			wordAcc = WordEvaluateLane(irop, cBLane, wordAcc, wordLane);
+		}
+	}
+
+	memcpy(pBOut, &wordAcc, cBLane);
+}
+
 SValue * CBuilder::PLvalConstNCmp(NPRED npred, STypeInfo * pTin, LValue * pLvalLhs, LValue * pLvalRhs)
 {
 	u64 cB;
@@ -2961,6 +3568,13 @@ void PrintInstance(CVirtualMachine * pVm, STypeInfo * pTin, u8 * pData)
     case TINK_Array:
 	{
 		auto pTinary = (STypeInfoArray *)pTin;
+		if (pTinary->m_fIsSoa && pTinary->m_pTinstructSoa)
+		{
+			AppendCoz(pVm->m_pStrbuf, "SOA");
+			PrintInstance(pVm, pTinary->m_pTinstructSoa, pData);
+			break;
+		}
+
 		s64 c;
 		u8 * pDataAdj = pData;
 		switch (pTinary->m_aryk)
@@ -2973,7 +3587,8 @@ void PrintInstance(CVirtualMachine * pVm, STypeInfo * pTin, u8 * pData)
 		case ARYK_Dynamic:
 			{
 				AppendCoz(pVm->m_pStrbuf, "[..]{");
-					
+				c = *(s64 *)pData;
+				pDataAdj = *(u8 **)(pData + sizeof(s64));
 			} break;
 		case ARYK_Reference:
 			{
@@ -3284,8 +3899,10 @@ void CallForeignFunction(CVirtualMachine * pVm, void * pFnForeign, SProcedureSig
 	dcReset(pVm->m_pDcvm);
 }
 
-void ExecuteBytecode(CVirtualMachine * pVm, SProcedure * pProcEntry)
+bool ExecuteBytecode(CVirtualMachine * pVm, SProcedure * pProcEntry)
 {
+	u8 * pBStackEntry = pVm->m_pBStack;
+
 #if DEBUG_PROC_CALL
 	auto pDebcall = pVm->m_aryDebCall.AppendNew();
 	pDebcall->m_ppInstCall = nullptr;
@@ -3801,7 +4418,9 @@ void ExecuteBytecode(CVirtualMachine * pVm, SProcedure * pProcEntry)
 
 			if (*ppInstRet == nullptr)
 			{
-				return; // halt
+				dcFree(pVm->m_pDcvm);
+				pVm->m_pDcvm = nullptr;
+				return true; // halt
 			}
 
 			auto pInstCall = *ppInstRet;
@@ -3930,6 +4549,91 @@ void ExecuteBytecode(CVirtualMachine * pVm, SProcedure * pProcEntry)
 			ReadOpcode(pVm, pInst, 8, &wordLhsEx);
 			memset(wordLhs.m_pV, wordRhs.m_u8, wordLhsEx.m_u64);
 		} break;
+		case MASHOP(IROP_BoundsCheck, 8):
+		{
+			ReadOpcodes(pVm, pInst, 8, &wordLhs, &wordRhs);
+			if (wordLhs.m_u64 >= wordRhs.m_u64)
+			{
+				if (pVm->m_pStrbuf)
+				{
+					FormatCoz(pVm->m_pStrbuf, "boundsCheck(%lld, %lld);", wordLhs.m_s64, wordRhs.m_s64);
+				}
+				else
+				{
+					printf("array index %lld out of bounds (count %lld)\n", wordLhs.m_s64, wordRhs.m_s64);
+				}
+
+				dcFree(pVm->m_pDcvm);
+				pVm->m_pDcvm = nullptr;
+				pVm->m_pBStack = pBStackEntry;
+				return false; // halt
+			}
+		} break;
+		case MASHOP(IROP_LaneOp, 0):
+		{
+			auto pBLhs = (u8 *)PVReadAddressLhs(pVm, pInst, &wordLhs);
+			u8 * pBOut = &pVm->m_pBStack[pInst->m_iBStackOut];
+			++pInst;
+			if (!EWC_FVERIFY(pInst->m_irop == IROP_ExArgs, "expected extended argument block"))
+				break;
+
+			auto irop = IropFromLaneArgs(pInst->m_wordRhs);
+			auto pBRhs = (irop >= IROP_UnaryOpMin && irop < IROP_UnaryOpMax) ? nullptr : (u8 *)PVReadAddress(pVm, pInst->m_opkLhs, &pInst->m_wordLhs);
+			EvaluateLaneOp(irop, pInst->m_pred, pInst->m_cBRegister, CLaneFromLaneArgs(pInst->m_wordRhs), pBLhs, pBRhs, pBOut);
+		} break;
+		case MASHOP(IROP_LaneReduce, 1):
+		case MASHOP(IROP_LaneReduce, 2):
+		case MASHOP(IROP_LaneReduce, 4):
+		case MASHOP(IROP_LaneReduce, 8):
+		{
+			auto pBLhs = (u8 *)PVReadAddressLhs(pVm, pInst, &wordLhs);
+			u8 * pBOut = &pVm->m_pBStack[pInst->m_iBStackOut];
+			++pInst;
+			if (!EWC_FVERIFY(pInst->m_irop == IROP_ExArgs, "expected extended argument block"))
+				break;
+
+			EvaluateLaneReduce(
+				IropFromLaneArgs(pInst->m_wordRhs), pInst->m_pred, pInst->m_cBRegister, CLaneFromLaneArgs(pInst->m_wordRhs), pBLhs, pBOut);
+		} break;
+		case MASHOP(IROP_LaneShuffle, 0):
+		{
+			auto pBLhs = (u8 *)PVReadAddressLhs(pVm, pInst, &wordLhs);
+			u8 * pBOut = &pVm->m_pBStack[pInst->m_iBStackOut];
+			s32 cB = pInst->m_wordRhs.m_s32;
+			++pInst;
+			if (!EWC_FVERIFY(pInst->m_irop == IROP_ExArgs, "expected extended argument block"))
+				break;
+
+			u8 aBLane[s_cLaneSimdMax * sizeof(u64)];
+			memcpy(aBLane, pBLhs, cB);
+
+			s32 cBLane = pInst->m_cBRegister;
+			int cLane = cB / cBLane;
+			for (int iLane = 0; iLane < cLane; ++iLane)
+			{
+				int iLaneSrc = int((pInst->m_wordLhs.m_u64 >> (iLane * 4)) & 0xF);
+				memcpy(&pBOut[iLane * cBLane], &aBLane[iLaneSrc * cBLane], cBLane);
+			}
+		} break;
+		case MASHOP(IROP_LaneSelect, 0):
+		{
+			ReadOpcode(pVm, pInst, 4, &wordLhs);
+			u8 * pBOut = &pVm->m_pBStack[pInst->m_iBStackOut];
+			s32 cB = pInst->m_wordRhs.m_s32;
+			++pInst;
+			if (!EWC_FVERIFY(pInst->m_irop == IROP_ExArgs, "expected extended argument block"))
+				break;
+
+			auto pBTrue = (u8 *)PVReadAddress(pVm, pInst->m_opkLhs, &pInst->m_wordLhs);
+			auto pBFalse = (u8 *)PVReadAddress(pVm, pInst->m_opkRhs, &pInst->m_wordRhs);
+			s32 cBLane = pInst->m_cBRegister;
+			int cLane = cB / cBLane;
+			for (int iLane = 0; iLane < cLane; ++iLane)
+			{
+				auto pBSrc = (wordLhs.m_u32 & (0x1 << iLane)) ? pBTrue : pBFalse;
+				memmove(&pBOut[iLane * cBLane], &pBSrc[iLane * cBLane], cBLane);
+			}
+		} break;
 		case MASHOP(IROP_Memcpy, 0):
 		{
 			ReadOpcodes(pVm, pInst, 8, &wordLhs, &wordRhs);
@@ -3964,6 +4668,11 @@ void ExecuteBytecode(CVirtualMachine * pVm, SProcedure * pProcEntry)
 		default:
 
 			EWC_ASSERT(false, "unhandled opcode IROP_%s %d\n", PChzFromIrop(pInst->m_irop), pInst->m_cBRegister);
+
+			dcFree(pVm->m_pDcvm);
+			pVm->m_pDcvm = nullptr;
+			pVm->m_pBStack = pBStackEntry;
+			return false; // halt
 		}
 		++pInst;
 	}
@@ -3971,9 +4680,6 @@ void ExecuteBytecode(CVirtualMachine * pVm, SProcedure * pProcEntry)
 	#undef MASHOP
 	#undef FETCH
 	#undef MASHOP
-
-	dcFree(pVm->m_pDcvm);
-	pVm->m_pDcvm = nullptr;
 }
 
 void CBuilder::SwapToVm(CVirtualMachine * pVm)
@@ -131,7 +131,11 @@ namespace BCode
 						,m_cBRegister(0)
 						,m_pred(0)
 						,m_iBStackOut(0)
-							{ ; }
+							{
+								// zeroed so identical instruction streams compare bytewise (see MergeIdenticalProcedures)
+								m_wordLhs.m_u64 = 0;
+								m_wordRhs.m_u64 = 0;
+							}
 
 		IROP			m_irop;
 		OPK				m_opkLhs;
@@ -223,6 +227,7 @@ namespace BCode
 									SProcedure(EWC::CAlloc * pAlloc);
 
 		SProcedureSignature *				m_pProcsig;
+		SProcedure *						m_pProcAlias;	// identical procedure that direct calls are routed to
 
 		s64									m_cBStack;		// allocated bytes on stack (iff fIsForeign == false)
 
@@ -329,6 +334,7 @@ namespace BCode
 
 		void				PrintDump();
 		void				FinalizeBuild(CWorkspace * pWork);
+		void				MergeIdenticalProcedures();
 
 		SProcedure *		PProcCreateImplicit(CWorkspace * pWork, STypeInfoProcedure * pTinproc, CSTNode * pStnod);
 		SValue *			PValCreateProc(
@@ -366,6 +372,13 @@ namespace BCode
 		void				CreateBranch(SBlock * pBlock);
 		Instruction *		PInstCreateCondBranch(SValue * pValPred, SBlock * pBlockTrue, SBlock * pBlockFalse);
 		Instruction *		PInstCreateTraceStore(SValue * pVal, STypeInfo * pTin);
+		void				CreateBoundsCheck(SValue * pValIndex, SValue * pValCount);
+
+		Instruction *		PInstCreateLaneOp(IROP irop, s32 pred, STypeInfoStruct * pTinstruct, SValue * pValLhs, SValue * pValRhs, const char * pChzName = "");
+		Instruction *		PInstCreateLaneShuffle(STypeInfoStruct * pTinstruct, SValue * pVal, const s32 * aiLane, const char * pChzName = "");
+		Instruction *		PInstCreateLaneReduce(IROP irop, s32 pred, STypeInfoStruct * pTinstruct, SValue * pVal, const char * pChzName = "");
+		Instruction *		PInstCreateLaneSelect(STypeInfoStruct * pTinstruct, SValue * pValMask, SValue * pValTrue, SValue * pValFalse, const char * pChzName = "");
+		SInstruction *		PInstCreateLaneRaw(IROP irop, SValue * pValLhs, STypeInfo * pTinOut, s32 cBLane, SInstructionValue ** ppInstval);
 
 		s32					IBStackAlloc(s64 cB, s64 cBAlign);
 		Instruction *		PInstAlloc();
@@ -451,7 +464,6 @@ namespace BCode
 		void				SwapToVm(CVirtualMachine * pVm);
 
 		EWC::CAlloc *						m_pAlloc;
-		CSymbolTable *						m_pSymtab;
 		CIRBuilderErrorContext *			m_pBerrctx;
 		SDataLayout *						m_pDlay;
 		EWC::CHash<HV, SProcedure *>		m_hashHvMangledPProc;
@@ -463,6 +475,7 @@ namespace BCode
 		EWC::CHash<SSymbol *, SValue *>		m_hashPSymPVal;
 		EWC::CHash<STypeInfoLiteral *, SConstant *>					m_hashPTinlitPGlob;
 		EWC::CHash<STypeInfoStruct *, SCodeGenStruct *>				m_hashPTinstructPCgstruct;
+		EWC::CHash<STypeInfoArray *, SConstant *>					m_hashPTinaryPGlobInit;	// default element values for MemcpyGlobal arrays
 		EWC::CHash<STypeInfoProcedure *, SProcedureSignature *>		m_hashPTinprocPProcsig;
 		EWC::CHash<HV, void *> *			m_phashHvPFnForeign;
 
@@ -533,7 +546,7 @@ namespace BCode
 	bool LoadForeignLibraries(CWorkspace * pWork, EWC::CHash<HV, void*> * pHashHvPFn, EWC::CDynAry<void *> * parypDll);
 	void UnloadForeignLibraries(EWC::CDynAry<void *> * paryDll);
 
-	void ExecuteBytecode(CVirtualMachine * pVm, SProcedure * pProc);
+	bool ExecuteBytecode(CVirtualMachine * pVm, SProcedure * pProc); // returns false if execution halted on an error
 	void BuildTestByteCode(CWorkspace * pWork, EWC::CAlloc * pAlloc);
 
 } // namespace BCode
@@ -36,14 +36,19 @@ using namespace EWC;
 #include "llvm-c/Target.h"
 #include "llvm-c/TargetMachine.h"
 #include "llvm/IR/CallingConv.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Program.h"
 #include "llvm/BinaryFormat/Dwarf.h"
+#include "llvm/Transforms/IPO.h"
 #ifdef _WINDOWS
 #pragma warning ( pop )
 #endif
 
 #include "MissingLlvmC/llvmcDIBuilder.h"
+#include <algorithm>
 #include <stdio.h>
 #include <string>
 
@@ -147,6 +152,7 @@ enum CGINITK	// Code Gen INIT Kind
 };
 
 CGINITK CginitkCompute(STypeInfo * pTin, CSTNode * pStnodInit);
+void GatherBoundsLocals(CBuilderBase * pBuild, CSTNode ** apStnod, int cpStnod);
 
 const char * STypeInfo::s_pChzGlobalTinTable =  "_tinTable";
 
@@ -285,7 +291,13 @@ static inline void DumpLtype(const char * pChzLabel, LLVMOpaqueValue * pLval)
 // Debug Info Wrappers
 
 LLVMValueRef PLvalDInfoCreateLexicalBlock(CBuilderIR * pBuild, LLVMValueRef pLvalScope, SDIFile * pDif, unsigned nLine, unsigned nCol)
-	{ return LLVMDIBuilderCreateLexicalBlock(pBuild->m_pDib, pLvalScope, pDif->m_pLvalFile, nLine, nCol); }
+{
+	// line tables scope every location to its subprogram, no need for lexical blocks
+	if (!pBuild->FEmitsDebugTypes())
+		return pLvalScope;
+
+	return LLVMDIBuilderCreateLexicalBlock(pBuild->m_pDib, pLvalScope, pDif->m_pLvalFile, nLine, nCol);
+}
 
 BCode::SStub * PLvalDInfoCreateLexicalBlock(BCode::CBuilder * pBuild, BCode::SStub * pLvalScope, BCode::SStub * pDif, unsigned nLine, unsigned nCol)
 	{ return nullptr; }
@@ -308,6 +320,9 @@ void DInfoCreateGlobalVariable(
 	bool fIsLocalToUnit,
 	CIRGlobal * pGlob)
 {
+	if (!pBuild->FEmitsDebugTypes())
+		return;
+
 	LLVMDIBuilderCreateGlobalVariable(
 		pBuild->m_pDib,
 		pLvalScope,
@@ -330,6 +345,8 @@ LLVMValueRef PLvallDInfoCreateAutoVariable(
 	bool fIsPreservedWhenOptimized,
 	unsigned nFlags)
 {
+	if (!pBuild->FEmitsDebugTypes())
+		return nullptr;
 
 	return LLVMDIBuilderCreateAutoVariable(
 		pBuild->m_pDib,
@@ -363,6 +380,8 @@ void DInfoCreateTypedef(
 	unsigned nLine,
 	LLVMValueRef pLvalScope)
 {
+	if (!pBuild->FEmitsDebugTypes())
+		return;
 
 	(void) LLVMDIBuilderCreateTypeDef(
 			pBuild->m_pDib,
@@ -382,6 +401,9 @@ void DInfoInsertDeclare(
 	unsigned nCol,
 	CIRBlock * pBlock)
 {
+	if (!pLvalDIVariable)
+		return;
+
 	(void)LLVMDIBuilderInsertDeclare(
 		pBuild->m_pDib,
 		pValAlloca->m_pLval,
@@ -579,7 +601,7 @@ STypeInfoStruct * PTinstructEnsureImplicit(CSymbolTable * pSymtab, STypeInfoArra
 	EWC_ASSERT(pTinary->m_pTin->m_grftin.FIsSet(FTIN_IsUnique), "expected unique array element type");
 	if (!pTinary->m_pTinstructImplicit)
 	{
-		STypeInfoStruct * pTinstruct = PTinstructAlloc(pSymtab, CString(), 2, 0);
+		STypeInfoStruct * pTinstruct = PTinstructAlloc(pSymtab, CString(), CArymembFromAryk(pTinary->m_aryk), 0);
 		pTinary->m_pTinstructImplicit = pTinstruct;
 
 		STypeStructMember * pTypemembCount = pTinstruct->m_aryTypemembField.AppendNew();
@@ -589,11 +611,80 @@ STypeInfoStruct * PTinstructEnsureImplicit(CSymbolTable * pSymtab, STypeInfoArra
 		STypeStructMember * pTypemembData = pTinstruct->m_aryTypemembField.AppendNew();
 		pTypemembData->m_strName = PChzFromArymemb(ARYMEMB_Data);
 		pTypemembData->m_pTin = pSymtab->PTinptrAllocate(pTinary->m_pTin);
+
+		if (pTinary->m_aryk == ARYK_Dynamic)
+		{
+			STypeStructMember * pTypemembCapacity = pTinstruct->m_aryTypemembField.AppendNew();
+			pTypemembCapacity->m_strName = PChzFromArymemb(ARYMEMB_Capacity);
+			pTypemembCapacity->m_pTin = pSymtab->PTinBuiltin(CSymbolTable::s_strS64);
+		}
 	}
 
 	return pTinary->m_pTinstructImplicit;
 }
 
+STypeInfoStruct * PTinstructEnsureSoa(CSymbolTable * pSymtab, STypeInfoArray * pTinary)
+{
+	// SOA arrays are laid out as a struct with one field per element member:
+	//   fixed:		{ m_a: [c] A, m_b: [c] B, ... }
+	//   reference:	{ count: s64, m_a: & A, m_b: & B, ... }
+
+	EWC_ASSERT(pTinary->m_fIsSoa, "expected SOA array");
+	if (pTinary->m_pTinstructSoa)
+		return pTinary->m_pTinstructSoa;
+
+	auto pTinstructElement = PTinRtiCast<STypeInfoStruct *>(PTinStripQualifiers(pTinary->m_pTin));
+	if (!EWC_FVERIFY(pTinstructElement, "SOA array with non-struct element type"))
+		return nullptr;
+
+	bool fIsFixed = pTinary->m_aryk == ARYK_Fixed;
+	size_t cTypememb = pTinstructElement->m_aryTypemembField.C();
+
+	char aCh[256];
+	SStringBuffer strbuf(aCh, EWC_DIM(aCh));
+	FormatCoz(&strbuf, "%s_soa", pTinstructElement->m_strName.PCoz());
+
+	STypeInfoStruct * pTinstruct = PTinstructAlloc(pSymtab, CString(aCh), (fIsFixed) ? cTypememb : cTypememb + 1, 0);
+	pTinary->m_pTinstructSoa = pTinstruct;
+
+	if (!fIsFixed)
+	{
+		STypeStructMember * pTypemembCount = pTinstruct->m_aryTypemembField.AppendNew();
+		pTypemembCount->m_strName = PChzFromArymemb(ARYMEMB_Count);
+		pTypemembCount->m_pTin = pSymtab->PTinBuiltin(CSymbolTable::s_strS64);
+	}
+
+	auto pTypemembMac = pTinstructElement->m_aryTypemembField.PMac();
+	for (auto pTypememb = pTinstructElement->m_aryTypemembField.A(); pTypememb != pTypemembMac; ++pTypememb)
+	{
+		STypeStructMember * pTypemembSoa = pTinstruct->m_aryTypemembField.AppendNew();
+		pTypemembSoa->m_strName = pTypememb->m_strName;
+		pTypemembSoa->m_pStnod = pTypememb->m_pStnod;
+
+		if (fIsFixed)
+		{
+			auto pTinaryMember = EWC_NEW(pSymtab->m_pAlloc, STypeInfoArray) STypeInfoArray();
+			pTinaryMember->m_pTin = pTypememb->m_pTin;
+			pTinaryMember->m_c = pTinary->m_c;
+			pTinaryMember->m_aryk = ARYK_Fixed;
+			pSymtab->AddManagedTin(pTinaryMember);
+			pTypemembSoa->m_pTin = pSymtab->PTinMakeUnique(pTinaryMember);
+		}
+		else
+		{
+			pTypemembSoa->m_pTin = pSymtab->PTinptrAllocate(pTypememb->m_pTin);
+		}
+	}
+
+	return pTinstruct;
+}
+
+// index of the storage field for element member iTypememb in an SOA array's storage struct
+inline int ITypemembSoa(STypeInfoArray * pTinary, int iTypememb)
+{
+	return (pTinary->m_aryk == ARYK_Fixed) ? iTypememb : iTypememb + 1;
+}
+
 LLVMOpaqueType * CBuilderIR::PLtypeFromPTin(STypeInfo * pTin)
 {
 	if (!pTin)
@@ -650,6 +741,11 @@ LLVMOpaqueType * CBuilderIR::PLtypeFromPTin(STypeInfo * pTin)
 		case TINK_Array:
 		{
 			STypeInfoArray * pTinary = (STypeInfoArray *)pTin;
+			if (pTinary->m_fIsSoa)
+			{
+				return PLtypeFromPTin(PTinstructEnsureSoa(m_pSymtab, pTinary));
+			}
+
 			auto pLtypeElement = PLtypeFromPTin(pTinary->m_pTin);
 
 			switch (pTinary->m_aryk)
@@ -660,12 +756,14 @@ LLVMOpaqueType * CBuilderIR::PLtypeFromPTin(STypeInfo * pTin)
 					return LLVMArrayType(pLtypeElement, u32(pTinary->m_c));
 				}
 				case ARYK_Reference:
+				case ARYK_Dynamic:
 				{
-					LLVMTypeRef apLtype[2]; // count, pointer
+					LLVMTypeRef apLtype[ARYMEMB_Max]; // count, pointer, capacity
 					apLtype[ARYMEMB_Count] = LLVMInt64Type();
 					apLtype[ARYMEMB_Data] = LLVMPointerType(pLtypeElement, 0);
+					apLtype[ARYMEMB_Capacity] = LLVMInt64Type();
 
-					return LLVMStructType(apLtype, EWC_DIM(apLtype), false);
+					return LLVMStructType(apLtype, CArymembFromAryk(pTinary->m_aryk), false);
 				}
 				default: EWC_ASSERT(false, "unhandled ARYK");
 			}
@@ -840,7 +938,7 @@ SDIFile * PDifEnsure(CWorkspace * pWork, CBuilderIR * pBuild, const CString & st
 	PathSplitDestructive(pCozCopy, cBFilename, &pCozPath, &pCozFile, nullptr);
 
 	pDif->m_pLvalScope = pBuild->m_pLvalCompileUnit;
-	pDif->m_pLvalFile = LLVMDIBuilderCreateFile(pBuild->m_pDib, pCozFile, pCozPath);
+	pDif->m_pLvalFile = (pBuild->m_pDib) ? LLVMDIBuilderCreateFile(pBuild->m_pDib, pCozFile, pCozPath) : nullptr;
 
 	pDif->m_aryLvalScopeStack.SetAlloc(pWork->m_pAlloc, EWC::BK_WorkspaceFile);
 	pDif->m_aryLvalScopeStack.Append(pDif->m_pLvalFile);
@@ -871,7 +969,7 @@ BCode::SStub * PLvalFromDIFile(BCode::CBuilder * pBuild, BCode::SStub * pDif)
 
 void PushDIScope(SDIFile * pDif, LLVMOpaqueValue * pLvalScope)
 {
-	EWC_ASSERT(pLvalScope, "null debug info scope");
+	EWC_ASSERT(pLvalScope || !pDif->m_pLvalFile, "null debug info scope");
 	pDif->m_aryLvalScopeStack.Append(pLvalScope);
 }
 
@@ -896,7 +994,7 @@ void PushLexicalBlock(CWorkspace * pWork, CBuilderIR * pBuild, const SLexerLocat
 	s32 iLine, iCol;
 	CalculateLinePosition(pWork, &lexloc, &iLine, &iCol);
 
-	LLVMValueRef pLvalScope = LLVMDIBuilderCreateLexicalBlock(pBuild->m_pDib, pLvalScopeParent, pDif->m_pLvalFile, iLine, iCol);
+	LLVMValueRef pLvalScope = PLvalDInfoCreateLexicalBlock(pBuild, pLvalScopeParent, pDif, iLine, iCol);
 	pDif->m_aryLvalScopeStack.Append(pLvalScope);
 }
 
@@ -908,6 +1006,9 @@ void PopLexicalBlock(CWorkspace * pWork, CBuilderIR * pBuild, const SLexerLocati
 
 void EmitLocation(CWorkspace * pWork, CBuilderIR * pBuild, const SLexerLocation & lexloc)
 {
+	if (!pBuild->FEmitsDebugLines())
+		return;
+
 	auto pDif = PDifEnsure(pWork, pBuild, lexloc.m_strFilename);
 
 	LLVMOpaqueValue * pLvalScope = PLvalFromDIFile(pBuild, pDif);
@@ -937,8 +1038,11 @@ SDIFile * PDifEmitLocation(
 	s32 iLine, iCol;
 	CalculateLinePosition(pWork, &lexloc, &iLine, &iCol);
 
-	LLVMOpaqueValue * pLvalLoc = LLVMCreateDebugLocation(pBuild->m_pLbuild, iLine, iCol, pLvalScope);
-	LLVMSetCurrentDebugLocation(pBuild->m_pLbuild, pLvalLoc);
+	if (pBuild->FEmitsDebugLines())
+	{
+		LLVMOpaqueValue * pLvalLoc = LLVMCreateDebugLocation(pBuild->m_pLbuild, iLine, iCol, pLvalScope);
+		LLVMSetCurrentDebugLocation(pBuild->m_pLbuild, pLvalLoc);
+	}
 
 	if (piLine) *piLine = iLine;
 	if (piCol) *piCol = iCol;
@@ -1030,6 +1134,15 @@ static inline LLVMOpaqueValue * PLvalCreateDebugFunction(
 	LLVMOpaqueValue * pLvalDIFunctionType,
 	LLVMOpaqueValue * pLvalFunction)
 {
+	if (!pBuild->FEmitsDebugLines())
+		return nullptr;
+
+	if (!pBuild->FEmitsDebugTypes())
+	{
+		// line tables don't describe parameters, every subprogram shares an empty signature
+		pLvalDIFunctionType = pBuild->m_pLvalDITypeProcEmpty;
+	}
+
 	s32 iLine, iCol;
 	CalculateLinePosition(pWork, &pStnodFunction->m_lexloc, &iLine, &iCol);
 
@@ -1058,7 +1171,7 @@ static inline LLVMOpaqueValue * PLvalCreateDebugFunction(
 }
 static inline void CreateDebugInfo(CWorkspace * pWork, CBuilderIR * pBuild, CSTNode * pStnodRef, STypeInfo * pTin)
 {
-	if (pTin->m_pCgvalDIType)
+	if (pTin->m_pCgvalDIType || !pBuild->FEmitsDebugTypes())
 		return;
 
 	auto strPunyName = StrPunyEncode(pTin->m_strName.PCoz());
@@ -1152,6 +1265,54 @@ static inline void CreateDebugInfo(CWorkspace * pWork, CBuilderIR * pBuild, CSTN
 			u64 cBitSizeArray, cBitAlignArray;
 			CalculateSizeAndAlign(pBuild, pLtypeArray, &cBitSizeArray, &cBitAlignArray);
 
+			if (pTinary->m_fIsSoa)
+			{
+				// describe the SOA storage struct, one array (or array pointer) per element member
+				auto pTinstructSoa = PTinstructEnsureSoa(pWork->m_pSymtab, pTinary);
+				auto pDif = PDifEnsure(pWork, pBuild, pStnodRef->m_lexloc.m_strFilename);
+
+				int cTypememb = (int)pTinstructSoa->m_aryTypemembField.C();
+				auto apLvalMember = (LLVMOpaqueValue **)(alloca(sizeof(LLVMOpaqueValue *) * cTypememb));
+				for (int iTypememb = 0; iTypememb < cTypememb; ++iTypememb)
+				{
+					auto pTypememb = &pTinstructSoa->m_aryTypemembField[iTypememb];
+					auto pTinMember = pTypememb->m_pTin;
+					CreateDebugInfo(pWork, pBuild, pStnodRef, pTinMember);
+
+					u64 cBitSizeMember, cBitAlignMember;
+					CalculateSizeAndAlign(pBuild, pBuild->PLtypeFromPTin(pTinMember), &cBitSizeMember, &cBitAlignMember);
+					u64 dBitMembOffset = 8 * LLVMOffsetOfElement(pBuild->m_pTargd, pLtypeArray, iTypememb);
+
+					apLvalMember[iTypememb] = LLVMDIBuilderCreateMemberType(
+												pDib,
+												pDif->m_pLvalFile,
+												pTypememb->m_strName.PCoz(),
+												pDif->m_pLvalFile,
+												0,
+												cBitSizeMember,
+												cBitAlignMember,
+												dBitMembOffset,
+												0,
+												(LLVMValueRef)pTinMember->m_pCgvalDIType);
+				}
+
+				pTin->m_pCgvalDIType = LLVMDIBuilderCreateStructType(
+										pDib,
+										pDif->m_pLvalFile,
+										"",
+										pDif->m_pLvalFile,
+										0,
+										cBitSizeArray,
+										cBitAlignArray,
+										0,
+										nullptr, //pLvalDerivedFrom
+										apLvalMember,
+										cTypememb,
+										nullptr, //pLvalVTableHolder
+										pBuild->m_nRuntimeLanguage);
+				break;
+			}
+
 			switch (pTinary->m_aryk)
 			{
 			case ARYK_Fixed:
@@ -1167,6 +1328,7 @@ static inline void CreateDebugInfo(CWorkspace * pWork, CBuilderIR * pBuild, CSTN
 						1);
 				} break;
 		    case ARYK_Reference:
+		    case ARYK_Dynamic:
 				{
 					auto pDif = PDifEnsure(pWork, pBuild, pStnodRef->m_lexloc.m_strFilename);
 					LLVMOpaqueValue * pLvalScope = pDif->m_pLvalFile;
@@ -1177,22 +1339,25 @@ static inline void CreateDebugInfo(CWorkspace * pWork, CBuilderIR * pBuild, CSTN
 					u64 cBitAlign = cBitSize;
 					auto pLvalDITypePtr = LLVMDIBuilderCreatePointerType(pDib, (LLVMValueRef)pTinElement->m_pCgvalDIType, cBitSize, cBitAlign, "");
 
-					LLVMTypeRef mpArymembPLtype[ARYMEMB_Max]; // pointer, count
+					LLVMTypeRef mpArymembPLtype[ARYMEMB_Max]; // pointer, count, capacity
 					mpArymembPLtype[ARYMEMB_Count] = LLVMInt64Type();
 					mpArymembPLtype[ARYMEMB_Data] = LLVMPointerType(pLtypeMember, 0);
+					mpArymembPLtype[ARYMEMB_Capacity] = LLVMInt64Type();
 
 					auto pTinCount = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strS64);
 					CreateDebugInfo(pWork, pBuild, pStnodRef, pTinCount);
 
-					LLVMValueRef mpArymembPLvalDIType[ARYMEMB_Max]; // pointer, count
+					LLVMValueRef mpArymembPLvalDIType[ARYMEMB_Max]; // pointer, count, capacity
 					mpArymembPLvalDIType[ARYMEMB_Count] = (LLVMValueRef)pTinCount->m_pCgvalDIType;
 					mpArymembPLvalDIType[ARYMEMB_Data] = pLvalDITypePtr;
+					mpArymembPLvalDIType[ARYMEMB_Capacity] = (LLVMValueRef)pTinCount->m_pCgvalDIType;
 
 					u64 cBitSizeMember, cBitAlignMember;
 					unsigned nFlagsMember = 0;
-					LLVMOpaqueValue * apLvalMember[2]; // pointer, count	
+					LLVMOpaqueValue * apLvalMember[ARYMEMB_Max]; // pointer, count, capacity
+					int cArymemb = CArymembFromAryk(pTinary->m_aryk);
 
-					for (int arymemb = 0; arymemb < ARYMEMB_Max; ++arymemb)
+					for (int arymemb = 0; arymemb < cArymemb; ++arymemb)
 					{
 						auto pLtypeMember =  mpArymembPLtype[arymemb];
 						u64 dBitMembOffset = 8 * LLVMOffsetOfElement(pBuild->m_pTargd, pLtypeArray, arymemb);
@@ -1223,12 +1388,11 @@ static inline void CreateDebugInfo(CWorkspace * pWork, CBuilderIR * pBuild, CSTN
 											nFlags,
 											nullptr, //pLvalDerivedFrom
 											apLvalMember,
-											ARYMEMB_Max,
+											cArymemb,
 											nullptr, //pLvalVTableHolder
 											pBuild->m_nRuntimeLanguage);
 				} break;
 			default:
-		    case ARYK_Dynamic:
 				EWC_ASSERT(false, "debug info is for aryk %s is TBD", PChzFromAryk(pTinary->m_aryk));
 				break;
 			}
@@ -1400,7 +1564,12 @@ void TokenizeTripleString(char * pChzTripleCopy, char ** ppChzArch, char ** ppCh
 
 CBuilderBase::CBuilderBase(CWorkspace * pWork)
 :m_pAlloc(pWork->m_pAlloc)
+,m_pSymtab(pWork->m_pSymtab)
 ,m_pBerrctx(nullptr)
+,m_fBoundsCheck(false)
+,m_arypSymBoundsLocal(pWork->m_pAlloc, EWC::BK_CodeGen)
+,m_aryBfact(pWork->m_pAlloc, EWC::BK_CodeGen)
+,m_hashPStnodDeadInit(pWork->m_pAlloc, EWC::BK_CodeGen)
 	{ ; }
 					
 
@@ -1411,18 +1580,26 @@ CBuilderIR::CBuilderIR(CWorkspace * pWork, const char * pChzFilename, GRFCOMPILE
 ,m_pLmoduleCur(nullptr)
 ,m_pLbuild(nullptr)
 ,m_pTargd (nullptr)
+,m_fEmitDebugLines(pWork->m_debuginfo != DEBUGINFO_None)
+,m_fEmitDebugTypes(pWork->m_debuginfo == DEBUGINFO_Full)
 ,m_pDib(nullptr)
+,m_pLvalDITypeProcEmpty(nullptr)
 ,m_pLvalCompileUnit(nullptr)
 ,m_pLvalScope(nullptr)
 ,m_pLvalFile(nullptr)
 ,m_pProcCur(nullptr)
 ,m_pBlockCur(nullptr)
 ,m_arypProcVerify(pWork->m_pAlloc, EWC::BK_CodeGen)
+,m_aryMvproc(pWork->m_pAlloc, EWC::BK_CodeGen)
+,m_arypTinReflectRoot(pWork->m_pAlloc, EWC::BK_CodeGenReflect)
+,m_pSymTinTable(nullptr)
+,m_pGlobTinTable(nullptr)
 ,m_parypValManaged(&pWork->m_arypValManaged)
 ,m_aryJumptStack(pWork->m_pAlloc, EWC::BK_CodeGen)
 ,m_hashPSymPVal(pWork->m_pAlloc, BK_CodeGen, 256)
 ,m_hashPTinlitPGlob(pWork->m_pAlloc, BK_CodeGen, 256)
 ,m_hashPTinstructPCgstruct(pWork->m_pAlloc, BK_CodeGen,32)
+,m_hashPTinaryPGlobInit(pWork->m_pAlloc, BK_CodeGen, 32)
 { 
 	CAlloc * pAlloc = pWork->m_pAlloc;
 
@@ -1489,12 +1666,38 @@ CBuilderIR::CBuilderIR(CWorkspace * pWork, const char * pChzFilename, GRFCOMPILE
 	#endif
 	LLVMCodeModel lcodemodel = LLVMCodeModelDefault;
 
-	// NOTE: llvm-c doesn't expose functions to query these, but it seems to just return the empty string.
-	//  This may not work for all target backends.
-	const char * pChzCPU = "";
-	const char * pChzFeatures = "";
+	// NOTE: an empty cpu/feature string selects the triple's generic cpu. '-mcpu native' asks llvm for the host cpu 
+	//  and, unless features were specified with -mattr, the host's feature set.
+	const char * pChzCPU = (pWork->m_pChzTargetCpu) ? pWork->m_pChzTargetCpu : "";
+	const char * pChzFeatures = (pWork->m_pChzTargetFeatures) ? pWork->m_pChzTargetFeatures : "";
+
+	char * pChzCPUHost = nullptr;
+	char * pChzFeaturesHost = nullptr;
+	if (FAreCozEqual(pChzCPU, "native"))
+	{
+		pChzCPUHost = PChzCreateHostCpuName();
+		pChzCPU = pChzCPUHost;
+
+		if (!pWork->m_pChzTargetFeatures)
+		{
+			pChzFeaturesHost = PChzCreateHostCpuFeatures();
+			pChzFeatures = pChzFeaturesHost;
+		}
+	}
 
+	m_strTargetFeatures = pChzFeatures;
 	m_pLtmachine = LLVMCreateTargetMachine(pLtarget, pChzTriple, pChzCPU, pChzFeatures, loptlevel, lrelocmode, lcodemodel);
+
+	if (pChzCPUHost)
+	{
+		LLVMDisposeMessage(pChzCPUHost);
+	}
+
+	if (pChzFeaturesHost)
+	{
+		LLVMDisposeMessage(pChzFeaturesHost);
+	}
+
 	if (grfcompile.FIsSet(FCOMPILE_FastIsel))
 	{
 		SetUseFastIsel(m_pLtmachine);
@@ -1521,8 +1724,11 @@ CBuilderIR::CBuilderIR(CWorkspace * pWork, const char * pChzFilename, GRFCOMPILE
 	
 #endif
 
-	m_pDib = LLVMCreateDIBuilder(m_pLmoduleCur);
 	m_nRuntimeLanguage = llvm::dwarf::DW_LANG_C;
+	if (!m_fEmitDebugLines)
+		return;
+
+	m_pDib = LLVMCreateDIBuilder(m_pLmoduleCur);
 	
 	/*CWorkspace::SFile * pFile = pWork->PFileLookup(pChzFilename, CWorkspace::FILEK_Source);
 	EWC_ASSERT(pFile, "failed to find source CWorkspace::SFile");
@@ -1542,10 +1748,16 @@ CBuilderIR::CBuilderIR(CWorkspace * pWork, const char * pChzFilename, GRFCOMPILE
 								"Moe Compiler",		// pChzProducer
 								false,				// fIsOptimized
 								"",					// pChzFlags
-								0);					// nRuntimeVersion
+								0,					// nRuntimeVersion
+								!m_fEmitDebugTypes);
 	}
 
 	m_pLvalScope = m_pLvalCompileUnit;
+
+	if (!m_fEmitDebugTypes)
+	{
+		m_pLvalDITypeProcEmpty = LLVMDIBuilderCreateFunctionType(m_pDib, nullptr, 0, 0, 0);
+	}
 }
 
 void CBuilderIR::AddManagedVal(CIRValue * pVal)
@@ -1593,6 +1805,7 @@ CBuilderIR::~CBuilderIR()
 		}
 
 		m_hashPTinstructPCgstruct.Clear(0);
+		m_hashPTinaryPGlobInit.Clear(0);
 	}
 }
 
@@ -2146,6 +2359,13 @@ LLVMOpaqueValue * PLvalZeroInType(CBuilderIR * pBuild, STypeInfo * pTin)
 	case TINK_Array:
 		{
 			auto pTinary = (STypeInfoArray *)pTin;
+			if (pTinary->m_fIsSoa)
+			{
+				auto pTinstructSoa = PTinstructEnsureSoa(pBuild->m_pSymtab, pTinary);
+				(void) pBuild->PLtypeFromPTin(pTinstructSoa); // make sure the named storage type exists
+				return PLvalZeroInType(pBuild, pTinstructSoa);
+			}
+
 			LLVMOpaqueType * pLtypeElement = pBuild->PLtypeFromPTin(pTinary->m_pTin);
 			switch (pTinary->m_aryk)
 			{
@@ -2168,12 +2388,14 @@ LLVMOpaqueValue * PLvalZeroInType(CBuilderIR * pBuild, STypeInfo * pTin)
 				return pLvalReturn;
 			}
 			case ARYK_Reference:
+			case ARYK_Dynamic:
 			{
-				LLVMOpaqueValue * apLvalMember[2]; // pointer, count
+				LLVMOpaqueValue * apLvalMember[ARYMEMB_Max]; // pointer, count, capacity
 				apLvalMember[ARYMEMB_Count] = LLVMConstInt(LLVMInt64Type(), 0, false);
 				apLvalMember[ARYMEMB_Data] = LLVMConstNull(LLVMPointerType(pLtypeElement, 0));
+				apLvalMember[ARYMEMB_Capacity] = LLVMConstInt(LLVMInt64Type(), 0, false);
 
-				return LLVMConstStruct(apLvalMember, EWC_DIM(apLvalMember), false);
+				return LLVMConstStruct(apLvalMember, CArymembFromAryk(pTinary->m_aryk), false);
 			}
 			default: EWC_ASSERT(false, "Unhandled ARYK");
 			}
@@ -2230,6 +2452,11 @@ BCode::SValue * PLvalZeroInType(BCode::CBuilder * pBuild, STypeInfo * pTin)
 	case TINK_Array:
 		{
 			auto pTinary = (STypeInfoArray *)pTin;
+			if (pTinary->m_fIsSoa)
+			{
+				return PLvalZeroInType(pBuild, PTinstructEnsureSoa(pBuild->m_pSymtab, pTinary));
+			}
+
 			auto pLtypeElement = pBuild->PLtypeFromPTin(pTinary->m_pTin);
 			switch (pTinary->m_aryk)
 			{
@@ -2252,6 +2479,7 @@ BCode::SValue * PLvalZeroInType(BCode::CBuilder * pBuild, STypeInfo * pTin)
 				return pValReturn;
 			}
 			case ARYK_Reference:
+			case ARYK_Dynamic:
 			{
 				auto pTinstructImplicit = PTinstructEnsureImplicit(pBuild->m_pSymtab, pTinary);
 				return PLvalZeroInType(pBuild, pTinstructImplicit);
@@ -2281,6 +2509,118 @@ BCode::SValue * PLvalZeroInType(BCode::CBuilder * pBuild, STypeInfo * pTin)
 	return nullptr;
 }
 
+template <typename BUILD>
+typename BUILD::LValue * PLvalFromBakedBytes(BUILD * pBuild, SDataLayout * pDlay, STypeInfo * pTin, const u8 * pB)
+{
+	// build a constant from values computed by the bytecode VM, pDlay is the layout the VM used
+
+	switch (pTin->m_tink)
+	{
+	case TINK_Bool:
+		{
+			u64 nUnsigned = 0;
+			for (int iB = 0; iB < pDlay->m_cBBool; ++iB)
+			{
+				nUnsigned |= pB[iB];
+			}
+			return pBuild->PLvalConstantInt(nUnsigned != 0, 1, false);
+		}
+	case TINK_Integer:
+		{
+			auto pTinint = (STypeInfoInteger *)pTin;
+			bool fIsSigned = pTinint->m_fIsSigned;
+
+			u64 nUnsigned = 0;
+			switch (pTinint->m_cBit)
+			{
+			case 8:		nUnsigned = (fIsSigned) ? u64(*(s8 *)pB) : *(u8 *)pB;		break;
+			case 16:	nUnsigned = (fIsSigned) ? u64(*(s16 *)pB) : *(u16 *)pB;	break;
+			case 32:	nUnsigned = (fIsSigned) ? u64(*(s32 *)pB) : *(u32 *)pB;	break;
+			case 64:	nUnsigned = *(u64 *)pB;									break;
+			default:	EWC_ASSERT(false, "unexpected integer size in #run result");	break;
+			}
+			return pBuild->PLvalConstantInt(nUnsigned, pTinint->m_cBit, fIsSigned);
+		}
+	case TINK_Float:
+		{
+			auto pTinfloat = (STypeInfoFloat *)pTin;
+			f64 g = (pTinfloat->m_cBit == 32) ? *(f32 *)pB : *(f64 *)pB;
+			return pBuild->PLvalConstantFloat(g, pTinfloat->m_cBit);
+		}
+	case TINK_Enum:
+		{
+			auto pTinenum = (STypeInfoEnum *)pTin;
+			return PLvalFromBakedBytes(pBuild, pDlay, pTinenum->m_pTinLoose, pB);
+		} 
+	case TINK_Qualifier:
+		{
+			auto pTinqual = (STypeInfoQualifier *)pTin;
+			return PLvalFromBakedBytes(pBuild, pDlay, pTinqual->m_pTin, pB);
+		}
+	case TINK_Array:
+		{
+			auto pTinary = (STypeInfoArray *)pTin;
+			if (!EWC_FVERIFY(pTinary->m_aryk == ARYK_Fixed && !pTinary->m_fIsSoa, "unexpected array kind in #run result"))
+				return nullptr;
+
+			u64 cBElement;
+			u64 cBAlignElement;
+			CalculateByteSizeAndAlign(pDlay, pTinary->m_pTin, &cBElement, &cBAlignElement);
+
+			auto apLval = (BUILD::LValue **)pBuild->m_pAlloc->EWC_ALLOC_TYPE_ARRAY(BUILD::LValue *, (size_t)pTinary->m_c);
+			for (s64 iElement = 0; iElement < pTinary->m_c; ++iElement)
+			{
+				apLval[iElement] = PLvalFromBakedBytes(pBuild, pDlay, pTinary->m_pTin, &pB[iElement * cBElement]);
+			}
+
+			auto pLtypeElement = pBuild->PLtypeFromPTin(pTinary->m_pTin);
+			auto pLvalReturn = pBuild->PLvalConstantArray(pLtypeElement, apLval, u32(pTinary->m_c));
+			pBuild->m_pAlloc->EWC_DELETE(apLval);
+			return pLvalReturn;
+		}
+	case TINK_Struct:
+		{
+			auto pTinstruct = (STypeInfoStruct *)pTin;
+
+			// make sure the member offsets have been computed
+			u64 cBStruct;
+			u64 cBAlignStruct;
+			CalculateByteSizeAndAlign(pDlay, pTinstruct, &cBStruct, &cBAlignStruct);
+
+			int cpLvalField = (int)pTinstruct->m_aryTypemembField.C();
+			auto apLvalField = (BUILD::LValue **)(alloca(sizeof(BUILD::LValue *) * cpLvalField));
+
+			for (int ipLval = 0; ipLval < cpLvalField; ++ipLval)
+			{
+				auto pTypememb = &pTinstruct->m_aryTypemembField[ipLval];
+				apLvalField[ipLval] = PLvalFromBakedBytes(pBuild, pDlay, pTypememb->m_pTin, &pB[pTypememb->m_dBOffset]);
+			}
+
+			auto pCgstruct = pBuild->PCgstructEnsure(pTinstruct);
+			return pBuild->PLvalConstantStruct(pCgstruct->m_pLtype, apLvalField, cpLvalField);
+		}
+	default: 
+		EWC_ASSERT(false, "unexpected type in #run result TINK_%s", PChzFromTink(pTin->m_tink));
+		break;
+	}
+
+	return nullptr;
+}
+
+template <typename BUILD>
+typename BUILD::LValue * PLvalFromRunDirective(BUILD * pBuild, CSTNode * pStnodRun)
+{
+	// returns null if the directive hasn't been evaluated yet (ie. we're building the bytecode that evaluates it)
+
+	auto pStrun = PStmapRtiCast<CSTRun *>(pStnodRun->m_pStmap);
+	if (!pStrun || !pStrun->m_pBResult)
+		return nullptr;
+
+	SDataLayout dlay;
+	BuildStubDataLayout(&dlay);
+	return PLvalFromBakedBytes(pBuild, &dlay, pStnodRun->m_pTin, pStrun->m_pBResult);
+}
+
 CIRConstant * PConstZeroInType(CBuilderIR * pBuild, STypeInfo * pTin)
 {
 	CIRConstant * pConst = EWC_NEW(pBuild->m_pAlloc, CIRConstant) CIRConstant();
@@ -2379,6 +2719,38 @@ LLVMOpaqueValue * PLvalBuildConstantGlobalArrayRef(
 	return LLVMConstStruct(apLvalMember, EWC_DIM(apLvalMember), false);
 }
 
+const char * PChzReflectStructFromTink(TINK tink)
+{
+	switch (tink)
+	{
+	case TINK_Integer:		return "STypeInfoInteger";
+	case TINK_Float:		return "STypeInfoFloat";
+	case TINK_Qualifier:	return "STypeInfoQualifier";
+	case TINK_Pointer:		return "STypeInfoPointer";
+	case TINK_Struct:		return "STypeInfoStruct";
+	case TINK_Enum:			return "STypeInfoEnum";
+	case TINK_Array:		return "STypeInfoArray";
+	case TINK_Procedure:	return "STypeInfoProcedure";
+	default:				return "STypeInfo";
+	}
+}
+
+// declare the reflection global for a type, it's initializer is set once the type table layout is known
+LLVMOpaqueValue * PLvalEnsureReflectGlobal(CWorkspace * pWork, CBuilderIR * pBuild, LLVMOpaqueType * pLtypePTin, STypeInfo * pTin)
+{
+	if (!pTin->m_pCgvalReflectGlobal)
+	{
+		auto pLtypeTinDerived = PLtypeForTypeInfo(pWork, pBuild, PChzReflectStructFromTink(pTin->m_tink));
+		auto strPunyName = StrPunyEncode(pTin->m_strName.PCoz());
+
+		auto pLvalGlobal = LLVMAddGlobal(pBuild->m_pLmoduleCur, pLtypeTinDerived, strPunyName.PCoz());
+		LLVMSetGlobalConstant(pLvalGlobal, true);
+		pTin->m_pCgvalReflectGlobal = pLvalGlobal;
+	}
+
+	return LLVMConstPointerCast((LLVMValueRef)pTin->m_pCgvalReflectGlobal, pLtypePTin);
+}
+
 LLVMOpaqueValue * PLvalEnsureReflectStruct(
 	CWorkspace * pWork,
 	CBuilderIR * pBuild,
@@ -2387,10 +2759,12 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 	STypeInfo * pTin,
 	SReflectGlobalTable * pReftab)
 {
-	if ((LLVMValueRef)pTin->m_pCgvalReflectGlobal)
-	{
-		return LLVMConstPointerCast((LLVMValueRef)pTin->m_pCgvalReflectGlobal, pLtypePTin);
-	}
+	auto pLvalReflectPtr = PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTin);
+	if (LLVMGetInitializer((LLVMValueRef)pTin->m_pCgvalReflectGlobal))
+		return pLvalReflectPtr;
+
+	// NOTE: referenced types are all in the table (see EnsureReftent), so they only need a declared global here -
+	//  this also keeps us from recursing forever on self referential types.
 
 	CDynAry<LLVMOpaqueValue *> arypLval(pBuild->m_pAlloc, BK_CodeGenReflect, 16);
 	LLVMOpaqueValue * pLvalReflect = nullptr;
@@ -2425,7 +2799,7 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 			arypLval.Append(PLvalCreateReflectTin(pBuild, pLtypeTin, pTin, pReftab));
 
 			auto pLtypePTin = LLVMPointerType(pLtypeTin, 0);
-			arypLval.Append(PLvalEnsureReflectStruct(pWork, pBuild, pLtypeTin, pLtypePTin, pTinqual->m_pTin, pReftab));
+			arypLval.Append(PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTinqual->m_pTin));
 			arypLval.Append(LLVMConstInt(LLVMInt8Type(), pTinqual->m_grfqualk.m_raw, false)); //m_grfqualk
 
 			pLtypeTinDerived = PLtypeForTypeInfo(pWork, pBuild, "STypeInfoQualifier");
@@ -2437,7 +2811,7 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 			arypLval.Append(PLvalCreateReflectTin(pBuild, pLtypeTin, pTin, pReftab));
 
 			auto pLtypePTin = LLVMPointerType(pLtypeTin, 0);
-			arypLval.Append(PLvalEnsureReflectStruct(pWork, pBuild, pLtypeTin, pLtypePTin, pTinptr->m_pTinPointedTo, pReftab));
+			arypLval.Append(PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTinptr->m_pTinPointedTo));
 
 			pLtypeTinDerived = PLtypeForTypeInfo(pWork, pBuild, "STypeInfoPointer");
 			pLvalReflect = LLVMConstNamedStruct(pLtypeTinDerived, arypLval.A(), (unsigned)arypLval.C());
@@ -2458,7 +2832,7 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 				CFixAry<LLVMOpaqueValue *, 3> arypLvalMember;
 
 				arypLvalMember.Append(LLVMGlobalStringPtr(pBuild->m_pLbuild, pBuild->m_pLmoduleCur, pTypememb->m_strName.PCoz(), "strMemb")); //m_pCozName
-				arypLvalMember.Append(PLvalEnsureReflectStruct(pWork, pBuild, pLtypeTin, pLtypePTin, pTypememb->m_pTin, pReftab));
+				arypLvalMember.Append(PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTypememb->m_pTin));
 
 				u64 dBMember = LLVMOffsetOfElement(pBuild->m_pTargd, pLtypeStruct, iTypememb);
 				arypLvalMember.Append(LLVMConstInt(PLtypeSizeInt(pBuild), dBMember, false)); //m_iB
@@ -2512,7 +2886,7 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 
 			auto pLtypePTin = LLVMPointerType(pLtypeTin, 0);
 
-			arypLval.Append(PLvalEnsureReflectStruct(pWork, pBuild, pLtypeTin, pLtypePTin, pTinenum->m_pTinLoose, pReftab));
+			arypLval.Append(PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTinenum->m_pTinLoose));
 			arypLval.Append(LLVMGlobalStringPtr(pBuild->m_pLbuild, pBuild->m_pLmoduleCur, pTinenum->m_strName.PCoz(), "strEnum")); //m_pCozName
 			arypLval.Append(pLvalAryEconArray);
 
@@ -2527,7 +2901,7 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 
 			auto pLtypePTin = LLVMPointerType(pLtypeTin, 0);
 
-			arypLval.Append(PLvalEnsureReflectStruct(pWork, pBuild, pLtypeTin, pLtypePTin, pTinary->m_pTin, pReftab));
+			arypLval.Append(PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTinary->m_pTin));
 			arypLval.Append(LLVMConstInt(LLVMInt8Type(), pTinary->m_aryk, true)); //m_aryk
 			arypLval.Append(LLVMConstInt(PLtypeSizeInt(pBuild), pTinary->m_c, true)); //m_c
 
@@ -2543,7 +2917,7 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 			auto apLvalParam = (LLVMOpaqueValue **)alloca(sizeof(LLVMOpaqueValue**) * cParam);
 			for (u32 iParam = 0; iParam < cParam; ++iParam)
 			{
-				apLvalParam[iParam] = PLvalEnsureReflectStruct(pWork, pBuild, pLtypeTin, pLtypePTin, pTinproc->m_arypTinParams[iParam], pReftab);
+				apLvalParam[iParam] = PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTinproc->m_arypTinParams[iParam]);
 			}
 
 			auto pLvalAryParam = PLvalBuildConstantGlobalArrayRef(pWork, pBuild, pLtypePTin, apLvalParam, cParam);
@@ -2552,7 +2926,7 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 			auto apLvalReturn = (LLVMOpaqueValue **)alloca(sizeof(LLVMOpaqueValue**) * cReturn);
 			for (u32 iReturn = 0; iReturn < cReturn; ++iReturn)
 			{
-				apLvalReturn[iReturn] = PLvalEnsureReflectStruct(pWork, pBuild, pLtypeTin, pLtypePTin, pTinproc->m_arypTinReturns[iReturn], pReftab);
+				apLvalReturn[iReturn] = PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTinproc->m_arypTinReturns[iReturn]);
 			}
 
 			auto pLvalAryReturn = PLvalBuildConstantGlobalArrayRef(pWork, pBuild, pLtypePTin, apLvalReturn, cReturn);
@@ -2582,16 +2956,12 @@ LLVMOpaqueValue * PLvalEnsureReflectStruct(
 	}
 
 	EWC_ASSERT(pLvalReflect, "expected reflection type info");
-
-	auto strName = pTin->m_strName;
-	auto strPunyName = StrPunyEncode(strName.PCoz());
-
-	pTin->m_pCgvalReflectGlobal = LLVMAddGlobal(pBuild->m_pLmoduleCur, pLtypeTinDerived, strPunyName.PCoz());
-	LLVMSetGlobalConstant((LLVMValueRef)pTin->m_pCgvalReflectGlobal, true);
+	EWC_ASSERT(
+		LLVMGetElementType(LLVMTypeOf((LLVMValueRef)pTin->m_pCgvalReflectGlobal)) == pLtypeTinDerived,
+		"reflection global declared with the wrong type");
 
 	LLVMSetInitializer((LLVMValueRef)pTin->m_pCgvalReflectGlobal, pLvalReflect);
-
-	return LLVMConstPointerCast((LLVMValueRef)pTin->m_pCgvalReflectGlobal, pLtypePTin);
+	return pLvalReflectPtr;
 }
 
 struct SReflectOrderData // tag = reord
@@ -2719,6 +3089,12 @@ void EnsureReftent(SReflectGlobalTable * pReftab, STypeInfo * pTin, CDynAry<STyp
 	pReftent->m_ipTinNative = -1;
 	pReftent->m_cAliasChild = 0;
 
+	// aliased types are laid out after their native type, and reflect.moe indexes the table by m_ipTinNative
+	if (pTin->m_pTinNative)
+	{
+		EnsureReftent(pReftab, pTin->m_pTinNative, parypTin);
+	}
+
 	switch (pTin->m_tink)
 	{
 	case TINK_Array:
@@ -2786,32 +3162,35 @@ void EnsureReftent(SReflectGlobalTable * pReftab, STypeInfo * pTin, CDynAry<STyp
 	}
 }
 
-static inline BCode::CBuilder::LValue * PLvalGenerateReflectTypeTable(CWorkspace * pWork, BCode::CBuilder * pBuild)
+static inline void DeferReflectTypeTable(BCode::CBuilder * pBuild, SSymbol * pSym, BCode::CBuilder::Global * pGlob)
 {
 	EWC_ASSERT(false, "bytecode TBD (reflect type table)");
-	return nullptr;
 }
 
-static inline LLVMOpaqueValue * PLvalGenerateReflectTypeTable(CWorkspace * pWork, CBuilderIR * pBuild)
+static inline void DeferReflectTypeTable(CBuilderIR * pBuild, SSymbol * pSym, CIRGlobal * pGlob)
+{
+	// the table's initializer is generated by FinalizeBuild, once we know which types are reflected
+	pBuild->m_pSymTinTable = pSym;
+	pBuild->m_pGlobTinTable = pGlob;
+}
+
+// Emits reflection data for the types referenced by typeinfo expressions (and the types they reference), returns 
+//  the initializer for the global type table or null if !fEmitTable.
+static inline LLVMOpaqueValue * PLvalGenerateReflectTypeTable(CWorkspace * pWork, CBuilderIR * pBuild, bool fEmitTable)
 {
 	CDynAry<STypeInfo *> arypTin(pBuild->m_pAlloc, BK_CodeGenReflect, 256);
 	SReflectGlobalTable reftab(pBuild->m_pAlloc);
 
 	auto pLtypeTin = PLtypeForTypeInfo(pWork, pBuild, "STypeInfo");
 	auto pLtypePTin = LLVMPointerType(pLtypeTin, 0);
-	CSymbolTable * pSymtab = pWork->m_pSymtab;
 
-	STypeInfo ** ppTin;
-	EWC::CHash<u64, STypeInfo *>::CIterator iter(&pSymtab->m_pUntyper->m_hashHvPTinUnique);
-	while ((ppTin = iter.Next()))
+	auto ppTinRootMac = pBuild->m_arypTinReflectRoot.PMac();
+	for (auto ppTinRoot = pBuild->m_arypTinReflectRoot.A(); ppTinRoot != ppTinRootMac; ++ppTinRoot)
 	{
-		auto pTin = *ppTin;
-		if (!pTin || pTin->m_tink >= TINK_ReflectedMax)
-			continue;
-
-		EnsureReftent(&reftab, pTin, &arypTin);
+		EnsureReftent(&reftab, *ppTinRoot, &arypTin);
 	}
 
+	if (!arypTin.FIsEmpty())
 	{
 		CDynAry<SReflectOrderData> aryReord(pWork->m_pAlloc, BK_CodeGenReflect);
 		ComputeTableOrder(&reftab, &aryReord, arypTin);
@@ -2829,12 +3208,20 @@ static inline LLVMOpaqueValue * PLvalGenerateReflectTypeTable(CWorkspace * pWork
 	}
 
 	CDynAry<LLVMOpaqueValue *> arypLval(pBuild->m_pAlloc, BK_CodeGenReflect, 256);
+	for (STypeInfo ** ppTin = arypTin.A(); ppTin != arypTin.PMac(); ++ppTin)
+	{
+		(void) PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, *ppTin);
+	}
+
 	for (STypeInfo ** ppTin = arypTin.A(); ppTin != arypTin.PMac(); ++ppTin)
 	{
 		STypeInfo * pTin = *ppTin;
 		arypLval.Append(PLvalEnsureReflectStruct(pWork, pBuild, pLtypeTin, pLtypePTin, pTin, &reftab));
 	}
 
+	if (!fEmitTable)
+		return nullptr;
+
 	// array of pointers 
 	auto pLtypeArray = LLVMArrayType(pLtypePTin, u32(arypLval.C()));
 
@@ -3453,65 +3840,295 @@ CIRInstruction * CBuilderIR::PInstCreateMemset(CIRValue * pValLhs, s64 cBSize, s
 	return pInstMemcpy;
 }
 
-template <typename BUILD>
-typename BUILD::Instruction * PInstCreateLoopingInit(CWorkspace * pWork, BUILD * pBuild, STypeInfo * pTin, typename BUILD::Value * pValLhs, CSTNode * pStnodInit)
+void CBuilderIR::CreateBoundsCheck(CIRValue * pValIndex, CIRValue * pValCount)
 {
-	// This should be an arry, we need to loop over the elements and either memcpy a global or call an 
-	//  initializer proc:
-		
-	BUILD::Proc * pProc = pBuild->m_pProcCur;
-	auto pTinary = (STypeInfoArray *)pTin;
-	EWC_ASSERT(pTinary->m_aryk == ARYK_Fixed, "unexpected ARYK");
-
-	auto pLvalZero = pBuild->PConstInt(0, 64, false);
-	auto pLvalOne = pBuild->PConstInt(1, 64, false);
-	auto pLvalCount = pBuild->PConstInt(pTinary->m_c, 64, false);
-	
-	auto pTinS64 = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strUsize);
-	auto pLtypeIndex = pBuild->PLtypeFromPTin(pTinS64);
-	auto pValAlloca = pBuild->PValCreateAlloca(pLtypeIndex, "iInit");
-
-	pBuild->PInstCreateStore(pValAlloca, pLvalZero);
-
-	BUILD::Block *	pBlockPred = pBuild->PBlockCreate(pProc, "initPred");
-	BUILD::Block *	pBlockBody = pBuild->PBlockCreate(pProc, "initBody");
-	BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "initPost");
-
-	pBuild->CreateBranch(pBlockPred);	
+	// both operands are s64, an unsigned compare catches negative indices too
+	auto pInstCmp = PInstCreateNCmp(NPRED_ULT, pValIndex, pValCount, "bchkCmp");
+	if (FIsError(pInstCmp))
+		return;
 
-	pBuild->ActivateBlock(pBlockPred);
-	auto pLvalLoadIndex = pBuild->PInstCreate(IROP_Load, pValAlloca, "iLoad");
-	auto pLvalCmp = pBuild->PInstCreateNCmp(NPRED_ULT, pLvalLoadIndex, pLvalCount, "NCmp");
+	CIRBlock * pBlockFail = PBlockCreate(m_pProcCur, "bchkFail");
+	CIRBlock * pBlockOk = PBlockCreate(m_pProcCur, "bchkOk");
+	(void) PInstCreateCondBranch(pInstCmp, pBlockOk, pBlockFail);
 
-	(void) pBuild->PInstCreateCondBranch(pLvalCmp, pBlockBody, pBlockPost);
-	pBuild->ActivateBlock(pBlockBody);
+	if (!m_mpIntfunkPLval[INTFUNK_Trap])
+	{
+		LLVMTypeRef pLtypeFunction = LLVMFunctionType(LLVMVoidType(), nullptr, 0, false);
+		m_mpIntfunkPLval[INTFUNK_Trap] = LLVMAddFunction(m_pLmoduleCur, "llvm.trap", pLtypeFunction);
+	}
 
-	BUILD::GepIndex * apLvalIndex[2] = {};
-	apLvalIndex[0] = pBuild->PGepIndex(0);
-	apLvalIndex[1] = pBuild->PGepIndexFromValue(pLvalLoadIndex);
-	auto pInstGEP = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, 2, "initGEP");
+	ActivateBlock(pBlockFail);
+	CIRInstruction * pInstTrap = PInstCreateRaw(IROP_BoundsCheck, nullptr, nullptr, "trap");
+	pInstTrap->m_pLval = LLVMBuildCall(m_pLbuild, m_mpIntfunkPLval[INTFUNK_Trap], nullptr, 0, "");
+	LLVMBuildUnreachable(m_pLbuild);
+	pBlockFail->m_fIsTerminated = true;
 
-	EWC_ASSERT(!pStnodInit, "expected null initializer - ignoring");
-	(void) PValInitialize(pWork, pBuild, pTinary->m_pTin, pInstGEP, nullptr);
+	ActivateBlock(pBlockOk);
+}
 
-	auto pLvalInc = pBuild->PInstCreate(IROP_NAdd, pLvalLoadIndex, pLvalOne, "iInc");
-	pBuild->PInstCreateStore(pValAlloca, pLvalInc);
-	pBuild->CreateBranch(pBlockPred);
+// #simd structures keep their struct layout in memory, lane ops move the fields into an LLVM vector, operate and
+//  move them back out. SROA/instcombine fold the extract/insert pairs away, leaving packed vector instructions.
 
-	pBuild->ActivateBlock(pBlockPost);
-	return nullptr;
+static LLVMValueRef PLvalVectorFromStruct(LLVMBuilderRef pLbuild, LLVMTypeRef pLtypeVector, int cLane, LLVMValueRef pLvalStruct)
+{
+	LLVMValueRef pLvalVector = LLVMGetUndef(pLtypeVector);
+	for (int iLane = 0; iLane < cLane; ++iLane)
+	{
+		auto pLvalLane = LLVMBuildExtractValue(pLbuild, pLvalStruct, iLane, "lane");
+		pLvalVector = LLVMBuildInsertElement(pLbuild, pLvalVector, pLvalLane, LLVMConstInt(LLVMInt32Type(), iLane, false), "");
+	}
+	return pLvalVector;
 }
 
+static LLVMValueRef PLvalStructFromVector(LLVMBuilderRef pLbuild, LLVMTypeRef pLtypeStruct, int cLane, LLVMValueRef pLvalVector)
+{
+	LLVMValueRef pLvalStruct = LLVMGetUndef(pLtypeStruct);
+	for (int iLane = 0; iLane < cLane; ++iLane)
+	{
+		auto pLvalLane = LLVMBuildExtractElement(pLbuild, pLvalVector, LLVMConstInt(LLVMInt32Type(), iLane, false), "lane");
+		pLvalStruct = LLVMBuildInsertValue(pLbuild, pLvalStruct, pLvalLane, iLane, "");
+	}
+	return pLvalStruct;
+}
 
-// allocate a global constant used to initialize type with memcpy
-template <typename BUILD>
-typename BUILD::LValue * PLvalBuildConstantInitializer(BUILD * pBuild, STypeInfo * pTin, CSTNode * pStnodInit)
+static LLVMValueRef PLvalConstLaneMask(const s32 * aiLane, int cLane)
 {
-	if (pTin->m_tink == TINK_Struct)
+	LLVMValueRef apLvalLane[s_cLaneSimdMax];
+	for (int iLane = 0; iLane < cLane; ++iLane)
 	{
-		auto pTinstruct = PTinDerivedCast<STypeInfoStruct *>(pTin);
+		apLvalLane[iLane] = LLVMConstInt(LLVMInt32Type(), aiLane[iLane], false);
+	}
+	return LLVMConstVector(apLvalLane, cLane);
+}
 
-		int cTypememb = (int)pTinstruct->m_aryTypemembField.C();
+static LLVMValueRef PLvalBuildLaneOp(LLVMBuilderRef pLbuild, IROP irop, s32 pred, LLVMValueRef pLvalLhs, LLVMValueRef pLvalRhs, const char * pChzName)
+{
+	switch (irop)
+	{
+	case IROP_NAdd:	return LLVMBuildAdd(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_GAdd:	return LLVMBuildFAdd(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_NSub:	return LLVMBuildSub(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_GSub:	return LLVMBuildFSub(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_NMul:	return LLVMBuildMul(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_GMul:	return LLVMBuildFMul(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_SDiv:	return LLVMBuildSDiv(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_UDiv:	return LLVMBuildUDiv(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_GDiv:	return LLVMBuildFDiv(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_SRem:	return LLVMBuildSRem(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_URem:	return LLVMBuildURem(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_GRem:	return LLVMBuildFRem(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_Shl:	return LLVMBuildShl(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_AShr:	return LLVMBuildAShr(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_LShr:	return LLVMBuildLShr(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_And:	return LLVMBuildAnd(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_Or:	return LLVMBuildOr(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_Xor:	return LLVMBuildXor(pLbuild, pLvalLhs, pLvalRhs, pChzName);
+	case IROP_NNeg:	return LLVMBuildNeg(pLbuild, pLvalLhs, pChzName);
+	case IROP_GNeg:	return LLVMBuildFNeg(pLbuild, pLvalLhs, pChzName);
+	case IROP_Not:	return LLVMBuildNot(pLbuild, pLvalLhs, pChzName);
+	case IROP_NCmp:	return LLVMBuildICmp(pLbuild, s_mpNcmpredLpredicate[pred], pLvalLhs, pLvalRhs, pChzName);
+	case IROP_GCmp:	return LLVMBuildFCmp(pLbuild, s_mpGcmpredLpredicate[pred], pLvalLhs, pLvalRhs, pChzName);
+	default: 
+		EWC_ASSERT(false, "IROP_%s is not supported as a lane op", PChzFromIrop(irop)); 
+		return nullptr;
+	}
+}
+
+static LLVMValueRef PLvalBuildLaneReduceStep(LLVMBuilderRef pLbuild, IROP irop, s32 pred, LLVMValueRef pLvalAcc, LLVMValueRef pLvalLane)
+{
+	if ((irop == IROP_NCmp) | (irop == IROP_GCmp))
+	{
+		// min/max: keep the accumulator while pred(acc, lane) holds
+		auto pLvalCmp = PLvalBuildLaneOp(pLbuild, irop, pred, pLvalAcc, pLvalLane, "redCmp");
+		return LLVMBuildSelect(pLbuild, pLvalCmp, pLvalAcc, pLvalLane, "redSel");
+	}
+	return PLvalBuildLaneOp(pLbuild, irop, pred, pLvalAcc, pLvalLane, "redOp");
+}
+
+CIRInstruction * CBuilderIR::PInstCreateLaneOp(
+	IROP irop,
+	s32 pred,
+	STypeInfoStruct * pTinstruct,
+	CIRValue * pValLhs,
+	CIRValue * pValRhs,
+	const char * pChzName)
+{
+	CIRInstruction * pInst = PInstCreateRaw(IROP_LaneOp, pValLhs, nullptr, pChzName);
+	if (FIsError(pInst))
+		return pInst;
+
+	int cLane = pTinstruct->CLane();
+	auto pLtypeStruct = PLtypeFromPTin(pTinstruct);
+	auto pLtypeVector = LLVMVectorType(PLtypeFromPTin(pTinstruct->PTinLane()), cLane);
+
+	auto pLvalLhs = PLvalVectorFromStruct(m_pLbuild, pLtypeVector, cLane, pValLhs->m_pLval);
+	auto pLvalRhs = (pValRhs) ? PLvalVectorFromStruct(m_pLbuild, pLtypeVector, cLane, pValRhs->m_pLval) : nullptr;
+	auto pLvalOp = PLvalBuildLaneOp(m_pLbuild, irop, pred, pLvalLhs, pLvalRhs, OPNAME(pChzName));
+
+	if ((irop == IROP_NCmp) | (irop == IROP_GCmp))
+	{
+		// <N x i1> -> iN -> u32 lane mask
+		auto pLvalBits = LLVMBuildBitCast(m_pLbuild, pLvalOp, LLVMIntType(cLane), "maskBits");
+		pInst->m_pLval = LLVMBuildZExt(m_pLbuild, pLvalBits, LLVMInt32Type(), OPNAME(pChzName));
+		return pInst;
+	}
+
+	pInst->m_pLval = PLvalStructFromVector(m_pLbuild, pLtypeStruct, cLane, pLvalOp);
+	return pInst;
+}
+
+CIRInstruction * CBuilderIR::PInstCreateLaneShuffle(STypeInfoStruct * pTinstruct, CIRValue * pVal, const s32 * aiLane, const char * pChzName)
+{
+	CIRInstruction * pInst = PInstCreateRaw(IROP_LaneShuffle, pVal, nullptr, pChzName);
+	if (FIsError(pInst))
+		return pInst;
+
+	int cLane = pTinstruct->CLane();
+	auto pLtypeVector = LLVMVectorType(PLtypeFromPTin(pTinstruct->PTinLane()), cLane);
+
+	auto pLvalVector = PLvalVectorFromStruct(m_pLbuild, pLtypeVector, cLane, pVal->m_pLval);
+	auto pLvalShuffle = LLVMBuildShuffleVector(
+							m_pLbuild, 
+							pLvalVector, 
+							LLVMGetUndef(pLtypeVector), 
+							PLvalConstLaneMask(aiLane, cLane),
+							OPNAME(pChzName));
+
+	pInst->m_pLval = PLvalStructFromVector(m_pLbuild, PLtypeFromPTin(pTinstruct), cLane, pLvalShuffle);
+	return pInst;
+}
+
+CIRInstruction * CBuilderIR::PInstCreateLaneReduce(IROP irop, s32 pred, STypeInfoStruct * pTinstruct, CIRValue * pVal, const char * pChzName)
+{
+	CIRInstruction * pInst = PInstCreateRaw(IROP_LaneReduce, pVal, nullptr, pChzName);
+	if (FIsError(pInst))
+		return pInst;
+
+	int cLane = pTinstruct->CLane();
+	auto pLtypeLane = PLtypeFromPTin(pTinstruct->PTinLane());
+	auto pLvalVector = PLvalVectorFromStruct(m_pLbuild, LLVMVectorType(pLtypeLane, cLane), cLane, pVal->m_pLval);
+
+	// reduce pairwise halves while the lane count is even, this maps to horizontal ops for power of two widths
+	s32 aiLane[s_cLaneSimdMax];
+	while ((cLane > 1) & ((cLane & 0x1) == 0))
+	{
+		int cLaneHalf = cLane / 2;
+		auto pLtypeHalf = LLVMVectorType(pLtypeLane, cLaneHalf);
+		auto pLvalUndef = LLVMGetUndef(LLVMTypeOf(pLvalVector));
+
+		for (int iLane = 0; iLane < cLaneHalf; ++iLane)
+		{
+			aiLane[iLane] = iLane;
+		}
+		auto pLvalLo = LLVMBuildShuffleVector(m_pLbuild, pLvalVector, pLvalUndef, PLvalConstLaneMask(aiLane, cLaneHalf), "redLo");
+
+		for (int iLane = 0; iLane < cLaneHalf; ++iLane)
+		{
+			aiLane[iLane] = iLane + cLaneHalf;
+		}
+		auto pLvalHi = LLVMBuildShuffleVector(m_pLbuild, pLvalVector, pLvalUndef, PLvalConstLaneMask(aiLane, cLaneHalf), "redHi");
+
+		pLvalVector = PLvalBuildLaneReduceStep(m_pLbuild, irop, pred, pLvalLo, pLvalHi);
+		EWC_ASSERT(LLVMTypeOf(pLvalVector) == pLtypeHalf, "unexpected reduction type");
+		cLane = cLaneHalf;
+	}
+
+	auto pLvalAcc = LLVMBuildExtractElement(m_pLbuild, pLvalVector, LLVMConstInt(LLVMInt32Type(), 0, false), "redAcc");
+	for (int iLane = 1; iLane < cLane; ++iLane)
+	{
+		auto pLvalLane = LLVMBuildExtractElement(m_pLbuild, pLvalVector, LLVMConstInt(LLVMInt32Type(), iLane, false), "lane");
+		pLvalAcc = PLvalBuildLaneReduceStep(m_pLbuild, irop, pred, pLvalAcc, pLvalLane);
+	}
+
+	pInst->m_pLval = pLvalAcc;
+	return pInst;
+}
+
+CIRInstruction * CBuilderIR::PInstCreateLaneSelect(
+	STypeInfoStruct * pTinstruct,
+	CIRValue * pValMask,
+	CIRValue * pValTrue,
+	CIRValue * pValFalse,
+	const char * pChzName)
+{
+	CIRInstruction * pInst = PInstCreateRaw(IROP_LaneSelect, pValMask, nullptr, pChzName);
+	if (FIsError(pInst))
+		return pInst;
+
+	int cLane = pTinstruct->CLane();
+	auto pLtypeVector = LLVMVectorType(PLtypeFromPTin(pTinstruct->PTinLane()), cLane);
+
+	// u32 lane mask -> iN -> <N x i1>
+	auto pLvalBits = LLVMBuildTrunc(m_pLbuild, pValMask->m_pLval, LLVMIntType(cLane), "maskBits");
+	auto pLvalMask = LLVMBuildBitCast(m_pLbuild, pLvalBits, LLVMVectorType(LLVMInt1Type(), cLane), "mask");
+
+	auto pLvalTrue = PLvalVectorFromStruct(m_pLbuild, pLtypeVector, cLane, pValTrue->m_pLval);
+	auto pLvalFalse = PLvalVectorFromStruct(m_pLbuild, pLtypeVector, cLane, pValFalse->m_pLval);
+	auto pLvalSelect = LLVMBuildSelect(m_pLbuild, pLvalMask, pLvalTrue, pLvalFalse, OPNAME(pChzName));
+
+	pInst->m_pLval = PLvalStructFromVector(m_pLbuild, PLtypeFromPTin(pTinstruct), cLane, pLvalSelect);
+	return pInst;
+}
+
+template <typename BUILD>
+typename BUILD::Instruction * PInstCreateLoopingInit(CWorkspace * pWork, BUILD * pBuild, STypeInfo * pTin, typename BUILD::Value * pValLhs, CSTNode * pStnodInit)
+{
+	// This should be an arry, we need to loop over the elements and either memcpy a global or call an 
+	//  initializer proc:
+		
+	BUILD::Proc * pProc = pBuild->m_pProcCur;
+	auto pTinary = (STypeInfoArray *)pTin;
+	EWC_ASSERT(pTinary->m_aryk == ARYK_Fixed, "unexpected ARYK");
+
+	auto pLvalZero = pBuild->PConstInt(0, 64, false);
+	auto pLvalOne = pBuild->PConstInt(1, 64, false);
+	auto pLvalCount = pBuild->PConstInt(pTinary->m_c, 64, false);
+	
+	auto pTinS64 = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strUsize);
+	auto pLtypeIndex = pBuild->PLtypeFromPTin(pTinS64);
+	auto pValAlloca = pBuild->PValCreateAlloca(pLtypeIndex, "iInit");
+
+	pBuild->PInstCreateStore(pValAlloca, pLvalZero);
+
+	BUILD::Block *	pBlockPred = pBuild->PBlockCreate(pProc, "initPred");
+	BUILD::Block *	pBlockBody = pBuild->PBlockCreate(pProc, "initBody");
+	BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "initPost");
+
+	pBuild->CreateBranch(pBlockPred);	
+
+	pBuild->ActivateBlock(pBlockPred);
+	auto pLvalLoadIndex = pBuild->PInstCreate(IROP_Load, pValAlloca, "iLoad");
+	auto pLvalCmp = pBuild->PInstCreateNCmp(NPRED_ULT, pLvalLoadIndex, pLvalCount, "NCmp");
+
+	(void) pBuild->PInstCreateCondBranch(pLvalCmp, pBlockBody, pBlockPost);
+	pBuild->ActivateBlock(pBlockBody);
+
+	BUILD::GepIndex * apLvalIndex[2] = {};
+	apLvalIndex[0] = pBuild->PGepIndex(0);
+	apLvalIndex[1] = pBuild->PGepIndexFromValue(pLvalLoadIndex);
+	auto pInstGEP = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, 2, "initGEP");
+
+	EWC_ASSERT(!pStnodInit, "expected null initializer - ignoring");
+	(void) PValInitialize(pWork, pBuild, pTinary->m_pTin, pInstGEP, nullptr);
+
+	auto pLvalInc = pBuild->PInstCreate(IROP_NAdd, pLvalLoadIndex, pLvalOne, "iInc");
+	pBuild->PInstCreateStore(pValAlloca, pLvalInc);
+	pBuild->CreateBranch(pBlockPred);
+
+	pBuild->ActivateBlock(pBlockPost);
+	return nullptr;
+}
+
+
+// allocate a global constant used to initialize type with memcpy
+template <typename BUILD>
+typename BUILD::LValue * PLvalBuildConstantInitializer(BUILD * pBuild, STypeInfo * pTin, CSTNode * pStnodInit)
+{
+	if (pTin->m_tink == TINK_Struct)
+	{
+		auto pTinstruct = PTinDerivedCast<STypeInfoStruct *>(pTin);
+
+		int cTypememb = (int)pTinstruct->m_aryTypemembField.C();
 		size_t cB = sizeof(BUILD::LValue *) * cTypememb;
 		auto apLvalMember = (BUILD::LValue **)(alloca(cB));
 		EWC::ZeroAB(apLvalMember, cB);
@@ -3554,7 +4171,11 @@ typename BUILD::LValue * PLvalBuildConstantInitializer(BUILD * pBuild, STypeInfo
 				}
 				else if (pStnodTypememb)
 				{
-					arypStnodInit[iTypememb] = pStnodTypememb;
+					auto iTypemembDecl = ITypemembFromDeclIndex(pTinstruct, iTypememb);
+					if (EWC_FVERIFY(iTypemembDecl >= 0, "too many struct initializers"))
+					{
+						arypStnodInit[iTypemembDecl] = pStnodTypememb;
+					}
 				}
 			}
 		}
@@ -3601,6 +4222,12 @@ typename BUILD::LValue * PLvalBuildConstantInitializer(BUILD * pBuild, STypeInfo
 	else if (pTin->m_tink == TINK_Array)
 	{
 		auto pTinary = (STypeInfoArray *)pTin;
+		if (pTinary->m_fIsSoa)
+		{
+			// SOA storage is zero initialized, literal initializers are rejected during typecheck
+			return PLvalZeroInType(pBuild, pTin);
+		}
+
 		switch (pTinary->m_aryk)
 		{
 			case ARYK_Fixed:
@@ -3639,6 +4266,7 @@ typename BUILD::LValue * PLvalBuildConstantInitializer(BUILD * pBuild, STypeInfo
 
 			} break;
 			case ARYK_Reference:
+			case ARYK_Dynamic:
 			{
 				if (pStnodInit && pStnodInit->m_park != PARK_Uninitializer)
 				{
@@ -3665,6 +4293,21 @@ typename BUILD::LValue * PLvalBuildConstantInitializer(BUILD * pBuild, STypeInfo
 	return PLvalZeroInType(pBuild, pTin);
 }
 
+// fixed arrays with more elements than this are initialized in a loop rather than copied from a constant global
+static const s64 s_cElementMemcpyGlobalMax = 1024;
+
+static s64 CElementFlattened(STypeInfoArray * pTinary)
+{
+	s64 cElement = pTinary->m_c;
+	auto pTinaryElement = PTinRtiCast<STypeInfoArray *>(pTinary->m_pTin);
+	while (pTinaryElement && pTinaryElement->m_aryk == ARYK_Fixed)
+	{
+		cElement *= pTinaryElement->m_c;
+		pTinaryElement = PTinRtiCast<STypeInfoArray *>(pTinaryElement->m_pTin);
+	}
+	return cElement;
+}
+
 CGINITK CginitkCompute(STypeInfo * pTin, CSTNode * pStnodInit)
 {
 	if (!EWC_FVERIFY(pTin, "null type in CginitkCompute"))
@@ -3720,6 +4363,14 @@ CGINITK CginitkCompute(STypeInfo * pTin, CSTNode * pStnodInit)
 	else if (pTin->m_tink == TINK_Array)
 	{
 		auto pTinary = (STypeInfoArray *)pTin;
+		if (pTinary->m_fIsSoa)
+		{
+			// element types with member default values are rejected during typecheck, every member starts zeroed
+			if (pStnodInit)
+				return CGINITK_AssignInitializer;
+			return CGINITK_MemsetZero;
+		}
+
 		switch (pTinary->m_aryk)
 		{
 		case ARYK_Fixed:
@@ -3733,9 +4384,14 @@ CGINITK CginitkCompute(STypeInfo * pTin, CSTNode * pStnodInit)
 				if (cginitkElement <= CGINITK_AssignInitializer)
 					return cginitkElement;
 
+				// small arrays of constant-initialized elements are copied from a single constant global
+				if (cginitkElement == CGINITK_MemcpyGlobal && CElementFlattened(pTinary) <= s_cElementMemcpyGlobalMax)
+					return CGINITK_MemcpyGlobal;
+
 				return CGINITK_LoopingInit;
 			}
 		case ARYK_Reference:	
+		case ARYK_Dynamic:	
 			{
 				if (pStnodInit)
 					return CGINITK_AssignInitializer;
@@ -3812,6 +4468,23 @@ static inline typename BUILD::Value * PValInitialize(
 
 			// if no initializer 
 			//		if struct make the default global initializer and save it for reuse
+			//		if fixed array build a constant global of default elements, shared by every array of that type
+
+			if (pTin->m_tink == TINK_Array)
+			{
+				auto pTinary = (STypeInfoArray *)pTin;
+				auto ppGlobInit = pBuild->m_hashPTinaryPGlobInit.Lookup(pTinary);
+				if (ppGlobInit)
+					return pBuild->PInstCreateMemcpy(pTin, pValPT, *ppGlobInit);
+
+				auto strPunyName = StrPunyEncode(pTin->m_strName.PCoz());
+				auto pLvalInit = PLvalBuildConstantInitializer(pBuild, pTin, nullptr);
+
+				auto pGlobInit = pBuild->PGlobCreate(pBuild->PLtypeFromPTin(pTin), strPunyName.PCoz());
+				pBuild->SetInitializer(pGlobInit, pLvalInit);
+				pBuild->m_hashPTinaryPGlobInit.Insert(pTinary, pGlobInit);
+				return pBuild->PInstCreateMemcpy(pTin, pValPT, pGlobInit);
+			}
 
 			auto pTinstruct = PTinRtiCast<STypeInfoStruct *>(pTin);
 			if (EWC_FVERIFY(pTinstruct, "non-struct value without initializer should not be MemmcpyGlobal"))
@@ -4047,7 +4720,7 @@ static inline typename BUILD::Value * PValGenerateCast(
 			{
 				if (pTinaryLhs->m_aryk == ARYK_Reference)
 				{
-					EWC_ASSERT(pTinaryRhs->m_aryk == ARYK_Fixed, "expected ARYK_Fixed");
+					EWC_ASSERT(pTinaryRhs->m_aryk != ARYK_Reference, "expected ARYK_Fixed or ARYK_Dynamic");
 
 					auto pLtype = pBuild->PLtypeFromPTin(pTinaryLhs);
 					if (!EWC_FVERIFY(pLtype, "couldn't find llvm type for cast"))
@@ -4127,6 +4800,49 @@ static inline typename BUILD::Value * PValGenerateCast(
 	return pVal;
 }
 
+template <typename BUILD>
+typename BUILD::Instruction * PInstGenerateSoaAssignmentFromRef(
+	BUILD * pBuild,
+	STypeInfoArray * pTinaryLhs,
+	STypeInfo * pTinRhs,
+	typename BUILD::Value * pValLhs,
+	typename BUILD::Value * pValRhsRef)
+{
+	auto pTinaryRhs = PTinRtiCast<STypeInfoArray *>(PTinStripQualifiers(pTinRhs));
+	if (!EWC_FVERIFY(pTinaryRhs && pTinaryRhs->m_fIsSoa, "SOA arrays can only be assigned from SOA arrays"))
+		return nullptr;
+
+	if (pTinaryLhs->m_aryk == pTinaryRhs->m_aryk)
+	{
+		// identical storage: fixed arrays copy every member array, references copy the count and member pointers
+		return pBuild->PInstCreateMemcpy(pTinaryLhs, pValLhs, pValRhsRef);
+	}
+
+	EWC_ASSERT(pTinaryLhs->m_aryk == ARYK_Reference && pTinaryRhs->m_aryk == ARYK_Fixed, "unexpected SOA array conversion");
+	auto pTinstructRhs = PTinstructEnsureSoa(pBuild->m_pSymtab, pTinaryRhs);
+
+	BUILD::LValue * apLvalIndex[3] = {};
+	apLvalIndex[0] = pBuild->PLvalConstantInt(0, 32, false);
+	apLvalIndex[1] = pBuild->PLvalConstantInt(ARYMEMB_Count, 32, false);
+	auto pInstGepCount = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, 2, "gepCount");
+	auto pInstStore = pBuild->PInstCreateStore(pInstGepCount, pBuild->PConstInt(pTinaryRhs->m_c));
+
+	// point the reference at the start of each member array
+	int cTypememb = (int)pTinstructRhs->m_aryTypemembField.C();
+	for (int iTypememb = 0; iTypememb < cTypememb; ++iTypememb)
+	{
+		apLvalIndex[1] = pBuild->PLvalConstantInt(iTypememb, 32, false);
+		apLvalIndex[2] = pBuild->PLvalConstantInt(0, 32, false);
+		auto pInstGepData = pBuild->PInstCreateGEP(pValRhsRef, apLvalIndex, 3, "gepData");
+
+		apLvalIndex[1] = pBuild->PLvalConstantInt(ITypemembSoa(pTinaryLhs, iTypememb), 32, false);
+		auto pInstGepLhs = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, 2, "gepSoa");
+		pInstStore = pBuild->PInstCreateStore(pInstGepLhs, pInstGepData);
+	}
+
+	return pInstStore;
+}
+
 template <typename BUILD>
 typename BUILD::Instruction * PInstGenerateAssignmentFromRef(
 	CWorkspace * pWork,
@@ -4140,6 +4856,11 @@ typename BUILD::Instruction * PInstGenerateAssignmentFromRef(
 	{
 		case TINK_Array:
 		{
+			if (((STypeInfoArray *)pTinLhs)->m_fIsSoa)
+			{
+				return PInstGenerateSoaAssignmentFromRef(pBuild, (STypeInfoArray *)pTinLhs, pTinRhs, pValLhs, pValRhsRef);
+			}
+
 			ARYK arykRhs;
 			s64 cRhs;
 			switch (pTinRhs->m_tink)
@@ -4230,6 +4951,7 @@ typename BUILD::Instruction * PInstGenerateAssignmentFromRef(
 							pValData = pBuild->PInstCreateGEP(pValRhsRef, apLvalIndex, EWC_DIM(apLvalIndex), "aryGep");
 						} break;
 					case ARYK_Reference:
+					case ARYK_Dynamic:
 						{
 							apLvalIndex[1] = pBuild->PLvalConstantInt(ARYMEMB_Count, 32, false);
 							auto pInstGepCount = pBuild->PInstCreateGEP(pValRhsRef, apLvalIndex, 2, "gepCount");
@@ -4251,6 +4973,12 @@ typename BUILD::Instruction * PInstGenerateAssignmentFromRef(
 					return pBuild->PInstCreateStore(pInstGepData, pValData);
 
 				} break;
+			case ARYK_Dynamic:
+				{
+					// dynamic arrays are only assigned from other dynamic arrays, this is a shallow copy
+					EWC_ASSERT(arykRhs == ARYK_Dynamic, "cannot copy mixed array kinds to dynamic array");
+					return pBuild->PInstCreateMemcpy(pTinLhs, pValLhs, pValRhsRef);
+				} break;
 			default: EWC_ASSERT(false, "Unhandled ARYK"); 
 			}
 		} break;
@@ -4308,6 +5036,14 @@ typename BUILD::Instruction * PInstGenerateAssignment(
 				return pBuild->PInstCreateMemcpy(pStnodRhs->m_pTin, pValLhs, pValRhsRef);
 			}
 
+			auto pTinaryLhs = (STypeInfoArray *)pTinLhs;
+			if (pTinaryLhs->m_aryk == ARYK_Dynamic && IvalkCompute(pStnodRhs) < IVALK_LValue)
+			{
+				// dynamic arrays returned from procedures don't have an address to copy from
+				auto pValRhs = PValGenerate(pWork, pBuild, pStnodRhs, VALGENK_Instance);
+				return pBuild->PInstCreateStore(pValLhs, pValRhs);
+			}
+
 			auto pValRhsRef = PValGenerate(pWork, pBuild, pStnodRhs, VALGENK_Reference);
 			return PInstGenerateAssignmentFromRef(pWork, pBuild, pTinLhs, pStnodRhs->m_pTin, pValLhs, pValRhsRef);
 		} break;
@@ -4412,10 +5148,37 @@ void GenerateMethodBody(
 	typename BUILD::Proc * pProc,
 	CSTNode ** apStnodBody, 
 	int cpStnodBody,
+	CSTNode * pStnodProc,
 	bool fNeedsNullReturn)
 {
 	EWC_ASSERT(pProc && apStnodBody && cpStnodBody, "bad parameters to GenerateMethodBody");
 
+	// nested procedures get their own bounds check state
+	bool fBoundsCheckPrev = pBuild->m_fBoundsCheck;
+	size_t cSymBoundsLocalPrev = pBuild->m_arypSymBoundsLocal.C();
+	CDynAry<SBoundsFact> aryBfactPrev(pBuild->m_pAlloc, BK_CodeGen, 0);
+	pBuild->m_aryBfact.Swap(&aryBfactPrev);
+
+	pBuild->m_fBoundsCheck = pWork->m_fBoundsCheck;
+	auto pTinproc = (pStnodProc) ? PTinRtiCast<STypeInfoProcedure *>(pStnodProc->m_pTin) : nullptr;
+	if (pTinproc && pTinproc->m_boundscheck != BOUNDSCHECK_Nil)
+	{
+		pBuild->m_fBoundsCheck = pTinproc->m_boundscheck == BOUNDSCHECK_Enabled;
+	}
+
+	if (pBuild->m_fBoundsCheck)
+	{
+		// parameters are declared outside of the body
+		if (pStnodProc)
+		{
+			GatherBoundsLocals(pBuild, &pStnodProc, 1);
+		}
+		else
+		{
+			GatherBoundsLocals(pBuild, apStnodBody, cpStnodBody);
+		}
+	}
+
 	auto pDif = PDifEnsure(pWork, pBuild, apStnodBody[0]->m_lexloc.m_strFilename.PCoz());
 	PushDIScope(pDif, PLvalDInfo(pProc));
 
@@ -4441,6 +5204,10 @@ void GenerateMethodBody(
 	pBuild->ActivateProc(nullptr, nullptr);
 
 	pBuild->FinalizeProc(pProc);
+
+	pBuild->m_aryBfact.Swap(&aryBfactPrev);
+	pBuild->m_arypSymBoundsLocal.PopToSize(cSymBoundsLocalPrev);
+	pBuild->m_fBoundsCheck = fBoundsCheckPrev;
 }
 
 void CBuilderIR::FinalizeProc(CIRProcedure * pProc)
@@ -4489,6 +5256,19 @@ void CreateOpinfo(GPRED gpred, const char * pChzName, SOperatorInfo * pOpinfo)
 static void GenerateOperatorInfo(TOK tok, const SOpTypes * pOptype, SOperatorInfo * pOpinfo)
 {
 	STypeInfo * apTin[2] = {PTinStripQualifiers(pOptype->m_pTinLhs), PTinStripQualifiers(pOptype->m_pTinRhs)};
+	if (FIsSimdStruct(apTin[0]) && tok != TOK('='))
+	{
+		// lane-wise operators are the scalar operator applied to each lane, short circuit ops aren't supported
+		auto pTinLane = ((STypeInfoStruct *)apTin[0])->PTinLane();
+		SOpTypes optypeLane(pTinLane, pTinLane, pTinLane);
+		GenerateOperatorInfo(tok, &optypeLane, pOpinfo);
+		if (pOpinfo->m_irop == IROP_Phi)
+		{
+			pOpinfo->m_irop = IROP_Nil;
+		}
+		return;
+	}
+
 	bool aFIsSigned[2];
 	TINK aTink[2];
 
@@ -4847,6 +5627,13 @@ static inline typename BUILD::Instruction * PInstGenerateOperator(
 		return nullptr;
 	}
 
+	auto pTinLhs = PTinStripQualifiers(pOptype->m_pTinLhs);
+	if (FIsSimdStruct(pTinLhs))
+	{
+		s32 pred = (opinfo.m_irop == IROP_GCmp) ? opinfo.m_gpred : opinfo.m_npred;
+		return pBuild->PInstCreateLaneOp(opinfo.m_irop, pred, (STypeInfoStruct *)pTinLhs, pValLhs, pValRhs, opinfo.m_pChzName);
+	}
+
 	BUILD::Instruction * pInstOp = nullptr;
 	switch (opinfo.m_irop)
 	{
@@ -4899,2830 +5686,4656 @@ static inline bool FIsOverloadedOp(CSTNode * pStnod)
 	return pStnod->m_pOptype && pStnod->m_pOptype->m_pTinprocOverload;
 }
 
-void CBuilderIR::SetGlobalInitializer(CWorkspace * pWork, CIRGlobal * pGlob, STypeInfo * pTinGlob, STypeInfoLiteral * pTinlit, CSTNode * pStnodLiteral)
+static bool FReferencesSymbol(CSTNode * pStnod, SSymbol * pSym)
 {
-	LLVMOpaqueValue * pLvalInit;
-	auto pTinaryGlob = PTinRtiCast<STypeInfoArray *>(pTinGlob);
-	if (pTinaryGlob && pTinaryGlob->m_aryk == ARYK_Reference)
+	if (!pStnod)
+		return false;
+
+	if (pStnod->PSym() == pSym)
+		return true;
+
+	int cStnodChild = pStnod->CStnodChild();
+	for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
 	{
-		auto pLtypeElement = PLtypeFromPTin(pTinlit->m_pTinSource);
+		if (FReferencesSymbol(pStnod->PStnodChild(iStnodChild), pSym))
+			return true;
+	}
+	return false;
+}
 
-		auto apLvalElem = (LLVMOpaqueValue **)m_pAlloc->EWC_ALLOC_TYPE_ARRAY(LLVMOpaqueValue *, (size_t)pTinlit->m_c);
+// Definite assignment check for a local declaration without an initializer: the default initialization is dead
+//  if the first statement in the enclosing list that touches the new symbol is a plain assignment to the whole
+//  variable that doesn't read it. Nothing can alias a symbol before it's first referenced, so intervening 
+//  statements (and any control flow that skips the assignment) can't observe the uninitialized value.
 
-		CSTNode * pStnodList = nullptr;
-		CSTDecl * pStdecl = PStmapRtiCast<CSTDecl *>(pStnodLiteral->m_pStmap);
-		if (EWC_FVERIFY(pStdecl && pStdecl->m_iStnodInit >= 0, "array literal with no values"))
-		{
-			pStnodList = pStnodLiteral->PStnodChild(pStdecl->m_iStnodInit);
-		}
+static bool FIsDeadInitializerCandidate(CSTNode * pStnodDecl)
+{
+	if (pStnodDecl->m_park != PARK_Decl)
+		return false;
 
-		if (!pStnodList || !EWC_FVERIFY(pStnodList->CStnodChild() == pTinlit->m_c, "missing values for array literal"))
-			return;
+	auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnodDecl->m_pStmap);
+	if (!pStdecl || pStdecl->m_iStnodInit >= 0 || pStdecl->m_iStnodChildMin != -1 || pStdecl->m_fIsBakedConstant)
+		return false;
 
-		for (int iStnod = 0; iStnod < pTinlit->m_c; ++iStnod)
-		{
-			auto pStnodChild = pStnodList->PStnodChild(iStnod);
-			STypeInfoLiteral * pTinlitElem = (STypeInfoLiteral *)pStnodChild->m_pTin;
-			EWC_ASSERT(pTinlit->m_tink == TINK_Literal, "Bad array literal element");
+	auto pSym = pStnodDecl->PSym();
+	if (!pSym || FIsOverloadedOp(pStnodDecl))
+		return false;
 
-			apLvalElem[iStnod] = PLvalFromLiteral(this, pTinlitElem, pStnodChild);
-		}
+	// initializer procs can call arbitrary code for member defaults, we can't drop those side effects
+	return CginitkCompute(pStnodDecl->m_pTin, nullptr) <= CGINITK_MemcpyGlobal;
+}
 
-		pLvalInit = PLvalBuildConstantGlobalArrayRef(pWork, this, pLtypeElement, apLvalElem, U32Coerce(pTinlit->m_c));
+// move every pending declaration whose symbol is referenced under pStnod into paryPStnodTouched
+static void GatherTouchedDecls(CSTNode * pStnod, CHash<SSymbol *, CSTNode *> * pHashPSymPStnodPending, CDynAry<CSTNode *> * paryPStnodTouched)
+{
+	if (!pStnod)
+		return;
 
-		m_pAlloc->EWC_FREE(apLvalElem);
-	}
-	else
+	auto pSym = pStnod->PSym();
+	if (pSym)
 	{
-		pLvalInit = PLvalFromLiteral(this, pTinlit, pStnodLiteral);
+		CSTNode ** ppStnodDecl = pHashPSymPStnodPending->Lookup(pSym);
+		if (ppStnodDecl)
+		{
+			paryPStnodTouched->Append(*ppStnodDecl);
+			pHashPSymPStnodPending->Remove(pSym);
+		}
 	}
 
-	SetInitializer(pGlob, pLvalInit);
+	int cStnodChild = pStnod->CStnodChild();
+	for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
+	{
+		GatherTouchedDecls(pStnod->PStnodChild(iStnodChild), pHashPSymPStnodPending, paryPStnodTouched);
+	}
 }
 
-void BCode::CBuilder::SetGlobalInitializer(CWorkspace * pWork, BCode::SConstant * pGlob, STypeInfo * pTinGlob, STypeInfoLiteral * pTinlit, CSTNode * pStnodInit)
+// single pass over a statement list: each candidate declaration is decided by the first statement that touches it, 
+//  results are stored in the builder's side table rather than on the AST.
+
+static void GatherDeadInitializers(CBuilderBase * pBuild, CSTNode * pStnodList)
 {
-	auto pLvalInit = PLvalFromLiteral(this, pTinlit, pStnodInit);
+	CHash<SSymbol *, CSTNode *> hashPSymPStnodPending(pBuild->m_pAlloc, BK_CodeGen);
+	CDynAry<CSTNode *> aryPStnodTouched(pBuild->m_pAlloc, BK_CodeGen);
 
-	if (!EWC_FVERIFY(pLvalInit->m_valk == VALK_Constant, "initializer must be constant"))
-		return;
+	int cStnodChild = pStnodList->CStnodChild();
+	for (int iStnod = 0; iStnod < cStnodChild; ++iStnod)
+	{
+		CSTNode * pStnodStmt = pStnodList->PStnodChild(iStnod);
+		if (hashPSymPStnodPending.C())
+		{
+			aryPStnodTouched.Clear();
+			GatherTouchedDecls(pStnodStmt, &hashPSymPStnodPending, &aryPStnodTouched);
 
-	auto pConstInit = (BCode::SConstant *)pLvalInit;
-
-	auto pTinaryGlob = PTinRtiCast<STypeInfoArray *>(pTinGlob);
-	if (pTinaryGlob && pTinaryGlob->m_aryk == ARYK_Reference)
-	{
-		// allocate space for an array reference
-		auto pConstGlob = m_blistConst.AppendNew();
-		pConstGlob->m_pTin = m_pSymtab->PTinptrAllocate(pTinaryGlob);
-		pConstGlob->m_opk = OPK_Global;
-
-		size_t cBArrayRef = sizeof(s64) + m_pDlay->m_cBPointer;
+			SSymbol * pSymAssigned = nullptr;
+			if (aryPStnodTouched.C() && 
+				pStnodStmt->m_park == PARK_AssignmentOp && pStnodStmt->m_tok == TOK('=') && !FIsOverloadedOp(pStnodStmt))
+			{
+				CSTNode * pStnodLhs = pStnodStmt->PStnodChild(0);
+				if (pStnodLhs->m_park == PARK_Identifier && !FReferencesSymbol(pStnodStmt->PStnodChild(1), pStnodLhs->PSym()))
+				{
+					pSymAssigned = pStnodLhs->PSym();
+				}
+			}
 
-		u8 * pBPointer;
-		s64 iBPointer;
-		s64 iBGlobal;
-		(void) PBAllocateGlobalWithPointer(cBArrayRef, EWC_ALIGN_OF(s64), &pBPointer, &iBPointer, &iBGlobal, "aryref");
-		pConstGlob->m_word.m_s64 = iBPointer;
+			CSTNode ** ppStnodMac = aryPStnodTouched.PMac();
+			for (CSTNode ** ppStnod = aryPStnodTouched.A(); ppStnod != ppStnodMac; ++ppStnod)
+			{
+				if (pSymAssigned && (*ppStnod)->PSym() == pSymAssigned)
+				{
+					pBuild->m_hashPStnodDeadInit.FinsEnsureKeyAndValue(*ppStnod, true);
+				}
+			}
+		}
 
-		auto pTinaryInit = PTinRtiCast<STypeInfoArray *>(pConstInit->m_pTin);
-		if (EWC_FVERIFY(pTinaryInit, "expected array") && pTinaryInit->m_aryk == ARYK_Fixed)
+		if (FIsDeadInitializerCandidate(pStnodStmt))
 		{
-			auto pBGlob = m_dataseg.PBFromGlobal(pConstGlob);
-							
-			*(s64*)pBGlob = pTinaryInit->m_c;
-			m_dataseg.AddRelocatedPointer(m_pDlay, pConstGlob->m_word.m_s32 + sizeof(s64), pConstInit->m_word.m_s32);
+			hashPSymPStnodPending.Insert(pStnodStmt->PSym(), pStnodStmt);
 		}
+	}
 
-		SetInitializer(pGlob, pConstGlob);
-		return;
+	// never referenced, no one can read the initial value
+	EWC::CHash<SSymbol *, CSTNode *>::CIterator iter(&hashPSymPStnodPending);
+	while (CSTNode ** ppStnod = iter.Next())
+	{
+		pBuild->m_hashPStnodDeadInit.FinsEnsureKeyAndValue(*ppStnod, true);
 	}
+}
 
-	SetInitializer(pGlob, pLvalInit);
+// Bounds check elimination: facts record index variables that are known to be within an array's bounds, either
+//  because a dominating statement in the same list already checked them or because a counted loop's predicate
+//  bounds them. Facts only track locals whose address is never taken so any write to them is visible in the AST.
+
+static bool FIsBoundsLocal(CBuilderBase * pBuild, SSymbol * pSym)
+{
+	if (!pSym)
+		return false;
+
+	SSymbol ** ppSymMac = pBuild->m_arypSymBoundsLocal.PMac();
+	for (SSymbol ** ppSym = pBuild->m_arypSymBoundsLocal.A(); ppSym != ppSymMac; ++ppSym)
+	{
+		if (*ppSym == pSym)
+			return true;
+	}
+	return false;
 }
 
-template <typename BUILD>
-typename BUILD::Value * PValGenerateDecl(
-	CWorkspace * pWork,
-	BUILD * pBuild,
-	CSTNode * pStnod,
-	CSTNode * pStnodInit,
-	VALGENK valgenk)
+static SSymbol * PSymBoundsTracked(CBuilderBase * pBuild, CSTNode * pStnod)
 {
-	auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
-	auto pSym = pStnod->PSym();
-	if (!pStdecl || !EWC_FVERIFY(pSym, "declaration without symbol"))
+	// identifiers resolved through 'using' refer to members, not the local itself
+	if (pStnod->m_park != PARK_Identifier || !pStnod->m_pSymbase || pStnod->m_pSymbase->m_symk != SYMK_Symbol)
 		return nullptr;
 
-	auto pLtype = pBuild->PLtypeFromPTin(pStnod->m_pTin);
-	if (!EWC_FVERIFY(pLtype, "couldn't find llvm type for declaration"))
-		return nullptr;
+	SSymbol * pSym = pStnod->PSym();
+	return (FIsBoundsLocal(pBuild, pSym)) ? pSym : nullptr;
+}
 
-	u64 cBitSize, cBitAlign;
-	CalculateSizeAndAlign(pBuild, pLtype, &cBitSize, &cBitAlign);
-	if (cBitSize == 0)
+static SSymbol * PSymRootOfLvalue(CSTNode * pStnod)
+{
+	// writes to a.count or a.b.c modify a
+	while (pStnod && pStnod->m_park == PARK_MemberLookup && pStnod->CStnodChild() > 0)
 	{
-		EmitError(pWork, &pStnod->m_lexloc, ERRID_ZeroSizeInstance,
-			"Could not instantiate %s, zero-sized instances are not allowed", pSym->m_strName.PCoz());
-		return nullptr;
+		pStnod = pStnod->PStnodChild(0);
 	}
 
-	s32 iLine, iCol;
-	auto pDif = PDifEmitLocation(pWork, pBuild, pStnod->m_lexloc, &iLine, &iCol);
-
-	auto pLvalScope = PLvalFromDIFile(pBuild, pDif);
+	if (pStnod && pStnod->m_park == PARK_Identifier)
+		return pStnod->PSym();
+	return nullptr;
+}
 
-	CreateDebugInfo(pWork, pBuild, pStnod, pStnod->m_pTin);
+static void RemoveBoundsLocal(CBuilderBase * pBuild, size_t ipSymMin, SSymbol * pSym)
+{
+	if (!pSym)
+		return;
 
-	bool fIsGlobal = pBuild->m_pProcCur == nullptr;
-	auto strName = pSym->m_strName;
-	auto strPunyName = StrPunyEncode(strName.PCoz());
-	if (fIsGlobal)
+	for (size_t ipSym = ipSymMin; ipSym < pBuild->m_arypSymBoundsLocal.C(); ++ipSym)
 	{
-		auto pGlob = pBuild->PGlobCreate(pLtype, strPunyName.PCoz());
-		pBuild->SetSymbolValue(pSym, pGlob);
-
-		DInfoCreateGlobalVariable(pBuild, pStnod->m_pTin, pLvalScope, pDif, strName.PCoz(), strPunyName.PCoz(), iLine, true, pGlob);
-
-		BUILD::LValue * pLvalInit = nullptr;
-		if (pStnodInit)
+		if (pBuild->m_arypSymBoundsLocal[ipSym] == pSym)
 		{
-			auto pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnodInit->m_pTin);
-			if (pTinlit && pStnodInit->m_park != PARK_Uninitializer)
-			{
-				pLvalInit = PLvalBuildConstantInitializer(pBuild, pStnod->m_pTin, pStnodInit);
-				auto pLvalCast = PLvalGenerateConstCast(pWork, pBuild, valgenk, pLvalInit, pStnodInit, pStnod->m_pTin);
-
-				pBuild->SetInitializer(pGlob, pLvalCast);
-				return pGlob;
-
-			}
-
-			EWC_ASSERT(false, "Not yet supporting globals that require some runtime init");
-			//return PValInitialize(pWork, pBuild, pStnod->m_pTin, pGlob, pStnodInit);
-
-			// Also - not handling globals that need to call an overloaded := operator
+			pBuild->m_arypSymBoundsLocal.RemoveFastByI(ipSym);
+			return;
 		}
+	}
+}
 
-		// yuck, we're doing this check for every global variable?!?
+static void GatherBoundsLocals(CBuilderBase * pBuild, size_t ipSymMin, CSTNode * pStnod, bool fRemoveAddressTaken)
+{
+	if (!pStnod || pStnod->m_park == PARK_StructDefinition)
+		return;
 
-		if (FAreCozEqual(strName.PCoz(),STypeInfo::s_pChzGlobalTinTable))
+	if (fRemoveAddressTaken)
+	{
+		if (pStnod->m_park == PARK_UnaryOp && pStnod->m_tok == TOK_Reference && pStnod->CStnodChild() > 0)
 		{
-			pLvalInit = PLvalGenerateReflectTypeTable(pWork, pBuild);
-			pBuild->SetInitializer(pGlob, pLvalInit);
-			return pGlob;
+			RemoveBoundsLocal(pBuild, ipSymMin, PSymRootOfLvalue(pStnod->PStnodChild(0)));
+		}
+		else if (FIsOverloadedOp(pStnod))
+		{
+			// overloads may take their operands by reference
+			for (int iStnodChild = 0; iStnodChild < pStnod->CStnodChild(); ++iStnodChild)
+			{
+				RemoveBoundsLocal(pBuild, ipSymMin, PSymRootOfLvalue(pStnod->PStnodChild(iStnodChild)));
+			}
 		}
-
-		pLvalInit = PLvalBuildConstantInitializer(pBuild, pStnod->m_pTin, pStnodInit);
-		pBuild->SetInitializer(pGlob, pLvalInit);
-
-		return pGlob;
 	}
-	else
+	else if (pStnod->m_park == PARK_Decl && pStnod->PSym())
 	{
-		// generate the local variable into the first basic block for procedure
+		pBuild->m_arypSymBoundsLocal.Append(pStnod->PSym());
+	}
 
-		auto pBlockCur = pBuild->m_pBlockCur;
-		pBuild->ActivateBlock(pBuild->m_pProcCur->m_pBlockLocals);
-		auto pValAlloca = pBuild->PValCreateAlloca(pLtype, strPunyName.PCoz());
-		pBuild->ActivateBlock(pBlockCur);
+	int cStnodChild = pStnod->CStnodChild();
+	for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
+	{
+		GatherBoundsLocals(pBuild, ipSymMin, pStnod->PStnodChild(iStnodChild), fRemoveAddressTaken);
+	}
+}
 
+void GatherBoundsLocals(CBuilderBase * pBuild, CSTNode ** apStnod, int cpStnod)
+{
+	size_t ipSymMin = pBuild->m_arypSymBoundsLocal.C();
+	for (int ipStnod = 0; ipStnod < cpStnod; ++ipStnod)
+	{
+		GatherBoundsLocals(pBuild, ipSymMin, apStnod[ipStnod], false);
+	}
 
-		pBuild->SetSymbolValue(pSym, pValAlloca);
-	
-		auto pLvalDIVariable = PLvallDInfoCreateAutoVariable(pBuild, pStnod->m_pTin, pLvalScope, pDif, strPunyName.PCoz(), iLine, false, 0);
+	for (int ipStnod = 0; ipStnod < cpStnod; ++ipStnod)
+	{
+		GatherBoundsLocals(pBuild, ipSymMin, apStnod[ipStnod], true);
+	}
+}
 
-		DInfoInsertDeclare(pBuild, pValAlloca, pLvalDIVariable, pLvalScope, iLine, iCol, pBuild->m_pBlockCur);
+static bool FMightModifySymbol(CSTNode * pStnod, SSymbol * pSym)
+{
+	if (!pStnod)
+		return false;
 
-		if (FIsOverloadedOp(pStnod))
+	switch (pStnod->m_park)
+	{
+	case PARK_AssignmentOp:
 		{
-			auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
-			if (EWC_FVERIFY(pStdecl && pStdecl->m_iStnodIdentifier >= 0 && pStdecl->m_iStnodInit >= 0,
-					"bad declaration"))
-			{
-				CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
+			if (PSymRootOfLvalue(pStnod->PStnodChildSafe(0)) == pSym)
+				return true;
+		} break;
+	case PARK_UnaryOp:
+	case PARK_PostfixUnaryOp:
+		{
+			TOK tok = pStnod->m_tok;
+			if (((tok == TOK_PlusPlus) | (tok == TOK_MinusMinus) | (tok == TOK_Reference)) && 
+				PSymRootOfLvalue(pStnod->PStnodChildSafe(0)) == pSym)
+				return true;
+		} break;
+	default:
+		break;
+	}
 
-				auto pTinproc = pStnod->m_pOptype->m_pTinprocOverload;
+	int cStnodChild = pStnod->CStnodChild();
+	for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
+	{
+		if (FMightModifySymbol(pStnod->PStnodChild(iStnodChild), pSym))
+			return true;
+	}
+	return false;
+}
 
-				//BB - This won't work with generic procedure overloads
+static bool FContainsEarlyExit(CSTNode * pStnod)
+{
+	if (!pStnod)
+		return false;
 
-				auto pTinptr = PTinRtiCast<STypeInfoPointer*>(pTinproc->m_arypTinParams[0]);
-				EWC_ASSERT(pTinptr, "exected pointer type for implicit reference");
+	if (FIsReservedWord(pStnod, RWORD_Break) || FIsReservedWord(pStnod, RWORD_Continue) || FIsReservedWord(pStnod, RWORD_Return))
+		return true;
 
-				auto pValArg = PValGenerate(pWork, pBuild, pStnod->m_arypStnodChild[pStdecl->m_iStnodIdentifier], VALGENK_Reference);
-				arypLvalArgs.Append(PLvalFromPVal(pValArg));
+	int cStnodChild = pStnod->CStnodChild();
+	for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
+	{
+		if (FContainsEarlyExit(pStnod->PStnodChild(iStnodChild)))
+			return true;
+	}
+	return false;
+}
 
-				auto pTinRhs = pTinproc->m_arypTinParams[1];
-				pValArg = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnod->m_arypStnodChild[pStdecl->m_iStnodInit], pTinRhs);
-				arypLvalArgs.Append(PLvalFromPVal(pValArg));
+static bool FTryComputeConstantIndex(CSTNode * pStnod, s64 * pNIndex)
+{
+	if (pStnod->m_park != PARK_Literal || !pStnod->m_pStval)
+		return false;
 
-				auto pSymProc = pTinproc->m_pStnodDefinition->PSym();
-				return pBuild->PValGenerateCall(pWork, pStnod, pSymProc, &arypLvalArgs, true, pTinproc, valgenk);
-			}
+	CSTValue * pStval = pStnod->m_pStval;
+	switch (pStval->m_stvalk)
+	{
+	case STVALK_SignedInt:		*pNIndex = pStval->m_nSigned;	return true;
+	case STVALK_UnsignedInt:	
+		{
+			if (pStval->m_nUnsigned > LLONG_MAX)
+				return false;
+			*pNIndex = (s64)pStval->m_nUnsigned;
+			return true;
 		}
-
-		return PValInitialize(pWork, pBuild, pStnod->m_pTin, pValAlloca, pStnodInit);
+	default:
+		return false;
 	}
 }
 
-template <typename BUILD>
-typename BUILD::Value * PValGenerateArrayLiteralReference(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnod)
+static bool FIsIndexProvenInBounds(CBuilderBase * pBuild, CSTNode * pStnodAry, STypeInfoArray * pTinary, CSTNode * pStnodIndex)
 {
-	// constant decl's don't actually generate anything until referenced.
-	if (pStnod->m_park == PARK_ConstantDecl)
-		return nullptr;
-
-	STypeInfoLiteral * pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnod->m_pTin);
-	if (!pTinlit)
-		return nullptr;
-
-	if (!EWC_FVERIFY(pTinlit->m_litty.m_litk == LITK_Compound, "expected array literal"))
-		return nullptr;
-
-	BUILD::Global * pGlob = nullptr;
-	BUILD::Global ** ppGlob = pBuild->m_hashPTinlitPGlob.Lookup(pTinlit);
-	if (ppGlob)
+	s64 nIndex;
+	if (FTryComputeConstantIndex(pStnodIndex, &nIndex))
 	{
-		pGlob = *ppGlob;
+		return pTinary->m_aryk == ARYK_Fixed && nIndex >= 0 && nIndex < pTinary->m_c;
 	}
-	else
-	{
-		auto pLvalConstInit = PLvalFromLiteral(pBuild, pTinlit, pStnod);
-		if (!pLvalConstInit)
-			return nullptr;
 
-		auto pLtypeArray = pBuild->PLtypeFromPTin(pTinlit);
+	SSymbol * pSymIndex = PSymBoundsTracked(pBuild, pStnodIndex);
+	SSymbol * pSymArray = PSymBoundsTracked(pBuild, pStnodAry);
+	if (!pSymIndex)
+		return false;
 
-		pGlob = pBuild->PGlobCreate(pLtypeArray, "aryLitRef");
+	SBoundsFact * pBfactMac = pBuild->m_aryBfact.PMac();
+	for (SBoundsFact * pBfact = pBuild->m_aryBfact.A(); pBfact != pBfactMac; ++pBfact)
+	{
+		if (pBfact->m_pSymIndex != pSymIndex)
+			continue;
 
-		pBuild->SetGlobalIsConstant(pGlob, true);
-		pBuild->SetInitializer(pGlob, pLvalConstInit);
-		(void) pBuild->m_hashPTinlitPGlob.FinsEnsureKeyAndValue(pTinlit, pGlob);
+		if (pSymArray && pBfact->m_pSymArray == pSymArray)
+			return true;
+
+		if (pTinary->m_aryk == ARYK_Fixed && pBfact->m_cMax >= 0 && pBfact->m_cMax <= pTinary->m_c)
+			return true;
 	}
-	return pGlob;
+	return false;
 }
 
-
-void CBuilderIR::SetGlobalIsConstant(CIRGlobal * pGlob, bool fIsConstant)
+static void AddBoundsFact(CBuilderBase * pBuild, SSymbol * pSymIndex, SSymbol * pSymArray, s64 cMax)
 {
-	LLVMSetGlobalConstant(pGlob->m_pLval, fIsConstant);
+	auto pBfact = pBuild->m_aryBfact.AppendNew();
+	pBfact->m_pSymIndex = pSymIndex;
+	pBfact->m_pSymArray = pSymArray;
+	pBfact->m_cMax = cMax;
 }
 
-CIRValue * PValGenerateLiteral(CWorkspace * pWork, CBuilderIR * pBuildIr, CSTNode * pStnod)
+// Add facts for array elements that are always evaluated when pStnod is, skipping anything conditional. 
+static void AddBoundsFactsFromStatement(CBuilderBase * pBuild, CSTNode * pStnod, CDynAry<CSTNode *> * parypStnodAry = nullptr)
 {
-	// constant decl's don't actually generate anything until referenced.
-	if (pStnod->m_park == PARK_ConstantDecl)
-		return nullptr;
-
-	STypeInfoLiteral * pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnod->m_pTin);
-	if (!pTinlit)
-		return nullptr;
+	switch (pStnod->m_park)
+	{
+	case PARK_ArrayElement:
+		{
+			if (pStnod->CStnodChild() != 2)
+				return;
 
-	auto pLval = PLvalFromLiteral(pBuildIr, pTinlit, pStnod);
-	if (!pLval)
-		return nullptr;
+			CSTNode * pStnodAry = pStnod->PStnodChild(0);
+			CSTNode * pStnodIndex = pStnod->PStnodChild(1);
+			AddBoundsFactsFromStatement(pBuild, pStnodAry, parypStnodAry);
+			AddBoundsFactsFromStatement(pBuild, pStnodIndex, parypStnodAry);
 
-	CIRConstant * pConst = EWC_NEW(pBuildIr->m_pAlloc, CIRConstant) CIRConstant();
-	pBuildIr->AddManagedVal(pConst);
-	pConst->m_pLval = pLval;
-	return pConst;
-}
+			auto pTinary = PTinRtiCast<STypeInfoArray *>(PTinStripQualifiers(pStnodAry->m_pTin));
+			SSymbol * pSymIndex = PSymBoundsTracked(pBuild, pStnodIndex);
+			if (!pTinary || !pSymIndex)
+				return;
 
-BCode::SValue * PValGenerateLiteral(CWorkspace * pWork, BCode::CBuilder * pBuildBc, CSTNode * pStnod)
-{
-	// constant decl's don't actually generate anything until referenced.
-	if (pStnod->m_park == PARK_ConstantDecl)
-		return nullptr;
-
-	STypeInfoLiteral * pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnod->m_pTin);
-	if (!pTinlit)
-		return nullptr;
-
-	auto pLval = PLvalFromLiteral(pBuildBc, pTinlit, pStnod);
-	return pLval;
+			SSymbol * pSymArray = PSymBoundsTracked(pBuild, pStnodAry);
+			s64 cMax = (pTinary->m_aryk == ARYK_Fixed) ? pTinary->m_c : -1;
+			if (pSymArray || cMax >= 0)
+			{
+				AddBoundsFact(pBuild, pSymIndex, pSymArray, cMax);
+				if (parypStnodAry)
+				{
+					parypStnodAry->Append(pStnodAry);
+				}
+			}
+		} break;
+	case PARK_AdditiveOp:
+	case PARK_MultiplicativeOp:
+	case PARK_ShiftOp:
+	case PARK_RelationalOp:
+	case PARK_AssignmentOp:
+	case PARK_UnaryOp:
+	case PARK_PostfixUnaryOp:
+	case PARK_Cast:
+	case PARK_MemberLookup:
+	case PARK_ProcedureCall:
+	case PARK_ArgumentLabel:
+	case PARK_ExpressionList:
+	case PARK_Decl:
+		{
+			int cStnodChild = pStnod->CStnodChild();
+			for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
+			{
+				AddBoundsFactsFromStatement(pBuild, pStnod->PStnodChild(iStnodChild), parypStnodAry);
+			}
+		} break;
+	default:
+		break;
+	}
 }
 
-template <typename BUILD>
-void GenerateArguments(
-	CWorkspace * pWork,
-	BUILD * pBuild,
-	GRFSTNOD grfstnod,
-	STypeInfoProcedure * pTinproc, 
-	size_t cpStnodArg,
-	CSTNode ** ppStnodArg,
-	CDynAry<typename BUILD::LValue *> * parypLvalArgs,
-	CDynAry<typename BUILD::Value *> * parypValArgs = nullptr)
+static void InvalidateBoundsFacts(CBuilderBase * pBuild, CSTNode * pStnod)
 {
-	// what's with passing both a val array and a LVal array arguments? we need the LVal array for llvm, the val for postInc op overload
-
-	for (size_t ipStnodChild = 0; ipStnodChild < cpStnodArg; ++ipStnodChild)
+	SBoundsFact * pBfactMac = pBuild->m_aryBfact.PMac();
+	for (SBoundsFact * pBfact = pBuild->m_aryBfact.A(); pBfact != pBfactMac; ++pBfact)
 	{
-		CSTNode * pStnodArg = ppStnodArg[ipStnodChild];
-
-		STypeInfo * pTinParam = pStnodArg->m_pTin;
+		if (!pBfact->m_pSymIndex)
+			continue;
 
-		size_t cpTinParam = pTinproc->m_arypTinParams.C();
-		if (ipStnodChild < cpTinParam)
+		if (FMightModifySymbol(pStnod, pBfact->m_pSymIndex) || 
+			(pBfact->m_pSymArray && FMightModifySymbol(pStnod, pBfact->m_pSymArray)))
 		{
-			size_t ipStnodChildAdj = (grfstnod.FIsSet(FSTNOD_CommutativeCall)) ? (cpTinParam - 1 - ipStnodChild) : ipStnodChild;
-			pTinParam = pTinproc->m_arypTinParams[ipStnodChildAdj];
+			// leave a tombstone so enclosing lists can still pop back to their starting count
+			pBfact->m_pSymIndex = nullptr;
 		}
+	}
+}
 
-		BUILD::Value * pValRhsCast = nullptr;
-		if (ipStnodChild < pTinproc->m_mpIptinGrfparmq.C() && 
-			pTinproc->m_mpIptinGrfparmq[ipStnodChild].FIsSet(FPARMQ_ImplicitRef))
-		{
-			auto pTinptr = PTinRtiCast<STypeInfoPointer*>(pTinproc->m_arypTinParams[ipStnodChild]);
-			EWC_ASSERT(pTinptr, "exected pointer type for implicit reference");
+static bool FIsLoopStatement(CSTNode * pStnod)
+{
+	return FIsReservedWord(pStnod, RWORD_For) || FIsReservedWord(pStnod, RWORD_ForEach) || FIsReservedWord(pStnod, RWORD_While);
+}
 
-			pValRhsCast = PValGenerate(pWork, pBuild, pStnodArg, VALGENK_Reference);
-		}
-		else
-		{
-			pValRhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodArg, pTinParam);
-		}
+static bool FIsUnitIncrement(CSTNode * pStnod, SSymbol * pSym)
+{
+	if (!pStnod || FIsOverloadedOp(pStnod) || pStnod->CStnodChild() < 1)
+		return false;
 
-		parypLvalArgs->Append(pBuild->PProcArg(pValRhsCast));
-		if (parypValArgs)
-		{
-			parypValArgs->Append(pValRhsCast);
-		}
+	if (PSymRootOfLvalue(pStnod->PStnodChild(0)) != pSym || pStnod->PStnodChild(0)->m_park != PARK_Identifier)
+		return false;
 
-		EWC_ASSERT(*parypLvalArgs->PLast(), "missing argument value");
-	}
+	if ((pStnod->m_park == PARK_UnaryOp) | (pStnod->m_park == PARK_PostfixUnaryOp))
+		return pStnod->m_tok == TOK_PlusPlus;
 
-	if (grfstnod.FIsSet(FSTNOD_CommutativeCall))
-	{
-		ReverseArray(parypLvalArgs->A(), parypLvalArgs->C());
-		if (parypValArgs)
-		{
-			ReverseArray(parypValArgs->A(), parypValArgs->C());
-		}
-	}
+	s64 nStep;
+	return pStnod->m_park == PARK_AssignmentOp && 
+		pStnod->m_tok == TOK_PlusEqual && 
+		pStnod->CStnodChild() == 2 &&
+		FTryComputeConstantIndex(pStnod->PStnodChild(1), &nStep) && 
+		nStep == 1;
 }
 
-CBuilderIR::ProcArg * CBuilderIR::PProcArg(CIRValue * pVal)
+static bool FTryExtractIntegerInfo(STypeInfo * pTin, u32 * pCBit, bool * pFIsSigned)
 {
-	return pVal->m_pLval;
+	pTin = PTinStripQualifiers(pTin);
+	return pTin && pTin->m_tink == TINK_Integer && FExtractNumericInfo(pTin, pCBit, pFIsSigned);
 }
 
-CIRValue * CBuilderIR::PValGenerateCall(
-	CWorkspace * pWork,
-	CSTNode * pStnod,
-	SSymbol * pSym,
-	EWC::CDynAry<LLVMValueRef> * parypLvalArgs,
-	bool fIsDirectCall,
-	STypeInfoProcedure * pTinproc, 
-	VALGENK valgenk)
+struct SBoundsLoop // tag = bloop
 {
-	if (!EWC_FVERIFY(pTinproc->m_pStnodDefinition, "procedure missing definition"))
-		return nullptr;
-
-	CIRValue * pValSym = nullptr;
-	if (fIsDirectCall)
-	{
-		if (!EWC_FVERIFY(pSym, "calling function without generated code"))
-			return nullptr;
-
-		EWC_ASSERT(pSym->m_symdep == SYMDEP_Used, "Calling function thought to be unused '%s'", pTinproc->m_strName.PCoz());
+	SSymbol *	m_pSymIndex;
+	s64			m_nInit;
+	CSTNode *	m_pStnodBound;	// local the index is compared against ('i < n'), null if the bound was constant or .count
+};
 
-		(void)PValTryEnsureProc(pWork, this, pSym);
+// Match 'for i := k; i < bound; ++i' where k >= 0, the loop only changes i in its increment and can't overflow i
+//  before reaching the bound. Facts for constant and array.count bounds are added here, 'i < n' bounds are 
+//  returned so the caller can hoist checks into the preheader.
 
-		pValSym = PValFromSymbol(pSym);
-		if (!pValSym)
-			return nullptr;
-	}
+static bool FTryAddLoopBoundsFacts(CBuilderBase * pBuild, CSTNode * pStnodFor, CSTFor * pStfor, SBoundsLoop * pBloop)
+{
+	CSTNode * pStnodDecl = pStnodFor->PStnodChildSafe(pStfor->m_iStnodDecl);
+	CSTNode * pStnodPred = pStnodFor->PStnodChildSafe(pStfor->m_iStnodPredicate);
+	CSTNode * pStnodIncrement = pStnodFor->PStnodChildSafe(pStfor->m_iStnodIncrement);
+	CSTNode * pStnodBody = pStnodFor->PStnodChildSafe(pStfor->m_iStnodBody);
+	if (!pStnodDecl || !pStnodPred || !pStnodIncrement || !pStnodBody || pStnodDecl->m_park != PARK_Decl)
+		return false;
 
-	EmitLocation(pWork, this, pStnod->m_lexloc);
-	EWC_ASSERT(valgenk != VALGENK_Reference, "cannot return reference value for procedure call");
+	auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnodDecl->m_pStmap);
+	if (!pStdecl || pStdecl->m_iStnodChildMin != -1)
+		return false;
 
-	CIRInstruction * pInst = PInstCreateRaw(IROP_Call, nullptr, nullptr, "RetTmp");
-	if (FIsError(pInst))
-		return pInst;
+	SSymbol * pSymIndex = (pStnodDecl->PSym() && FIsBoundsLocal(pBuild, pStnodDecl->PSym())) ? pStnodDecl->PSym() : nullptr;
+	CSTNode * pStnodInit = pStnodDecl->PStnodChildSafe(pStdecl->m_iStnodInit);
+	s64 nInit;
+	u32 cBitIndex;
+	bool fIsSignedIndex;
+	if (!pSymIndex || 
+		!pStnodInit || !FTryComputeConstantIndex(pStnodInit, &nInit) || nInit < 0 ||
+		!FTryExtractIntegerInfo(pStnodDecl->m_pTin, &cBitIndex, &fIsSignedIndex))
+		return false;
 
-	if (fIsDirectCall)
-	{
-		CIRProcedure * pProc = (CIRProcedure *)pValSym;
-		auto pLvalFunction = pProc->m_pLval;
-		if (LLVMCountParams(pLvalFunction) != parypLvalArgs->C())
-		{
-			if (!EWC_FVERIFY(pTinproc->FHasVarArgs(), "unexpected number of arguments"))
-				return nullptr;
-		}
+	if (pStnodPred->m_park != PARK_RelationalOp || pStnodPred->m_tok != TOK('<') || FIsOverloadedOp(pStnodPred) ||
+		pStnodPred->CStnodChild() != 2)
+		return false;
 
-		s32 iLine;
-		s32 iCol;
-		CalculateLinePosition(pWork, &pStnod->m_lexloc, &iLine, &iCol);
+	CSTNode * pStnodPredLhs = pStnodPred->PStnodChild(0);
+	CSTNode * pStnodBound = pStnodPred->PStnodChild(1);
+	if (PSymBoundsTracked(pBuild, pStnodPredLhs) != pSymIndex)
+		return false;
 
-		pInst->m_pLval = LLVMBuildCall(
-							m_pLbuild,
-							pProc->m_pLval,
-							parypLvalArgs->A(),
-							(u32)parypLvalArgs->C(),
-							"");
+	if (!FIsUnitIncrement(pStnodIncrement, pSymIndex) || FMightModifySymbol(pStnodBody, pSymIndex))
+		return false;
 
+	u64 nIndexMax = (fIsSignedIndex) ? (u64(1) << (cBitIndex - 1)) - 1 : (cBitIndex == 64) ? ULLONG_MAX : (u64(1) << cBitIndex) - 1;
 
-		if (pTinproc->m_callconv != CALLCONV_Nil)
-		{
-			LLVMSetInstructionCallConv(pInst->m_pLval, CallingconvFromCallconv(pTinproc->m_callconv));
-		}
-		return pInst;
+	SSymbol * pSymArray = nullptr;
+	s64 cMax = -1;
+	s64 nBound;
+	if (FTryComputeConstantIndex(pStnodBound, &nBound))
+	{
+		cMax = nBound;
 	}
-	else
+	else if (pStnodBound->m_park == PARK_MemberLookup && pStnodBound->CStnodChild() == 2)
 	{
-		CSTNode * pStnodProcref = pStnod->PStnodChildSafe(0);
-		if (!EWC_FVERIFY(pStnodProcref, "expected procedure reference"))
-			return nullptr;
-
-		auto pValProcref = PValGenerate(pWork, this, pStnodProcref, VALGENK_Instance);
+		CSTNode * pStnodAry = pStnodBound->PStnodChild(0);
+		auto pTinary = PTinRtiCast<STypeInfoArray *>(PTinStripQualifiers(pStnodAry->m_pTin));
+		if (!pTinary || pStnodAry->m_park != PARK_Identifier || 
+			ArymembLookup(StrFromIdentifier(pStnodBound->PStnodChild(1)).PCoz()) != ARYMEMB_Count)
+			return false;
 
-		pInst->m_pLval = LLVMBuildCall(
-							m_pLbuild,
-							pValProcref->m_pLval,
-							parypLvalArgs->A(),
-							(u32)parypLvalArgs->C(),
-							"");
-		if (pTinproc->m_callconv != CALLCONV_Nil)
+		if (pTinary->m_aryk == ARYK_Fixed)
 		{
-			LLVMSetInstructionCallConv(pInst->m_pLval, CallingconvFromCallconv(pTinproc->m_callconv));
+			cMax = pTinary->m_c;
+		}
+		else
+		{
+			// the count is only known at runtime, a narrower index could wrap before reaching it
+			pSymArray = PSymBoundsTracked(pBuild, pStnodAry);
+			if (cBitIndex != 64 || !pSymArray || 
+				FMightModifySymbol(pStnodBody, pSymArray) || FMightModifySymbol(pStnodIncrement, pSymArray))
+				return false;
 		}
-		return pInst;
 	}
-}
-
-BCode::SValue * BCode::CBuilder::PValGenerateCall(
-	CWorkspace * pWork,
-	CSTNode * pStnod,
-	SSymbol * pSym,
-	EWC::CDynAry<ProcArg *> * parypValArgs,
-	bool fIsDirectCall,
-	STypeInfoProcedure * pTinproc,
-	VALGENK valgenk)
-{
-	SValue * pValProc;
-	if (fIsDirectCall)
+	else if (pStnodBound->m_park == PARK_Identifier)
 	{
-		if (!EWC_FVERIFY(pSym, "calling function without generated code"))
-			return nullptr;
-
-		EWC_ASSERT(pSym->m_symdep == SYMDEP_Used, "Calling function thought to be unused %p %s", pSym, pSym->m_strName.PCoz());
+		SSymbol * pSymBound = PSymBoundsTracked(pBuild, pStnodBound);
+		u32 cBitBound;
+		bool fIsSignedBound;
+		if (!pSymBound || 
+			!FTryExtractIntegerInfo(pSymBound->m_pTin, &cBitBound, &fIsSignedBound) ||
+			!fIsSignedIndex || !fIsSignedBound || cBitBound > cBitIndex ||
+			FMightModifySymbol(pStnodBody, pSymBound) || FMightModifySymbol(pStnodIncrement, pSymBound))
+			return false;
 
-		pValProc = PValTryEnsureProc(pWork, this, pSym);
+		pBloop->m_pSymIndex = pSymIndex;
+		pBloop->m_nInit = nInit;
+		pBloop->m_pStnodBound = pStnodBound;
+		return true;
 	}
 	else
 	{
-		CSTNode * pStnodProcref = pStnod->PStnodChildSafe(0);
-		if (!EWC_FVERIFY(pStnodProcref, "expected procedure reference"))
-			return nullptr;
-
-		pValProc = PValGenerate(pWork, this, pStnodProcref, VALGENK_Instance);
+		return false;
 	}
 
-	auto pInst = PInstCreateCall(pValProc, pTinproc, parypValArgs->A(), (int)parypValArgs->C());
-	if (FIsError(pInst))
-		return pInst;
+	if (cMax >= 0 && u64(cMax) > nIndexMax)
+		return false;
 
-	if (pTinproc->m_callconv != CALLCONV_Nil)
-	{
-		//LLVMSetInstructionCallConv(pInst->m_pLval, CallingconvFromCallconv(pTinproc->m_callconv));
-	}
-	return pInst;
+	AddBoundsFact(pBuild, pSymIndex, pSymArray, cMax);
+	return false;
 }
 
-CIRValue * PValGenerateTypeInfo(CBuilderIR * pBuild, CSTNode * pStnod, CSTNode * pStnodChild)
+template <typename BUILD>
+static void GenerateBoundsCheck(
+	CWorkspace * pWork,
+	BUILD * pBuild,
+	typename BUILD::Value * pValAryRef,
+	STypeInfoArray * pTinary,
+	typename BUILD::Value * pValIndex,
+	CSTNode * pStnodIndex)
 {
-	CIRGlobal * pGlob = EWC_NEW(pBuild->m_pAlloc, CIRGlobal) CIRGlobal();
-	pBuild->AddManagedVal(pGlob);
+	auto pTinS64 = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strS64);
 
-	auto pLtypePTin = pBuild->PLtypeFromPTin(pStnod->m_pTin);
+	s64 nIndex;
+	BUILD::Value * pValIndexCheck;
+	if (FTryComputeConstantIndex(pStnodIndex, &nIndex))
+	{
+		pValIndexCheck = pBuild->PConstInt(nIndex, 64, true);
+	}
+	else
+	{
+		pValIndexCheck = PValCreateCast(pWork, pBuild, pValIndex, pStnodIndex->m_pTin, pTinS64);
+	}
 
-	pGlob->m_pLval = LLVMConstPointerCast((LLVMValueRef)pStnodChild->m_pTin->m_pCgvalReflectGlobal, pLtypePTin);
-	return pGlob;
-}
+	if (!EWC_FVERIFY(pValIndexCheck, "unable to cast array index for bounds check"))
+		return;
 
-BCode::SValue * PValGenerateTypeInfo(BCode::CBuilder * pBuild, CSTNode * pStnod, CSTNode * pStnodChild)
-{
-	EWC_ASSERT(false, "bytecode TBD");
-	return nullptr;
+	auto pValCount = PValFromArrayMember(pWork, pBuild, pValAryRef, pTinary, ARYMEMB_Count, VALGENK_Instance);
+	pBuild->CreateBoundsCheck(pValIndexCheck, pValCount);
 }
 
+// For 'for i := k; i < n; ++i' loops without early exits, every iteration evaluates the unconditional a[i] 
+//  accesses in the body, so checking a[n-1] once before the loop covers them all.
+
 template <typename BUILD>
-void GenerateSwitch(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnod, typename BUILD::Value * pValExp)
+static void HoistLoopBoundsChecks(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnodBody, SBoundsLoop * pBloop)
 {
-	BUILD::Proc * pProc = pBuild->m_pProcCur;
-	auto pBlockPost = pBuild->PBlockCreate(pProc, "PostSw");
-	auto pBlockDefault = pBlockPost;
-
-	auto pJumpt = pBuild->m_aryJumptStack.AppendNew();
-	pJumpt->m_pBlockBreak = pBlockPost;
-	pJumpt->m_pBlockContinue = nullptr;
+	if (FContainsEarlyExit(pStnodBody))
+		return;
 
-	if (pStnod->m_pStident)
+	CDynAry<CSTNode *> arypStnodAry(pBuild->m_pAlloc, BK_CodeGen);
+	size_t iBfactMin = pBuild->m_aryBfact.C();
+	int cStnodStmt = (pStnodBody->m_park == PARK_List) ? pStnodBody->CStnodChild() : 1;
+	for (int iStnodStmt = 0; iStnodStmt < cStnodStmt; ++iStnodStmt)
 	{
-		pJumpt->m_strLabel = pStnod->m_pStident->m_str;
+		CSTNode * pStnodStmt = (pStnodBody->m_park == PARK_List) ? pStnodBody->PStnodChild(iStnodStmt) : pStnodBody;
+		AddBoundsFactsFromStatement(pBuild, pStnodStmt, &arypStnodAry);
 	}
+	EWC_ASSERT(arypStnodAry.C() == pBuild->m_aryBfact.C() - iBfactMin, "expected one array node per fact");
 
-	CDynAry<BUILD::Value *> arypVal(pBuild->m_pAlloc, BK_CodeGen, pStnod->CStnodChild()-1);
-	CDynAry<BUILD::Block *> arypBlock(pBuild->m_pAlloc, BK_CodeGen, pStnod->CStnodChild()-1);
-
-	u32 cStnodCase = 0;
-	for (int iStnodChild = 1; iStnodChild < pStnod->CStnodChild(); ++iStnodChild)
+	// keep facts indexed by the loop variable on arrays the loop doesn't modify, each needs one hoisted check
+	size_t iBfactMax = iBfactMin;
+	for (size_t iBfact = iBfactMin; iBfact < pBuild->m_aryBfact.C(); ++iBfact)
 	{
-		auto pStnodCase = pStnod->PStnodChild(iStnodChild);
-		if (!EWC_FVERIFY(pStnod->m_park == PARK_ReservedWord && pStnod->m_pStval, "bad case statement"))
+		SBoundsFact bfact = pBuild->m_aryBfact[iBfact];
+		if (bfact.m_pSymIndex != pBloop->m_pSymIndex || !bfact.m_pSymArray || FMightModifySymbol(pStnodBody, bfact.m_pSymArray))
 			continue;
 
-		switch(pStnodCase->m_pStval->m_rword)
+		bool fIsDuplicate = false;
+		for (size_t iBfactPrev = iBfactMin; iBfactPrev < iBfactMax; ++iBfactPrev)
 		{
-			case RWORD_Case:
-			{
-				auto pStnodCase = pStnod->PStnodChild(iStnodChild);
+			fIsDuplicate |= pBuild->m_aryBfact[iBfactPrev].m_pSymArray == bfact.m_pSymArray;
+		}
 
-				int cStnodLit = pStnodCase->CStnodChild()-1; // The last child is the case body (not a literal)
-				cStnodCase += cStnodLit;
+		if (!fIsDuplicate)
+		{
+			bfact.m_cMax = -1;
+			arypStnodAry[iBfactMax - iBfactMin] = arypStnodAry[iBfact - iBfactMin];
+			pBuild->m_aryBfact[iBfactMax++] = bfact;
+		}
+	}
+	pBuild->m_aryBfact.PopToSize(iBfactMax);
 
-			} break;
-			case RWORD_Else:	
-				pBlockDefault = pBuild->PBlockCreate(pProc, "Default");
-				break;
-			default:
-				EWC_ASSERT(false, "Unexpected reserved word in switch");
-				break;
-		}
-	}
+	if (iBfactMax == iBfactMin)
+		return;
 
-	auto pInstSw = pBuild->PInstCreateSwitch(pValExp, pBlockDefault, cStnodCase);
+	auto pTinS64 = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strS64);
+	auto pValBound = PValGenerate(pWork, pBuild, pBloop->m_pStnodBound, VALGENK_Instance);
+	pValBound = PValCreateCast(pWork, pBuild, pValBound, pBloop->m_pStnodBound->m_pTin, pTinS64);
+	if (!EWC_FVERIFY(pValBound, "bad loop bound"))
+		return;
 
-	bool fPrevCaseFallsThrough = false;
-	for (int iStnodChild = 1; iStnodChild < pStnod->CStnodChild(); ++iStnodChild)
+	BUILD::Proc * pProc = pBuild->m_pProcCur;
+	BUILD::Block * pBlockHoist = pBuild->PBlockCreate(pProc, "bchkHoist");
+	BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "bchkHoistPost");
+
+	auto pValRuns = pBuild->PInstCreateNCmp(NPRED_SGT, pValBound, pBuild->PConstInt(pBloop->m_nInit, 64, true), "bchkRuns");
+	(void) pBuild->PInstCreateCondBranch(pValRuns, pBlockHoist, pBlockPost);
+
+	pBuild->ActivateBlock(pBlockHoist);
+	auto pValLast = pBuild->PInstCreate(IROP_NSub, pValBound, pBuild->PConstInt(1, 64, true), "bchkLast");
+
+	for (size_t iBfact = iBfactMin; iBfact < iBfactMax; ++iBfact)
 	{
-		auto pStnodCase = pStnod->PStnodChild(iStnodChild);
-		if (!EWC_FVERIFY(pStnod->m_park == PARK_ReservedWord && pStnod->m_pStval, "bad case statement"))
+		CSTNode * pStnodAry = arypStnodAry[iBfact - iBfactMin];
+		auto pTinary = (STypeInfoArray *)PTinStripQualifiers(pStnodAry->m_pTin);
+		auto pValAryRef = PValGenerate(pWork, pBuild, pStnodAry, VALGENK_Reference);
+		if (!EWC_FVERIFY(pValAryRef, "missing value for hoisted bounds check"))
 			continue;
 
-		RWORD rword = pStnodCase->m_pStval->m_rword;
+		pBuild->CreateBoundsCheck(pValLast, PValFromArrayMember(pWork, pBuild, pValAryRef, pTinary, ARYMEMB_Count, VALGENK_Instance));
+	}
 
-		BUILD::Block * pBlockBody = nullptr;
-		CSTNode * pStnodBody = nullptr;
-		switch (rword)
-		{
-			case RWORD_Case:
-			{
-				if (!EWC_FVERIFY(pStnodCase->CStnodChild() >= 2, "expected case (literal, (opt literals...), body)"))
-					break;	
+	pBuild->CreateBranch(pBlockPost);
+	pBuild->ActivateBlock(pBlockPost);
+}
 
-				auto pBlockCase = pBuild->PBlockCreate(pProc, "Case");
-				int cStnodLit = pStnodCase->CStnodChild()-1; // The last child is the case body (not a literal)
-				for (int iStnodLit = 0; iStnodLit < cStnodLit; ++iStnodLit)
-				{
-					auto pValLit = PValGenerate(pWork, pBuild, pStnodCase->PStnodChild(iStnodLit), VALGENK_Instance);
-					arypBlock.Append(pBlockCase);
-					arypVal.Append(pValLit);
-				}
+void CBuilderIR::SetGlobalInitializer(CWorkspace * pWork, CIRGlobal * pGlob, STypeInfo * pTinGlob, STypeInfoLiteral * pTinlit, CSTNode * pStnodLiteral)
+{
+	LLVMOpaqueValue * pLvalInit;
+	auto pTinaryGlob = PTinRtiCast<STypeInfoArray *>(pTinGlob);
+	if (pTinaryGlob && pTinaryGlob->m_aryk == ARYK_Reference)
+	{
+		auto pLtypeElement = PLtypeFromPTin(pTinlit->m_pTinSource);
 
-				pBlockBody = pBlockCase;
-				pStnodBody = pStnodCase->PStnodChild(cStnodLit);
-			} break;
-			case RWORD_Else:
-			{
-				if (!EWC_FVERIFY(pStnodCase->CStnodChild() == 1, "expected default case to have one child (body)"))
-					break;
+		auto apLvalElem = (LLVMOpaqueValue **)m_pAlloc->EWC_ALLOC_TYPE_ARRAY(LLVMOpaqueValue *, (size_t)pTinlit->m_c);
 
-				pBlockBody = pBlockDefault;
-				pStnodBody = pStnodCase->PStnodChild(0);
-			} break;
-			default:
-				EWC_ASSERT(false, "unexpected reserved word during case statement code gen (%s)", PCozFromRword(rword));
-		}
-		
-		if (fPrevCaseFallsThrough)
+		CSTNode * pStnodList = nullptr;
+		CSTDecl * pStdecl = PStmapRtiCast<CSTDecl *>(pStnodLiteral->m_pStmap);
+		if (EWC_FVERIFY(pStdecl && pStdecl->m_iStnodInit >= 0, "array literal with no values"))
 		{
-			pBuild->CreateBranch(pBlockBody);	
+			pStnodList = pStnodLiteral->PStnodChild(pStdecl->m_iStnodInit);
 		}
-		fPrevCaseFallsThrough = pStnodCase->m_grfstnod.FIsSet(FSTNOD_Fallthrough);
-
-		pBuild->ActivateBlock(pBlockBody);
-		(void) PValGenerate(pWork, pBuild, pStnodBody, VALGENK_Instance);
 
-		bool fIsLastCase = iStnodChild+1 == pStnod->CStnodChild();
-		if (!fPrevCaseFallsThrough || fIsLastCase)
+		if (!pStnodList || !EWC_FVERIFY(pStnodList->CStnodChild() == pTinlit->m_c, "missing values for array literal"))
+			return;
 
+		for (int iStnod = 0; iStnod < pTinlit->m_c; ++iStnod)
 		{
-			pBuild->CreateBranch(pBlockPost);	
+			auto pStnodChild = pStnodList->PStnodChild(iStnod);
+			STypeInfoLiteral * pTinlitElem = (STypeInfoLiteral *)pStnodChild->m_pTin;
+			EWC_ASSERT(pTinlit->m_tink == TINK_Literal, "Bad array literal element");
+
+			apLvalElem[iStnod] = PLvalFromLiteral(this, pTinlitElem, pStnodChild);
 		}
-	}
 
-	for (int ipLval = 0; ipLval < arypVal.C(); ++ipLval)
+		pLvalInit = PLvalBuildConstantGlobalArrayRef(pWork, this, pLtypeElement, apLvalElem, U32Coerce(pTinlit->m_c));
+
+		m_pAlloc->EWC_FREE(apLvalElem);
+	}
+	else
 	{
-		pBuild->AddSwitchCase(pInstSw, arypVal[ipLval], arypBlock[ipLval], ipLval);
+		pLvalInit = PLvalFromLiteral(this, pTinlit, pStnodLiteral);
 	}
-	
-	pBuild->m_aryJumptStack.PopLast();
-	pBuild->ActivateBlock(pBlockPost);
+
+	SetInitializer(pGlob, pLvalInit);
 }
 
-CIRInstruction * CBuilderIR::PInstCreateSwitch(CIRValue * pVal, CIRBlock * pBlockElse, u32 cCases)
+void BCode::CBuilder::SetGlobalInitializer(CWorkspace * pWork, BCode::SConstant * pGlob, STypeInfo * pTinGlob, STypeInfoLiteral * pTinlit, CSTNode * pStnodInit)
 {
-	CIRInstruction * pInst = PInstCreateRaw(IROP_Switch, nullptr, nullptr, "");
-	if (FIsError(pInst))
-		return pInst;
+	auto pLvalInit = PLvalFromLiteral(this, pTinlit, pStnodInit);
 
-	pInst->m_pLval = LLVMBuildSwitch(m_pLbuild, pVal->m_pLval, pBlockElse->m_pLblock, cCases);
-	return pInst;
-}
+	if (!EWC_FVERIFY(pLvalInit->m_valk == VALK_Constant, "initializer must be constant"))
+		return;
 
-void CBuilderIR::AddSwitchCase(CIRInstruction * pInstSwitch, CIRValue * pValOn, CIRBlock * pBlock, int iInstCase)
-{
-	LLVMAddCase(pInstSwitch->m_pLval, pValOn->m_pLval, pBlock->m_pLblock); 
-}
+	auto pConstInit = (BCode::SConstant *)pLvalInit;
 
-static inline bool FIsNull(CIRValue * pVal)
-{
-	return pVal == nullptr || pVal->m_pLval == nullptr;
-}
+	auto pTinaryGlob = PTinRtiCast<STypeInfoArray *>(pTinGlob);
+	if (pTinaryGlob && pTinaryGlob->m_aryk == ARYK_Reference)
+	{
+		// allocate space for an array reference
+		auto pConstGlob = m_blistConst.AppendNew();
+		pConstGlob->m_pTin = m_pSymtab->PTinptrAllocate(pTinaryGlob);
+		pConstGlob->m_opk = OPK_Global;
 
-static inline bool FIsNull(BCode::SValue * pVal)
-{
-	return pVal == nullptr;
-}
+		size_t cBArrayRef = sizeof(s64) + m_pDlay->m_cBPointer;
 
-// called with a terminal identifier symbol, NOT a symbol path (symbol path handling will call this)
-template <typename BUILD>
-typename BUILD::Value * PValFromIdentifierSym(CWorkspace * pWork, BUILD * pBuild, SSymbol * pSymIdent, VALGENK valgenk)
-{
-	BUILD::Value * pVal = pBuild->PValFromSymbol(pSymIdent);
+		u8 * pBPointer;
+		s64 iBPointer;
+		s64 iBGlobal;
+		(void) PBAllocateGlobalWithPointer(cBArrayRef, EWC_ALIGN_OF(s64), &pBPointer, &iBPointer, &iBGlobal, "aryref");
+		pConstGlob->m_word.m_s64 = iBPointer;
 
-	if (!pVal)
-	{
-		SLexerLocation lexloc;
-		if (pSymIdent->m_pStnodDefinition)
+		auto pTinaryInit = PTinRtiCast<STypeInfoArray *>(pConstInit->m_pTin);
+		if (EWC_FVERIFY(pTinaryInit, "expected array") && pTinaryInit->m_aryk == ARYK_Fixed)
 		{
-			lexloc = pSymIdent->m_pStnodDefinition->m_lexloc;
+			auto pBGlob = m_dataseg.PBFromGlobal(pConstGlob);
+							
+			*(s64*)pBGlob = pTinaryInit->m_c;
+			m_dataseg.AddRelocatedPointer(m_pDlay, pConstGlob->m_word.m_s32 + sizeof(s64), pConstInit->m_word.m_s32);
 		}
 
-		EmitError(pWork, &lexloc, ERRID_UnknownError, "INTERNAL ERROR: Missing value for symbol %s", pSymIdent->m_strName.PCoz());
-		return nullptr;
+		SetInitializer(pGlob, pConstGlob);
+		return;
 	}
 
-	return pVal;
+	SetInitializer(pGlob, pLvalInit);
 }
 
-VALGENK ValgenkLhs(STypeInfo * pTinLhs, STypeInfo ** ppTinLhsValue)
+template <typename BUILD>
+typename BUILD::Value * PValGenerateDecl(
+	CWorkspace * pWork,
+	BUILD * pBuild,
+	CSTNode * pStnod,
+	CSTNode * pStnodInit,
+	VALGENK valgenk)
 {
-	auto pTinLhsValue = PTinStripQualifiers(pTinLhs);
+	auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
+	auto pSym = pStnod->PSym();
+	if (!pStdecl || !EWC_FVERIFY(pSym, "declaration without symbol"))
+		return nullptr;
 
-	VALGENK valgenkLhs = VALGENK_Reference;
-	if (pTinLhsValue)
+	auto pLtype = pBuild->PLtypeFromPTin(pStnod->m_pTin);
+	if (!EWC_FVERIFY(pLtype, "couldn't find llvm type for declaration"))
+		return nullptr;
+
+	u64 cBitSize, cBitAlign;
+	CalculateSizeAndAlign(pBuild, pLtype, &cBitSize, &cBitAlign);
+	if (cBitSize == 0)
 	{
-		if (pTinLhsValue->m_tink == TINK_Pointer)
-		{
-			pTinLhsValue = ((STypeInfoPointer *)pTinLhsValue)->m_pTinPointedTo;
-			valgenkLhs = VALGENK_Instance;
-		}
+		EmitError(pWork, &pStnod->m_lexloc, ERRID_ZeroSizeInstance,
+			"Could not instantiate %s, zero-sized instances are not allowed", pSym->m_strName.PCoz());
+		return nullptr;
 	}
 
-	*ppTinLhsValue = pTinLhsValue;
-	return valgenkLhs;
-}
+	s32 iLine, iCol;
+	auto pDif = PDifEmitLocation(pWork, pBuild, pStnod->m_lexloc, &iLine, &iCol);
 
-template <typename BUILD>
-typename BUILD::Value * PValGenerateSymbolPath(
-	CWorkspace * pWork,
-	BUILD * pBuild,
-	STypeInfo * pTinLhs,
-	typename BUILD::Value * pValLhs,
-	SSymbol ** ppSymMin,
-	SSymbol ** ppSymMax, 
-	VALGENK valgenkFinal)
-{
+	auto pLvalScope = PLvalFromDIFile(pBuild, pDif);
 
-	for (auto ppSymRhs = ppSymMin; ppSymRhs != ppSymMax; ++ppSymRhs)
+	CreateDebugInfo(pWork, pBuild, pStnod, pStnod->m_pTin);
+
+	bool fIsGlobal = pBuild->m_pProcCur == nullptr;
+	auto strName = pSym->m_strName;
+	auto strPunyName = StrPunyEncode(strName.PCoz());
+	if (fIsGlobal)
 	{
-		// check the symbol because we need to differentiate between enum namespacing and enum struct member.
-		BUILD::Constant * pConstEnum = nullptr;
+		auto pGlob = pBuild->PGlobCreate(pLtype, strPunyName.PCoz());
+		pBuild->SetSymbolValue(pSym, pGlob);
 
-		auto pSymRhs = *ppSymRhs;
-		
-		auto pTinLhsValue = pTinLhs;
-		bool fWasPointerType = false;
-		while (pTinLhsValue)
+		DInfoCreateGlobalVariable(pBuild, pStnod->m_pTin, pLvalScope, pDif, strName.PCoz(), strPunyName.PCoz(), iLine, true, pGlob);
+
+		BUILD::LValue * pLvalInit = nullptr;
+		if (pStnodInit)
 		{
-			if (pTinLhsValue->m_tink == TINK_Qualifier)
+			auto pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnodInit->m_pTin);
+			if (pTinlit && pStnodInit->m_park != PARK_Uninitializer)
 			{
-				auto pTinqual = (STypeInfoQualifier *)pTinLhsValue;
-				pTinLhsValue = pTinqual->m_pTin;
+				pLvalInit = PLvalBuildConstantInitializer(pBuild, pStnod->m_pTin, pStnodInit);
+				auto pLvalCast = PLvalGenerateConstCast(pWork, pBuild, valgenk, pLvalInit, pStnodInit, pStnod->m_pTin);
+
+				pBuild->SetInitializer(pGlob, pLvalCast);
+				return pGlob;
+
 			}
-			else if (pTinLhsValue->m_tink == TINK_Pointer)
+
+			if (FIsRunDirective(pStnodInit))
 			{
-				pTinLhsValue = ((STypeInfoPointer *)pTinLhsValue)->m_pTinPointedTo;
-				fWasPointerType = true;
+				pLvalInit = PLvalFromRunDirective(pBuild, pStnodInit);
+				if (!pLvalInit)
+				{
+					// not baked yet, directives that read this global are deferred to a later round of EvaluateRunDirectives()
+					pLvalInit = PLvalZeroInType(pBuild, pStnod->m_pTin);
+				}
+				else
+				{
+					EWC_ASSERT(
+						FTypesAreSame(PTinStripQualifiers(pStnodInit->m_pTin), PTinStripQualifiers(pStnod->m_pTin)),
+						"#run result type should have been matched during type check");
+				}
+
+				pBuild->SetInitializer(pGlob, pLvalInit);
+				return pGlob;
 			}
-			else 
-				break;
+
+			EWC_ASSERT(false, "Not yet supporting globals that require some runtime init");
+			//return PValInitialize(pWork, pBuild, pStnod->m_pTin, pGlob, pStnodInit);
+
+			// Also - not handling globals that need to call an overloaded := operator
 		}
 
-		// we want val lhs to be a reference type here, but if pTinLhs was a pointer the instance IS the reference type.
-		if (fWasPointerType)
+		// yuck, we're doing this check for every global variable?!?
+
+		if (FAreCozEqual(strName.PCoz(),STypeInfo::s_pChzGlobalTinTable))
 		{
-			pValLhs = pBuild->PInstCreate(IROP_Load, pValLhs, "ptrLoad");
+			DeferReflectTypeTable(pBuild, pSym, pGlob);
+			return pGlob;
 		}
 
-		auto pTinenum = PTinRtiCast<STypeInfoEnum *>(pTinLhsValue);
-		if (pTinenum)
-		{
-			CSTValue * pStvalRhs = nullptr;
-			if (pSymRhs->m_pStnodDefinition)
-			{
-				pStvalRhs = pSymRhs->m_pStnodDefinition->m_pStval;
-			}
+		pLvalInit = PLvalBuildConstantInitializer(pBuild, pStnod->m_pTin, pStnodInit);
+		pBuild->SetInitializer(pGlob, pLvalInit);
 
-			if (EWC_FVERIFY(pStvalRhs, "Enum constant lookup without value"))
-			{
-				pConstEnum = pBuild->PConstEnumLiteral(pTinenum, pStvalRhs);
+		return pGlob;
+	}
+	else
+	{
+		// generate the local variable into the first basic block for procedure
 
-				if (pTinenum->m_enumk != ENUMK_FlagEnum)
-					return pConstEnum;
-			}
-		}
+		auto pBlockCur = pBuild->m_pBlockCur;
+		pBuild->ActivateBlock(pBuild->m_pProcCur->m_pBlockLocals);
+		auto pValAlloca = pBuild->PValCreateAlloca(pLtype, strPunyName.PCoz());
+		pBuild->ActivateBlock(pBlockCur);
 
-		if (pConstEnum)
+
+		pBuild->SetSymbolValue(pSym, pValAlloca);
+	
+		auto pLvalDIVariable = PLvallDInfoCreateAutoVariable(pBuild, pStnod->m_pTin, pLvalScope, pDif, strPunyName.PCoz(), iLine, false, 0);
+
+		DInfoInsertDeclare(pBuild, pValAlloca, pLvalDIVariable, pLvalScope, iLine, iCol, pBuild->m_pBlockCur);
+
+		if (FIsOverloadedOp(pStnod))
 		{
-			if (valgenkFinal == VALGENK_Reference)
+			auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
+			if (EWC_FVERIFY(pStdecl && pStdecl->m_iStnodIdentifier >= 0 && pStdecl->m_iStnodInit >= 0,
+					"bad declaration"))
 			{
-				// set val: (n & ~flag) | (sext(fNew) & flag)
-				// return the instance here, the assignment operator will have to flip the right bits 
-				return pValLhs;
-			}
+				CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
 
-			// get val: (n & flag) == flag;
-			auto pInstLhsLoad = pBuild->PInstCreate(IROP_Load, pValLhs, "membLoad");
-			auto pInstAnd = pBuild->PInstCreate(IROP_And, pInstLhsLoad, pConstEnum, "and");
-			auto pInstCmp = pBuild->PInstCreateNCmp(NPRED_EQ, pInstAnd, pConstEnum, "cmpEq");
-			return pInstCmp;
-		}
+				auto pTinproc = pStnod->m_pOptype->m_pTinprocOverload;
 
-		CString strMemberName = pSymRhs->m_strName;
-		auto pTinstruct = PTinRtiCast<STypeInfoStruct *>(pTinLhsValue);
+				//BB - This won't work with generic procedure overloads
 
-		if (!EWC_FVERIFY(pTinstruct, "missing type structure in symbol path for %s", StrFromTypeInfo(pTinLhs).PCoz()))
-			return nullptr;
+				auto pTinptr = PTinRtiCast<STypeInfoPointer*>(pTinproc->m_arypTinParams[0]);
+				EWC_ASSERT(pTinptr, "exected pointer type for implicit reference");
 
-		int iTypememb = ITypemembLookup(pTinstruct, pSymRhs->m_strName);
-		if (!EWC_FVERIFY(iTypememb >= 0, "cannot find structure member %s.%s", pTinstruct->m_strName.PCoz(), pSymRhs->m_strName.PCoz()))
-			return nullptr;
-		auto pTypememb = &pTinstruct->m_aryTypemembField[iTypememb];
+				auto pValArg = PValGenerate(pWork, pBuild, pStnod->m_arypStnodChild[pStdecl->m_iStnodIdentifier], VALGENK_Reference);
+				arypLvalArgs.Append(PLvalFromPVal(pValArg));
 
-		BUILD::GepIndex * apLvalIndex[3] = {};
-		int cpLvalIndex = 0;
-		apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(0);
-		apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(pTinstruct->m_aryTypemembField.IFromP(pTypememb));
-		pValLhs = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, cpLvalIndex, "aryGep");
-		pTinLhs = pSymRhs->m_pTin;
-	}
+				auto pTinRhs = pTinproc->m_arypTinParams[1];
+				pValArg = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnod->m_arypStnodChild[pStdecl->m_iStnodInit], pTinRhs);
+				arypLvalArgs.Append(PLvalFromPVal(pValArg));
 
-	bool fIsProcedureRef = FIsProcedure(pValLhs);
-	if (valgenkFinal == VALGENK_Instance)
-	{
-		if (!fIsProcedureRef)
-		{
-			return pBuild->PInstCreate(IROP_Load, pValLhs, "rhsLoad");
+				auto pSymProc = pTinproc->m_pStnodDefinition->PSym();
+				return pBuild->PValGenerateCall(pWork, pStnod, pSymProc, &arypLvalArgs, true, pTinproc, valgenk);
+			}
 		}
-	}
-	else if (valgenkFinal == VALGENK_Reference)
-	{
-		EWC_ASSERT(!fIsProcedureRef, "Cannot return reference for instance symbol type");
-	}
 
-	return pValLhs;
+		if (pBuild->m_hashPStnodDeadInit.Lookup(pStnod))
+			return pValAlloca;
+
+		return PValInitialize(pWork, pBuild, pStnod->m_pTin, pValAlloca, pStnodInit);
+	}
 }
 
 template <typename BUILD>
-typename BUILD::Instruction * PInstGepFromSymbolList(
-	BUILD * pBuild,
-	SSymbol ** ppSymBegin,
-	SSymbol ** ppSymEnd,
-	typename BUILD::Value * pValLhs,
-	STypeInfo * pTinLhs,
-	VALGENK valgenk)
+typename BUILD::Value * PValGenerateArrayLiteralReference(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnod)
 {
-	BUILD::Instruction * pInstRet = nullptr;
-	for (auto ppSym = ppSymBegin; ppSym != ppSymEnd; ++ppSym)	
-	{
-		auto pSym = *ppSym;
-		STypeInfoStruct * pTinstruct = nullptr;
-		pTinLhs = PTinStripQualifiers(pTinLhs);
-		if (pTinLhs)
-		{
-			if (pTinLhs->m_tink == TINK_Pointer)
-			{
-				pTinLhs = ((STypeInfoPointer *)pTinLhs)->m_pTinPointedTo;
-				pValLhs = pBuild->PInstCreate(IROP_Load, pValLhs, "");
-			}
+	// constant decl's don't actually generate anything until referenced.
+	if (pStnod->m_park == PARK_ConstantDecl)
+		return nullptr;
 
-			pTinstruct = PTinRtiCast<STypeInfoStruct *>(pTinLhs);
-		}
-		if (!EWC_FVERIFY(pTinstruct, "missing type structure in symbol path for %s", pSym->m_strName.PCoz()))
-			return nullptr;
+	STypeInfoLiteral * pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnod->m_pTin);
+	if (!pTinlit)
+		return nullptr;
 
-		int iTypememb = PTypemembLookup(pTinstruct, pSym->m_strName);
-		if (!EWC_FVERIFY(iTypememb >= 0, "cannot find structure member %s", pSym->m_strName.PCoz()))
-			return nullptr;
-		auto pTypememb = &pTinstruct->m_aryTypemembField[iTypememb];
+	if (!EWC_FVERIFY(pTinlit->m_litty.m_litk == LITK_Compound, "expected array literal"))
+		return nullptr;
 
+	BUILD::Global * pGlob = nullptr;
+	BUILD::Global ** ppGlob = pBuild->m_hashPTinlitPGlob.Lookup(pTinlit);
+	if (ppGlob)
+	{
+		pGlob = *ppGlob;
+	}
+	else
+	{
+		auto pLvalConstInit = PLvalFromLiteral(pBuild, pTinlit, pStnod);
+		if (!pLvalConstInit)
+			return nullptr;
 
-		BUILD::GepIndex * apLvalIndex[3] = {};
-		int cpLvalIndex = 0;
-		apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(0);
-		apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(pTinstruct->m_aryTypemembField.IFromP(pTypememb));
-		auto pInstGep = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, cpLvalIndex, "aryGep");
+		auto pLtypeArray = pBuild->PLtypeFromPTin(pTinlit);
 
+		pGlob = pBuild->PGlobCreate(pLtypeArray, "aryLitRef");
 
-		pInstRet = pInstGep;
-		pValLhs = pInstGep;
-		pTinLhs = pTypememb->m_pTin;
+		pBuild->SetGlobalIsConstant(pGlob, true);
+		pBuild->SetInitializer(pGlob, pLvalConstInit);
+		(void) pBuild->m_hashPTinlitPGlob.FinsEnsureKeyAndValue(pTinlit, pGlob);
 	}
+	return pGlob;
+}
 
-	if (EWC_FVERIFY(pInstRet, "member dereference failure in codegen") && valgenk != VALGENK_Reference)
-	{
-		pInstRet = pBuild->PInstCreate(IROP_Load, pInstRet, "membLoad");
-	}
 
-	return pInstRet;
+void CBuilderIR::SetGlobalIsConstant(CIRGlobal * pGlob, bool fIsConstant)
+{
+	LLVMSetGlobalConstant(pGlob->m_pLval, fIsConstant);
 }
 
-template <typename BUILD>
-typename BUILD::Value * PValForSymbase(
-	BUILD * pBuild,
-	SSymbolBase * pSymbase,
-	VALGENK valgenk)
+CIRValue * PValGenerateLiteral(CWorkspace * pWork, CBuilderIR * pBuildIr, CSTNode * pStnod)
 {
-	if (!pSymbase)
+	// constant decl's don't actually generate anything until referenced.
+	if (pStnod->m_park == PARK_ConstantDecl)
 		return nullptr;
 
-	switch (pSymbase->m_symk)
-	{
-	case SYMK_Path:
-		{
-			auto pSymp = (SSymbolPath *)pSymbase;
-			auto pSymRoot = pSymp->m_arypSym[0];
-			auto pValRoot = pBuild->PValFromSymbol(pSymRoot);
+	STypeInfoLiteral * pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnod->m_pTin);
+	if (!pTinlit)
+		return nullptr;
 
-			auto ppSymBegin = &pSymp->m_arypSym[1];
-			auto ppSymEnd = pSymp->m_arypSym.PMac();
-			return PInstGepFromSymbolList(pBuild, ppSymBegin, ppSymEnd, pValRoot, pSymRoot->m_pTin, valgenk);
-			
-		} break;
-	case SYMK_Symbol:
-		{
-			return pBuild->PValFromSymbol((SSymbol *)pSymbase);
-		} break;
-	default:
-		EWC_ASSERT(false, "unhandled symk");
+	auto pLval = PLvalFromLiteral(pBuildIr, pTinlit, pStnod);
+	if (!pLval)
 		return nullptr;
-	}
+
+	CIRConstant * pConst = EWC_NEW(pBuildIr->m_pAlloc, CIRConstant) CIRConstant();
+	pBuildIr->AddManagedVal(pConst);
+	pConst->m_pLval = pLval;
+	return pConst;
 }
 
-template <typename BUILD>
-typename BUILD::Instruction * PInstGepFromSymbase(
-	BUILD * pBuild,
-	SSymbolBase * pSymbase,
-	typename BUILD::Value * pValLhs,
-	STypeInfo * pTinLhs,
-	VALGENK valgenk)
+BCode::SValue * PValGenerateLiteral(CWorkspace * pWork, BCode::CBuilder * pBuildBc, CSTNode * pStnod)
 {
-	BUILD::Instruction * pInstRet = nullptr;
-
-	SSymbol ** ppSymBegin;
-	SSymbol ** ppSymEnd;
-	switch(pSymbase->m_symk)
-	{
-	case SYMK_Symbol:
-		{
-			ppSymBegin = (SSymbol**)&pSymbase;
-			ppSymEnd = ppSymBegin+1;
+	// constant decl's don't actually generate anything until referenced.
+	if (pStnod->m_park == PARK_ConstantDecl)
+		return nullptr;
 
-		} break;
-	case SYMK_Path:
-		{
-			auto pSymp = (SSymbolPath *)pSymbase;
-			ppSymBegin = pSymp->m_arypSym.A();
-			ppSymEnd = pSymp->m_arypSym.PMac();
-		} break;
-	default:
-		EWC_ASSERT(false, "unhandled symbol kind %d", pSymbase->m_symk);
+	STypeInfoLiteral * pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnod->m_pTin);
+	if (!pTinlit)
 		return nullptr;
-	}
 
-	return PInstGepFromSymbolList(pBuild, ppSymBegin, ppSymEnd, pValLhs, pTinLhs, valgenk);
+	auto pLval = PLvalFromLiteral(pBuildBc, pTinlit, pStnod);
+	return pLval;
 }
 
-void AppendSymbase(EWC::CDynAry<SSymbol *> * parypSym, SSymbolBase * pSymbase)
+template <typename BUILD>
+void GenerateArguments(
+	CWorkspace * pWork,
+	BUILD * pBuild,
+	GRFSTNOD grfstnod,
+	STypeInfoProcedure * pTinproc, 
+	size_t cpStnodArg,
+	CSTNode ** ppStnodArg,
+	CDynAry<typename BUILD::LValue *> * parypLvalArgs,
+	CDynAry<typename BUILD::Value *> * parypValArgs = nullptr)
 {
-	switch (pSymbase->m_symk)
+	// what's with passing both a val array and a LVal array arguments? we need the LVal array for llvm, the val for postInc op overload
+
+	for (size_t ipStnodChild = 0; ipStnodChild < cpStnodArg; ++ipStnodChild)
 	{
-	case SYMK_Path:
-		{
-			auto pSymp = (SSymbolPath *)pSymbase;
-			auto ppSymMax = pSymp->m_arypSym.PMac();
-			for(auto ppSymIt = pSymp->m_arypSym.A(); ppSymIt != ppSymMax; ++ppSymIt)
-			{
-				parypSym->Append(*ppSymIt);
-			}
+		CSTNode * pStnodArg = ppStnodArg[ipStnodChild];
 
-		} break;
-	case SYMK_Symbol:
+		STypeInfo * pTinParam = pStnodArg->m_pTin;
+
+		size_t cpTinParam = pTinproc->m_arypTinParams.C();
+		if (ipStnodChild < cpTinParam)
 		{
-			parypSym->Append((SSymbol *)pSymbase);
-		} break;
-	default:
-		EWC_ASSERT(false, "unhandled symk");
-	}
-}
+			size_t ipStnodChildAdj = (grfstnod.FIsSet(FSTNOD_CommutativeCall)) ? (cpTinParam - 1 - ipStnodChild) : ipStnodChild;
+			pTinParam = pTinproc->m_arypTinParams[ipStnodChildAdj];
+		}
 
-template <typename BUILD>
-typename BUILD::Constant * PConstEnumLiteralFromStnod(BUILD * pBuild, CSTNode * pStnod, STypeInfo ** ppTinLoose)
-{
-	EWC::CDynAry<SSymbol *> arypSym(pBuild->m_pAlloc, BK_CodeGen);
-	switch (pStnod->m_park)
-	{
-	case PARK_MemberLookup:
+		BUILD::Value * pValRhsCast = nullptr;
+		if (ipStnodChild < pTinproc->m_mpIptinGrfparmq.C() && 
+			pTinproc->m_mpIptinGrfparmq[ipStnodChild].FIsSet(FPARMQ_ImplicitRef))
 		{
-			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
-			CSTNode * pStnodRhs = pStnod->PStnodChild(1);
-			AppendSymbase(&arypSym, pStnodLhs->m_pSymbase);
-			AppendSymbase(&arypSym, pStnodRhs->m_pSymbase);
-		} break;
-	case PARK_Identifier:
+			auto pTinptr = PTinRtiCast<STypeInfoPointer*>(pTinproc->m_arypTinParams[ipStnodChild]);
+			EWC_ASSERT(pTinptr, "exected pointer type for implicit reference");
+
+			pValRhsCast = PValGenerate(pWork, pBuild, pStnodArg, VALGENK_Reference);
+		}
+		else
 		{
-			AppendSymbase(&arypSym, pStnod->m_pSymbase);
-		} break;
-	default:
-		EWC_ASSERT(false, "unexpected parse kind %s", PChzFromPark(pStnod->m_park));
-		return nullptr;
+			pValRhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodArg, pTinParam);
+		}
+
+		parypLvalArgs->Append(pBuild->PProcArg(pValRhsCast));
+		if (parypValArgs)
+		{
+			parypValArgs->Append(pValRhsCast);
+		}
+
+		EWC_ASSERT(*parypLvalArgs->PLast(), "missing argument value");
 	}
 
-	auto cSym = arypSym.C();
-	if (cSym >= 2)
+	if (grfstnod.FIsSet(FSTNOD_CommutativeCall))
 	{
-		auto pSymEnum = arypSym[cSym-2];
-		auto pSymConstant = arypSym[cSym-1];
-
-		auto pTin = PTinStripQualifiersAndPointers(pSymEnum->m_pTin);
-		auto pTinenum = PTinRtiCast<STypeInfoEnum *>(pTin);
-		CSTValue * pStval = pSymConstant->m_pStnodDefinition->m_pStval;
-		if (pTinenum && pStval)
+		ReverseArray(parypLvalArgs->A(), parypLvalArgs->C());
+		if (parypValArgs)
 		{
-			*ppTinLoose = pTinenum->m_pTinLoose;
-			return pBuild->PConstEnumLiteral(pTinenum, pStval);
+			ReverseArray(parypValArgs->A(), parypValArgs->C());
 		}
 	}
-
-	return nullptr;
 }
 
-static bool FIsArrayLiteral(STypeInfoLiteral * pTinlit)
+CBuilderIR::ProcArg * CBuilderIR::PProcArg(CIRValue * pVal)
 {
-	if (pTinlit->m_litty.m_litk != LITK_Compound)
-		return false;
-
-	auto pTinSource = pTinlit->m_pTinSource;
-	if (!pTinSource)
-		return false;
-
-	pTinSource = PTinStripQualifiers(pTinSource);
-	return pTinSource && pTinSource->m_tink == TINK_Array;
+	return pVal->m_pLval;
 }
 
-template <typename BUILD>
-typename BUILD::Value * PValGenerate(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnod, VALGENK valgenk)
+CIRValue * CBuilderIR::PValGenerateCall(
+	CWorkspace * pWork,
+	CSTNode * pStnod,
+	SSymbol * pSym,
+	EWC::CDynAry<LLVMValueRef> * parypLvalArgs,
+	bool fIsDirectCall,
+	STypeInfoProcedure * pTinproc, 
+	VALGENK valgenk)
 {
-	CIRBuilderErrorContext berrctx(pWork->m_pErrman, pBuild, pStnod);
+	if (!EWC_FVERIFY(pTinproc->m_pStnodDefinition, "procedure missing definition"))
+		return nullptr;
 
-	if (pStnod->m_pTin && pStnod->m_pTin->m_tink == TINK_Literal)
+	CIRValue * pValSym = nullptr;
+	if (fIsDirectCall)
 	{
-		STypeInfoLiteral * pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnod->m_pTin);
-		if (valgenk == VALGENK_Reference)
-		{
-			if (pTinlit && pTinlit->m_litty.m_litk == LITK_Compound)
-			{
-				EWC_ASSERT(valgenk == VALGENK_Reference, "Trying to generate a reference from a literal");
-				return PValGenerateArrayLiteralReference(pWork, pBuild, pStnod);
-			}
-			EWC_ASSERT(false, "references to literals are only allowed on arrays");
-		}
+		if (!EWC_FVERIFY(pSym, "calling function without generated code"))
+			return nullptr;
 
-		return PValGenerateLiteral(pWork, pBuild, pStnod);
+		EWC_ASSERT(pSym->m_symdep == SYMDEP_Used, "Calling function thought to be unused '%s'", pTinproc->m_strName.PCoz());
+
+		(void)PValTryEnsureProc(pWork, this, pSym);
+
+		pValSym = PValFromSymbol(pSym);
+		if (!pValSym)
+			return nullptr;
 	}
 
-	switch (pStnod->m_park)
+	EmitLocation(pWork, this, pStnod->m_lexloc);
+	EWC_ASSERT(valgenk != VALGENK_Reference, "cannot return reference value for procedure call");
+
+	CIRInstruction * pInst = PInstCreateRaw(IROP_Call, nullptr, nullptr, "RetTmp");
+	if (FIsError(pInst))
+		return pInst;
+
+	if (fIsDirectCall)
 	{
-	case PARK_ProcedureDefinition:
-		{ 
-			auto pSym = pStnod->PSym();
-			if (!EWC_FVERIFY(pSym, "expected symbol to be set during type check, (implicit function?)"))
+		CIRProcedure * pProc = (CIRProcedure *)pValSym;
+		auto pLvalFunction = pProc->m_pLval;
+		if (LLVMCountParams(pLvalFunction) != parypLvalArgs->C())
+		{
+			if (!EWC_FVERIFY(pTinproc->FHasVarArgs(), "unexpected number of arguments"))
 				return nullptr;
+		}
 
-			auto pValProc = pBuild->PValFromSymbol(pSym);
-			if (!pValProc)
-			{
-				pValProc = PValCodegenPrototype<BUILD>(pWork, pBuild, pStnod);
-			}
+		s32 iLine;
+		s32 iCol;
+		CalculateLinePosition(pWork, &pStnod->m_lexloc, &iLine, &iCol);
 
-			
-			CSTNode * pStnodBody = nullptr;
-			auto pStproc = PStmapDerivedCast<CSTProcedure *>(pStnod->m_pStmap);
-			auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnod->m_pTin);
+		pInst->m_pLval = LLVMBuildCall(
+							m_pLbuild,
+							pProc->m_pLval,
+							parypLvalArgs->A(),
+							(u32)parypLvalArgs->C(),
+							"");
 
-			if (pValProc && pValProc->m_valk == VALK_Procedure && !pTinproc->FIsForeign())
-			{
-				auto pProc = (BUILD::Proc *)pValProc;
-				if (EWC_FVERIFY(pTinproc, "procedure missing tinproc") &&
-					EWC_FVERIFY(pStproc && pProc->m_pBlockFirst, "Encountered procedure without CSTProcedure"))
-				{
-					pStnodBody = pStnod->PStnodChildSafe(pStproc->m_iStnodBody);
-				}
 
-				if (pStnodBody)
-				{
-					GenerateMethodBody(pWork, pBuild, pProc, &pStnodBody, 1, false);
-				}
-			}
-		} break;
-	case PARK_List:
+		if (pTinproc->m_callconv != CALLCONV_Nil)
 		{
+			LLVMSetInstructionCallConv(pInst->m_pLval, CallingconvFromCallconv(pTinproc->m_callconv));
+		}
+		return pInst;
+	}
+	else
+	{
+		CSTNode * pStnodProcref = pStnod->PStnodChildSafe(0);
+		if (!EWC_FVERIFY(pStnodProcref, "expected procedure reference"))
+			return nullptr;
 
-			auto pDif = PDifEnsure(pWork, pBuild, pStnod->m_lexloc.m_strFilename.PCoz());
-			auto pLvalScope = PLvalFromDIFile(pBuild, pDif);
+		auto pValProcref = PValGenerate(pWork, this, pStnodProcref, VALGENK_Instance);
 
-			s32 iLine;
-			s32 iCol;
-			CalculateLinePosition(pWork, &pStnod->m_lexloc, &iLine, &iCol);
+		pInst->m_pLval = LLVMBuildCall(
+							m_pLbuild,
+							pValProcref->m_pLval,
+							parypLvalArgs->A(),
+							(u32)parypLvalArgs->C(),
+							"");
+		if (pTinproc->m_callconv != CALLCONV_Nil)
+		{
+			LLVMSetInstructionCallConv(pInst->m_pLval, CallingconvFromCallconv(pTinproc->m_callconv));
+		}
+		return pInst;
+	}
+}
 
-			auto pLvalDiBlock = PLvalDInfoCreateLexicalBlock(pBuild, pLvalScope, pDif, iLine, iCol);
-			PushDIScope(pDif, pLvalDiBlock);
+BCode::SValue * BCode::CBuilder::PValGenerateCall(
+	CWorkspace * pWork,
+	CSTNode * pStnod,
+	SSymbol * pSym,
+	EWC::CDynAry<ProcArg *> * parypValArgs,
+	bool fIsDirectCall,
+	STypeInfoProcedure * pTinproc,
+	VALGENK valgenk)
+{
+	SValue * pValProc;
+	if (fIsDirectCall)
+	{
+		if (!EWC_FVERIFY(pSym, "calling function without generated code"))
+			return nullptr;
 
-			int cStnodChild = pStnod->CStnodChild();
-			for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
-			{
-				PValGenerate(pWork, pBuild, pStnod->PStnodChild(iStnodChild), VALGENK_Instance);
-			}
+		EWC_ASSERT(pSym->m_symdep == SYMDEP_Used, "Calling function thought to be unused %p %s", pSym, pSym->m_strName.PCoz());
 
-			PopDIScope(pDif, pLvalDiBlock);
+		pValProc = PValTryEnsureProc(pWork, this, pSym);
+	}
+	else
+	{
+		CSTNode * pStnodProcref = pStnod->PStnodChildSafe(0);
+		if (!EWC_FVERIFY(pStnodProcref, "expected procedure reference"))
+			return nullptr;
 
-		} break;
-	case PARK_ExpressionList:
-		{
-			int cStnodChild = pStnod->CStnodChild();
-			for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
-			{
-				PValGenerate(pWork, pBuild, pStnod->PStnodChild(iStnodChild), VALGENK_Instance);
-			}
+		pValProc = PValGenerate(pWork, this, pStnodProcref, VALGENK_Instance);
+	}
 
-		}break;
-	case PARK_Decl:
-		{
-			auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
-			auto pStnodInit = pStnod->PStnodChildSafe(pStdecl->m_iStnodInit);
-			if (pStdecl->m_iStnodChildMin != -1)
-			{
-				// compound decl
-				for (int iStnod = pStdecl->m_iStnodChildMin; iStnod < pStdecl->m_iStnodChildMax; ++iStnod)
-				{
-					auto pStnodChild = pStnod->PStnodChild(iStnod);
-					(void) PValGenerateDecl(pWork, pBuild, pStnodChild, pStnodInit, valgenk);
-				}
-			}
+	auto pInst = PInstCreateCall(pValProc, pTinproc, parypValArgs->A(), (int)parypValArgs->C());
+	if (FIsError(pInst))
+		return pInst;
+
+	if (pTinproc->m_callconv != CALLCONV_Nil)
+	{
+		//LLVMSetInstructionCallConv(pInst->m_pLval, CallingconvFromCallconv(pTinproc->m_callconv));
+	}
+	return pInst;
+}
+
+CIRValue * PValGenerateTypeInfo(CWorkspace * pWork, CBuilderIR * pBuild, CSTNode * pStnod, CSTNode * pStnodChild)
+{
+	CIRGlobal * pGlob = EWC_NEW(pBuild->m_pAlloc, CIRGlobal) CIRGlobal();
+	pBuild->AddManagedVal(pGlob);
+
+	auto pTin = pStnodChild->m_pTin;
+	EWC_ASSERT(pTin->m_tink < TINK_ReflectedMax, "typeinfo on unreflected type kind %s", PChzFromTink(pTin->m_tink));
+	if (!pTin->m_pCgvalReflectGlobal)
+	{
+		pBuild->m_arypTinReflectRoot.Append(pTin);
+	}
+
+	auto pLtypePTin = pBuild->PLtypeFromPTin(pStnod->m_pTin);
+	pGlob->m_pLval = PLvalEnsureReflectGlobal(pWork, pBuild, pLtypePTin, pTin);
+	return pGlob;
+}
+
+BCode::SValue * PValGenerateTypeInfo(CWorkspace * pWork, BCode::CBuilder * pBuild, CSTNode * pStnod, CSTNode * pStnodChild)
+{
+	EWC_ASSERT(false, "bytecode TBD");
+	return nullptr;
+}
+
+template <typename BUILD>
+void GenerateSwitch(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnod, typename BUILD::Value * pValExp)
+{
+	BUILD::Proc * pProc = pBuild->m_pProcCur;
+	auto pBlockPost = pBuild->PBlockCreate(pProc, "PostSw");
+	auto pBlockDefault = pBlockPost;
+
+	auto pJumpt = pBuild->m_aryJumptStack.AppendNew();
+	pJumpt->m_pBlockBreak = pBlockPost;
+	pJumpt->m_pBlockContinue = nullptr;
+
+	if (pStnod->m_pStident)
+	{
+		pJumpt->m_strLabel = pStnod->m_pStident->m_str;
+	}
+
+	CDynAry<BUILD::Value *> arypVal(pBuild->m_pAlloc, BK_CodeGen, pStnod->CStnodChild()-1);
+	CDynAry<BUILD::Block *> arypBlock(pBuild->m_pAlloc, BK_CodeGen, pStnod->CStnodChild()-1);
+
+	u32 cStnodCase = 0;
+	for (int iStnodChild = 1; iStnodChild < pStnod->CStnodChild(); ++iStnodChild)
+	{
+		auto pStnodCase = pStnod->PStnodChild(iStnodChild);
+		if (!EWC_FVERIFY(pStnod->m_park == PARK_ReservedWord && pStnod->m_pStval, "bad case statement"))
+			continue;
+
+		switch(pStnodCase->m_pStval->m_rword)
+		{
+			case RWORD_Case:
+			{
+				auto pStnodCase = pStnod->PStnodChild(iStnodChild);
+
+				int cStnodLit = pStnodCase->CStnodChild()-1; // The last child is the case body (not a literal)
+				cStnodCase += cStnodLit;
+
+			} break;
+			case RWORD_Else:	
+				pBlockDefault = pBuild->PBlockCreate(pProc, "Default");
+				break;
+			default:
+				EWC_ASSERT(false, "Unexpected reserved word in switch");
+				break;
+		}
+	}
+
+	auto pInstSw = pBuild->PInstCreateSwitch(pValExp, pBlockDefault, cStnodCase);
+
+	bool fPrevCaseFallsThrough = false;
+	for (int iStnodChild = 1; iStnodChild < pStnod->CStnodChild(); ++iStnodChild)
+	{
+		auto pStnodCase = pStnod->PStnodChild(iStnodChild);
+		if (!EWC_FVERIFY(pStnod->m_park == PARK_ReservedWord && pStnod->m_pStval, "bad case statement"))
+			continue;
+
+		RWORD rword = pStnodCase->m_pStval->m_rword;
+
+		BUILD::Block * pBlockBody = nullptr;
+		CSTNode * pStnodBody = nullptr;
+		switch (rword)
+		{
+			case RWORD_Case:
+			{
+				if (!EWC_FVERIFY(pStnodCase->CStnodChild() >= 2, "expected case (literal, (opt literals...), body)"))
+					break;	
+
+				auto pBlockCase = pBuild->PBlockCreate(pProc, "Case");
+				int cStnodLit = pStnodCase->CStnodChild()-1; // The last child is the case body (not a literal)
+				for (int iStnodLit = 0; iStnodLit < cStnodLit; ++iStnodLit)
+				{
+					auto pValLit = PValGenerate(pWork, pBuild, pStnodCase->PStnodChild(iStnodLit), VALGENK_Instance);
+					arypBlock.Append(pBlockCase);
+					arypVal.Append(pValLit);
+				}
+
+				pBlockBody = pBlockCase;
+				pStnodBody = pStnodCase->PStnodChild(cStnodLit);
+			} break;
+			case RWORD_Else:
+			{
+				if (!EWC_FVERIFY(pStnodCase->CStnodChild() == 1, "expected default case to have one child (body)"))
+					break;
+
+				pBlockBody = pBlockDefault;
+				pStnodBody = pStnodCase->PStnodChild(0);
+			} break;
+			default:
+				EWC_ASSERT(false, "unexpected reserved word during case statement code gen (%s)", PCozFromRword(rword));
+		}
+		
+		if (fPrevCaseFallsThrough)
+		{
+			pBuild->CreateBranch(pBlockBody);	
+		}
+		fPrevCaseFallsThrough = pStnodCase->m_grfstnod.FIsSet(FSTNOD_Fallthrough);
+
+		pBuild->ActivateBlock(pBlockBody);
+		(void) PValGenerate(pWork, pBuild, pStnodBody, VALGENK_Instance);
+
+		bool fIsLastCase = iStnodChild+1 == pStnod->CStnodChild();
+		if (!fPrevCaseFallsThrough || fIsLastCase)
+
+		{
+			pBuild->CreateBranch(pBlockPost);	
+		}
+	}
+
+	for (int ipLval = 0; ipLval < arypVal.C(); ++ipLval)
+	{
+		pBuild->AddSwitchCase(pInstSw, arypVal[ipLval], arypBlock[ipLval], ipLval);
+	}
+	
+	pBuild->m_aryJumptStack.PopLast();
+	pBuild->ActivateBlock(pBlockPost);
+}
+
+CIRInstruction * CBuilderIR::PInstCreateSwitch(CIRValue * pVal, CIRBlock * pBlockElse, u32 cCases)
+{
+	CIRInstruction * pInst = PInstCreateRaw(IROP_Switch, nullptr, nullptr, "");
+	if (FIsError(pInst))
+		return pInst;
+
+	pInst->m_pLval = LLVMBuildSwitch(m_pLbuild, pVal->m_pLval, pBlockElse->m_pLblock, cCases);
+	return pInst;
+}
+
+void CBuilderIR::AddSwitchCase(CIRInstruction * pInstSwitch, CIRValue * pValOn, CIRBlock * pBlock, int iInstCase)
+{
+	LLVMAddCase(pInstSwitch->m_pLval, pValOn->m_pLval, pBlock->m_pLblock); 
+}
+
+static inline bool FIsNull(CIRValue * pVal)
+{
+	return pVal == nullptr || pVal->m_pLval == nullptr;
+}
+
+static inline bool FIsNull(BCode::SValue * pVal)
+{
+	return pVal == nullptr;
+}
+
+// called with a terminal identifier symbol, NOT a symbol path (symbol path handling will call this)
+template <typename BUILD>
+typename BUILD::Value * PValFromIdentifierSym(CWorkspace * pWork, BUILD * pBuild, SSymbol * pSymIdent, VALGENK valgenk)
+{
+	BUILD::Value * pVal = pBuild->PValFromSymbol(pSymIdent);
+
+	if (!pVal)
+	{
+		SLexerLocation lexloc;
+		if (pSymIdent->m_pStnodDefinition)
+		{
+			lexloc = pSymIdent->m_pStnodDefinition->m_lexloc;
+		}
+
+		EmitError(pWork, &lexloc, ERRID_UnknownError, "INTERNAL ERROR: Missing value for symbol %s", pSymIdent->m_strName.PCoz());
+		return nullptr;
+	}
+
+	return pVal;
+}
+
+VALGENK ValgenkLhs(STypeInfo * pTinLhs, STypeInfo ** ppTinLhsValue)
+{
+	auto pTinLhsValue = PTinStripQualifiers(pTinLhs);
+
+	VALGENK valgenkLhs = VALGENK_Reference;
+	if (pTinLhsValue)
+	{
+		if (pTinLhsValue->m_tink == TINK_Pointer)
+		{
+			pTinLhsValue = ((STypeInfoPointer *)pTinLhsValue)->m_pTinPointedTo;
+			valgenkLhs = VALGENK_Instance;
+		}
+	}
+
+	*ppTinLhsValue = pTinLhsValue;
+	return valgenkLhs;
+}
+
+// returns the SOA array indexed by an array element node, or null if it is not an SOA element
+static STypeInfoArray * PTinarySoaFromElement(CSTNode * pStnodElement)
+{
+	if (pStnodElement->m_park != PARK_ArrayElement)
+		return nullptr;
+
+	auto pTinary = PTinRtiCast<STypeInfoArray *>(PTinStripQualifiers(pStnodElement->PStnodChild(0)->m_pTin));
+	return (pTinary && pTinary->m_fIsSoa) ? pTinary : nullptr;
+}
+
+template <typename BUILD>
+typename BUILD::Value * PValGenerateSoaIndex(
+	CWorkspace * pWork,
+	BUILD * pBuild,
+	CSTNode * pStnodElement,
+	STypeInfoArray * pTinary,
+	typename BUILD::Value ** ppValAryRef)
+{
+	CSTNode * pStnodAry = pStnodElement->PStnodChild(0);
+	CSTNode * pStnodIndex = pStnodElement->PStnodChild(1);
+
+	auto pValIndex = PValGenerate(pWork, pBuild, pStnodIndex, VALGENK_Instance);
+	auto pValAryRef = PValGenerate(pWork, pBuild, pStnodAry, VALGENK_Reference);
+
+	if (pBuild->m_fBoundsCheck && !FIsIndexProvenInBounds(pBuild, pStnodAry, pTinary, pStnodIndex))
+	{
+		GenerateBoundsCheck(pWork, pBuild, pValAryRef, pTinary, pValIndex, pStnodIndex);
+	}
+
+	*ppValAryRef = pValAryRef;
+	return pValIndex;
+}
+
+// address of member iTypememb of element pValIndex: &aSoa.m_member[i]
+template <typename BUILD>
+typename BUILD::Value * PValSoaMemberReference(
+	BUILD * pBuild,
+	typename BUILD::Value * pValAryRef,
+	STypeInfoArray * pTinary,
+	int iTypememb,
+	typename BUILD::Value * pValIndex)
+{
+	BUILD::GepIndex * apLvalIndex[3] = {};
+	apLvalIndex[0] = pBuild->PGepIndex(0);
+	apLvalIndex[1] = pBuild->PGepIndex(ITypemembSoa(pTinary, iTypememb));
+
+	if (pTinary->m_aryk == ARYK_Fixed)
+	{
+		apLvalIndex[2] = pBuild->PGepIndexFromValue(pValIndex);
+		return pBuild->PInstCreateGEP(pValAryRef, apLvalIndex, 3, "soaGep");
+	}
+
+	auto pInstGepData = pBuild->PInstCreateGEP(pValAryRef, apLvalIndex, 2, "soaGepData");
+	auto pInstData = pBuild->PInstCreate(IROP_Load, pInstGepData, "soaData");
+
+	apLvalIndex[0] = pBuild->PGepIndexFromValue(pValIndex);
+	return pBuild->PInstCreateGEP(pInstData, apLvalIndex, 1, "soaGep");
+}
+
+template <typename BUILD>
+typename BUILD::Value * PValGenerateSoaElement(
+	CWorkspace * pWork,
+	BUILD * pBuild,
+	CSTNode * pStnodElement,
+	STypeInfoArray * pTinary,
+	VALGENK valgenk)
+{
+	// SOA elements don't exist in memory, gather each member into a temporary copy of the element
+	auto pTinstruct = (STypeInfoStruct *)PTinStripQualifiers(pTinary->m_pTin);
+
+	BUILD::Value * pValAryRef;
+	auto pValIndex = PValGenerateSoaIndex(pWork, pBuild, pStnodElement, pTinary, &pValAryRef);
+
+	auto pValAlloca = pBuild->PValCreateAlloca(pBuild->PLtypeFromPTin(pTinstruct), "soaElem");
+
+	BUILD::GepIndex * apLvalIndex[2] = {};
+	apLvalIndex[0] = pBuild->PGepIndex(0);
+
+	int cTypememb = (int)pTinstruct->m_aryTypemembField.C();
+	for (int iTypememb = 0; iTypememb < cTypememb; ++iTypememb)
+	{
+		auto pValMember = PValSoaMemberReference(pBuild, pValAryRef, pTinary, iTypememb, pValIndex);
+
+		apLvalIndex[1] = pBuild->PGepIndex(iTypememb);
+		auto pInstGepDst = pBuild->PInstCreateGEP(pValAlloca, apLvalIndex, 2, "soaGather");
+
+		auto pTinMember = PTinStripQualifiers(pTinstruct->m_aryTypemembField[iTypememb].m_pTin);
+		if (pTinMember->m_tink == TINK_Struct || pTinMember->m_tink == TINK_Array)
+		{
+			(void) pBuild->PInstCreateMemcpy(pTinMember, pInstGepDst, pValMember);
+		}
+		else
+		{
+			auto pInstLoad = pBuild->PInstCreate(IROP_Load, pValMember, "soaLoad");
+			(void) pBuild->PInstCreateStore(pInstGepDst, pInstLoad);
+		}
+	}
+
+	if (valgenk == VALGENK_Reference)
+		return pValAlloca;
+	return pBuild->PInstCreate(IROP_Load, pValAlloca, "soaElemLoad");
+}
+
+template <typename BUILD>
+typename BUILD::Value * PValGenerateSymbolPath(
+	CWorkspace * pWork,
+	BUILD * pBuild,
+	STypeInfo * pTinLhs,
+	typename BUILD::Value * pValLhs,
+	SSymbol ** ppSymMin,
+	SSymbol ** ppSymMax, 
+	VALGENK valgenkFinal)
+{
+
+	for (auto ppSymRhs = ppSymMin; ppSymRhs != ppSymMax; ++ppSymRhs)
+	{
+		// check the symbol because we need to differentiate between enum namespacing and enum struct member.
+		BUILD::Constant * pConstEnum = nullptr;
+
+		auto pSymRhs = *ppSymRhs;
+		
+		auto pTinLhsValue = pTinLhs;
+		bool fWasPointerType = false;
+		while (pTinLhsValue)
+		{
+			if (pTinLhsValue->m_tink == TINK_Qualifier)
+			{
+				auto pTinqual = (STypeInfoQualifier *)pTinLhsValue;
+				pTinLhsValue = pTinqual->m_pTin;
+			}
+			else if (pTinLhsValue->m_tink == TINK_Pointer)
+			{
+				pTinLhsValue = ((STypeInfoPointer *)pTinLhsValue)->m_pTinPointedTo;
+				fWasPointerType = true;
+			}
+			else 
+				break;
+		}
+
+		// we want val lhs to be a reference type here, but if pTinLhs was a pointer the instance IS the reference type.
+		if (fWasPointerType)
+		{
+			pValLhs = pBuild->PInstCreate(IROP_Load, pValLhs, "ptrLoad");
+		}
+
+		auto pTinenum = PTinRtiCast<STypeInfoEnum *>(pTinLhsValue);
+		if (pTinenum)
+		{
+			CSTValue * pStvalRhs = nullptr;
+			if (pSymRhs->m_pStnodDefinition)
+			{
+				pStvalRhs = pSymRhs->m_pStnodDefinition->m_pStval;
+			}
+
+			if (EWC_FVERIFY(pStvalRhs, "Enum constant lookup without value"))
+			{
+				pConstEnum = pBuild->PConstEnumLiteral(pTinenum, pStvalRhs);
+
+				if (pTinenum->m_enumk != ENUMK_FlagEnum)
+					return pConstEnum;
+			}
+		}
+
+		if (pConstEnum)
+		{
+			if (valgenkFinal == VALGENK_Reference)
+			{
+				// set val: (n & ~flag) | (sext(fNew) & flag)
+				// return the instance here, the assignment operator will have to flip the right bits 
+				return pValLhs;
+			}
+
+			// get val: (n & flag) == flag;
+			auto pInstLhsLoad = pBuild->PInstCreate(IROP_Load, pValLhs, "membLoad");
+			auto pInstAnd = pBuild->PInstCreate(IROP_And, pInstLhsLoad, pConstEnum, "and");
+			auto pInstCmp = pBuild->PInstCreateNCmp(NPRED_EQ, pInstAnd, pConstEnum, "cmpEq");
+			return pInstCmp;
+		}
+
+		CString strMemberName = pSymRhs->m_strName;
+		auto pTinstruct = PTinRtiCast<STypeInfoStruct *>(pTinLhsValue);
+
+		if (!EWC_FVERIFY(pTinstruct, "missing type structure in symbol path for %s", StrFromTypeInfo(pTinLhs).PCoz()))
+			return nullptr;
+
+		int iTypememb = ITypemembLookup(pTinstruct, pSymRhs->m_strName);
+		if (!EWC_FVERIFY(iTypememb >= 0, "cannot find structure member %s.%s", pTinstruct->m_strName.PCoz(), pSymRhs->m_strName.PCoz()))
+			return nullptr;
+		auto pTypememb = &pTinstruct->m_aryTypemembField[iTypememb];
+
+		BUILD::GepIndex * apLvalIndex[3] = {};
+		int cpLvalIndex = 0;
+		apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(0);
+		apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(pTinstruct->m_aryTypemembField.IFromP(pTypememb));
+		pValLhs = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, cpLvalIndex, "aryGep");
+		pTinLhs = pSymRhs->m_pTin;
+	}
+
+	bool fIsProcedureRef = FIsProcedure(pValLhs);
+	if (valgenkFinal == VALGENK_Instance)
+	{
+		if (!fIsProcedureRef)
+		{
+			return pBuild->PInstCreate(IROP_Load, pValLhs, "rhsLoad");
+		}
+	}
+	else if (valgenkFinal == VALGENK_Reference)
+	{
+		EWC_ASSERT(!fIsProcedureRef, "Cannot return reference for instance symbol type");
+	}
+
+	return pValLhs;
+}
+
+template <typename BUILD>
+typename BUILD::Instruction * PInstGepFromSymbolList(
+	BUILD * pBuild,
+	SSymbol ** ppSymBegin,
+	SSymbol ** ppSymEnd,
+	typename BUILD::Value * pValLhs,
+	STypeInfo * pTinLhs,
+	VALGENK valgenk)
+{
+	BUILD::Instruction * pInstRet = nullptr;
+	for (auto ppSym = ppSymBegin; ppSym != ppSymEnd; ++ppSym)	
+	{
+		auto pSym = *ppSym;
+		STypeInfoStruct * pTinstruct = nullptr;
+		pTinLhs = PTinStripQualifiers(pTinLhs);
+		if (pTinLhs)
+		{
+			if (pTinLhs->m_tink == TINK_Pointer)
+			{
+				pTinLhs = ((STypeInfoPointer *)pTinLhs)->m_pTinPointedTo;
+				pValLhs = pBuild->PInstCreate(IROP_Load, pValLhs, "");
+			}
+
+			pTinstruct = PTinRtiCast<STypeInfoStruct *>(pTinLhs);
+		}
+		if (!EWC_FVERIFY(pTinstruct, "missing type structure in symbol path for %s", pSym->m_strName.PCoz()))
+			return nullptr;
+
+		int iTypememb = PTypemembLookup(pTinstruct, pSym->m_strName);
+		if (!EWC_FVERIFY(iTypememb >= 0, "cannot find structure member %s", pSym->m_strName.PCoz()))
+			return nullptr;
+		auto pTypememb = &pTinstruct->m_aryTypemembField[iTypememb];
+
+
+		BUILD::GepIndex * apLvalIndex[3] = {};
+		int cpLvalIndex = 0;
+		apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(0);
+		apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(pTinstruct->m_aryTypemembField.IFromP(pTypememb));
+		auto pInstGep = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, cpLvalIndex, "aryGep");
+
+
+		pInstRet = pInstGep;
+		pValLhs = pInstGep;
+		pTinLhs = pTypememb->m_pTin;
+	}
+
+	if (EWC_FVERIFY(pInstRet, "member dereference failure in codegen") && valgenk != VALGENK_Reference)
+	{
+		pInstRet = pBuild->PInstCreate(IROP_Load, pInstRet, "membLoad");
+	}
+
+	return pInstRet;
+}
+
+template <typename BUILD>
+typename BUILD::Value * PValForSymbase(
+	BUILD * pBuild,
+	SSymbolBase * pSymbase,
+	VALGENK valgenk)
+{
+	if (!pSymbase)
+		return nullptr;
+
+	switch (pSymbase->m_symk)
+	{
+	case SYMK_Path:
+		{
+			auto pSymp = (SSymbolPath *)pSymbase;
+			auto pSymRoot = pSymp->m_arypSym[0];
+			auto pValRoot = pBuild->PValFromSymbol(pSymRoot);
+
+			auto ppSymBegin = &pSymp->m_arypSym[1];
+			auto ppSymEnd = pSymp->m_arypSym.PMac();
+			return PInstGepFromSymbolList(pBuild, ppSymBegin, ppSymEnd, pValRoot, pSymRoot->m_pTin, valgenk);
+			
+		} break;
+	case SYMK_Symbol:
+		{
+			return pBuild->PValFromSymbol((SSymbol *)pSymbase);
+		} break;
+	default:
+		EWC_ASSERT(false, "unhandled symk");
+		return nullptr;
+	}
+}
+
+template <typename BUILD>
+typename BUILD::Instruction * PInstGepFromSymbase(
+	BUILD * pBuild,
+	SSymbolBase * pSymbase,
+	typename BUILD::Value * pValLhs,
+	STypeInfo * pTinLhs,
+	VALGENK valgenk)
+{
+	BUILD::Instruction * pInstRet = nullptr;
+
+	SSymbol ** ppSymBegin;
+	SSymbol ** ppSymEnd;
+	switch(pSymbase->m_symk)
+	{
+	case SYMK_Symbol:
+		{
+			ppSymBegin = (SSymbol**)&pSymbase;
+			ppSymEnd = ppSymBegin+1;
+
+		} break;
+	case SYMK_Path:
+		{
+			auto pSymp = (SSymbolPath *)pSymbase;
+			ppSymBegin = pSymp->m_arypSym.A();
+			ppSymEnd = pSymp->m_arypSym.PMac();
+		} break;
+	default:
+		EWC_ASSERT(false, "unhandled symbol kind %d", pSymbase->m_symk);
+		return nullptr;
+	}
+
+	return PInstGepFromSymbolList(pBuild, ppSymBegin, ppSymEnd, pValLhs, pTinLhs, valgenk);
+}
+
+void AppendSymbase(EWC::CDynAry<SSymbol *> * parypSym, SSymbolBase * pSymbase)
+{
+	switch (pSymbase->m_symk)
+	{
+	case SYMK_Path:
+		{
+			auto pSymp = (SSymbolPath *)pSymbase;
+			auto ppSymMax = pSymp->m_arypSym.PMac();
+			for(auto ppSymIt = pSymp->m_arypSym.A(); ppSymIt != ppSymMax; ++ppSymIt)
+			{
+				parypSym->Append(*ppSymIt);
+			}
+
+		} break;
+	case SYMK_Symbol:
+		{
+			parypSym->Append((SSymbol *)pSymbase);
+		} break;
+	default:
+		EWC_ASSERT(false, "unhandled symk");
+	}
+}
+
+template <typename BUILD>
+typename BUILD::Constant * PConstEnumLiteralFromStnod(BUILD * pBuild, CSTNode * pStnod, STypeInfo ** ppTinLoose)
+{
+	EWC::CDynAry<SSymbol *> arypSym(pBuild->m_pAlloc, BK_CodeGen);
+	switch (pStnod->m_park)
+	{
+	case PARK_MemberLookup:
+		{
+			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
+			CSTNode * pStnodRhs = pStnod->PStnodChild(1);
+			AppendSymbase(&arypSym, pStnodLhs->m_pSymbase);
+			AppendSymbase(&arypSym, pStnodRhs->m_pSymbase);
+		} break;
+	case PARK_Identifier:
+		{
+			AppendSymbase(&arypSym, pStnod->m_pSymbase);
+		} break;
+	default:
+		EWC_ASSERT(false, "unexpected parse kind %s", PChzFromPark(pStnod->m_park));
+		return nullptr;
+	}
+
+	auto cSym = arypSym.C();
+	if (cSym >= 2)
+	{
+		auto pSymEnum = arypSym[cSym-2];
+		auto pSymConstant = arypSym[cSym-1];
+
+		auto pTin = PTinStripQualifiersAndPointers(pSymEnum->m_pTin);
+		auto pTinenum = PTinRtiCast<STypeInfoEnum *>(pTin);
+		CSTValue * pStval = pSymConstant->m_pStnodDefinition->m_pStval;
+		if (pTinenum && pStval)
+		{
+			*ppTinLoose = pTinenum->m_pTinLoose;
+			return pBuild->PConstEnumLiteral(pTinenum, pStval);
+		}
+	}
+
+	return nullptr;
+}
+
+static bool FIsArrayLiteral(STypeInfoLiteral * pTinlit)
+{
+	if (pTinlit->m_litty.m_litk != LITK_Compound)
+		return false;
+
+	auto pTinSource = pTinlit->m_pTinSource;
+	if (!pTinSource)
+		return false;
+
+	pTinSource = PTinStripQualifiers(pTinSource);
+	return pTinSource && pTinSource->m_tink == TINK_Array;
+}
+
+template <typename BUILD>
+typename BUILD::Value * PValGenerate(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnod, VALGENK valgenk)
+{
+	CIRBuilderErrorContext berrctx(pWork->m_pErrman, pBuild, pStnod);
+
+	if (pStnod->m_pTin && pStnod->m_pTin->m_tink == TINK_Literal)
+	{
+		STypeInfoLiteral * pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnod->m_pTin);
+		if (valgenk == VALGENK_Reference)
+		{
+			if (pTinlit && pTinlit->m_litty.m_litk == LITK_Compound)
+			{
+				EWC_ASSERT(valgenk == VALGENK_Reference, "Trying to generate a reference from a literal");
+				return PValGenerateArrayLiteralReference(pWork, pBuild, pStnod);
+			}
+			EWC_ASSERT(false, "references to literals are only allowed on arrays");
+		}
+
+		return PValGenerateLiteral(pWork, pBuild, pStnod);
+	}
+
+	switch (pStnod->m_park)
+	{
+	case PARK_ProcedureDefinition:
+		{ 
+			auto pSym = pStnod->PSym();
+			if (!EWC_FVERIFY(pSym, "expected symbol to be set during type check, (implicit function?)"))
+				return nullptr;
+
+			auto pValProc = pBuild->PValFromSymbol(pSym);
+			if (!pValProc)
+			{
+				pValProc = PValCodegenPrototype<BUILD>(pWork, pBuild, pStnod);
+			}
+
+			
+			CSTNode * pStnodBody = nullptr;
+			auto pStproc = PStmapDerivedCast<CSTProcedure *>(pStnod->m_pStmap);
+			auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnod->m_pTin);
+
+			if (pValProc && pValProc->m_valk == VALK_Procedure && !pTinproc->FIsForeign())
+			{
+				auto pProc = (BUILD::Proc *)pValProc;
+				if (EWC_FVERIFY(pTinproc, "procedure missing tinproc") &&
+					EWC_FVERIFY(pStproc && pProc->m_pBlockFirst, "Encountered procedure without CSTProcedure"))
+				{
+					pStnodBody = pStnod->PStnodChildSafe(pStproc->m_iStnodBody);
+				}
+
+				if (pStnodBody)
+				{
+					GenerateMethodBody(pWork, pBuild, pProc, &pStnodBody, 1, pStnod, false);
+				}
+			}
+		} break;
+	case PARK_List:
+		{
+
+			auto pDif = PDifEnsure(pWork, pBuild, pStnod->m_lexloc.m_strFilename.PCoz());
+			auto pLvalScope = PLvalFromDIFile(pBuild, pDif);
+
+			s32 iLine;
+			s32 iCol;
+			CalculateLinePosition(pWork, &pStnod->m_lexloc, &iLine, &iCol);
+
+			auto pLvalDiBlock = PLvalDInfoCreateLexicalBlock(pBuild, pLvalScope, pDif, iLine, iCol);
+			PushDIScope(pDif, pLvalDiBlock);
+
+			size_t cBfactPrev = pBuild->m_aryBfact.C();
+			GatherDeadInitializers(pBuild, pStnod);
+
+			int cStnodChild = pStnod->CStnodChild();
+			for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
+			{
+				CSTNode * pStnodChild = pStnod->PStnodChild(iStnodChild);
+				bool fTrackBounds = pBuild->m_fBoundsCheck;
+				if (fTrackBounds && FIsLoopStatement(pStnodChild))
+				{
+					// the loop body runs after writes later in the loop
+					InvalidateBoundsFacts(pBuild, pStnodChild);
+				}
+
+				PValGenerate(pWork, pBuild, pStnodChild, VALGENK_Instance);
+
+				if (fTrackBounds)
+				{
+					AddBoundsFactsFromStatement(pBuild, pStnodChild);
+					InvalidateBoundsFacts(pBuild, pStnodChild);
+				}
+			}
+			pBuild->m_aryBfact.PopToSize(cBfactPrev);
+
+			PopDIScope(pDif, pLvalDiBlock);
+
+		} break;
+	case PARK_ExpressionList:
+		{
+			int cStnodChild = pStnod->CStnodChild();
+			for (int iStnodChild = 0; iStnodChild < cStnodChild; ++iStnodChild)
+			{
+				PValGenerate(pWork, pBuild, pStnod->PStnodChild(iStnodChild), VALGENK_Instance);
+			}
+
+		}break;
+	case PARK_Decl:
+		{
+			auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
+			auto pStnodInit = pStnod->PStnodChildSafe(pStdecl->m_iStnodInit);
+			if (pStdecl->m_iStnodChildMin != -1)
+			{
+				// compound decl
+				for (int iStnod = pStdecl->m_iStnodChildMin; iStnod < pStdecl->m_iStnodChildMax; ++iStnod)
+				{
+					auto pStnodChild = pStnod->PStnodChild(iStnod);
+					(void) PValGenerateDecl(pWork, pBuild, pStnodChild, pStnodInit, valgenk);
+				}
+			}
 			else
 			{
-				(void) PValGenerateDecl(pWork, pBuild, pStnod, pStnodInit, valgenk);
+				(void) PValGenerateDecl(pWork, pBuild, pStnod, pStnodInit, valgenk);
+			}
+
+		} break;
+	case PARK_Cast:
+		{
+			auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
+			if (!EWC_FVERIFY(pStdecl && pStdecl->m_iStnodInit >= 0, "expected init child for cast"))
+				return nullptr;
+
+			return PValGenerateCast(pWork, pBuild, valgenk, pStnod->PStnodChild(pStdecl->m_iStnodInit), pStnod->m_pTin);
+		} break;
+	case PARK_Literal:
+		{
+			EWC_ASSERT(false, "encountered literal AST node during codegen, should have encountered literal type first");
+		} break;
+	case PARK_ReservedWord:
+		{
+			if (!EWC_FVERIFY(pStnod->m_pStval, "reserved word without value"))
+				return nullptr;
+
+			RWORD rword = pStnod->m_pStval->m_rword;
+			switch (rword)
+			{
+			case RWORD_Sizeof:
+			case RWORD_Alignof:
+				{
+					u64 cBitSize;
+					u64 cBitAlign;
+
+					auto pStnodChild = pStnod->PStnodChildSafe(0);
+					if (!EWC_FVERIFY(pStnodChild && pStnodChild->m_pTin, "bad alignof/typeof"))
+						return nullptr;
+
+					auto pLtype = pBuild->PLtypeFromPTin(pStnodChild->m_pTin);
+					CalculateSizeAndAlign(pBuild, pLtype, &cBitSize, &cBitAlign);
+
+					u64 cBit = (rword == RWORD_Sizeof) ? cBitSize : cBitAlign;
+
+					auto pTinint = PTinDerivedCast<STypeInfoInteger *>(pStnod->m_pTin);
+					if (!pTinint)
+						return nullptr;
+
+					return pBuild->PConstInt(cBit / 8, pTinint->m_cBit, false);
+
+				} break;
+			case RWORD_Typeinfo:
+				{
+					auto pStnodChild = pStnod->PStnodChildSafe(0);
+					if (!EWC_FVERIFY(pStnodChild && pStnodChild->m_pTin, "bad Typeinfo directive"))
+						return nullptr;
+
+					return PValGenerateTypeInfo(pWork, pBuild, pStnod, pStnodChild);
+				} break;
+			case RWORD_RunDirective:
+				{
+					auto pLvalResult = PLvalFromRunDirective(pBuild, pStnod);
+					if (!pLvalResult)
+					{
+						// not baked yet, this is the bytecode build that evaluates it.
+						auto pValCall = PValGenerate(pWork, pBuild, pStnod->PStnodChild(0), VALGENK_Instance);
+						if (valgenk != VALGENK_Reference)
+							return pValCall;
+
+						auto pValAlloca = pBuild->PValCreateAlloca(pBuild->PLtypeFromPTin(pStnod->m_pTin), "runTmp");
+						(void) pBuild->PInstCreateStore(pValAlloca, pValCall);
+						return pValAlloca;
+					}
+
+					auto pGlob = pBuild->PGlobCreate(pBuild->PLtypeFromPTin(pStnod->m_pTin), "runResult");
+					pBuild->SetGlobalIsConstant(pGlob, true);
+					pBuild->SetInitializer(pGlob, pLvalResult);
+
+					if (valgenk == VALGENK_Reference)
+						return pGlob;
+					return pBuild->PInstCreate(IROP_Load, pGlob, "runLoad");
+				}
+			case RWORD_New:
+				{
+					EWC_ASSERT(valgenk != VALGENK_Reference, "new doesn't produce an lvalue");
+
+					// the allocator runtime asserts on failure, so the new instance is always initialized
+					auto pTinptr = PTinDerivedCast<STypeInfoPointer *>(pStnod->m_pTin);
+					auto pValAlloc = PValGenerate(pWork, pBuild, pStnod->PStnodChild(1), VALGENK_Instance);
+					auto pValNew = pBuild->PInstCreateCast(IROP_Bitcast, pValAlloc, pTinptr, "newCast");
+
+					(void) PValInitialize(pWork, pBuild, pTinptr->m_pTinPointedTo, pValNew, nullptr);
+					return pValNew;
+				}
+			case RWORD_SimdShuffle:
+				{
+					auto pStnodVector = pStnod->PStnodChild(0);
+					auto pTinstruct = (STypeInfoStruct *)PTinStripQualifiers(pStnodVector->m_pTin);
+					EWC_ASSERT(FIsSimdStruct(pTinstruct), "expected #simd operand");
+
+					s32 aiLane[s_cLaneSimdMax];
+					int cLane = pTinstruct->CLane();
+					for (int iLane = 0; iLane < cLane; ++iLane)
+					{
+						auto pStnodLane = pStnod->PStnodChild(iLane + 1);
+						if (!EWC_FVERIFY(pStnodLane->m_pStval, "expected constant lane index"))
+							return nullptr;
+						aiLane[iLane] = S32Coerce(pStnodLane->m_pStval->m_nSigned);
+					}
+
+					auto pValVector = PValGenerate(pWork, pBuild, pStnodVector, VALGENK_Instance);
+					return pBuild->PInstCreateLaneShuffle(pTinstruct, pValVector, aiLane, "shuffle");
+				}
+			case RWORD_SimdSelect:
+				{
+					auto pTinstruct = (STypeInfoStruct *)PTinStripQualifiers(pStnod->m_pTin);
+					EWC_ASSERT(FIsSimdStruct(pTinstruct), "expected #simd operand");
+
+					auto pTinU32 = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strU32);
+					auto pValMask = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnod->PStnodChild(0), pTinU32);
+					auto pValTrue = PValGenerate(pWork, pBuild, pStnod->PStnodChild(1), VALGENK_Instance);
+					auto pValFalse = PValGenerate(pWork, pBuild, pStnod->PStnodChild(2), VALGENK_Instance);
+					return pBuild->PInstCreateLaneSelect(pTinstruct, pValMask, pValTrue, pValFalse, "select");
+				}
+			case RWORD_SimdReduceAdd:
+			case RWORD_SimdReduceMin:
+			case RWORD_SimdReduceMax:
+				{
+					auto pStnodVector = pStnod->PStnodChild(0);
+					auto pTinstruct = (STypeInfoStruct *)PTinStripQualifiers(pStnodVector->m_pTin);
+					EWC_ASSERT(FIsSimdStruct(pTinstruct), "expected #simd operand");
+
+					// min/max are a compare and select per step, encoded as the compare op and predicate
+					auto pTinLane = PTinStripQualifiers(pTinstruct->PTinLane());
+					bool fIsFloat = pTinLane->m_tink == TINK_Float;
+					bool fIsSigned = fIsFloat || ((STypeInfoInteger *)pTinLane)->m_fIsSigned;
+
+					IROP irop = (fIsFloat) ? IROP_GCmp : IROP_NCmp;
+					s32 pred;
+					switch (rword)
+					{
+					case RWORD_SimdReduceMin:	pred = (fIsFloat) ? GPRED_LT : ((fIsSigned) ? NPRED_SLT : NPRED_ULT);	break;
+					case RWORD_SimdReduceMax:	pred = (fIsFloat) ? GPRED_GT : ((fIsSigned) ? NPRED_SGT : NPRED_UGT);	break;
+					default:
+						irop = (fIsFloat) ? IROP_GAdd : IROP_NAdd;
+						pred = 0;
+						break;
+					}
+
+					auto pValVector = PValGenerate(pWork, pBuild, pStnodVector, VALGENK_Instance);
+					return pBuild->PInstCreateLaneReduce(irop, pred, pTinstruct, pValVector, "reduce");
+				}
+			case RWORD_Fallthrough:
+				break;
+			case RWORD_Switch:
+				{
+					auto pValExp = PValGenerate(pWork, pBuild, pStnod->PStnodChild(0), VALGENK_Instance);
+					GenerateSwitch(pWork, pBuild, pStnod, pValExp);
+				} break;
+			case RWORD_If:
+				{
+
+					//		NCmp
+					//		CondBr then, elifA
+					//	}
+					//	{ then:
+					//		...do stuff
+					//		Br post
+					//	}
+					//	{ :elifA
+					//		NCmp	
+					//		CondBr thenA, else
+					//	}
+					//	{ :thenA
+					//		...do stuff A	
+					//		Br post
+					//	}
+					//	{ :else
+					//		...do stuff C
+					//		Br post
+					//	}
+					//	{ :post
+
+					if (pStnod->CStnodChild() < 2)
+						return nullptr;
+
+					BUILD::Proc * pProc = pBuild->m_pProcCur;
+					BUILD::Block * pBlockPost = nullptr;	
+					CSTNode * pStnodCur = pStnod;
+
+					while (pStnodCur)
+					{
+						// BB - should handle declarations inside conditional statement? ie, does it need a new block
+
+						CSTNode * pStnodIf = pStnodCur;
+						CSTNode * pStnodPred = pStnodIf->PStnodChild(0);
+
+						STypeInfo * pTinBool = pStnodIf->m_pTin;
+
+						BUILD::Block *	pBlockTrue = pBuild->PBlockCreate(pProc, "ifThen");
+						BUILD::Block * pBlockFalse = nullptr;
+						pStnodCur = nullptr;
+						CSTNode * pStnodElseChild = nullptr;
+						if (pStnodIf->CStnodChild() == 3)
+						{
+							CSTNode * pStnodElse = pStnodIf->PStnodChild(2);
+							if (FIsReservedWord(pStnodElse, RWORD_Else))
+							{
+								CSTNode * pStnodChild = nullptr;
+								if (EWC_FVERIFY(pStnodElse->CStnodChild() == 1, "expected one child for else statement")) //statement or list
+								{
+									pStnodChild = pStnodElse->PStnodChild(0);
+								}
+
+								if (pStnodChild && FIsReservedWord(pStnodChild, RWORD_If))
+								{
+									pBlockFalse = pBuild->PBlockCreate(pProc, "ifElif");
+									pStnodCur = pStnodChild;
+								}
+								else
+								{
+									pBlockFalse = pBuild->PBlockCreate(pProc, "else");
+									pStnodElseChild = pStnodChild;
+								}
+							}
+						}
+
+						if (!pBlockPost)
+						{
+							pBlockPost = pBuild->PBlockCreate(pProc, "postIf");
+						}
+
+						if (!pBlockFalse)
+						{
+							pBlockFalse = pBlockPost;
+						}
+						GeneratePredicate(pWork, pBuild, pStnodPred, pBlockTrue, pBlockFalse, pTinBool);
+
+						pBuild->ActivateBlock(pBlockTrue);
+						(void) PValGenerate(pWork, pBuild, pStnodIf->PStnodChild(1), VALGENK_Instance);
+						pBuild->CreateBranch(pBlockPost);	
+						pBlockTrue = pBuild->m_pBlockCur;	// could have changed during this' codegen
+
+						if (pBlockFalse != pBlockPost)
+						{
+							pBuild->ActivateBlock(pBlockFalse);
+						}
+
+						if (pStnodElseChild)
+						{
+							(void) PValGenerate(pWork, pBuild, pStnodElseChild, VALGENK_Instance);
+							pBlockFalse = pBuild->m_pBlockCur;	// could have changed during else's codegen
+
+							pBuild->CreateBranch(pBlockPost);	
+						}
+					}
+
+					pBuild->ActivateBlock(pBlockPost);
+
+				} break;
+			case RWORD_Else:
+				EWC_ASSERT(false, "Else reserved word should be handled during codegen for if");
+				return nullptr;
+			case RWORD_For:
+				{
+					auto pStfor = PStmapRtiCast<CSTFor *>(pStnod->m_pStmap);
+					if (!EWC_FVERIFY(pStfor, "bad for loop"))
+						return nullptr;
+
+					EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+
+					CSTNode * pStnodFor = pStnod;
+					if (pStfor->m_iStnodDecl >= 0)
+					{
+						(void) PValGenerate(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodDecl), VALGENK_Instance);
+					}
+
+					size_t cBfactPrev = pBuild->m_aryBfact.C();
+					SBoundsLoop bloop;
+					if (pBuild->m_fBoundsCheck && FTryAddLoopBoundsFacts(pBuild, pStnodFor, pStfor, &bloop))
+					{
+						HoistLoopBoundsChecks(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodBody), &bloop);
+					}
+
+					BUILD::Proc * pProc = pBuild->m_pProcCur;
+					BUILD::Block *	pBlockBody = pBuild->PBlockCreate(pProc, "fbody");
+					BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "fpost");
+
+					BUILD::Block *	pBlockPred = pBlockBody;
+					CSTNode * pStnodPred = pStnodFor->PStnodChildSafe(pStfor->m_iStnodPredicate);
+					if (pStnodPred)
+					{
+						pBlockPred = pBuild->PBlockCreate(pProc, "fpred");
+					}
+
+					BUILD::Block * pBlockIncrement = pBlockPred;
+					CSTNode * pStnodIncrement = pStnodFor->PStnodChildSafe(pStfor->m_iStnodIncrement);
+					if (pStnodIncrement)
+					{
+						pBlockIncrement = pBuild->PBlockCreate(pProc, "finc");
+					}
+
+					pBuild->CreateBranch(pBlockPred);	
+
+					if (pStnodPred)
+					{
+						pBuild->ActivateBlock(pBlockPred);
+
+						STypeInfo * pTinBool = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strBool);
+						GeneratePredicate(pWork, pBuild, pStnodPred, pBlockBody, pBlockPost, pTinBool);
+					}
+
+					auto pJumpt = pBuild->m_aryJumptStack.AppendNew();
+					pJumpt->m_pBlockBreak = pBlockPost;
+					pJumpt->m_pBlockContinue = (pStnodIncrement) ? pBlockIncrement : pBlockBody;
+					if (pStnodFor->m_pStident)
+					{
+						pJumpt->m_strLabel = pStnodFor->m_pStident->m_str;
+					}
+
+					pBuild->ActivateBlock(pBlockBody);
+					(void) PValGenerate(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodBody), VALGENK_Instance);
+					pBuild->m_aryBfact.PopToSize(cBfactPrev);
+
+					pBuild->CreateBranch(pBlockIncrement);	
+					pBuild->m_aryJumptStack.PopLast();
+
+					if (pStnodIncrement)
+					{
+
+						pBuild->ActivateBlock(pBlockIncrement);
+						(void) PValGenerate(pWork, pBuild, pStnodIncrement, VALGENK_Instance);
+
+						pBuild->CreateBranch(pBlockPred);	
+					}
+
+					pBuild->ActivateBlock(pBlockPost);
+
+				} break;
+			case RWORD_ForEach:
+				{
+					auto pStfor = PStmapRtiCast<CSTFor *>(pStnod->m_pStmap);
+					if (!EWC_FVERIFY(pStfor, "bad for_each loop"))
+						return nullptr;
+
+					EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+
+					CSTNode * pStnodFor = pStnod;
+					if (pStfor->m_iStnodDecl >= 0)
+					{
+						(void) PValGenerate(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodDecl), VALGENK_Instance);
+					}
+					else if (pStfor->m_iStnodInit >= 0 && pStfor->m_iStnodIterator >= 0)
+					{
+						auto pStnodIterator = pStnodFor->PStnodChild(pStfor->m_iStnodIterator);
+						auto pStnodInit = pStnodFor->PStnodChild(pStfor->m_iStnodInit);
+
+						auto pValIterator = PValGenerate(pWork, pBuild, pStnodIterator, VALGENK_Reference);
+						(void) PInstGenerateAssignment(pWork, pBuild, pStnodIterator->m_pTin, pValIterator, pStnodInit);
+					}
+
+					CSTNode * pStnodPred = pStnodFor->PStnodChild(pStfor->m_iStnodPredicate);
+
+					// counted loops address the iterator directly, the predicate's argument is a reference to it
+					BUILD::Value * pValIterator = nullptr;
+					STypeInfoInteger * pTinintCounter = nullptr;
+					if (pStfor->m_iTypemembCounter >= 0)
+					{
+						CSTNode * pStnodIterator = pStnodPred->PStnodChild(1)->PStnodChild(0);
+						auto pTinstruct = PTinDerivedCast<STypeInfoStruct *>(PTinStripQualifiers(pStnodIterator->m_pTin));
+						pTinintCounter = PTinDerivedCast<STypeInfoInteger *>(pTinstruct->m_aryTypemembField[pStfor->m_iTypemembCounter].m_pTin);
+						pValIterator = PValGenerate(pWork, pBuild, pStnodIterator, VALGENK_Reference);
+					}
+
+					BUILD::Proc * pProc = pBuild->m_pProcCur;
+					BUILD::Block *	pBlockPred = pBuild->PBlockCreate(pProc, "fpred");
+					BUILD::Block *	pBlockBody = pBuild->PBlockCreate(pProc, "fbody");
+					BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "fpost");
+					BUILD::Block * pBlockIncrement = pBuild->PBlockCreate(pProc, "finc");
+					pBuild->CreateBranch(pBlockPred);	
+
+					pBuild->ActivateBlock(pBlockPred);
+
+					if (pValIterator)
+					{
+						BUILD::GepIndex * apLvalIndex[2] = {};
+						apLvalIndex[0] = pBuild->PGepIndex(0);
+						apLvalIndex[1] = pBuild->PGepIndex(pStfor->m_iTypemembCounter);
+						auto pInstGepCounter = pBuild->PInstCreateGEP(pValIterator, apLvalIndex, 2, "iterCounter");
+						apLvalIndex[1] = pBuild->PGepIndex(pStfor->m_iTypemembLimit);
+						auto pInstGepLimit = pBuild->PInstCreateGEP(pValIterator, apLvalIndex, 2, "iterLimit");
+
+						auto pInstCounter = pBuild->PInstCreate(IROP_Load, pInstGepCounter, "iLoad");
+						auto pInstLimit = pBuild->PInstCreate(IROP_Load, pInstGepLimit, "iMaxLoad");
+						auto pInstCmp = pBuild->PInstCreateNCmp(
+											(pTinintCounter->m_fIsSigned) ? NPRED_SLT : NPRED_ULT,
+											pInstCounter,
+											pInstLimit,
+											"NCmp");
+						(void) pBuild->PInstCreateCondBranch(pInstCmp, pBlockBody, pBlockPost);
+					}
+					else
+					{
+						STypeInfo * pTinBool = pStnodPred->m_pTin;
+						EWC_ASSERT(pTinBool->m_tink == TINK_Bool, "expected bool type for for loop predicate");
+
+						// NOTE: we're swapping the true/false blocks here because the predicate is reversed, ie fIsDone
+						GeneratePredicate(pWork, pBuild, pStnodPred, pBlockPost, pBlockBody, pTinBool);
+					}
+
+					auto pJumpt = pBuild->m_aryJumptStack.AppendNew();
+					pJumpt->m_pBlockBreak = pBlockPost;
+					pJumpt->m_pBlockContinue = pBlockIncrement;
+					if (pStnodFor->m_pStident)
+					{
+						pJumpt->m_strLabel = pStnodFor->m_pStident->m_str;
+					}
+
+					pBuild->ActivateBlock(pBlockBody);
+					(void) PValGenerate(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodBody), VALGENK_Instance);
+					pBuild->CreateBranch(pBlockIncrement);	
+					pBuild->m_aryJumptStack.PopLast();
+
+					pBuild->ActivateBlock(pBlockIncrement);
+					if (pValIterator)
+					{
+						BUILD::GepIndex * apLvalIndex[2] = {};
+						apLvalIndex[0] = pBuild->PGepIndex(0);
+						apLvalIndex[1] = pBuild->PGepIndex(pStfor->m_iTypemembCounter);
+						auto pInstGepCounter = pBuild->PInstCreateGEP(pValIterator, apLvalIndex, 2, "iterCounter");
+
+						auto pInstCounter = pBuild->PInstCreate(IROP_Load, pInstGepCounter, "iLoad");
+						auto pValOne = pBuild->PConstInt(1, pTinintCounter->m_cBit, pTinintCounter->m_fIsSigned);
+						auto pInstInc = pBuild->PInstCreate(IROP_NAdd, pInstCounter, pValOne, "iInc");
+						(void) pBuild->PInstCreateStore(pInstGepCounter, pInstInc);
+					}
+					else
+					{
+						CSTNode * pStnodIncrement = pStnodFor->PStnodChild(pStfor->m_iStnodIncrement);
+						(void) PValGenerate(pWork, pBuild, pStnodIncrement, VALGENK_Instance);
+					}
+
+					pBuild->CreateBranch(pBlockPred);	
+
+					pBuild->ActivateBlock(pBlockPost);
+
+				} break;
+			case RWORD_While:
+				{
+					if (pStnod->CStnodChild() < 2)
+						return nullptr;
+
+					EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+
+					BUILD::Proc * pProc = pBuild->m_pProcCur;
+					BUILD::Block * pBlockPred = pBuild->PBlockCreate(pProc, "wpred");
+					BUILD::Block * pBlockBody = pBuild->PBlockCreate(pProc, "wbody");
+					BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "wpost");
+					pBuild->CreateBranch(pBlockPred);	
+
+					pBuild->ActivateBlock(pBlockPred);
+
+					// BB - should handle declarations inside conditional statement? ie, does it need a new block
+
+					CSTNode * pStnodWhile = pStnod;
+					CSTNode * pStnodPred = pStnodWhile->PStnodChild(0);
+
+					STypeInfo * pTinBool = pStnodWhile->m_pTin;
+					EWC_ASSERT(pTinBool->m_tink == TINK_Bool, "expected bool type for while predicate");
+
+					GeneratePredicate(pWork, pBuild, pStnodPred, pBlockBody, pBlockPost, pTinBool);
+
+					pBuild->ActivateBlock(pBlockBody);
+
+					auto pJumpt = pBuild->m_aryJumptStack.AppendNew();
+					pJumpt->m_pBlockBreak = pBlockPost;
+					pJumpt->m_pBlockContinue = pBlockPred;
+					if (pStnodWhile->m_pStident)
+					{
+						pJumpt->m_strLabel = pStnodWhile->m_pStident->m_str;
+					}
+
+					(void) PValGenerate(pWork, pBuild, pStnodWhile->PStnodChild(1), VALGENK_Instance);
+					pBuild->m_aryJumptStack.PopLast();
+
+					pBuild->CreateBranch(pBlockPred);	
+
+
+					pBuild->ActivateBlock(pBlockPost);
+
+				} break;
+			case RWORD_Return:
+				{
+					EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+
+					BUILD::Value * pValRhs = nullptr;
+					if (pStnod->CStnodChild() == 1)
+					{
+						pValRhs = PValGenerate(pWork, pBuild, pStnod->PStnodChild(0), VALGENK_Instance);
+					}
+
+					pBuild->CreateReturn(&pValRhs, 1, "retTmp");
+
+				} break;
+			case RWORD_Break:
+			case RWORD_Continue:
+				{
+					BUILD::Block * pBlock = nullptr;
+					CString * pString = nullptr;
+					if (pStnod->m_pStident)
+					{
+						pString = &pStnod->m_pStident->m_str;
+					}
+
+					if (rword == RWORD_Break)
+					{
+						for (int iJumpt = (int)pBuild->m_aryJumptStack.C(); --iJumpt >= 0; )
+						{
+							auto pJumpt = &pBuild->m_aryJumptStack[iJumpt];
+							if (pJumpt->m_pBlockBreak && (pString == nullptr || pJumpt->m_strLabel == *pString))
+							{
+								pBlock = pJumpt->m_pBlockBreak;
+								break;
+							}
+						}
+					}
+					else //RWORD_Continue
+					{
+						for (size_t iJumpt = pBuild->m_aryJumptStack.C()-1; true; --iJumpt)
+						{
+							auto pJumpt = &pBuild->m_aryJumptStack[iJumpt];
+							if (pJumpt->m_pBlockContinue && (pString == nullptr || pJumpt->m_strLabel == *pString))
+							{
+								pBlock = pJumpt->m_pBlockContinue;
+								break;
+							}
+						}
+					}
+
+					if (pBlock)
+					{
+						pBuild->CreateBranch(pBlock);	
+					}
+					else
+					{
+						if (pString)
+						{
+							EmitError(pWork, &pStnod->m_lexloc, ERRID_UnknownError,
+								"Could not %s to label matching '%s'", PCozFromRword(rword), pString->PCoz());
+						}
+						else
+							EmitError(pWork, &pStnod->m_lexloc, ERRID_UnknownError,
+								"Encountered %s statement outside of a loop or switch", PCozFromRword(rword));
+					}
+
+				} break;
+			default:
+				EWC_ASSERT(false, "Unhandled reserved word in code gen %s", PCozFromRword(rword));
+				break;
+			}
+		} break;
+	case PARK_ProcedureCall:
+		{
+			auto pStnodTarget = pStnod->PStnodChildSafe(0);
+			STypeInfoProcedure * pTinproc = (pStnodTarget) ? PTinRtiCast<STypeInfoProcedure *>(pStnodTarget->m_pTin) : nullptr;
+
+			if (!EWC_FVERIFY(pTinproc, "expected type info procedure"))
+				return nullptr;
+	
+			CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
+
+			size_t cStnodArgs = pStnod->CStnodChild() - 1; // don't count the identifier
+			for (size_t iStnodChild = 0; iStnodChild < cStnodArgs; ++iStnodChild)
+			{
+				CSTNode * pStnodArg = pStnod->PStnodChild((int)iStnodChild + 1);
+				if (pStnodArg->m_park == PARK_TypeArgument)
+					continue;
+
+				STypeInfo * pTinParam = pStnodArg->m_pTin;
+				if (iStnodChild < pTinproc->m_arypTinParams.C())
+				{
+					pTinParam = pTinproc->m_arypTinParams[iStnodChild];
+				}
+
+				auto pValRhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodArg, pTinParam);
+
+				arypLvalArgs.Append(pBuild->PProcArg(pValRhsCast));
+				if (!EWC_FVERIFY(*arypLvalArgs.PLast(), "missing argument value"))
+					return nullptr;
+			}
+
+			bool fIsDirectCall = FIsDirectCall(pStnod);
+			return pBuild->PValGenerateCall(pWork, pStnod, pStnod->PSym(), &arypLvalArgs, fIsDirectCall, pTinproc, valgenk);
+		} 
+
+	case PARK_Identifier:
+		{
+#if 1
+			SSymbol ** ppSymMin = nullptr;
+			SSymbol ** ppSymMax = nullptr;
+			if (pStnod->m_pSymbase)
+			{
+				switch (pStnod->m_pSymbase->m_symk)
+				{
+				case SYMK_Symbol:
+					{
+						ppSymMin = (SSymbol**)&pStnod->m_pSymbase;
+						ppSymMax = ppSymMin+1;
+
+					} break;
+				case SYMK_Path:
+					{
+						auto pSymp = (SSymbolPath *)pStnod->m_pSymbase;
+						ppSymMin = pSymp->m_arypSym.A();
+						ppSymMax = pSymp->m_arypSym.PMac();
+					} break;
+				default: break;
+				}
+			}
+
+			if (ppSymMin == ppSymMax)
+			{
+				CString strName(StrFromIdentifier(pStnod));
+				EmitError(pWork, &pStnod->m_lexloc, ERRID_UnknownError, "INTERNAL ERROR: Missing value for symbol %s", strName.PCoz());
+			}
+
+			auto pSymLeft = *ppSymMin;
+			++ppSymMin;
+			BUILD::Value * pValLhs = PValFromIdentifierSym(pWork, pBuild, pSymLeft, VALGENK_Reference);
+			return PValGenerateSymbolPath(pWork, pBuild, pSymLeft->m_pTin, pValLhs, ppSymMin, ppSymMax, valgenk);
+
+#else
+			BUILD::Value * pVal = nullptr;
+			if (pStnod->m_pSymbase)
+			{
+				pVal = PValForSymbase(pBuild, pStnod->m_pSymbase, VALGENK_Reference);
+			}
+
+			if (!pVal)
+			{
+				CString strName(StrFromIdentifier(pStnod));
+				EmitError(pWork, &pStnod->m_lexloc, ERRID_UnknownError, "INTERNAL ERROR: Missing value for symbol %s", strName.PCoz());
+			}
+
+			if (!EWC_FVERIFY(pVal, "unknown identifier in codegen"))
+				return nullptr;
+
+			bool fIsProcedureRef = FIsProcedure(pVal);
+			auto valgenkSym = fIsProcedureRef ? VALGENK_Instance : VALGENK_Reference;
+			if (valgenk == VALGENK_Instance)
+			{
+				if (!fIsProcedureRef)
+				{
+					auto pSym = pStnod->PSym();
+					auto strPunyName = StrPunyEncode(pSym->m_strName.PCoz());
+					return pBuild->PInstCreate(IROP_Load, pVal, strPunyName.PCoz());
+				}
+			}
+			else if (valgenk == VALGENK_Reference)
+			{
+				ASSERT_STNOD(pWork, pStnod, valgenkSym == VALGENK_Reference, "Cannot return reference for instance symbol type");
+			}
+			return pVal;
+#endif
+		}
+	case PARK_MemberLookup:
+		{
+			CSTNode * pStnodRhs = pStnod->PStnodChild(1);
+			SSymbol ** ppSymMin = nullptr;
+			SSymbol ** ppSymMax = nullptr;
+			if (pStnodRhs->m_pSymbase)
+			{
+				switch (pStnodRhs->m_pSymbase->m_symk)
+				{
+				case SYMK_Symbol:
+					{
+						ppSymMin = (SSymbol**)&pStnodRhs->m_pSymbase;
+						ppSymMax = ppSymMin+1;
+
+					} break;
+				case SYMK_Path:
+					{
+						auto pSymp = (SSymbolPath *)pStnodRhs->m_pSymbase;
+						ppSymMin = pSymp->m_arypSym.A();
+						ppSymMax = pSymp->m_arypSym.PMac();
+					} break;
+				default: break;
+				}
+			}
+
+			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
+			if (auto pTinarySoa = PTinarySoaFromElement(pStnodLhs))
+			{
+				// aSoa[i].m addresses the member array directly, the element itself is never gathered
+				if (!EWC_FVERIFY(ppSymMin != ppSymMax, "missing member symbol for SOA element lookup"))
+					return nullptr;
+
+				auto pTinstructElement = (STypeInfoStruct *)PTinStripQualifiers(pTinarySoa->m_pTin);
+				auto pSymMember = *ppSymMin;
+				int iTypememb = ITypemembLookup(pTinstructElement, pSymMember->m_strName);
+				if (!EWC_FVERIFY(iTypememb >= 0, "cannot find structure member %s.%s", pTinstructElement->m_strName.PCoz(), pSymMember->m_strName.PCoz()))
+					return nullptr;
+
+				BUILD::Value * pValAryRef;
+				auto pValIndex = PValGenerateSoaIndex(pWork, pBuild, pStnodLhs, pTinarySoa, &pValAryRef);
+				auto pValMember = PValSoaMemberReference(pBuild, pValAryRef, pTinarySoa, iTypememb, pValIndex);
+				return PValGenerateSymbolPath(pWork, pBuild, pSymMember->m_pTin, pValMember, ppSymMin + 1, ppSymMax, valgenk);
+			}
+
+			auto pTinLhs = pStnodLhs->m_pTin;
+			VALGENK valgenkLhs = VALGENK_Reference;
+			if (pTinLhs)
+			{
+				if (pTinLhs->m_tink == TINK_Pointer)
+				{
+					pTinLhs = ((STypeInfoPointer *)pTinLhs)->m_pTinPointedTo;
+					valgenkLhs = VALGENK_Instance;
+				}
+			}
+			BUILD::Value * pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, valgenkLhs);
+
+			// implicit array members don't have a symbol for the RHS
+			CString strMemberName = StrFromIdentifier(pStnod->PStnodChild(1));
+			if (pTinLhs && pTinLhs->m_tink == TINK_Array)
+			{
+				auto pTinary = (STypeInfoArray *)pTinLhs;
+				ARYMEMB arymemb = ArymembLookup(strMemberName.PCoz());
+				return PValFromArrayMember(pWork, pBuild, pValLhs, pTinary, arymemb, valgenk);
+			}
+			if (pTinLhs && pTinLhs->m_tink == TINK_Literal)
+			{
+				auto pTinlit = (STypeInfoLiteral *)pTinLhs;
+				BUILD::Global ** ppGlob = pBuild->m_hashPTinlitPGlob.Lookup(pTinlit);
+				if (EWC_FVERIFY(ppGlob, "expected global instance for array literal"))
+				{
+					// BB - cleanup this (BUILD::Global *) cast
+					BUILD::Global * pGlobLit = (BUILD::Global *)*ppGlob;
+
+					if (FIsArrayLiteral(pTinlit))
+					{
+						ARYMEMB arymemb = ArymembLookup(strMemberName.PCoz());
+
+						EWC_ASSERT(valgenk == VALGENK_Instance, "expected instance");
+						if (arymemb == ARYMEMB_Count)
+						{
+							return pBuild->PConstInt(pTinlit->m_c, 64, true);
+						}
+
+						// the type of aN.data is &N so a reference would need to be a &&N which we don't have
+						EWC_ASSERT(arymemb == ARYMEMB_Data, "unexpected array member '%s'", PChzFromArymemb(arymemb));
+						auto pTinary = PTinDerivedCast<STypeInfoArray *>(PTinStripQualifiers(pTinlit->m_pTinSource));
+						auto pTinptr = pWork->m_pSymtab->PTinptrAllocate(pTinary->m_pTin);
+
+						return pBuild->PInstCreateCast(IROP_Bitcast, pGlobLit, pTinptr, "Bitcast");
+					}
+					return pGlobLit;
+				}
+			}
+
+			return PValGenerateSymbolPath(pWork, pBuild, pTinLhs, pValLhs, ppSymMin, ppSymMax, valgenk);
+		}
+	case PARK_ArrayElement:
+		{ 
+			if (!EWC_FVERIFY(pStnod->CStnodChild() == 2, "expected (array, index) for array element node"))
+				return nullptr;
+
+			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
+			CSTNode * pStnodIndex = pStnod->PStnodChild(1);
+
+			if (auto pTinarySoa = PTinarySoaFromElement(pStnod))
+			{
+				return PValGenerateSoaElement(pWork, pBuild, pStnod, pTinarySoa, valgenk);
+			}
+
+			BUILD::Value * pValLhs;
+			auto pValIndex = PValGenerate(pWork, pBuild, pStnodIndex, VALGENK_Instance);
+			if (!EWC_FVERIFY(!FIsNull(pValIndex), "null index llvm value"))
+				return nullptr;
+
+			BUILD::GepIndex * apLvalIndex[2] = {};
+			TINK tinkLhs = PTinStripQualifiers(pStnodLhs->m_pTin)->m_tink;
+			int cpLvalIndex = 0;
+
+			if (tinkLhs == TINK_Literal)
+			{
+				auto pTinlit = PTinDerivedCast<STypeInfoLiteral *>(pStnodLhs->m_pTin);
+				EWC_ASSERT(FIsArrayLiteral(pTinlit), "non-array literal being indexed like an array, missed during typecheck?");
+
+				pValLhs = PValGenerateArrayLiteralReference(pWork, pBuild, pStnodLhs);
+				apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(0);
+				apLvalIndex[cpLvalIndex++] = pBuild->PGepIndexFromValue(pValIndex);
 			}
+			else if (tinkLhs == TINK_Array)
+			{
+				auto pTinary = (STypeInfoArray *)PTinStripQualifiers(pStnodLhs->m_pTin);
+				pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, VALGENK_Reference);
 
-		} break;
-	case PARK_Cast:
-		{
-			auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
-			if (!EWC_FVERIFY(pStdecl && pStdecl->m_iStnodInit >= 0, "expected init child for cast"))
+				if (pBuild->m_fBoundsCheck && !FIsIndexProvenInBounds(pBuild, pStnodLhs, pTinary, pStnodIndex))
+				{
+					GenerateBoundsCheck(pWork, pBuild, pValLhs, pTinary, pValIndex, pStnodIndex);
+				}
+
+				if (pTinary->m_aryk != ARYK_Fixed)
+				{
+					pValLhs = PValFromArrayMember(pWork, pBuild, pValLhs, pTinary, ARYMEMB_Data, VALGENK_Instance);	// BB - why is this instance??
+				}
+				else
+				{
+					apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(0);
+				}
+				apLvalIndex[cpLvalIndex++] = pBuild->PGepIndexFromValue(pValIndex);
+			}
+			else if (tinkLhs == TINK_Pointer)
+			{
+				pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, VALGENK_Instance);
+				apLvalIndex[0] = pBuild->PGepIndexFromValue(pValIndex);
+				cpLvalIndex = 1;
+			}
+			else
+			{
+				EWC_ASSERT(false, "unexpected type on left hand side of array element");
 				return nullptr;
+			}
 
-			return PValGenerateCast(pWork, pBuild, valgenk, pStnod->PStnodChild(pStdecl->m_iStnodInit), pStnod->m_pTin);
+			auto pInst = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, cpLvalIndex, "aryGep");
+
+			if (EWC_FVERIFY(pInst, "unknown identifier in codegen") && valgenk != VALGENK_Reference)
+			{
+				return pBuild->PInstCreate(IROP_Load, pInst, "aryLoad");
+			}
+			return pInst;
 		} break;
-	case PARK_Literal:
+	case PARK_LogicalAndOrOp:
 		{
-			EWC_ASSERT(false, "encountered literal AST node during codegen, should have encountered literal type first");
+			// BB - What is the right thing here, C++ logical op overloads don't short circuit, C# breaks
+			// it into two operators (false and &)
+
+			auto pTinBool = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strBool);
+			auto pLtypeBool = pBuild->PLtypeFromPTin(pTinBool);
+
+			BUILD::Proc * pProc = pBuild->m_pProcCur;
+			auto pBlockTrue = pBuild->PBlockCreate(pProc, "predTrue");
+			auto pBlockFalse = pBuild->PBlockCreate(pProc, "predFalse");
+			auto pBlockPost = pBuild->PBlockCreate(pProc, "predPost");
+
+			GeneratePredicate(pWork, pBuild, pStnod, pBlockTrue, pBlockFalse, pTinBool);
+
+			pBuild->ActivateBlock(pBlockTrue);
+			auto pValTrue = pBuild->PConstInt(1, 1, false);
+			pBuild->CreateBranch(pBlockPost);	
+
+			pBuild->ActivateBlock(pBlockFalse);
+			auto pValFalse = pBuild->PConstInt(0, 1, false);
+			pBuild->CreateBranch(pBlockPost);	
+
+			pBuild->ActivateBlock(pBlockPost);
+			auto pValPhi = pBuild->PInstCreatePhi(pLtypeBool, "predPhi"); 
+			pBuild->AddPhiIncoming(pValPhi, pValTrue, pBlockTrue);
+			pBuild->AddPhiIncoming(pValPhi, pValFalse, pBlockFalse);
+
+			EWC_ASSERT(valgenk != VALGENK_Reference, "taking the address of a temporary (?)");
+			return pValPhi;
+
 		} break;
-	case PARK_ReservedWord:
+	case PARK_AssignmentOp:
 		{
-			if (!EWC_FVERIFY(pStnod->m_pStval, "reserved word without value"))
-				return nullptr;
+			if (FIsOverloadedOp(pStnod))
+			{
+				auto pTinproc = pStnod->m_pOptype->m_pTinprocOverload;
 
-			RWORD rword = pStnod->m_pStval->m_rword;
-			switch (rword)
+				//BB - This won't work with generic procedure overloads
+				auto pSym = pTinproc->m_pStnodDefinition->PSym();
+
+				CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
+				GenerateArguments(pWork, pBuild, pStnod->m_grfstnod, pTinproc, 2, pStnod->m_arypStnodChild.A(), &arypLvalArgs);
+				return pBuild->PValGenerateCall(pWork, pStnod, pSym, &arypLvalArgs, true, pTinproc, valgenk);
+			}
+
+			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
+			CSTNode * pStnodRhs = pStnod->PStnodChild(1);
+
+			BUILD::Value * pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, VALGENK_Reference);
+			if (pStnod->m_tok == TOK('='))
 			{
-			case RWORD_Sizeof:
-			case RWORD_Alignof:
+				if (pStnodLhs->m_pTin->m_tink == TINK_Flag)
 				{
-					u64 cBitSize;
-					u64 cBitAlign;
+					STypeInfo * pTinLoose = nullptr;
+					BUILD::Constant * pConstEnum = PConstEnumLiteralFromStnod(pBuild, pStnodLhs, &pTinLoose);
+					EWC_ASSERT(pConstEnum, "failed to find constant for flag enum");
 
-					auto pStnodChild = pStnod->PStnodChildSafe(0);
-					if (!EWC_FVERIFY(pStnodChild && pStnodChild->m_pTin, "bad alignof/typeof"))
-						return nullptr;
+					// set val: (n & ~flag) | (sext(rhs) & flag)
 
-					auto pLtype = pBuild->PLtypeFromPTin(pStnodChild->m_pTin);
-					CalculateSizeAndAlign(pBuild, pLtype, &cBitSize, &cBitAlign);
+					auto pTinBool = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strBool);
+					auto pValRhs = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodRhs, pTinBool);
 
-					u64 cBit = (rword == RWORD_Sizeof) ? cBitSize : cBitAlign;
+					auto pInstSExt = pBuild->PInstCreateCast(IROP_SignExt, pValRhs, pTinLoose, "SignExt");
+					auto pInstAndRhs = pBuild->PInstCreate(IROP_And, pInstSExt, pConstEnum, "andRhs");
 
-					auto pTinint = PTinDerivedCast<STypeInfoInteger *>(pStnod->m_pTin);
-					if (!pTinint)
-						return nullptr;
+					auto pInstLhsLoad = pBuild->PInstCreate(IROP_Load, pValLhs, "lhsLoad");
+					auto pInstNotEnum =  pBuild->PInstCreate(IROP_Not, pConstEnum, "notEn");
+					auto pInstAndLhs = pBuild->PInstCreate(IROP_And, pInstLhsLoad, pInstNotEnum, "andLhs");
 
-					return pBuild->PConstInt(cBit / 8, pTinint->m_cBit, false);
+					auto pInstOr = pBuild->PInstCreate(IROP_Or, pInstAndLhs, pInstAndRhs, "orFlags");
+					return pBuild->PInstCreateStore(pValLhs, pInstOr);
+				}
 
-				} break;
-			case RWORD_Typeinfo:
-				{
-					auto pStnodChild = pStnod->PStnodChildSafe(0);
-					if (!EWC_FVERIFY(pStnodChild && pStnodChild->m_pTin, "bad Typeinfo directive"))
-						return nullptr;
+				auto pInstOp = PInstGenerateAssignment(pWork, pBuild, pStnodLhs->m_pTin, pValLhs, pStnodRhs);
+				return pInstOp;
+			}
 
-					if (!EWC_FVERIFY(pStnodChild->m_pTin->m_pCgvalReflectGlobal, "expected global type info to already be emitted"))
-						return nullptr;
+			EmitLocation(pWork, pBuild, pStnod->m_lexloc);
 
-					return PValGenerateTypeInfo(pBuild, pStnod, pStnodChild);
-				} break;
-			case RWORD_Fallthrough:
-				break;
-			case RWORD_Switch:
-				{
-					auto pValExp = PValGenerate(pWork, pBuild, pStnod->PStnodChild(0), VALGENK_Instance);
-					GenerateSwitch(pWork, pBuild, pStnod, pValExp);
-				} break;
-			case RWORD_If:
-				{
+			auto pTinOperandRhs = (EWC_FVERIFY(pStnod->m_pOptype, "missing operator types")) ? pStnod->m_pOptype->m_pTinRhs : pStnodLhs->m_pTin;
 
-					//		NCmp
-					//		CondBr then, elifA
-					//	}
-					//	{ then:
-					//		...do stuff
-					//		Br post
-					//	}
-					//	{ :elifA
-					//		NCmp	
-					//		CondBr thenA, else
-					//	}
-					//	{ :thenA
-					//		...do stuff A	
-					//		Br post
-					//	}
-					//	{ :else
-					//		...do stuff C
-					//		Br post
-					//	}
-					//	{ :post
+			auto pValLhsLoad = pBuild->PInstCreate(IROP_Load, pValLhs, "lhsLoad");
+			auto pValRhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodRhs, pTinOperandRhs);
+			EWC_ASSERT(pValRhsCast, "bad cast");
 
-					if (pStnod->CStnodChild() < 2)
-						return nullptr;
+			SOpTypes optype(pStnodLhs->m_pTin, pStnodRhs->m_pTin, pStnod->m_pTin);
+			auto pInstOp = PInstGenerateOperator(pBuild, pStnod->m_tok, &optype, pValLhsLoad, pValRhsCast);
+			return pBuild->PInstCreateStore(pValLhs, pInstOp);
+		}
+	case PARK_AdditiveOp:
+		{
+			SOpTypes * pOptype = pStnod->m_pOptype;
+			EWC_ASSERT(pOptype && pOptype->m_pTinLhs && pOptype->m_pTinRhs, "missing operand types for AdditiveOp");
 
-					BUILD::Proc * pProc = pBuild->m_pProcCur;
-					BUILD::Block * pBlockPost = nullptr;	
-					CSTNode * pStnodCur = pStnod;
+			STypeInfo * pTinLhs = PTinStripQualifiers(pOptype->m_pTinLhs);
+			STypeInfo * pTinRhs = PTinStripQualifiers(pOptype->m_pTinRhs);
+			TINK tinkLhs = pTinLhs->m_tink;
+			TINK tinkRhs = pTinRhs->m_tink;
+			if (!FIsOverloadedOp(pStnod))
+			{
+				if (((tinkLhs == TINK_Pointer) & (tinkRhs == TINK_Integer)) | 
+					((tinkLhs == TINK_Integer) & (tinkRhs == TINK_Pointer)))
+				{
+					//handle pointer arithmetic
 
-					while (pStnodCur)
+					CSTNode * pStnodLhs = pStnod->PStnodChild(0);
+					auto pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, VALGENK_Instance);
+
+					CSTNode * pStnodRhs = pStnod->PStnodChild(1);
+					auto pValRhs = PValGenerate(pWork, pBuild, pStnodRhs, VALGENK_Instance);
+
+					BUILD::Value * pValPtr;
+					BUILD::Value * pValIndex;
+					if (pTinLhs->m_tink == TINK_Pointer)
 					{
-						// BB - should handle declarations inside conditional statement? ie, does it need a new block
+						pValPtr = pValLhs;
+						pValIndex = pValRhs;
+					}
+					else
+					{
+						pValPtr = pValRhs;
+						pValIndex = pValLhs;
+					}
+					if (pStnod->m_tok == TOK('-'))
+					{
+						pValIndex = pBuild->PInstCreate(IROP_NNeg, pValIndex, "NNeg");
+					}
+
+					BUILD::GepIndex * pGepIndex = pBuild->PGepIndexFromValue(pValIndex);
+					auto pInstGep = pBuild->PInstCreateGEP(pValPtr, &pGepIndex, 1, "ptrGep");
+					return pInstGep; 
+				}
+			}
+		} // fallthrough
+	case PARK_MultiplicativeOp:
+	case PARK_ShiftOp:
+	case PARK_RelationalOp:
+		{
+			ASSERT_STNOD(pWork, pStnod, valgenk != VALGENK_Reference, "operand result is not a valid LValue");
+
+			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
+			CSTNode * pStnodRhs = pStnod->PStnodChild(1);
+
+			SOpTypes * pOptype = pStnod->m_pOptype;
+			EWC_ASSERT(pOptype && pOptype->FIsValid(), "missing operand types");
+			STypeInfo * pTinOperandLhs = pOptype->m_pTinLhs;
+			STypeInfo * pTinOperandRhs = pOptype->m_pTinRhs;
+			auto pValLhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodLhs, pTinOperandLhs);
+			auto pValRhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodRhs, pTinOperandRhs);
+			if (!EWC_FVERIFY((pValLhsCast != nullptr) & (pValRhsCast != nullptr), "null operand"))
+				return nullptr;
+
+			STypeInfo * pTinLhs = pStnodLhs->m_pTin;
+			STypeInfo * pTinRhs = pStnodRhs->m_pTin;
+			if (!EWC_FVERIFY(
+					(pOptype->m_pTinResult != nullptr) & (pTinLhs != nullptr) & (pTinRhs != nullptr), 
+					"bad cast"))
+			{
+				return nullptr;
+			}
+
+			if (FIsOverloadedOp(pStnod))
+			{
+				auto pTinproc = pStnod->m_pOptype->m_pTinprocOverload;
 
-						CSTNode * pStnodIf = pStnodCur;
-						CSTNode * pStnodPred = pStnodIf->PStnodChild(0);
+				//BB - This won't work with generic procedure overloads
+				auto pSym = pTinproc->m_pStnodDefinition->PSym();
 
-						STypeInfo * pTinBool = pStnodIf->m_pTin;
+				CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
+				GenerateArguments(pWork, pBuild, pStnod->m_grfstnod, pTinproc, 2, pStnod->m_arypStnodChild.A(), &arypLvalArgs);
+				return pBuild->PValGenerateCall(pWork, pStnod, pSym, &arypLvalArgs, true, pTinproc, valgenk);
+			}
+	
+			/*
+			if (LLVMTypeOf(pValLhsCast->m_pLval) != LLVMTypeOf(pValRhsCast->m_pLval))
+			{
+				EmitError(pWork, &pStnod->m_lexloc, ERRID_BadCastGen, "INTERNAL ERROR: bad cast");
+				DumpLtype("Lhs", pValLhsCast);
+				DumpLtype("Rhs", pValRhsCast);
+				return nullptr;
+			}*/
 
-						BUILD::Block *	pBlockTrue = pBuild->PBlockCreate(pProc, "ifThen");
-						BUILD::Block * pBlockFalse = nullptr;
-						pStnodCur = nullptr;
-						CSTNode * pStnodElseChild = nullptr;
-						if (pStnodIf->CStnodChild() == 3)
-						{
-							CSTNode * pStnodElse = pStnodIf->PStnodChild(2);
-							if (FIsReservedWord(pStnodElse, RWORD_Else))
-							{
-								CSTNode * pStnodChild = nullptr;
-								if (EWC_FVERIFY(pStnodElse->CStnodChild() == 1, "expected one child for else statement")) //statement or list
-								{
-									pStnodChild = pStnodElse->PStnodChild(0);
-								}
+			auto pInstOp = PInstGenerateOperator(pBuild, pStnod->m_tok, pOptype, pValLhsCast, pValRhsCast);
 
-								if (pStnodChild && FIsReservedWord(pStnodChild, RWORD_If))
-								{
-									pBlockFalse = pBuild->PBlockCreate(pProc, "ifElif");
-									pStnodCur = pStnodChild;
-								}
-								else
-								{
-									pBlockFalse = pBuild->PBlockCreate(pProc, "else");
-									pStnodElseChild = pStnodChild;
-								}
-							}
-						}
+			EWC_ASSERT(pInstOp, "%s operator unsupported in codegen", PCozFromTok(pStnod->m_tok));
+			return pInstOp;
+		}
+	case PARK_PostfixUnaryOp:
+	case PARK_UnaryOp:
+		{
+			CSTNode * pStnodOperand = pStnod->PStnodChild(0);
 
-						if (!pBlockPost)
-						{
-							pBlockPost = pBuild->PBlockCreate(pProc, "postIf");
-						}
+			if (FIsOverloadedOp(pStnod))
+			{
+				auto pTinproc = pStnod->m_pOptype->m_pTinprocOverload;
 
-						if (!pBlockFalse)
-						{
-							pBlockFalse = pBlockPost;
-						}
-						GeneratePredicate(pWork, pBuild, pStnodPred, pBlockTrue, pBlockFalse, pTinBool);
+				//BB - This won't work with generic procedure overloads
+				auto pSym = pTinproc->m_pStnodDefinition->PSym();
 
-						pBuild->ActivateBlock(pBlockTrue);
-						(void) PValGenerate(pWork, pBuild, pStnodIf->PStnodChild(1), VALGENK_Instance);
-						pBuild->CreateBranch(pBlockPost);	
-						pBlockTrue = pBuild->m_pBlockCur;	// could have changed during this' codegen
+				CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
+				CDynAry<BUILD::Value *> arypValArgs(pBuild->m_pAlloc, EWC::BK_Stack);
+				GenerateArguments(pWork, pBuild, pStnod->m_grfstnod, pTinproc, 1, pStnod->m_arypStnodChild.A(), &arypLvalArgs, &arypValArgs);
 
-						if (pBlockFalse != pBlockPost)
-						{
-							pBuild->ActivateBlock(pBlockFalse);
-						}
+				BUILD::Value * pValReturn = nullptr;
+				if (pStnod->m_park == PARK_PostfixUnaryOp)
+				{
+					pValReturn = pBuild->PInstCreate(IROP_Load, arypValArgs[0], "");
+				}
 
-						if (pStnodElseChild)
-						{
-							(void) PValGenerate(pWork, pBuild, pStnodElseChild, VALGENK_Instance);
-							pBlockFalse = pBuild->m_pBlockCur;	// could have changed during else's codegen
+				auto pValCall = pBuild->PValGenerateCall(pWork, pStnod, pSym, &arypLvalArgs, true, pTinproc, valgenk);
 
-							pBuild->CreateBranch(pBlockPost);	
-						}
-					}
+				return (pValReturn) ? pValReturn : pValCall;;
+			}
 
-					pBuild->ActivateBlock(pBlockPost);
+			if (pStnod->m_tok == TOK_Reference)
+			{
+				return PValGenerate(pWork, pBuild, pStnodOperand, VALGENK_Reference);
+			}
 
-				} break;
-			case RWORD_Else:
-				EWC_ASSERT(false, "Else reserved word should be handled during codegen for if");
+			TOK tok = pStnod->m_tok;
+			VALGENK valgenkUnary = ((tok == TOK_PlusPlus) | (tok == TOK_MinusMinus)) ? VALGENK_Reference : VALGENK_Instance;
+			auto pValOperand = PValGenerate(pWork, pBuild, pStnodOperand, valgenkUnary);
+			if (!EWC_FVERIFY(!FIsNull(pValOperand), "null operand"))
 				return nullptr;
-			case RWORD_For:
-				{
-					auto pStfor = PStmapRtiCast<CSTFor *>(pStnod->m_pStmap);
-					if (!EWC_FVERIFY(pStfor, "bad for loop"))
-						return nullptr;
 
-					EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+			EWC_ASSERT(pStnod->m_pOptype, "mising operator types in unary op");
+			STypeInfo * pTinOutput = PTinStripQualifiers(pStnod->m_pOptype->m_pTinResult);
+			STypeInfo * pTinOperand = PTinStripQualifiers(pStnodOperand->m_pTin);
 
-					CSTNode * pStnodFor = pStnod;
-					if (pStfor->m_iStnodDecl >= 0)
-					{
-						(void) PValGenerate(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodDecl), VALGENK_Instance);
-					}
+			pTinOutput = PTinStripEnumToLoose(pTinOutput);
+			pTinOperand = PTinStripEnumToLoose(pTinOperand);
 
-					BUILD::Proc * pProc = pBuild->m_pProcCur;
-					BUILD::Block *	pBlockBody = pBuild->PBlockCreate(pProc, "fbody");
-					BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "fpost");
+			if (!EWC_FVERIFY((pTinOutput != nullptr) & (pTinOperand != nullptr), "bad cast"))
+				return nullptr;
+	
+			BUILD::Value * pValOp = nullptr;
 
-					BUILD::Block *	pBlockPred = pBlockBody;
-					CSTNode * pStnodPred = pStnodFor->PStnodChildSafe(pStfor->m_iStnodPredicate);
-					if (pStnodPred)
-					{
-						pBlockPred = pBuild->PBlockCreate(pProc, "fpred");
-					}
+			bool fIsSigned = true;
+			TINK tink = pTinOutput->m_tink;
+			if (pTinOutput->m_tink == TINK_Literal)
+			{
+				STypeInfoLiteral * pTinlit = (STypeInfoLiteral *)pTinOutput;
+				fIsSigned = pTinlit->m_litty.m_fIsSigned;
+				switch (pTinlit->m_litty.m_litk)
+				{
+				case LITK_Integer:	tink = TINK_Integer;	break;
+				case LITK_Float:	tink = TINK_Float;		break;
+				case LITK_Enum:		tink = TINK_Enum;		break;
+				default:			tink = TINK_Nil;
+				}
+			}
+			else if (pTinOutput->m_tink == TINK_Integer)
+			{
+				fIsSigned = ((STypeInfoInteger *)pTinOutput)->m_fIsSigned;
+			}
 
-					BUILD::Block * pBlockIncrement = pBlockPred;
-					CSTNode * pStnodIncrement = pStnodFor->PStnodChildSafe(pStfor->m_iStnodIncrement);
-					if (pStnodIncrement)
-					{
-						pBlockIncrement = pBuild->PBlockCreate(pProc, "finc");
-					}
+			if (FIsSimdStruct(pTinOperand) && ((tok == TOK('-')) | (tok == TOK('~'))))
+			{
+				auto pTinstruct = (STypeInfoStruct *)pTinOperand;
+				IROP irop = IROP_Not;
+				if (tok == TOK('-'))
+				{
+					irop = (PTinStripQualifiers(pTinstruct->PTinLane())->m_tink == TINK_Float) ? IROP_GNeg : IROP_NNeg;
+				}
+				return pBuild->PInstCreateLaneOp(irop, 0, pTinstruct, pValOperand, nullptr, "laneUnary");
+			}
 
-					pBuild->CreateBranch(pBlockPred);	
+			switch ((u32)pStnod->m_tok)
+			{
+			case '!':				
+				{
+					EWC_ASSERT(tink == TINK_Bool, "expected value cannot be cast to bool for '!' operand");
 
-					if (pStnodPred)
-					{
-						pBuild->ActivateBlock(pBlockPred);
+					// OPTIMIZE: could probably save an instruction here by not comparing (for the cast to bool)
+					//  then inverting with a FNot
 
-						STypeInfo * pTinBool = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strBool);
-						GeneratePredicate(pWork, pBuild, pStnodPred, pBlockBody, pBlockPost, pTinBool);
+					auto pValOperandCast = PValCreateCast(pWork, pBuild, pValOperand, pTinOperand, pTinOutput);
+					if (!pValOperandCast)
+					{
+						EmitError(pWork, &pStnod->m_lexloc, ERRID_BadCastGen, "INTERNAL ERROR: trying to codegen unsupported numeric cast.");
+						return nullptr;
 					}
 
-					auto pJumpt = pBuild->m_aryJumptStack.AppendNew();
-					pJumpt->m_pBlockBreak = pBlockPost;
-					pJumpt->m_pBlockContinue = (pStnodIncrement) ? pBlockIncrement : pBlockBody;
-					if (pStnodFor->m_pStident)
+					pValOp = pBuild->PInstCreate(IROP_FNot, pValOperandCast, "NCmpEq");
+				} break;
+			case '+':
+				{
+					pValOp = pValOperand;
+				} break;
+			case '~':
+				{
+					switch (tink)
 					{
-						pJumpt->m_strLabel = pStnodFor->m_pStident->m_str;
+					case TINK_Integer : pValOp = pBuild->PInstCreate(IROP_Not, pValOperand, "NNot"); break;
+					default: EWC_ASSERT(false, "unexpected type '%s' for bitwise not operator", PChzFromTink(tink));
 					}
 
-					pBuild->ActivateBlock(pBlockBody);
-					(void) PValGenerate(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodBody), VALGENK_Instance);
-
-					pBuild->CreateBranch(pBlockIncrement);	
-					pBuild->m_aryJumptStack.PopLast();
-
-					if (pStnodIncrement)
+				} break;
+			case '-':
+				{
+					switch (tink)
 					{
-
-						pBuild->ActivateBlock(pBlockIncrement);
-						(void) PValGenerate(pWork, pBuild, pStnodIncrement, VALGENK_Instance);
-
-						pBuild->CreateBranch(pBlockPred);	
+					case TINK_Float:	pValOp = pBuild->PInstCreate(IROP_GNeg, pValOperand, "GNeg"); break;
+					case TINK_Integer:	pValOp = pBuild->PInstCreate(IROP_NNeg, pValOperand, "NNeg"); break;
+					default: EWC_ASSERT(false, "unexpected type '%s' for negate operator", PChzFromTink(tink));
 					}
-
-					pBuild->ActivateBlock(pBlockPost);
-
 				} break;
-			case RWORD_ForEach:
+			case TOK_Dereference:
 				{
-					auto pStfor = PStmapRtiCast<CSTFor *>(pStnod->m_pStmap);
-					if (!EWC_FVERIFY(pStfor, "bad for_each loop"))
-						return nullptr;
-
-					EmitLocation(pWork, pBuild, pStnod->m_lexloc);
-
-					CSTNode * pStnodFor = pStnod;
-					if (pStfor->m_iStnodDecl >= 0)
+					if (valgenk != VALGENK_Reference)
 					{
-						(void) PValGenerate(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodDecl), VALGENK_Instance);
+						pValOp = pBuild->PInstCreate(IROP_Load, pValOperand, "Deref");
 					}
-					else if (pStfor->m_iStnodInit >= 0 && pStfor->m_iStnodIterator >= 0)
+					else
 					{
-						auto pStnodIterator = pStnodFor->PStnodChild(pStfor->m_iStnodIterator);
-						auto pStnodInit = pStnodFor->PStnodChild(pStfor->m_iStnodInit);
-
-						auto pValIterator = PValGenerate(pWork, pBuild, pStnodIterator, VALGENK_Reference);
-						(void) PInstGenerateAssignment(pWork, pBuild, pStnodIterator->m_pTin, pValIterator, pStnodInit);
+						pValOp = pValOperand;
 					}
+				} break;
+			case TOK_PlusPlus:
+			case TOK_MinusMinus:
+				{
+					if (!EWC_FVERIFY((pTinOutput == pTinOperand), "increment type mismatch (?)"))
+						return nullptr;
+			
+					BUILD::Instruction * pInstLoad = pBuild->PInstCreate(IROP_Load, pValOperand, "IncLoad");
+					BUILD::Instruction * pInstAdd = nullptr;
+					switch (tink)
+					{
+					case TINK_Float:	
+						{
+							auto pConst = pBuild->PConstFloat(1.0f, ((STypeInfoFloat *)pTinOperand)->m_cBit);
 
-					BUILD::Proc * pProc = pBuild->m_pProcCur;
-					BUILD::Block *	pBlockPred = pBuild->PBlockCreate(pProc, "fpred");
-					BUILD::Block *	pBlockBody = pBuild->PBlockCreate(pProc, "fbody");
-					BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "fpost");
-					BUILD::Block * pBlockIncrement = pBuild->PBlockCreate(pProc, "finc");
-					pBuild->CreateBranch(pBlockPred);	
-
-					pBuild->ActivateBlock(pBlockPred);
-
-					CSTNode * pStnodPred = pStnodFor->PStnodChild(pStfor->m_iStnodPredicate);
+							if (pStnod->m_tok == TOK_PlusPlus)
+								pInstAdd = pBuild->PInstCreate(IROP_GAdd, pInstLoad, pConst, "gInc");
+							else
+								pInstAdd = pBuild->PInstCreate(IROP_GSub, pInstLoad, pConst, "gDec");
 
-					STypeInfo * pTinBool = pStnodPred->m_pTin;
-					EWC_ASSERT(pTinBool->m_tink == TINK_Bool, "expected bool type for for loop predicate");
+						} break;
+					case TINK_Enum:
+					case TINK_Integer:
+						{
+							auto pTinint = (STypeInfoInteger *)pTinOperand;
+							auto pConst = pBuild->PConstInt(1, pTinint->m_cBit, fIsSigned);
 
-					// NOTE: we're swapping the true/false blocks here because the predicate is reversed, ie fIsDone
-					GeneratePredicate(pWork, pBuild, pStnodPred, pBlockPost, pBlockBody, pTinBool);
+							if (pStnod->m_tok == TOK_PlusPlus)
+								pInstAdd = pBuild->PInstCreate(IROP_NAdd, pInstLoad, pConst, "gInc");
+							else
+								pInstAdd = pBuild->PInstCreate(IROP_NSub, pInstLoad, pConst, "gDec");
+						} break;
+					case TINK_Pointer:
+						{
+							int nDelta = (pStnod->m_tok == TOK_PlusPlus) ? 1 : -1;
+							auto pConstDelta = pBuild->PConstInt(nDelta, 64, true);
+							BUILD::GepIndex * pGepIndex = pBuild->PGepIndexFromValue(pConstDelta);
 
-					auto pJumpt = pBuild->m_aryJumptStack.AppendNew();
-					pJumpt->m_pBlockBreak = pBlockPost;
-					pJumpt->m_pBlockContinue = pBlockIncrement;
-					if (pStnodFor->m_pStident)
-					{
-						pJumpt->m_strLabel = pStnodFor->m_pStident->m_str;
+							auto pValLoad = pBuild->PInstCreate(IROP_Load, pValOperand, "incLoad");
+							pInstAdd = pBuild->PInstCreateGEP(pValLoad, &pGepIndex, 1, "incGep");
+						} break;
+					default: EWC_ASSERT(false, "unexpected type '%s' for increment/decrement operator", PChzFromTink(tink));
 					}
 
-					pBuild->ActivateBlock(pBlockBody);
-					(void) PValGenerate(pWork, pBuild, pStnodFor->PStnodChild(pStfor->m_iStnodBody), VALGENK_Instance);
-					pBuild->CreateBranch(pBlockIncrement);	
-					pBuild->m_aryJumptStack.PopLast();
-
-					pBuild->ActivateBlock(pBlockIncrement);
-					CSTNode * pStnodIncrement = pStnodFor->PStnodChild(pStfor->m_iStnodIncrement);
-					(void) PValGenerate(pWork, pBuild, pStnodIncrement, VALGENK_Instance);
-
-					pBuild->CreateBranch(pBlockPred);	
-
-					pBuild->ActivateBlock(pBlockPost);
+					(void) pBuild->PInstCreateStore(pValOperand, pInstAdd);
+					pValOp = (pStnod->m_park == PARK_PostfixUnaryOp) ? pInstLoad : pInstAdd;
+				}
+			default: break;
+			}
 
-				} break;
-			case RWORD_While:
-				{
-					if (pStnod->CStnodChild() < 2)
-						return nullptr;
+			EWC_ASSERT(
+				pValOp != nullptr,
+				"bad operand '%s' for type '%s'",
+				PCozFromTok(pStnod->m_tok),
+				PChzFromTink(tink));
 
-					EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+			EmitLocation(pWork, pBuild, pStnod->m_lexloc);
 
-					BUILD::Proc * pProc = pBuild->m_pProcCur;
-					BUILD::Block * pBlockPred = pBuild->PBlockCreate(pProc, "wpred");
-					BUILD::Block * pBlockBody = pBuild->PBlockCreate(pProc, "wbody");
-					BUILD::Block * pBlockPost = pBuild->PBlockCreate(pProc, "wpost");
-					pBuild->CreateBranch(pBlockPred);	
+			return pValOp;
+		}
+	case PARK_Typedef:
+		{
+			auto pSym = pStnod->PSym();
+			if (!EWC_FVERIFY(pSym, "typedef symbol not resolved before codeGen"))
+				return  nullptr;
 
-					pBuild->ActivateBlock(pBlockPred);
+			auto pDif = PDifEnsure(pWork, pBuild, pStnod->m_lexloc.m_strFilename);
+			auto pLvalScope = PLvalFromDIFile(pBuild, pDif);
 
-					// BB - should handle declarations inside conditional statement? ie, does it need a new block
+			s32 iLine, iCol;
+			CalculateLinePosition(pWork, &pStnod->m_lexloc, &iLine, &iCol);
 
-					CSTNode * pStnodWhile = pStnod;
-					CSTNode * pStnodPred = pStnodWhile->PStnodChild(0);
+			CreateDebugInfo(pWork, pBuild, pStnod, pSym->m_pTin);
 
-					STypeInfo * pTinBool = pStnodWhile->m_pTin;
-					EWC_ASSERT(pTinBool->m_tink == TINK_Bool, "expected bool type for while predicate");
+			auto strPunyName = StrPunyEncode(pSym->m_strName.PCoz());
 
-					GeneratePredicate(pWork, pBuild, pStnodPred, pBlockBody, pBlockPost, pTinBool);
+			DInfoCreateTypedef(pBuild, pSym->m_pTin, strPunyName.PCoz(), pDif, iLine, pLvalScope);
+		} break;
+	case PARK_StructDefinition:
+	case PARK_EnumDefinition:
+	case PARK_Nop: 
+		break;
+	default:
+		EWC_ASSERT(false, "unhandled PARK (%s) in code generation.", PChzFromPark(pStnod->m_park));
+	}
+	return nullptr;
+}
 
-					pBuild->ActivateBlock(pBlockBody);
+CIRBlock * CBuilderIR::PBlockCreate(CIRProcedure * pProc, const char * pChzName)
+{
+	CIRBlock * pBlock = EWC_NEW(m_pAlloc, CIRBlock) CIRBlock(m_pAlloc);
 
-					auto pJumpt = pBuild->m_aryJumptStack.AppendNew();
-					pJumpt->m_pBlockBreak = pBlockPost;
-					pJumpt->m_pBlockContinue = pBlockPred;
-					if (pStnodWhile->m_pStident)
-					{
-						pJumpt->m_strLabel = pStnodWhile->m_pStident->m_str;
-					}
+	EWC_ASSERT(pProc->m_pLval, "expected function value");
+	auto pLblock = LLVMAppendBasicBlock(pProc->m_pLval, pChzName);
+	pBlock->m_pLblock = pLblock;
 
-					(void) PValGenerate(pWork, pBuild, pStnodWhile->PStnodChild(1), VALGENK_Instance);
-					pBuild->m_aryJumptStack.PopLast();
+	if (EWC_FVERIFY(pProc, "missing procedure in PBlockCreate"))
+	{
+		pProc->m_arypBlockManaged.Append(pBlock);
+	}
+	return pBlock;
+}
 
-					pBuild->CreateBranch(pBlockPred);	
+void CBuilderIR::ActivateProc(CIRProcedure * pProc, CIRBlock * pBlock)
+{
+	if (m_pProcCur)
+	{
+		m_pProcCur->m_pLvalDebugLocCur = LLVMGetCurrentDebugLocation(m_pLbuild);
+	}
 
+	m_pProcCur = pProc;
 
-					pBuild->ActivateBlock(pBlockPost);
+	if (pProc)
+	{
+		LLVMSetCurrentDebugLocation(m_pLbuild, pProc->m_pLvalDebugLocCur);
+	}
+	ActivateBlock(pBlock);
+}
 
-				} break;
-			case RWORD_Return:
-				{
-					EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+void CBuilderIR::ActivateBlock(CIRBlock * pBlock)
+{
+	if (pBlock == m_pBlockCur)
+		return;
 
-					BUILD::Value * pValRhs = nullptr;
-					if (pStnod->CStnodChild() == 1)
-					{
-						pValRhs = PValGenerate(pWork, pBuild, pStnod->PStnodChild(0), VALGENK_Instance);
-					}
+	if (pBlock)
+	{
+		EWC_ASSERT(pBlock->m_pLblock, "bad block ptr");
+		auto pLvalBlockParent = LLVMGetBasicBlockParent(pBlock->m_pLblock);
 
-					pBuild->CreateReturn(&pValRhs, 1, "retTmp");
+		EWC_ASSERT(pLvalBlockParent == m_pProcCur->m_pLval, "block with multiple parents?");
+		LLVMPositionBuilder(m_pLbuild, pBlock->m_pLblock, nullptr);
+	}
 
-				} break;
-			case RWORD_Break:
-			case RWORD_Continue:
-				{
-					BUILD::Block * pBlock = nullptr;
-					CString * pString = nullptr;
-					if (pStnod->m_pStident)
-					{
-						pString = &pStnod->m_pStident->m_str;
-					}
+	m_pBlockCur = pBlock;
+}
 
-					if (rword == RWORD_Break)
-					{
-						for (int iJumpt = (int)pBuild->m_aryJumptStack.C(); --iJumpt >= 0; )
-						{
-							auto pJumpt = &pBuild->m_aryJumptStack[iJumpt];
-							if (pJumpt->m_pBlockBreak && (pString == nullptr || pJumpt->m_strLabel == *pString))
-							{
-								pBlock = pJumpt->m_pBlockBreak;
-								break;
-							}
-						}
-					}
-					else //RWORD_Continue
-					{
-						for (size_t iJumpt = pBuild->m_aryJumptStack.C()-1; true; --iJumpt)
-						{
-							auto pJumpt = &pBuild->m_aryJumptStack[iJumpt];
-							if (pJumpt->m_pBlockContinue && (pString == nullptr || pJumpt->m_strLabel == *pString))
-							{
-								pBlock = pJumpt->m_pBlockContinue;
-								break;
-							}
-						}
-					}
+CBuilderIR::LType * CBuilderIR::PLtypeVoid()
+{
+	return LLVMVoidType();
+}
 
-					if (pBlock)
-					{
-						pBuild->CreateBranch(pBlock);	
-					}
-					else
-					{
-						if (pString)
-						{
-							EmitError(pWork, &pStnod->m_lexloc, ERRID_UnknownError,
-								"Could not %s to label matching '%s'", PCozFromRword(rword), pString->PCoz());
-						}
-						else
-							EmitError(pWork, &pStnod->m_lexloc, ERRID_UnknownError,
-								"Encountered %s statement outside of a loop or switch", PCozFromRword(rword));
-					}
+static CSTNode * PStnodMemberInit(STypeStructMember * pTypememb)
+{
+	CSTNode * pStnodDecl = pTypememb->m_pStnod;
+	if (!EWC_FVERIFY(pStnodDecl && pStnodDecl->m_park == PARK_Decl, "expected member declaration"))
+		return nullptr;
 
-				} break;
-			default:
-				EWC_ASSERT(false, "Unhandled reserved word in code gen %s", PCozFromRword(rword));
-				break;
-			}
-		} break;
-	case PARK_ProcedureCall:
-		{
-			auto pStnodTarget = pStnod->PStnodChildSafe(0);
-			STypeInfoProcedure * pTinproc = (pStnodTarget) ? PTinRtiCast<STypeInfoProcedure *>(pStnodTarget->m_pTin) : nullptr;
+	auto pStdecl = PStmapDerivedCast<CSTDecl *>(pStnodDecl->m_pStmap);
+	return pStnodDecl->PStnodChildSafe(pStdecl->m_iStnodInit);
+}
 
-			if (!EWC_FVERIFY(pTinproc, "expected type info procedure"))
-				return nullptr;
-	
-			CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
+BCode::SProcedure * PProcCodegenInitializer(CWorkspace * pWork, BCode::CBuilder * pBuild, CSTNode * pStnodStruct)
+{
+	STypeInfoStruct * pTinstruct = PTinDerivedCast<STypeInfoStruct *>(pStnodStruct->m_pTin);
+	if (!pTinstruct)
+		return nullptr;
 
-			size_t cStnodArgs = pStnod->CStnodChild() - 1; // don't count the identifier
-			for (size_t iStnodChild = 0; iStnodChild < cStnodArgs; ++iStnodChild)
-			{
-				CSTNode * pStnodArg = pStnod->PStnodChild((int)iStnodChild + 1);
-				if (pStnodArg->m_park == PARK_TypeArgument)
-					continue;
+	if (!pTinstruct->m_pTinprocInit)
+	{
+		char aChName[128];
+		EWC::SStringBuffer strbufName(aChName, EWC_DIM(aChName));
+		auto strPunyName = StrPunyEncode(pTinstruct->m_strName.PCoz());
+		FormatCoz(&strbufName, "__%s_INIT", strPunyName.PCoz());
 
-				STypeInfo * pTinParam = pStnodArg->m_pTin;
-				if (iStnodChild < pTinproc->m_arypTinParams.C())
-				{
-					pTinParam = pTinproc->m_arypTinParams[iStnodChild];
-				}
+		auto pTinproc = PTinprocAlloc(pWork->m_pSymtab, 1, 0, aChName);
+		pTinstruct->m_pTinprocInit = pTinproc;
+		pTinproc->m_strMangled = aChName;
+		pTinproc->m_arypTinParams.Append(pWork->m_pSymtab->PTinptrAllocate(pTinstruct));
+		pTinproc->m_grftinproc.AddFlags(FTINPROC_Initializer);
+	}
 
-				auto pValRhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodArg, pTinParam);
+	auto pTinproc = pTinstruct->m_pTinprocInit;
+	auto pProc = pBuild->PProcCreateImplicit(pWork, pTinproc, nullptr);
+	auto pProcsig = pProc->m_pProcsig;
 
-				arypLvalArgs.Append(pBuild->PProcArg(pValRhsCast));
-				if (!EWC_FVERIFY(*arypLvalArgs.PLast(), "missing argument value"))
-					return nullptr;
-			}
+	auto pBlockPrev = pBuild->m_pBlockCur;
+	auto pProcPrev = pBuild->m_pProcCur;
 
-			bool fIsDirectCall = FIsDirectCall(pStnod);
-			return pBuild->PValGenerateCall(pWork, pStnod, pStnod->PSym(), &arypLvalArgs, fIsDirectCall, pTinproc, valgenk);
-		} 
+	pBuild->ActivateProc(nullptr, nullptr);
+	pBuild->ActivateProc(pProc, pProc->m_pBlockFirst);
 
-	case PARK_Identifier:
-		{
-#if 1
-			SSymbol ** ppSymMin = nullptr;
-			SSymbol ** ppSymMax = nullptr;
-			if (pStnod->m_pSymbase)
-			{
-				switch (pStnod->m_pSymbase->m_symk)
-				{
-				case SYMK_Symbol:
-					{
-						ppSymMin = (SSymbol**)&pStnod->m_pSymbase;
-						ppSymMax = ppSymMin+1;
+	// setup 'this' arg
+	auto pValPThis = pBuild->PValCreateAlloca(pTinproc->m_arypTinParams[0], "this");
+	(void) pBuild->PInstCreateStore(pValPThis, pBuild->PRegArg(pProcsig->m_aParamArg[0].m_iBStack, pTinproc->m_arypTinParams[0]));
+	auto pValThis = pBuild->PInstCreate(IROP_Load, pValPThis);
 
-					} break;
-				case SYMK_Path:
-					{
-						auto pSymp = (SSymbolPath *)pStnod->m_pSymbase;
-						ppSymMin = pSymp->m_arypSym.A();
-						ppSymMax = pSymp->m_arypSym.PMac();
-					} break;
-				default: break;
-				}
-			}
+	BCode::SValue * apValIndex[2] = {};
+	apValIndex[0] = pBuild->PConstInt(0, 32, false);
 
-			if (ppSymMin == ppSymMax)
-			{
-				CString strName(StrFromIdentifier(pStnod));
-				EmitError(pWork, &pStnod->m_lexloc, ERRID_UnknownError, "INTERNAL ERROR: Missing value for symbol %s", strName.PCoz());
-			}
+	int cTypemembField = (int)pTinstruct->m_aryTypemembField.C();
+	for (int iTypememb = 0; iTypememb < cTypemembField; ++iTypememb)
+	{
+		apValIndex[1] = pBuild->PConstInt(iTypememb, 32, false);
 
-			auto pSymLeft = *ppSymMin;
-			++ppSymMin;
-			BUILD::Value * pValLhs = PValFromIdentifierSym(pWork, pBuild, pSymLeft, VALGENK_Reference);
-			return PValGenerateSymbolPath(pWork, pBuild, pSymLeft->m_pTin, pValLhs, ppSymMin, ppSymMax, valgenk);
+		// use the member's own declaration, fields in #reorder structs don't follow the member list order
+		auto pTypememb = &pTinstruct->m_aryTypemembField[iTypememb];
+		CSTNode * pStnodInit = PStnodMemberInit(pTypememb);
 
-#else
-			BUILD::Value * pVal = nullptr;
-			if (pStnod->m_pSymbase)
-			{
-				pVal = PValForSymbase(pBuild, pStnod->m_pSymbase, VALGENK_Reference);
-			}
+		auto pInstGEP = pBuild->PInstCreateGEP(pValThis, apValIndex, 2, "initGEP");
+		(void)PValInitialize(pWork, pBuild, pTypememb->m_pTin, pInstGEP, pStnodInit);
+	}
 
-			if (!pVal)
-			{
-				CString strName(StrFromIdentifier(pStnod));
-				EmitError(pWork, &pStnod->m_lexloc, ERRID_UnknownError, "INTERNAL ERROR: Missing value for symbol %s", strName.PCoz());
-			}
+	pBuild->CreateReturn(nullptr, 0);
+	pBuild->FinalizeProc(pProc);
 
-			if (!EWC_FVERIFY(pVal, "unknown identifier in codegen"))
-				return nullptr;
+	pBuild->ActivateProc(nullptr, nullptr);
+	pBuild->ActivateProc(pProcPrev, pBlockPrev);
 
-			bool fIsProcedureRef = FIsProcedure(pVal);
-			auto valgenkSym = fIsProcedureRef ? VALGENK_Instance : VALGENK_Reference;
-			if (valgenk == VALGENK_Instance)
-			{
-				if (!fIsProcedureRef)
-				{
-					auto pSym = pStnod->PSym();
-					auto strPunyName = StrPunyEncode(pSym->m_strName.PCoz());
-					return pBuild->PInstCreate(IROP_Load, pVal, strPunyName.PCoz());
-				}
-			}
-			else if (valgenk == VALGENK_Reference)
-			{
-				ASSERT_STNOD(pWork, pStnod, valgenkSym == VALGENK_Reference, "Cannot return reference for instance symbol type");
-			}
-			return pVal;
-#endif
-		}
-	case PARK_MemberLookup:
-		{
-			CSTNode * pStnodRhs = pStnod->PStnodChild(1);
-			SSymbol ** ppSymMin = nullptr;
-			SSymbol ** ppSymMax = nullptr;
-			if (pStnodRhs->m_pSymbase)
-			{
-				switch (pStnodRhs->m_pSymbase->m_symk)
-				{
-				case SYMK_Symbol:
-					{
-						ppSymMin = (SSymbol**)&pStnodRhs->m_pSymbase;
-						ppSymMax = ppSymMin+1;
+	return pProc;
+}
 
-					} break;
-				case SYMK_Path:
-					{
-						auto pSymp = (SSymbolPath *)pStnodRhs->m_pSymbase;
-						ppSymMin = pSymp->m_arypSym.A();
-						ppSymMax = pSymp->m_arypSym.PMac();
-					} break;
-				default: break;
-				}
-			}
+CIRProcedure * PProcCodegenInitializer(CWorkspace * pWork, CBuilderIR * pBuild, CSTNode * pStnodStruct)
+{
+	STypeInfoStruct * pTinstruct = PTinDerivedCast<STypeInfoStruct *>(pStnodStruct->m_pTin);
+	if (!pTinstruct)
+		return nullptr;
 
-			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
-			auto pTinLhs = pStnodLhs->m_pTin;
-			VALGENK valgenkLhs = VALGENK_Reference;
-			if (pTinLhs)
-			{
-				if (pTinLhs->m_tink == TINK_Pointer)
-				{
-					pTinLhs = ((STypeInfoPointer *)pTinLhs)->m_pTinPointedTo;
-					valgenkLhs = VALGENK_Instance;
-				}
-			}
-			BUILD::Value * pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, valgenkLhs);
+	LLVMOpaqueType * pLtypeVoid = LLVMVoidType();
+	LLVMOpaqueType * apLtype[1];
+	apLtype[0] = LLVMPointerType(pBuild->PLtypeFromPTin(pTinstruct), 0);
+	auto pLtypeFunction = LLVMFunctionType(pLtypeVoid, apLtype, 1, false);
 
-			// implicit array members don't have a symbol for the RHS
-			CString strMemberName = StrFromIdentifier(pStnod->PStnodChild(1));
-			if (pTinLhs && pTinLhs->m_tink == TINK_Array)
-			{
-				auto pTinary = (STypeInfoArray *)pTinLhs;
-				ARYMEMB arymemb = ArymembLookup(strMemberName.PCoz());
-				return PValFromArrayMember(pWork, pBuild, pValLhs, pTinary, arymemb, valgenk);
-			}
-			if (pTinLhs && pTinLhs->m_tink == TINK_Literal)
-			{
-				auto pTinlit = (STypeInfoLiteral *)pTinLhs;
-				BUILD::Global ** ppGlob = pBuild->m_hashPTinlitPGlob.Lookup(pTinlit);
-				if (EWC_FVERIFY(ppGlob, "expected global instance for array literal"))
-				{
-					// BB - cleanup this (BUILD::Global *) cast
-					BUILD::Global * pGlobLit = (BUILD::Global *)*ppGlob;
+	char aChName[128];
+	EWC::SStringBuffer strbufName(aChName, EWC_DIM(aChName));
+	auto strPunyName = StrPunyEncode(pTinstruct->m_strName.PCoz());
+	FormatCoz(&strbufName, "__%s_INIT", strPunyName.PCoz());
 
-					if (FIsArrayLiteral(pTinlit))
-					{
-						ARYMEMB arymemb = ArymembLookup(strMemberName.PCoz());
+	LLVMOpaqueValue * pLvalFunc = LLVMAddFunction(pBuild->m_pLmoduleCur, aChName, pLtypeFunction);
+	LLVMSetLinkage(pLvalFunc, LLVMPrivateLinkage);
 
-						EWC_ASSERT(valgenk == VALGENK_Instance, "expected instance");
-						if (arymemb == ARYMEMB_Count)
-						{
-							return pBuild->PConstInt(pTinlit->m_c, 64, true);
-						}
+	CAlloc * pAlloc = pBuild->m_pAlloc;
+	CIRProcedure * pProc = EWC_NEW(pAlloc, CIRProcedure) CIRProcedure(pAlloc);
+	pBuild->AddManagedVal(pProc);
 
-						// the type of aN.data is &N so a reference would need to be a &&N which we don't have
-						EWC_ASSERT(arymemb == ARYMEMB_Data, "unexpected array member '%s'", PChzFromArymemb(arymemb));
-						auto pTinary = PTinDerivedCast<STypeInfoArray *>(PTinStripQualifiers(pTinlit->m_pTinSource));
-						auto pTinptr = pWork->m_pSymtab->PTinptrAllocate(pTinary->m_pTin);
+	auto pCgstruct = pBuild->PCgstructEnsure(pTinstruct);
+	pCgstruct->m_pProcInitMethod = pProc;
 
-						return pBuild->PInstCreateCast(IROP_Bitcast, pGlobLit, pTinptr, "Bitcast");
-					}
-					return pGlobLit;
-				}
-			}
+	pProc->m_pLval = pLvalFunc;
+	pProc->m_pBlockFirst = pBuild->PBlockCreate(pProc, aChName);
+	
+	auto pBlockPrev = pBuild->m_pBlockCur;
+	auto pProcPrev = pBuild->m_pProcCur;
 
-			return PValGenerateSymbolPath(pWork, pBuild, pTinLhs, pValLhs, ppSymMin, ppSymMax, valgenk);
-		}
-	case PARK_ArrayElement:
-		{ 
-			if (!EWC_FVERIFY(pStnod->CStnodChild() == 2, "expected (array, index) for array element node"))
-				return nullptr;
+	pBuild->ActivateProc(pProc, pProc->m_pBlockFirst);
 
-			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
-			CSTNode * pStnodIndex = pStnod->PStnodChild(1);
+	if (pBuild->FEmitsDebugLines())
+	{ // create debug info
+		LLVMValueRef pLvalDIType = nullptr;
+		if (pBuild->FEmitsDebugTypes())
+		{
+			CreateDebugInfo(pWork, pBuild, pStnodStruct, pTinstruct);
 
-			BUILD::Value * pValLhs;
-			auto pValIndex = PValGenerate(pWork, pBuild, pStnodIndex, VALGENK_Instance);
-			if (!EWC_FVERIFY(!FIsNull(pValIndex), "null index llvm value"))
-				return nullptr;
+			int cpTinParam = 1;
+			LLVMValueRef apLvalParam[1];
 
-			BUILD::GepIndex * apLvalIndex[2] = {};
-			TINK tinkLhs = PTinStripQualifiers(pStnodLhs->m_pTin)->m_tink;
-			int cpLvalIndex = 0;
+			u64 cBitSize = LLVMPointerSize(pBuild->m_pTargd) * 8;
+			u64 cBitAlign = cBitSize;
+			apLvalParam[0] = LLVMDIBuilderCreatePointerType(pBuild->m_pDib, (LLVMValueRef)pTinstruct->m_pCgvalDIType, cBitSize, cBitAlign, "");
 
-			if (tinkLhs == TINK_Literal)
-			{
-				auto pTinlit = PTinDerivedCast<STypeInfoLiteral *>(pStnodLhs->m_pTin);
-				EWC_ASSERT(FIsArrayLiteral(pTinlit), "non-array literal being indexed like an array, missed during typecheck?");
+			pLvalDIType = LLVMDIBuilderCreateFunctionType(pBuild->m_pDib, apLvalParam, cpTinParam, cBitSize, cBitAlign);
+		}
 
-				pValLhs = PValGenerateArrayLiteralReference(pWork, pBuild, pStnodLhs);
-				apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(0);
-				apLvalIndex[cpLvalIndex++] = pBuild->PGepIndexFromValue(pValIndex);
-			}
-			else if (tinkLhs == TINK_Array)
-			{
-				auto pTinary = (STypeInfoArray *)pStnodLhs->m_pTin;
-				pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, VALGENK_Reference);
+		pProc->m_pLvalDIFunction = PLvalCreateDebugFunction(
+										pWork,
+										pBuild,
+										aChName,
+										aChName,
+										pStnodStruct,
+										pStnodStruct,
+										pLvalDIType,
+										pProc->m_pLval);
 
-				if (pTinary->m_aryk != ARYK_Fixed)
-				{
-					pValLhs = PValFromArrayMember(pWork, pBuild, pValLhs, pTinary, ARYMEMB_Data, VALGENK_Instance);	// BB - why is this instance??
-				}
-				else
-				{
-					apLvalIndex[cpLvalIndex++] = pBuild->PGepIndex(0);
-				}
-				apLvalIndex[cpLvalIndex++] = pBuild->PGepIndexFromValue(pValIndex);
-			}
-			else if (tinkLhs == TINK_Pointer)
-			{
-				pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, VALGENK_Instance);
-				apLvalIndex[0] = pBuild->PGepIndexFromValue(pValIndex);
-				cpLvalIndex = 1;
-			}
-			else
-			{
-				EWC_ASSERT(false, "unexpected type on left hand side of array element");
-				return nullptr;
-			}
+		s32 iLine, iCol;
+		CalculateLinePosition(pWork, &pStnodStruct->m_lexloc, &iLine, &iCol);
 
-			auto pInst = pBuild->PInstCreateGEP(pValLhs, apLvalIndex, cpLvalIndex, "aryGep");
+		pProc->m_pLvalDebugLocCur = LLVMCreateDebugLocation(pBuild->m_pLbuild, iLine, iCol, pProc->m_pLvalDIFunction);
+		LLVMSetCurrentDebugLocation(pBuild->m_pLbuild, pProc->m_pLvalDebugLocCur);
+	}
 
-			if (EWC_FVERIFY(pInst, "unknown identifier in codegen") && valgenk != VALGENK_Reference)
-			{
-				return pBuild->PInstCreate(IROP_Load, pInst, "aryLoad");
-			}
-			return pInst;
-		} break;
-	case PARK_LogicalAndOrOp:
-		{
-			// BB - What is the right thing here, C++ logical op overloads don't short circuit, C# breaks
-			// it into two operators (false and &)
+	// load our 'this' argument
+	int cpLvalParams = LLVMCountParams(pProc->m_pLval);
+	EWC_ASSERT(cpLvalParams == 1, "only expected 'this' parameter");
 
-			auto pTinBool = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strBool);
-			auto pLtypeBool = pBuild->PLtypeFromPTin(pTinBool);
+	auto apLvalParam = (LLVMValueRef *)alloca(sizeof(LLVMValueRef) * cpLvalParams);
+	LLVMGetParams(pProc->m_pLval, apLvalParam);
+	LLVMSetValueName(apLvalParam[0], "this");
 
-			BUILD::Proc * pProc = pBuild->m_pProcCur;
-			auto pBlockTrue = pBuild->PBlockCreate(pProc, "predTrue");
-			auto pBlockFalse = pBuild->PBlockCreate(pProc, "predFalse");
-			auto pBlockPost = pBuild->PBlockCreate(pProc, "predPost");
+	CIRArgument * pArgThis = EWC_NEW(pAlloc, CIRArgument) CIRArgument();
+	pArgThis->m_pLval = apLvalParam[0];
+	pBuild->AddManagedVal(pArgThis);
 
-			GeneratePredicate(pWork, pBuild, pStnod, pBlockTrue, pBlockFalse, pTinBool);
+	LLVMOpaqueValue * apLvalIndex[2] = {};
+	apLvalIndex[0] = LLVMConstInt(LLVMInt32Type(), 0, false);
 
-			pBuild->ActivateBlock(pBlockTrue);
-			auto pValTrue = pBuild->PConstInt(1, 1, false);
-			pBuild->CreateBranch(pBlockPost);	
+	int cTypemembField = (int)pTinstruct->m_aryTypemembField.C();
+	for (int iTypememb = 0; iTypememb < cTypemembField; ++iTypememb)
+	{
+		apLvalIndex[1] = LLVMConstInt(LLVMInt32Type(), iTypememb, false);
 
-			pBuild->ActivateBlock(pBlockFalse);
-			auto pValFalse = pBuild->PConstInt(0, 1, false);
-			pBuild->CreateBranch(pBlockPost);	
+		auto pTypememb = &pTinstruct->m_aryTypemembField[iTypememb];
+		CSTNode * pStnodInit = PStnodMemberInit(pTypememb);
 
-			pBuild->ActivateBlock(pBlockPost);
-			auto pValPhi = pBuild->PInstCreatePhi(pLtypeBool, "predPhi"); 
-			pBuild->AddPhiIncoming(pValPhi, pValTrue, pBlockTrue);
-			pBuild->AddPhiIncoming(pValPhi, pValFalse, pBlockFalse);
+		auto pInstGEP = pBuild->PInstCreateGEP(pArgThis, apLvalIndex, 2, "initGEP");
+		(void)PValInitialize(pWork, pBuild, pTypememb->m_pTin, pInstGEP, pStnodInit);
+	}
 
-			EWC_ASSERT(valgenk != VALGENK_Reference, "taking the address of a temporary (?)");
-			return pValPhi;
+	LLVMBuildRetVoid(pBuild->m_pLbuild);
+	pBuild->ActivateProc(pProcPrev, pBlockPrev);
 
-		} break;
-	case PARK_AssignmentOp:
-		{
-			if (FIsOverloadedOp(pStnod))
-			{
-				auto pTinproc = pStnod->m_pOptype->m_pTinprocOverload;
+	pBuild->m_arypProcVerify.Append(pProc);
+	return pProc;
+}
 
-				//BB - This won't work with generic procedure overloads
-				auto pSym = pTinproc->m_pStnodDefinition->PSym();
+CIRProcedure * CBuilderIR::PProcCreateImplicit(CWorkspace * pWork, STypeInfoProcedure * pTinproc, CSTNode * pStnod)
+{
+	auto pProc = EWC_NEW(m_pAlloc, CIRProcedure) CIRProcedure(m_pAlloc);
+	AddManagedVal(pProc);
 
-				CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
-				GenerateArguments(pWork, pBuild, pStnod->m_grfstnod, pTinproc, 2, pStnod->m_arypStnodChild.A(), &arypLvalArgs);
-				return pBuild->PValGenerateCall(pWork, pStnod, pSym, &arypLvalArgs, true, pTinproc, valgenk);
-			}
+	auto pLtypeFunction = LLVMFunctionType(LLVMVoidType(), nullptr, 0, false);
+	const char * pCozName = pTinproc->m_strName.PCoz();
+	pProc->m_pLval = LLVMAddFunction(m_pLmoduleCur, pCozName, pLtypeFunction);
 
-			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
-			CSTNode * pStnodRhs = pStnod->PStnodChild(1);
+	pProc->m_pBlockLocals = PBlockCreate(pProc, pCozName);
+	pProc->m_pBlockFirst = PBlockCreate(pProc, pCozName);
 
-			BUILD::Value * pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, VALGENK_Reference);
-			if (pStnod->m_tok == TOK('='))
-			{
-				if (pStnodLhs->m_pTin->m_tink == TINK_Flag)
-				{
-					STypeInfo * pTinLoose = nullptr;
-					BUILD::Constant * pConstEnum = PConstEnumLiteralFromStnod(pBuild, pStnodLhs, &pTinLoose);
-					EWC_ASSERT(pConstEnum, "failed to find constant for flag enum");
+	LLVMValueRef pLvalDIFunctionType = nullptr;
+	if (FEmitsDebugTypes())
+	{
+		u64 cBitSize = LLVMPointerSize(m_pTargd) * 8;
+		u64 cBitAlign = cBitSize;
+		pLvalDIFunctionType = LLVMDIBuilderCreateFunctionType(m_pDib, nullptr, 0, cBitSize, cBitAlign);
+	}
 
-					// set val: (n & ~flag) | (sext(rhs) & flag)
+	pProc->m_pLvalDIFunction = PLvalCreateDebugFunction(
+									pWork,
+									this,
+									pCozName,
+									nullptr,
+									pStnod,
+									pStnod,
+									pLvalDIFunctionType,
+									pProc->m_pLval);
+	return pProc;
+}
 
-					auto pTinBool = pWork->m_pSymtab->PTinBuiltin(CSymbolTable::s_strBool);
-					auto pValRhs = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodRhs, pTinBool);
+CIRValue * CBuilderIR::PValCreateProc(
+	CWorkspace * pWork,
+	STypeInfoProcedure * pTinproc,
+	const CString & strMangled,
+	CSTNode * pStnod,
+	CSTNode * pStnodBody,
+	CDynAry<LLVMOpaqueType *> * parypLtype,
+	LLVMOpaqueType * pLtypeReturn)
+{
+	bool fHasVarArgs = pTinproc->m_grftinproc.FIsSet(FTINPROC_HasVarArgs);
+	auto pProc = EWC_NEW(m_pAlloc, CIRProcedure) CIRProcedure(m_pAlloc);
+	AddManagedVal(pProc);
 
-					auto pInstSExt = pBuild->PInstCreateCast(IROP_SignExt, pValRhs, pTinLoose, "SignExt");
-					auto pInstAndRhs = pBuild->PInstCreate(IROP_And, pInstSExt, pConstEnum, "andRhs");
+	auto pLtypeFunction = LLVMFunctionType(pLtypeReturn, parypLtype->A(), (u32)parypLtype->C(), fHasVarArgs);
 
-					auto pInstLhsLoad = pBuild->PInstCreate(IROP_Load, pValLhs, "lhsLoad");
-					auto pInstNotEnum =  pBuild->PInstCreate(IROP_Not, pConstEnum, "notEn");
-					auto pInstAndLhs = pBuild->PInstCreate(IROP_And, pInstLhsLoad, pInstNotEnum, "andLhs");
+	pProc->m_pLval = LLVMAddFunction(m_pLmoduleCur, strMangled.PCoz(), pLtypeFunction);
 
-					auto pInstOr = pBuild->PInstCreate(IROP_Or, pInstAndLhs, pInstAndRhs, "orFlags");
-					return pBuild->PInstCreateStore(pValLhs, pInstOr);
-				}
+	auto pStproc = PStmapDerivedCast<CSTProcedure *>(pStnod->m_pStmap);
+	if (!EWC_FVERIFY(pStproc, "expected stproc"))
+		return nullptr;
 
-				auto pInstOp = PInstGenerateAssignment(pWork, pBuild, pStnodLhs->m_pTin, pValLhs, pStnodRhs);
-				return pInstOp;
-			}
+	if (!pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign) &&
+		!pStproc->m_grfstproc.FIsAnySet(FSTPROC_UseUnmangledName | FSTPROC_PublicLinkage))
+	{
+		LLVMSetLinkage(pProc->m_pLval, LLVMPrivateLinkage);
+	}
 
-			EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+	pProc->m_pLval = pProc->m_pLval; // why is this redundant?
 
-			auto pTinOperandRhs = (EWC_FVERIFY(pStnod->m_pOptype, "missing operator types")) ? pStnod->m_pOptype->m_pTinRhs : pStnodLhs->m_pTin;
+	if (pTinproc->m_grfisaClones != FISALEVEL_None)
+	{
+		auto pMvproc = m_aryMvproc.AppendNew();
+		pMvproc->m_pProc = pProc;
+		pMvproc->m_pTinproc = pTinproc;
+	}
 
-			auto pValLhsLoad = pBuild->PInstCreate(IROP_Load, pValLhs, "lhsLoad");
-			auto pValRhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodRhs, pTinOperandRhs);
-			EWC_ASSERT(pValRhsCast, "bad cast");
+	if (pTinproc->m_callconv != CALLCONV_Nil)
+	{
+		LLVMSetFunctionCallConv(pProc->m_pLval, CallingconvFromCallconv(pTinproc->m_callconv));
+	}
 
-			SOpTypes optype(pStnodLhs->m_pTin, pStnodRhs->m_pTin, pStnod->m_pTin);
-			auto pInstOp = PInstGenerateOperator(pBuild, pStnod->m_tok, &optype, pValLhsLoad, pValRhsCast);
-			return pBuild->PInstCreateStore(pValLhs, pInstOp);
+	CSTNode * pStnodParamList = pStnod->PStnodChildSafe(pStproc->m_iStnodParameterList);
+	if (pStnodParamList)
+	{
+		AddParamAttributes(pProc->m_pLval, pStnodParamList);
+	}
+
+	const char * pChzInlineAttr = nullptr;
+	switch (pTinproc->m_inlinek)
+	{
+		case INLINEK_NoInline:		pChzInlineAttr = "noinline"; break;
+		case INLINEK_AlwaysInline:	pChzInlineAttr = "alwaysinline";	break;
+		default: break;
+	}
+
+	if (pChzInlineAttr)
+	{
+		auto pLctx = LLVMGetModuleContext(m_pLmoduleCur);
+		u32 attrKind = LLVMGetEnumAttributeKindForName(pChzInlineAttr, CCh(pChzInlineAttr));
+		if (EWC_FVERIFY(attrKind != 0, "unknown inline attr kind"))
+		{ 
+			LLVMCreateEnumAttribute(pLctx, attrKind, 0);
 		}
-	case PARK_AdditiveOp:
-		{
-			SOpTypes * pOptype = pStnod->m_pOptype;
-			EWC_ASSERT(pOptype && pOptype->m_pTinLhs && pOptype->m_pTinRhs, "missing operand types for AdditiveOp");
+		//LLVMAddFunctionAttr(pProc->m_pLval, LLVMNoInlineAttribute);	
+	}
 
-			STypeInfo * pTinLhs = PTinStripQualifiers(pOptype->m_pTinLhs);
-			STypeInfo * pTinRhs = PTinStripQualifiers(pOptype->m_pTinRhs);
-			TINK tinkLhs = pTinLhs->m_tink;
-			TINK tinkRhs = pTinRhs->m_tink;
-			if (!FIsOverloadedOp(pStnod))
+	if (!pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign))
+	{
+		pProc->m_pBlockLocals = PBlockCreate(pProc, strMangled.PCoz());
+		pProc->m_pBlockFirst = PBlockCreate(pProc, strMangled.PCoz());
+
+		if (EWC_FVERIFY(pTinproc, "expected type info procedure") && FEmitsDebugLines())
+		{
+			if (pTinproc->m_pCgvalDIType == nullptr)
 			{
-				if (((tinkLhs == TINK_Pointer) & (tinkRhs == TINK_Integer)) | 
-					((tinkLhs == TINK_Integer) & (tinkRhs == TINK_Pointer)))
-				{
-					//handle pointer arithmetic
+				CreateDebugInfo(pWork, this, pStnod, pTinproc);
+			}
 
-					CSTNode * pStnodLhs = pStnod->PStnodChild(0);
-					auto pValLhs = PValGenerate(pWork, pBuild, pStnodLhs, VALGENK_Instance);
+			pProc->m_pLvalDIFunction = PLvalCreateDebugFunction(
+											pWork,
+											this,
+											pTinproc->m_strName.PCoz(),
+											PChzVerifyAscii(pTinproc->m_strMangled.PCoz()),
+											pStnod,
+											pStnodBody,
+											(LLVMValueRef)pTinproc->m_pCgvalDIType,
+											pProc->m_pLval);
 
-					CSTNode * pStnodRhs = pStnod->PStnodChild(1);
-					auto pValRhs = PValGenerate(pWork, pBuild, pStnodRhs, VALGENK_Instance);
+			s32 iLine, iCol;
+			CalculateLinePosition(pWork, &pStnodBody->m_lexloc, &iLine, &iCol);
 
-					BUILD::Value * pValPtr;
-					BUILD::Value * pValIndex;
-					if (pTinLhs->m_tink == TINK_Pointer)
-					{
-						pValPtr = pValLhs;
-						pValIndex = pValRhs;
-					}
-					else
-					{
-						pValPtr = pValRhs;
-						pValIndex = pValLhs;
-					}
-					if (pStnod->m_tok == TOK('-'))
-					{
-						pValIndex = pBuild->PInstCreate(IROP_NNeg, pValIndex, "NNeg");
-					}
+			pProc->m_pLvalDebugLocCur = LLVMCreateDebugLocation(m_pLbuild, iLine, iCol, pProc->m_pLvalDIFunction);
+		}
+	}
 
-					BUILD::GepIndex * pGepIndex = pBuild->PGepIndexFromValue(pValIndex);
-					auto pInstGep = pBuild->PInstCreateGEP(pValPtr, &pGepIndex, 1, "ptrGep");
-					return pInstGep; 
-				}
-			}
-		} // fallthrough
-	case PARK_MultiplicativeOp:
-	case PARK_ShiftOp:
-	case PARK_RelationalOp:
-		{
-			ASSERT_STNOD(pWork, pStnod, valgenk != VALGENK_Reference, "operand result is not a valid LValue");
+	auto pSym = pStnod->PSym();
+	if (EWC_FVERIFY(pSym, "expected symbol to be set during type check"))
+	{
+		SetSymbolValue(pSym, pProc);
+	}
 
-			CSTNode * pStnodLhs = pStnod->PStnodChild(0);
-			CSTNode * pStnodRhs = pStnod->PStnodChild(1);
+	return pProc;
+}
+
+static void AddEnumAttribute(LLVMOpaqueValue * pLvalFunc, unsigned iAttr, const char * pChzAttr, u64 nValue = 0)
+{
+	u32 attrKind = LLVMGetEnumAttributeKindForName(pChzAttr, CCh(pChzAttr));
+	if (!EWC_FVERIFY(attrKind != 0, "unknown attribute kind '%s'", pChzAttr))
+		return;
+
+	auto pLctx = LLVMGetModuleContext(LLVMGetGlobalParent(pLvalFunc));
+	LLVMAddAttributeAtIndex(pLvalFunc, iAttr, LLVMCreateEnumAttribute(pLctx, attrKind, nValue));
+}
 
-			SOpTypes * pOptype = pStnod->m_pOptype;
-			EWC_ASSERT(pOptype && pOptype->FIsValid(), "missing operand types");
-			STypeInfo * pTinOperandLhs = pOptype->m_pTinLhs;
-			STypeInfo * pTinOperandRhs = pOptype->m_pTinRhs;
-			auto pValLhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodLhs, pTinOperandLhs);
-			auto pValRhsCast = PValGenerateCast(pWork, pBuild, VALGENK_Instance, pStnodRhs, pTinOperandRhs);
-			if (!EWC_FVERIFY((pValLhsCast != nullptr) & (pValRhsCast != nullptr), "null operand"))
-				return nullptr;
+void CBuilderIR::AddParamAttributes(LLVMOpaqueValue * pLvalFunc, CSTNode * pStnodParamList)
+{
+	// pointer parameters get the aliasing attributes their qualifiers guarantee:
+	//   restrict & T		-> noalias nocapture
+	//   & const T			-> readonly (const is transitive, but & T casts to & const T so it's not noalias)
+	//   implicit ref		-> nonnull dereferenceable(sizeof(T)), it always refers to the caller's lvalue
 
-			STypeInfo * pTinLhs = pStnodLhs->m_pTin;
-			STypeInfo * pTinRhs = pStnodRhs->m_pTin;
-			if (!EWC_FVERIFY(
-					(pOptype->m_pTinResult != nullptr) & (pTinLhs != nullptr) & (pTinRhs != nullptr), 
-					"bad cast"))
-			{
-				return nullptr;
-			}
+	int ipLvalParam = 0;
+	int cpStnodParam = pStnodParamList->CStnodChild();
+	for (int ipStnodParam = 0; ipStnodParam < cpStnodParam; ++ipStnodParam)
+	{
+		CSTNode * pStnodParam = pStnodParamList->PStnodChild(ipStnodParam);
+		if (pStnodParam->m_park == PARK_VariadicArg)
+			continue;
 
-			if (FIsOverloadedOp(pStnod))
-			{
-				auto pTinproc = pStnod->m_pOptype->m_pTinprocOverload;
+		CSTDecl * pStdecl = PStmapRtiCast<CSTDecl *>(pStnodParam->m_pStmap);
+		if (FIsTrimmedGenericParameter(pStdecl))
+			continue;
 
-				//BB - This won't work with generic procedure overloads
-				auto pSym = pTinproc->m_pStnodDefinition->PSym();
+		unsigned iAttr = LLVMAttributeReturnIndex + 1 + ipLvalParam;	// argument attributes follow the return attribute
+		++ipLvalParam;
 
-				CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
-				GenerateArguments(pWork, pBuild, pStnod->m_grfstnod, pTinproc, 2, pStnod->m_arypStnodChild.A(), &arypLvalArgs);
-				return pBuild->PValGenerateCall(pWork, pStnod, pSym, &arypLvalArgs, true, pTinproc, valgenk);
-			}
-	
-			/*
-			if (LLVMTypeOf(pValLhsCast->m_pLval) != LLVMTypeOf(pValRhsCast->m_pLval))
-			{
-				EmitError(pWork, &pStnod->m_lexloc, ERRID_BadCastGen, "INTERNAL ERROR: bad cast");
-				DumpLtype("Lhs", pValLhsCast);
-				DumpLtype("Rhs", pValRhsCast);
-				return nullptr;
-			}*/
+		STypeInfo * pTinParam = pStnodParam->m_pTin;
+		GRFQUALK grfqualk;
+		while (pTinParam && pTinParam->m_tink == TINK_Qualifier)
+		{
+			auto pTinqual = (STypeInfoQualifier *)pTinParam;
+			grfqualk.AddFlags(pTinqual->m_grfqualk);
+			pTinParam = pTinqual->m_pTin;
+		}
 
-			auto pInstOp = PInstGenerateOperator(pBuild, pStnod->m_tok, pOptype, pValLhsCast, pValRhsCast);
+		auto pTinptr = PTinRtiCast<STypeInfoPointer *>(pTinParam);
+		if (!pTinptr)
+			continue;
 
-			EWC_ASSERT(pInstOp, "%s operator unsupported in codegen", PCozFromTok(pStnod->m_tok));
-			return pInstOp;
+		if (grfqualk.FIsSet(FQUALK_Restrict))
+		{
+			AddEnumAttribute(pLvalFunc, iAttr, "noalias");
+			AddEnumAttribute(pLvalFunc, iAttr, "nocapture");
 		}
-	case PARK_PostfixUnaryOp:
-	case PARK_UnaryOp:
+
+		auto pTinqualPointedTo = PTinRtiCast<STypeInfoQualifier *>(pTinptr->m_pTinPointedTo);
+		if (pTinqualPointedTo && pTinqualPointedTo->m_grfqualk.FIsSet(FQUALK_Const))
 		{
-			CSTNode * pStnodOperand = pStnod->PStnodChild(0);
+			AddEnumAttribute(pLvalFunc, iAttr, "readonly");
+		}
 
-			if (FIsOverloadedOp(pStnod))
+		auto pTinPointedTo = PTinStripQualifiers(pTinptr->m_pTinPointedTo);
+		if (pTinptr->m_fIsImplicitRef && pTinPointedTo->m_tink != TINK_Void)
+		{
+			u64 cBPointedTo = LLVMABISizeOfType(m_pTargd, PLtypeFromPTin(pTinPointedTo));
+			AddEnumAttribute(pLvalFunc, iAttr, "nonnull");
+			if (cBPointedTo > 0)
 			{
-				auto pTinproc = pStnod->m_pOptype->m_pTinprocOverload;
-
-				//BB - This won't work with generic procedure overloads
-				auto pSym = pTinproc->m_pStnodDefinition->PSym();
+				AddEnumAttribute(pLvalFunc, iAttr, "dereferenceable", cBPointedTo);
+			}
+		}
+	}
+}
 
-				CDynAry<BUILD::ProcArg *> arypLvalArgs(pBuild->m_pAlloc, EWC::BK_Stack);
-				CDynAry<BUILD::Value *> arypValArgs(pBuild->m_pAlloc, EWC::BK_Stack);
-				GenerateArguments(pWork, pBuild, pStnod->m_grfstnod, pTinproc, 1, pStnod->m_arypStnodChild.A(), &arypLvalArgs, &arypValArgs);
+void CBuilderIR::SetupParamBlock(
+	CWorkspace * pWork,
+	CIRProcedure * pProc,
+	CSTNode * pStnod,
+	CSTNode * pStnodParamList,
+	EWC::CDynAry<LLVMOpaqueType *> * parypLtype)
+{
+	// set up llvm argument values for our formal parameters
 
-				BUILD::Value * pValReturn = nullptr;
-				if (pStnod->m_park == PARK_PostfixUnaryOp)
-				{
-					pValReturn = pBuild->PInstCreate(IROP_Load, arypValArgs[0], "");
-				}
+	auto pStproc = PStmapDerivedCast<CSTProcedure *>(pStnod->m_pStmap);
+	int cpStnodParam = pStnodParamList->CStnodChild();
+	int cpLvalParams = LLVMCountParams(pProc->m_pLval);
 
-				auto pValCall = pBuild->PValGenerateCall(pWork, pStnod, pSym, &arypLvalArgs, true, pTinproc, valgenk);
+	CAlloc * pAlloc = m_pAlloc;
+	LLVMValueRef * appLvalParams = (LLVMValueRef*)pAlloc->EWC_ALLOC_TYPE_ARRAY(LLVMValueRef, cpLvalParams);
+	LLVMGetParams(pProc->m_pLval, appLvalParams);
 
-				return (pValReturn) ? pValReturn : pValCall;;
-			}
+	auto pDif = PDifEnsure(pWork, this, pStnod->m_lexloc.m_strFilename);
 
-			if (pStnod->m_tok == TOK_Reference)
-			{
-				return PValGenerate(pWork, pBuild, pStnodOperand, VALGENK_Reference);
-			}
+	int ipLvalParam = 0;
+	for (int ipStnodParam = 0; ipStnodParam < cpStnodParam; ++ipStnodParam)
+	{
+		CSTNode * pStnodParam = pStnodParamList->PStnodChild(ipStnodParam);
+		if (pStnodParam->m_park == PARK_VariadicArg)
+			continue;
 
-			TOK tok = pStnod->m_tok;
-			VALGENK valgenkUnary = ((tok == TOK_PlusPlus) | (tok == TOK_MinusMinus)) ? VALGENK_Reference : VALGENK_Instance;
-			auto pValOperand = PValGenerate(pWork, pBuild, pStnodOperand, valgenkUnary);
-			if (!EWC_FVERIFY(!FIsNull(pValOperand), "null operand"))
-				return nullptr;
+		CSTDecl * pStdecl = PStmapRtiCast<CSTDecl *>(pStnodParam->m_pStmap);
+		if (FIsTrimmedGenericParameter(pStdecl))
+			continue;
 
-			EWC_ASSERT(pStnod->m_pOptype, "mising operator types in unary op");
-			STypeInfo * pTinOutput = PTinStripQualifiers(pStnod->m_pOptype->m_pTinResult);
-			STypeInfo * pTinOperand = PTinStripQualifiers(pStnodOperand->m_pTin);
+		EWC_ASSERT(ipLvalParam < cpLvalParams, "parameter count mismatch");
 
-			pTinOutput = PTinStripEnumToLoose(pTinOutput);
-			pTinOperand = PTinStripEnumToLoose(pTinOperand);
+		auto pSymParam = pStnodParam->PSym();
+		if (EWC_FVERIFY(pSymParam, "missing symbol for argument"))
+		{
+			LLVMValueRef  pLvalParam = appLvalParams[ipLvalParam];
+			auto strArgName = StrPunyEncode(pSymParam->m_strName.PCoz());
+			LLVMSetValueName(pLvalParam, strArgName.PCoz());
 
-			if (!EWC_FVERIFY((pTinOutput != nullptr) & (pTinOperand != nullptr), "bad cast"))
-				return nullptr;
-	
-			BUILD::Value * pValOp = nullptr;
+			CIRArgument * pArg = EWC_NEW(pAlloc, CIRArgument) CIRArgument();
+			AddManagedVal(pArg);
+			pArg->m_pLval = pLvalParam;
 
-			bool fIsSigned = true;
-			TINK tink = pTinOutput->m_tink;
-			if (pTinOutput->m_tink == TINK_Literal)
-			{
-				STypeInfoLiteral * pTinlit = (STypeInfoLiteral *)pTinOutput;
-				fIsSigned = pTinlit->m_litty.m_fIsSigned;
-				switch (pTinlit->m_litty.m_litk)
-				{
-				case LITK_Integer:	tink = TINK_Integer;	break;
-				case LITK_Float:	tink = TINK_Float;		break;
-				case LITK_Enum:		tink = TINK_Enum;		break;
-				default:			tink = TINK_Nil;
-				}
-			}
-			else if (pTinOutput->m_tink == TINK_Integer)
+			auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnod->m_pTin);
+			if (EWC_FVERIFY(pTinproc, "expected procedure type") && !pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign))
 			{
-				fIsSigned = ((STypeInfoInteger *)pTinOutput)->m_fIsSigned;
-			}
+				auto pInstAlloca = PValCreateAlloca((*parypLtype)[ipLvalParam], strArgName.PCoz());
+				SetSymbolValue(pSymParam, pInstAlloca);
 
-			switch ((u32)pStnod->m_tok)
-			{
-			case '!':				
+				if (FEmitsDebugTypes())
 				{
-					EWC_ASSERT(tink == TINK_Bool, "expected value cannot be cast to bool for '!' operand");
-
-					// OPTIMIZE: could probably save an instruction here by not comparing (for the cast to bool)
-					//  then inverting with a FNot
+					s32 iLine;
+					s32 iCol;
+					CalculateLinePosition(pWork, &pStnodParam->m_lexloc, &iLine, &iCol);
+
+					CreateDebugInfo(pWork, this, pStnod, pStnodParam->m_pTin);
+
+					auto pLvalDIVariable = LLVMDIBuilderCreateParameterVariable(
+						m_pDib,
+						pProc->m_pLvalDIFunction,
+						strArgName.PCoz(),
+						ipLvalParam + 1,
+						pDif->m_pLvalFile,
+						iLine,
+						(LLVMValueRef)pStnodParam->m_pTin->m_pCgvalDIType,
+						true,
+						0);
+
+					(void)LLVMDIBuilderInsertDeclare(
+						m_pDib,
+						pInstAlloca->m_pLval,
+						pLvalDIVariable,
+						pProc->m_pLvalDIFunction,
+						iLine,
+						iCol,
+						m_pBlockCur->m_pLblock);
+				}
 
-					auto pValOperandCast = PValCreateCast(pWork, pBuild, pValOperand, pTinOperand, pTinOutput);
-					if (!pValOperandCast)
-					{
-						EmitError(pWork, &pStnod->m_lexloc, ERRID_BadCastGen, "INTERNAL ERROR: trying to codegen unsupported numeric cast.");
-						return nullptr;
-					}
+				auto pValSym = PValFromSymbol(pSymParam);
+				(void) PInstCreateStore(pValSym, pArg);
+			}
+		}
+		++ipLvalParam;
+	}
 
-					pValOp = pBuild->PInstCreate(IROP_FNot, pValOperandCast, "NCmpEq");
-				} break;
-			case '+':
-				{
-					pValOp = pValOperand;
-				} break;
-			case '~':
-				{
-					switch (tink)
-					{
-					case TINK_Integer : pValOp = pBuild->PInstCreate(IROP_Not, pValOperand, "NNot"); break;
-					default: EWC_ASSERT(false, "unexpected type '%s' for bitwise not operator", PChzFromTink(tink));
-					}
+	m_pAlloc->EWC_FREE(appLvalParams);
+}
 
-				} break;
-			case '-':
-				{
-					switch (tink)
-					{
-					case TINK_Float:	pValOp = pBuild->PInstCreate(IROP_GNeg, pValOperand, "GNeg"); break;
-					case TINK_Integer:	pValOp = pBuild->PInstCreate(IROP_NNeg, pValOperand, "NNeg"); break;
-					default: EWC_ASSERT(false, "unexpected type '%s' for negate operator", PChzFromTink(tink));
-					}
-				} break;
-			case TOK_Dereference:
-				{
-					if (valgenk != VALGENK_Reference)
-					{
-						pValOp = pBuild->PInstCreate(IROP_Load, pValOperand, "Deref");
-					}
-					else
-					{
-						pValOp = pValOperand;
-					}
-				} break;
-			case TOK_PlusPlus:
-			case TOK_MinusMinus:
-				{
-					if (!EWC_FVERIFY((pTinOutput == pTinOperand), "increment type mismatch (?)"))
-						return nullptr;
-			
-					BUILD::Instruction * pInstLoad = pBuild->PInstCreate(IROP_Load, pValOperand, "IncLoad");
-					BUILD::Instruction * pInstAdd = nullptr;
-					switch (tink)
-					{
-					case TINK_Float:	
-						{
-							auto pConst = pBuild->PConstFloat(1.0f, ((STypeInfoFloat *)pTinOperand)->m_cBit);
+template <typename BUILD>
+typename BUILD::Value * PValCodegenPrototype(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnod)
+{
+	auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnod->m_pTin);
 
-							if (pStnod->m_tok == TOK_PlusPlus)
-								pInstAdd = pBuild->PInstCreate(IROP_GAdd, pInstLoad, pConst, "gInc");
-							else
-								pInstAdd = pBuild->PInstCreate(IROP_GSub, pInstLoad, pConst, "gDec");
+	CSTNode * pStnodParamList = nullptr;
+	CSTNode * pStnodReturn = nullptr;
+	CSTNode * pStnodName = nullptr;
+	CSTNode * pStnodAlias = nullptr;
+	CSTNode * pStnodBody = nullptr;
+	auto pStproc = PStmapDerivedCast<CSTProcedure *>(pStnod->m_pStmap);
+	if (EWC_FVERIFY(pStproc, "Encountered procedure without CSTProcedure"))
+	{
+		pStnodParamList = pStnod->PStnodChildSafe(pStproc->m_iStnodParameterList);
+		pStnodReturn = pStnod->PStnodChildSafe(pStproc->m_iStnodReturnType);
+		pStnodName = pStnod->PStnodChildSafe(pStproc->m_iStnodProcName);
+		pStnodAlias = pStnod->PStnodChildSafe(pStproc->m_iStnodForeignAlias);
+		pStnodBody = pStnod->PStnodChildSafe(pStproc->m_iStnodBody);
+	}
 
-						} break;
-					case TINK_Enum:
-					case TINK_Integer:
-						{
-							auto pTinint = (STypeInfoInteger *)pTinOperand;
-							auto pConst = pBuild->PConstInt(1, pTinint->m_cBit, fIsSigned);
+	bool fHasVarArgs = false;
+	CDynAry<BUILD::LType *> arypLtype(pBuild->m_pAlloc, EWC::BK_CodeGen);
+	if (pStnodParamList && EWC_FVERIFY(pStnodParamList->m_park == PARK_ParameterList, "expected parameter list"))
+	{
+		int cpStnodParams = pStnodParamList->CStnodChild();
+		for (int ipStnod = 0; ipStnod < cpStnodParams; ++ipStnod)
+		{
+			CSTNode * pStnodDecl = pStnodParamList->PStnodChild(ipStnod);
+			if (pStnodDecl->m_park == PARK_VariadicArg)
+			{
+				fHasVarArgs = true;
+				continue;
+			}
 
-							if (pStnod->m_tok == TOK_PlusPlus)
-								pInstAdd = pBuild->PInstCreate(IROP_NAdd, pInstLoad, pConst, "gInc");
-							else
-								pInstAdd = pBuild->PInstCreate(IROP_NSub, pInstLoad, pConst, "gDec");
-						} break;
-					case TINK_Pointer:
-						{
-							int nDelta = (pStnod->m_tok == TOK_PlusPlus) ? 1 : -1;
-							auto pConstDelta = pBuild->PConstInt(nDelta, 64, true);
-							BUILD::GepIndex * pGepIndex = pBuild->PGepIndexFromValue(pConstDelta);
+			if (!EWC_FVERIFY(pStnodDecl->m_park == PARK_Decl, "bad parameter"))
+				continue;
 
-							auto pValLoad = pBuild->PInstCreate(IROP_Load, pValOperand, "incLoad");
-							pInstAdd = pBuild->PInstCreateGEP(pValLoad, &pGepIndex, 1, "incGep");
-						} break;
-					default: EWC_ASSERT(false, "unexpected type '%s' for increment/decrement operator", PChzFromTink(tink));
-					}
+			auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnodDecl->m_pStmap);
+			if (FIsTrimmedGenericParameter(pStdecl))
+				continue;
 
-					(void) pBuild->PInstCreateStore(pValOperand, pInstAdd);
-					pValOp = (pStnod->m_park == PARK_PostfixUnaryOp) ? pInstLoad : pInstAdd;
-				}
-			default: break;
+			auto pLtype = pBuild->PLtypeFromPTin(pStnodDecl->m_pTin);
+			if (EWC_FVERIFY(pLtype, "Could not compute LLVM type for parameter"))
+			{
+				arypLtype.Append(pLtype);
 			}
+		}
+	}
 
-			EWC_ASSERT(
-				pValOp != nullptr,
-				"bad operand '%s' for type '%s'",
-				PCozFromTok(pStnod->m_tok),
-				PChzFromTink(tink));
+	BUILD::LType * pLtypeReturn = nullptr;
+	if (pStnodReturn)
+	{
+		pLtypeReturn = pBuild->PLtypeFromPTin(pStnodReturn->m_pTin);
+		EWC_FVERIFY(pLtypeReturn, "Could not compute LLVM type for return type");
+	}
+	if (!pLtypeReturn)
+	{
+		pLtypeReturn = pBuild->PLtypeVoid();
+	}
 
-			EmitLocation(pWork, pBuild, pStnod->m_lexloc);
+	EWC_ASSERT(pTinproc, "Exected procedure type");
 
-			return pValOp;
+	char aCh[256];
+	EWC_ASSERT(!pTinproc->FHasGenericArgs(), "generic arg should not make it to codegen");
+	EWC_ASSERT(pTinproc->m_strMangled.PCoz(), "missing procedure mangled name in tinproc '%s', pStnod = %p", pTinproc->m_strName.PCoz(), pStnod);
+	CString strMangled = pTinproc->m_strMangled;
+
+	if (pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign))
+	{
+		if (pStnodAlias)
+		{
+			strMangled = StrFromIdentifier(pStnodAlias);
 		}
-	case PARK_Typedef:
+	}
+
+	if (strMangled.FIsEmpty())
+	{
+		GenerateUniqueName(&pWork->m_unset, "__AnnonFunc__", aCh, EWC_DIM(aCh));
+		strMangled = aCh;
+	}
+
+	VerifyAscii(strMangled);
+	auto pValProc = pBuild->PValCreateProc(pWork, pTinproc, strMangled, pStnod, pStnodBody, &arypLtype, pLtypeReturn);
+	auto pBlockPrev = pBuild->m_pBlockCur;
+	auto pProcPrev = pBuild->m_pProcCur;
+
+	if (pValProc->m_valk == VALK_Procedure && !pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign))
+	{
+		auto pProc = (BUILD::Proc *)pValProc;
+		pBuild->ActivateProc(pProc, (pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign)) ? pBlockPrev : pProc->m_pBlockLocals);
+		if (pStnodParamList)
 		{
-			auto pSym = pStnod->PSym();
-			if (!EWC_FVERIFY(pSym, "typedef symbol not resolved before codeGen"))
-				return  nullptr;
+			pBuild->SetupParamBlock(pWork, pProc, pStnod, pStnodParamList, &arypLtype);
+		}
+		pBuild->ActivateProc(pProcPrev, pBlockPrev);
+	}
 
-			auto pDif = PDifEnsure(pWork, pBuild, pStnod->m_lexloc.m_strFilename);
-			auto pLvalScope = PLvalFromDIFile(pBuild, pDif);
+	return pValProc;
+}
 
-			s32 iLine, iCol;
-			CalculateLinePosition(pWork, &pStnod->m_lexloc, &iLine, &iCol);
+enum CGEPK // Code Generation Entry Point Kind
+{
+	CGEPK_None,
+	CGEPK_ImplicitProc,	// code will be added in order to an implicit proc for unit tests
+	CGEPK_Normal,
+};
 
-			CreateDebugInfo(pWork, pBuild, pStnod, pSym->m_pTin);
+CGEPK CgepkCompute(CWorkspace * pWork, CSTNode * pStnod)
+{
+	if (pStnod->m_grfstnod.FIsSet(FSTNOD_NoCodeGeneration))
+		return CGEPK_None;
 
-			auto strPunyName = StrPunyEncode(pSym->m_strName.PCoz());
+	bool fGlobalTypeDeclaration = false;
 
-			DInfoCreateTypedef(pBuild, pSym->m_pTin, strPunyName.PCoz(), pDif, iLine, pLvalScope);
-		} break;
-	case PARK_StructDefinition:
-	case PARK_EnumDefinition:
-	case PARK_Nop: 
+	bool fImplicitFunction = pWork->m_grfunt.FIsSet(FUNT_ImplicitProc);
+	switch (pStnod->m_park)
+	{
+	case PARK_StructDefinition:		fGlobalTypeDeclaration = true;	break;
+	case PARK_EnumDefinition:		fGlobalTypeDeclaration = true;	break;
+	case PARK_Typedef:				fGlobalTypeDeclaration = true;	break;
+	case PARK_Nop:					fGlobalTypeDeclaration = true;	break;
+	case PARK_ProcedureDefinition:	fImplicitFunction = false;		break;
+
+	case PARK_Decl:
+	case PARK_ConstantDecl:
 		break;
 	default:
-		EWC_ASSERT(false, "unhandled PARK (%s) in code generation.", PChzFromPark(pStnod->m_park));
+		EWC_ASSERT(fImplicitFunction, "Unexpected top level PARK (%s)", PChzFromPark(pStnod->m_park));
+		break;
 	}
-	return nullptr;
+
+	if (fGlobalTypeDeclaration)
+		return CGEPK_None;
+
+	if (fImplicitFunction)
+		return CGEPK_ImplicitProc;
+	return CGEPK_Normal;
 }
 
-CIRBlock * CBuilderIR::PBlockCreate(CIRProcedure * pProc, const char * pChzName)
+template <typename BUILD>
+void CodeGenEntryPoints(
+	CWorkspace * pWork,
+	BUILD * pBuild, 
+	CSymbolTable * pSymtabTop,
+	BlockListEntry * pblistEntry,
+	CAry<SWorkspaceEntry *> * parypEntryOrder,
+	typename BUILD::Proc ** ppProcUnitTest)
 {
-	CIRBlock * pBlock = EWC_NEW(m_pAlloc, CIRBlock) CIRBlock(m_pAlloc);
+	CAlloc * pAlloc = pWork->m_pAlloc;
+	BUILD::Proc * pProcImplicit = nullptr;
 
-	EWC_ASSERT(pProc->m_pLval, "expected function value");
-	auto pLblock = LLVMAppendBasicBlock(pProc->m_pLval, pChzName);
-	pBlock->m_pLblock = pLblock;
+	CDynAry<CSTNode *> arypStnodUnitTest(pWork->m_pAlloc, BK_UnitTest, (int)parypEntryOrder->C());	// entry points from unit tests that are not procedure definitions
 
-	if (EWC_FVERIFY(pProc, "missing procedure in PBlockCreate"))
+	// Two passes so that entry points added to an implicit procedure are added in lexical order, not 
+	//  Type-checked order.
+
+	SWorkspaceEntry ** ppEntryMac = parypEntryOrder->PMac();
+	for (SWorkspaceEntry ** ppEntry = parypEntryOrder->A(); ppEntry != ppEntryMac; ++ppEntry)
 	{
-		pProc->m_arypBlockManaged.Append(pBlock);
+		SWorkspaceEntry * pEntry = *ppEntry;
+		CSTNode * pStnod = pEntry->m_pStnod;
+		auto cgepk = CgepkCompute(pWork, pStnod);
+
+		if (cgepk == CGEPK_Normal)
+		{
+			auto pSym = pStnod->PSym();
+			if (pStnod->m_park == PARK_ProcedureDefinition && pSym->m_symdep != SYMDEP_Used)
+			{
+				EWC_ASSERT(
+					pSym->m_symdep == SYMDEP_Unused,
+					"unexpected symbol dependency type (%d) for symbol '%s'",
+					pSym->m_symdep,
+					pSym->m_strName.PCoz());
+
+				//printf("Skipping dead code %s\n", pSym->m_strName.PCoz());
+				continue;
+			}
+
+			PValGenerate(pWork, pBuild, pStnod, VALGENK_Instance);
+
+			if (pStnod->m_park == PARK_ProcedureDefinition)
+			{
+				auto pVal = pBuild->PValFromSymbol(pSym);
+				auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnod->m_pTin);
+				if (!EWC_FVERIFY(pVal && (pTinproc->FIsForeign() || pVal->m_valk == VALK_Procedure), "Expected procedure"))
+					return;
+
+				//pEntry->m_pProc = pProc;
+			}
+		}
 	}
-	return pBlock;
-}
 
-void CBuilderIR::ActivateProc(CIRProcedure * pProc, CIRBlock * pBlock)
-{
-	if (m_pProcCur)
+	BlockListEntry::CIterator iter(pblistEntry);
+	while (SWorkspaceEntry * pEntry = iter.Next()) 
 	{
-		m_pProcCur->m_pLvalDebugLocCur = LLVMGetCurrentDebugLocation(m_pLbuild);
+		CSTNode * pStnod = pEntry->m_pStnod;
+		auto cgepk = CgepkCompute(pWork, pStnod);
+
+		if (cgepk == CGEPK_ImplicitProc)	
+		{
+			arypStnodUnitTest.Append(pStnod);
+		}
 	}
 
-	m_pProcCur = pProc;
+	if (!arypStnodUnitTest.FIsEmpty() && !pProcImplicit)
+	{
+		char aCh[128];
+		GenerateUniqueName(&pWork->m_unset, "__AnonFunc__", aCh, EWC_DIM(aCh));
+		auto pTinproc = PTinprocAlloc(pWork->m_pSymtab, 0, 0, aCh);
+		pProcImplicit = pBuild->PProcCreateImplicit(pWork, pTinproc, arypStnodUnitTest[0]);
 
-	if (pProc)
+		GenerateMethodBody(pWork, pBuild, pProcImplicit, arypStnodUnitTest.A(), (int)arypStnodUnitTest.C(), nullptr, true);
+	}
+
+	pBuild->FinalizeBuild(pWork);
+
+	if (ppProcUnitTest)
 	{
-		LLVMSetCurrentDebugLocation(m_pLbuild, pProc->m_pLvalDebugLocCur);
+		*ppProcUnitTest = pProcImplicit;
 	}
-	ActivateBlock(pBlock);
 }
 
-void CBuilderIR::ActivateBlock(CIRBlock * pBlock)
+void CodeGenEntryPointsLlvm(
+	CWorkspace * pWork,
+	CBuilderIR * pBuildir,
+	CSymbolTable * pSymtabTop,
+	BlockListEntry * pblistEntry,
+	EWC::CAry<SWorkspaceEntry *> * parypEntryOrder)
 {
-	if (pBlock == m_pBlockCur)
+	CodeGenEntryPoints(pWork, pBuildir, pSymtabTop, pblistEntry, parypEntryOrder, nullptr);
+}
+
+void CodeGenEntryPointsBytecode(
+	CWorkspace * pWork,
+	BCode::CBuilder * pBuildBc, 
+	CSymbolTable * pSymtabTop,
+	BlockListEntry * pblistEntry,
+	EWC::CAry<SWorkspaceEntry *> * parypEntryOrder,
+	BCode::SProcedure ** pProcUnitTest)
+{
+	CodeGenEntryPoints(pWork, pBuildBc, pSymtabTop, pblistEntry, parypEntryOrder, pProcUnitTest);
+}
+
+static void AppendRunDirectives(CSTNode * pStnod, CDynAry<CSTNode *> * parypStnodRun)
+{
+	if (pStnod->m_grfstnod.FIsSet(FSTNOD_NoCodeGeneration))
 		return;
 
-	if (pBlock)
+	if (FIsRunDirective(pStnod) && pStnod->m_strees == STREES_TypeChecked)
 	{
-		EWC_ASSERT(pBlock->m_pLblock, "bad block ptr");
-		auto pLvalBlockParent = LLVMGetBasicBlockParent(pBlock->m_pLblock);
-
-		EWC_ASSERT(pLvalBlockParent == m_pProcCur->m_pLval, "block with multiple parents?");
-		LLVMPositionBuilder(m_pLbuild, pBlock->m_pLblock, nullptr);
+		parypStnodRun->Append(pStnod);
+		return;
 	}
 
-	m_pBlockCur = pBlock;
+	int cpStnodChild = pStnod->CStnodChild();
+	for (int ipStnod = 0; ipStnod < cpStnodChild; ++ipStnod)
+	{
+		auto pStnodChild = pStnod->PStnodChild(ipStnod);
+		if (pStnodChild)
+		{
+			AppendRunDirectives(pStnodChild, parypStnodRun);
+		}
+	}
 }
 
-CBuilderIR::LType * CBuilderIR::PLtypeVoid()
+static inline bool FIsRunBaked(CSTNode * pStnodRun)
 {
-	return LLVMVoidType();
+	auto pStrun = PStmapRtiCast<CSTRun *>(pStnodRun->m_pStmap);
+	return pStrun && pStrun->m_pBResult;
 }
 
-BCode::SProcedure * PProcCodegenInitializer(CWorkspace * pWork, BCode::CBuilder * pBuild, CSTNode * pStnodStruct)
+// matches the global initializers PValGenerateDecl can't emit as constants, these have no value in the #run build
+static inline bool FIsRuntimeInitializer(CSTNode * pStnodInit)
 {
-	STypeInfoStruct * pTinstruct = PTinDerivedCast<STypeInfoStruct *>(pStnodStruct->m_pTin);
-	if (!pTinstruct)
-		return nullptr;
-
-	if (!pTinstruct->m_pTinprocInit)
-	{
-		char aChName[128];
-		EWC::SStringBuffer strbufName(aChName, EWC_DIM(aChName));
-		auto strPunyName = StrPunyEncode(pTinstruct->m_strName.PCoz());
-		FormatCoz(&strbufName, "__%s_INIT", strPunyName.PCoz());
-
-		auto pTinproc = PTinprocAlloc(pWork->m_pSymtab, 1, 0, aChName);
-		pTinstruct->m_pTinprocInit = pTinproc;
-		pTinproc->m_strMangled = aChName;
-		pTinproc->m_arypTinParams.Append(pWork->m_pSymtab->PTinptrAllocate(pTinstruct));
-		pTinproc->m_grftinproc.AddFlags(FTINPROC_Initializer);
-	}
+	if (!pStnodInit || pStnodInit->m_park == PARK_Uninitializer || FIsRunDirective(pStnodInit))
+		return false;
 
-	auto pTinproc = pTinstruct->m_pTinprocInit;
-	auto pProc = pBuild->PProcCreateImplicit(pWork, pTinproc, nullptr);
-	auto pProcsig = pProc->m_pProcsig;
+	return PTinRtiCast<STypeInfoLiteral *>(pStnodInit->m_pTin) == nullptr;
+}
 
-	auto pBlockPrev = pBuild->m_pBlockCur;
-	auto pProcPrev = pBuild->m_pProcCur;
+struct SRunDependencyWalk // tag = rundw
+{
+						SRunDependencyWalk(CAlloc * pAlloc)
+						:m_hashPStnodVisited(pAlloc, BK_CodeGen)
+						,m_hashPStnodGlobalInit(pAlloc, BK_CodeGen)
+						,m_arypStnodDep(pAlloc, BK_CodeGen, 16)
+							{ ; }
 
-	pBuild->ActivateProc(nullptr, nullptr);
-	pBuild->ActivateProc(pProc, pProc->m_pBlockFirst);
+	CHash<CSTNode *, bool>			m_hashPStnodVisited;
+	CHash<CSTNode *, CSTNode *>		m_hashPStnodGlobalInit;	// global declaration -> its initializer (compound decls share one)
 
-	// setup 'this' arg
-	auto pValPThis = pBuild->PValCreateAlloca(pTinproc->m_arypTinParams[0], "this");
-	(void) pBuild->PInstCreateStore(pValPThis, pBuild->PRegArg(pProcsig->m_aParamArg[0].m_iBStack, pTinproc->m_arypTinParams[0]));
-	auto pValThis = pBuild->PInstCreate(IROP_Load, pValPThis);
+	// unbaked #run initializers, or declarations of globals initialized at runtime (those are never baked)
+	CDynAry<CSTNode *>				m_arypStnodDep;
+};
 
-	BCode::SValue * apValIndex[2] = {};
-	apValIndex[0] = pBuild->PConstInt(0, 32, false);
+static void AppendRunDependencies(CSTNode * pStnod, SRunDependencyWalk * pRundw);
 
-	CSTNode * pStnodList = pStnodStruct->PStnodChildSafe(1);
-	if (pStnodList && !EWC_FVERIFY(pStnodList->m_park == PARK_List, "expected member decl list"))
-		pStnodList = nullptr;
+static void AppendRunDependenciesFromDefinition(CSTNode * pStnodDef, SRunDependencyWalk * pRundw)
+{
+	if (!pStnodDef || pRundw->m_hashPStnodVisited.FinsEnsureKey(pStnodDef) != FINS_Inserted)
+		return;
 
-	int cTypemembField = (int)pTinstruct->m_aryTypemembField.C();
-	for (int iTypememb = 0; iTypememb < cTypemembField; ++iTypememb)
+	CSTNode ** ppStnodGlobalInit = pRundw->m_hashPStnodGlobalInit.Lookup(pStnodDef);
+	if (ppStnodGlobalInit && FIsRuntimeInitializer(*ppStnodGlobalInit))
 	{
-		apValIndex[1] = pBuild->PConstInt(iTypememb, 32, false);
+		pRundw->m_arypStnodDep.Append(pStnodDef);
+	}
 
-		CSTNode * pStnodInit = nullptr;
-		if (pStnodList)
+	// variables initialized by #run read as zero until the directive is baked
+	auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnodDef->m_pStmap);
+	if (pStnodDef->m_park == PARK_Decl && pStdecl)
+	{
+		auto pStnodInit = pStnodDef->PStnodChildSafe(pStdecl->m_iStnodInit);
+		if (pStnodInit && FIsRunDirective(pStnodInit) && !FIsRunBaked(pStnodInit))
 		{
-			CSTNode * pStnodDecl = pStnodList->PStnodChild(iTypememb);
-			if (EWC_FVERIFY(pStnodDecl->m_park == PARK_Decl, "expected member declaration"))
-			{
-				auto pStdecl = PStmapDerivedCast<CSTDecl *>(pStnodDecl->m_pStmap);
-				pStnodInit = pStnodDecl->PStnodChildSafe(pStdecl->m_iStnodInit);
-			}
+			pRundw->m_arypStnodDep.Append(pStnodInit);
 		}
-
-		auto pTypememb = &pTinstruct->m_aryTypemembField[iTypememb];
-
-		auto pInstGEP = pBuild->PInstCreateGEP(pValThis, apValIndex, 2, "initGEP");
-		(void)PValInitialize(pWork, pBuild, pTypememb->m_pTin, pInstGEP, pStnodInit);
 	}
 
-	pBuild->CreateReturn(nullptr, 0);
-	pBuild->FinalizeProc(pProc);
-
-	pBuild->ActivateProc(nullptr, nullptr);
-	pBuild->ActivateProc(pProcPrev, pBlockPrev);
-
-	return pProc;
+	AppendRunDependencies(pStnodDef, pRundw);
 }
 
-CIRProcedure * PProcCodegenInitializer(CWorkspace * pWork, CBuilderIR * pBuild, CSTNode * pStnodStruct)
+// gather the values evaluating pStnod can read that the #run build doesn't have yet, following called procedures and
+//  referenced globals
+static void AppendRunDependencies(CSTNode * pStnod, SRunDependencyWalk * pRundw)
 {
-	STypeInfoStruct * pTinstruct = PTinDerivedCast<STypeInfoStruct *>(pStnodStruct->m_pTin);
-	if (!pTinstruct)
-		return nullptr;
+	auto pSym = pStnod->PSym();
+	if (pSym && pSym->m_pStnodDefinition != pStnod)
+	{
+		AppendRunDependenciesFromDefinition(pSym->m_pStnodDefinition, pRundw);
+	}
 
-	LLVMOpaqueType * pLtypeVoid = LLVMVoidType();
-	LLVMOpaqueType * apLtype[1];
-	apLtype[0] = LLVMPointerType(pBuild->PLtypeFromPTin(pTinstruct), 0);
-	auto pLtypeFunction = LLVMFunctionType(pLtypeVoid, apLtype, 1, false);
+	if (pStnod->m_pOptype && pStnod->m_pOptype->m_pTinprocOverload)
+	{
+		AppendRunDependenciesFromDefinition(pStnod->m_pOptype->m_pTinprocOverload->m_pStnodDefinition, pRundw);
+	}
 
-	char aChName[128];
-	EWC::SStringBuffer strbufName(aChName, EWC_DIM(aChName));
-	auto strPunyName = StrPunyEncode(pTinstruct->m_strName.PCoz());
-	FormatCoz(&strbufName, "__%s_INIT", strPunyName.PCoz());
+	int cpStnodChild = pStnod->CStnodChild();
+	for (int ipStnod = 0; ipStnod < cpStnodChild; ++ipStnod)
+	{
+		auto pStnodChild = pStnod->PStnodChild(ipStnod);
+		if (pStnodChild)
+		{
+			AppendRunDependencies(pStnodChild, pRundw);
+		}
+	}
+}
 
-	LLVMOpaqueValue * pLvalFunc = LLVMAddFunction(pBuild->m_pLmoduleCur, aChName, pLtypeFunction);
-	LLVMSetLinkage(pLvalFunc, LLVMPrivateLinkage);
+struct SRunDirective // tag = rund
+{
+	CSTNode *	m_pStnod;
+	int			m_iStnodDepMin;		// range of this directive's dependencies in the shared dependency array
+	int			m_iStnodDepMax;
+};
 
-	CAlloc * pAlloc = pBuild->m_pAlloc;
-	CIRProcedure * pProc = EWC_NEW(pAlloc, CIRProcedure) CIRProcedure(pAlloc);
-	pBuild->AddManagedVal(pProc);
+static bool FEvaluateRunDirectives(CWorkspace * pWork, CSTNode ** apStnodRun, int cStnodRun)
+{
+	CHash<HV, void *> hashHvPFn(pWork->m_pAlloc, BK_ForeignFunctions);
+	CDynAry<void *> arypDll(pWork->m_pAlloc, BK_ForeignFunctions);
 
-	auto pCgstruct = pBuild->PCgstructEnsure(pTinstruct);
-	pCgstruct->m_pProcInitMethod = pProc;
+	bool fSuccess = true;
+	if (!BCode::LoadForeignLibraries(pWork, &hashHvPFn, &arypDll))
+	{
+		SLexerLocation lexloc;
+		EmitError(pWork, &lexloc, ERRID_FailedLoadingDLL, "Failed loading foreign libraries.\n");
+		fSuccess = false;
+	}
+	else
+	{
+		SDataLayout dlay;
+		BuildStubDataLayout(&dlay);
 
-	pProc->m_pLval = pLvalFunc;
-	pProc->m_pBlockFirst = pBuild->PBlockCreate(pProc, aChName);
-	
-	auto pBlockPrev = pBuild->m_pBlockCur;
-	auto pProcPrev = pBuild->m_pProcCur;
+		BCode::CBuilder buildBc(pWork, &dlay, &hashHvPFn);
+		CodeGenEntryPointsBytecode(pWork, &buildBc, pWork->m_pSymtab, &pWork->m_blistEntry, &pWork->m_arypEntryChecked, nullptr);
 
-	pBuild->ActivateProc(pProc, pProc->m_pBlockFirst);
+		CDynAry<BCode::SProcedure *> arypProc(pWork->m_pAlloc, BK_CodeGen, cStnodRun);
+		CDynAry<BCode::SConstant *> arypGlob(pWork->m_pAlloc, BK_CodeGen, cStnodRun);
 
-	{ // create debug info
-		CreateDebugInfo(pWork, pBuild, pStnodStruct, pTinstruct);
+		for (int ipStnod = 0; ipStnod < cStnodRun; ++ipStnod)
+		{
+			auto pStnodRun = apStnodRun[ipStnod];
 
-		int cpTinParam = 1;
-		LLVMValueRef apLvalParam[1];
+			char aCh[128];
+			GenerateUniqueName(&pWork->m_unset, "__RunDirective__", aCh, EWC_DIM(aCh));
+			auto pTinproc = PTinprocAlloc(pWork->m_pSymtab, 0, 0, aCh);
+			pTinproc->m_strMangled = aCh;
 
-		u64 cBitSize = LLVMPointerSize(pBuild->m_pTargd) * 8;
-		u64 cBitAlign = cBitSize;
-		apLvalParam[0] = LLVMDIBuilderCreatePointerType(pBuild->m_pDib, (LLVMValueRef)pTinstruct->m_pCgvalDIType, cBitSize, cBitAlign, "");
+			auto pProc = buildBc.PProcCreateImplicit(pWork, pTinproc, pStnodRun);
+			auto pGlob = buildBc.PGlobCreate(pStnodRun->m_pTin, "runResult");
 
-		auto pLvalDIType = LLVMDIBuilderCreateFunctionType(pBuild->m_pDib, apLvalParam, cpTinParam, cBitSize, cBitAlign);
+			buildBc.ActivateProc(pProc, pProc->m_pBlockLocals);
+			buildBc.ActivateBlock(pProc->m_pBlockFirst);
 
-		pProc->m_pLvalDIFunction = PLvalCreateDebugFunction(
-										pWork,
-										pBuild,
-										aChName,
-										aChName,
-										pStnodStruct,
-										pStnodStruct,
-										pLvalDIType,
-										pProc->m_pLval);
+			// store the call result by value, aggregate returns can't be generated as references
+			auto pValResult = PValGenerate(pWork, &buildBc, pStnodRun->PStnodChild(0), VALGENK_Instance);
+			(void) buildBc.PInstCreateStore(pGlob, pValResult);
+			buildBc.CreateReturn(nullptr, 0, "RetTmp");
 
-		s32 iLine, iCol;
-		CalculateLinePosition(pWork, &pStnodStruct->m_lexloc, &iLine, &iCol);
+			buildBc.ActivateBlock(pProc->m_pBlockLocals);
+			buildBc.CreateBranch(pProc->m_pBlockFirst);
+			buildBc.ActivateProc(nullptr, nullptr);
+			buildBc.FinalizeProc(pProc);
 
-		pProc->m_pLvalDebugLocCur = LLVMCreateDebugLocation(pBuild->m_pLbuild, iLine, iCol, pProc->m_pLvalDIFunction);
-		LLVMSetCurrentDebugLocation(pBuild->m_pLbuild, pProc->m_pLvalDebugLocCur);
-	}
+			arypProc.Append(pProc);
+			arypGlob.Append(pGlob);
+		}
 
-	// load our 'this' argument
-	int cpLvalParams = LLVMCountParams(pProc->m_pLval);
-	EWC_ASSERT(cpLvalParams == 1, "only expected 'this' parameter");
+		fSuccess = !pWork->m_pErrman->FHasErrors();
+		if (fSuccess)
+		{
+			static const u32 s_cBStackMax = 1024 * 100;
+			u8 * pBStack = (u8 *)pWork->m_pAlloc->EWC_ALLOC(s_cBStackMax, 16);
 
-	auto apLvalParam = (LLVMValueRef *)alloca(sizeof(LLVMValueRef) * cpLvalParams);
-	LLVMGetParams(pProc->m_pLval, apLvalParam);
-	LLVMSetValueName(apLvalParam[0], "this");
+			BCode::CVirtualMachine vm(pBStack, &pBStack[s_cBStackMax], &buildBc);
+			buildBc.SwapToVm(&vm);
 
-	CIRArgument * pArgThis = EWC_NEW(pAlloc, CIRArgument) CIRArgument();
-	pArgThis->m_pLval = apLvalParam[0];
-	pBuild->AddManagedVal(pArgThis);
+#if DEBUG_PROC_CALL
+			vm.m_aryDebCall.SetAlloc(pWork->m_pAlloc, BK_ByteCode, 32);
+#endif
 
-	LLVMOpaqueValue * apLvalIndex[2] = {};
-	apLvalIndex[0] = LLVMConstInt(LLVMInt32Type(), 0, false);
+			for (int ipStnod = 0; ipStnod < cStnodRun; ++ipStnod)
+			{
+				auto pStnodRun = apStnodRun[ipStnod];
+				if (!BCode::ExecuteBytecode(&vm, arypProc[ipStnod]))
+				{
+					EmitError(pWork, &pStnodRun->m_lexloc, ERRID_BadRunDirective, "#run directive halted before returning a result");
+					fSuccess = false;
+					continue;
+				}
 
-	CSTNode * pStnodList = pStnodStruct->PStnodChildSafe(1);
-	if (pStnodList && !EWC_FVERIFY(pStnodList->m_park == PARK_List, "expected member decl list"))
-		pStnodList = nullptr;
+				// globals are addressed through a pointer slot in the data segment, see CBuilder::PGlobCreate()
+				u8 * pBResult = *(u8 **)&vm.m_pBGlobal[arypGlob[ipStnod]->m_word.m_s64];
 
-	int cTypemembField = (int)pTinstruct->m_aryTypemembField.C();
-	for (int iTypememb = 0; iTypememb < cTypemembField; ++iTypememb)
-	{
-		apLvalIndex[1] = LLVMConstInt(LLVMInt32Type(), iTypememb, false);
+				u64 cBResult;
+				u64 cBAlignResult;
+				CalculateByteSizeAndAlign(&dlay, pStnodRun->m_pTin, &cBResult, &cBAlignResult);
 
-		CSTNode * pStnodInit = nullptr;
-		if (pStnodList)
-		{
-			CSTNode * pStnodDecl = pStnodList->PStnodChild(iTypememb);
-			if (EWC_FVERIFY(pStnodDecl->m_park == PARK_Decl, "expected member declaration"))
-			{
-				auto pStdecl = PStmapDerivedCast<CSTDecl *>(pStnodDecl->m_pStmap);
-				pStnodInit = pStnodDecl->PStnodChildSafe(pStdecl->m_iStnodInit);
+				EWC_ASSERT(pStnodRun->m_pStmap == nullptr, "#run directive evaluated twice");
+				pStnodRun->m_pStmap = PStrunAllocBaked(pWork->m_pAlloc, pBResult, (size_t)cBResult);
 			}
-		}
-
-		auto pTypememb = &pTinstruct->m_aryTypemembField[iTypememb];
 
-		auto pInstGEP = pBuild->PInstCreateGEP(pArgThis, apLvalIndex, 2, "initGEP");
-		(void)PValInitialize(pWork, pBuild, pTypememb->m_pTin, pInstGEP, pStnodInit);
+			pWork->m_pAlloc->EWC_DELETE(pBStack);
+		}
 	}
 
-	LLVMBuildRetVoid(pBuild->m_pLbuild);
-	pBuild->ActivateProc(pProcPrev, pBlockPrev);
-
-	pBuild->m_arypProcVerify.Append(pProc);
-	return pProc;
+	hashHvPFn.Clear(0);
+	BCode::UnloadForeignLibraries(&arypDll);
+	return fSuccess;
 }
 
-CIRProcedure * CBuilderIR::PProcCreateImplicit(CWorkspace * pWork, STypeInfoProcedure * pTinproc, CSTNode * pStnod)
+void EvaluateRunDirectives(CWorkspace * pWork)
 {
-	auto pProc = EWC_NEW(m_pAlloc, CIRProcedure) CIRProcedure(m_pAlloc);
-	AddManagedVal(pProc);
+	// #run directives are evaluated by generating the whole program as bytecode along with a thunk per directive 
+	//  that stores the result in a global. The results are copied out of the VM and baked into both backends as constants.
+	// Variables initialized by an unbaked #run read as zero in that build, so directives are evaluated in rounds: 
+	//  a directive runs once every #run initializer it can read has been baked in an earlier round.
+	// Globals initialized by runtime code have no value in that build at all, directives that read them are errors.
 
-	auto pLtypeFunction = LLVMFunctionType(LLVMVoidType(), nullptr, 0, false);
-	const char * pCozName = pTinproc->m_strName.PCoz();
-	pProc->m_pLval = LLVMAddFunction(m_pLmoduleCur, pCozName, pLtypeFunction);
-
-	pProc->m_pBlockLocals = PBlockCreate(pProc, pCozName);
-	pProc->m_pBlockFirst = PBlockCreate(pProc, pCozName);
+	CDynAry<CSTNode *> arypStnodRun(pWork->m_pAlloc, BK_CodeGen, 16);
+	SRunDependencyWalk rundw(pWork->m_pAlloc);
 
-	u64 cBitSize = LLVMPointerSize(m_pTargd) * 8;
-	u64 cBitAlign = cBitSize;
-	auto pLvalDIFunctionType = LLVMDIBuilderCreateFunctionType(m_pDib, nullptr, 0, cBitSize, cBitAlign);
+	auto ppEntryMac = pWork->m_arypEntryChecked.PMac();
+	for (auto ppEntry = pWork->m_arypEntryChecked.A(); ppEntry != ppEntryMac; ++ppEntry)
+	{
+		CSTNode * pStnod = (*ppEntry)->m_pStnod;
 
-	pProc->m_pLvalDIFunction = PLvalCreateDebugFunction(
-									pWork,
-									this,
-									pCozName,
-									nullptr,
-									pStnod,
-									pStnod,
-									pLvalDIFunctionType,
-									pProc->m_pLval);
-	return pProc;
-}
+		auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
+		if (pStnod->m_park == PARK_Decl && pStdecl)
+		{
+			auto pStnodInit = pStnod->PStnodChildSafe(pStdecl->m_iStnodInit);
+			rundw.m_hashPStnodGlobalInit.Insert(pStnod, pStnodInit);
+			for (int iStnod = pStdecl->m_iStnodChildMin; iStnod >= 0 && iStnod < pStdecl->m_iStnodChildMax; ++iStnod)
+			{
+				rundw.m_hashPStnodGlobalInit.Insert(pStnod->PStnodChild(iStnod), pStnodInit);
+			}
+		}
 
-CIRValue * CBuilderIR::PValCreateProc(
-	CWorkspace * pWork,
-	STypeInfoProcedure * pTinproc,
-	const CString & strMangled,
-	CSTNode * pStnod,
-	CSTNode * pStnodBody,
-	CDynAry<LLVMOpaqueType *> * parypLtype,
-	LLVMOpaqueType * pLtypeReturn)
-{
-	bool fHasVarArgs = pTinproc->m_grftinproc.FIsSet(FTINPROC_HasVarArgs);
-	auto pProc = EWC_NEW(m_pAlloc, CIRProcedure) CIRProcedure(m_pAlloc);
-	AddManagedVal(pProc);
+		// unused procedures aren't generated, unused globals are left zero initialized
+		auto pSym = pStnod->PSym();
+		if (pSym && pSym->m_symdep == SYMDEP_Unused)
+			continue;
 
-	auto pLtypeFunction = LLVMFunctionType(pLtypeReturn, parypLtype->A(), (u32)parypLtype->C(), fHasVarArgs);
+		AppendRunDirectives(pStnod, &arypStnodRun);
+	}
 
-	pProc->m_pLval = LLVMAddFunction(m_pLmoduleCur, strMangled.PCoz(), pLtypeFunction);
+	if (arypStnodRun.FIsEmpty())
+		return;
 
-	auto pStproc = PStmapDerivedCast<CSTProcedure *>(pStnod->m_pStmap);
-	if (!EWC_FVERIFY(pStproc, "expected stproc"))
-		return nullptr;
+	CDynAry<SRunDirective> aryRund(pWork->m_pAlloc, BK_CodeGen, (int)arypStnodRun.C());
+	CDynAry<CSTNode *> & arypStnodDep = rundw.m_arypStnodDep;
+	bool fReadsRuntimeGlobalAny = false;
 
-	if (!pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign) &&
-		!pStproc->m_grfstproc.FIsAnySet(FSTPROC_UseUnmangledName | FSTPROC_PublicLinkage))
+	auto ppStnodRunMac = arypStnodRun.PMac();
+	for (auto ppStnodRun = arypStnodRun.A(); ppStnodRun != ppStnodRunMac; ++ppStnodRun)
 	{
-		LLVMSetLinkage(pProc->m_pLval, LLVMPrivateLinkage);
-	}
+		int iStnodDepMin = (int)arypStnodDep.C();
 
-	pProc->m_pLval = pProc->m_pLval; // why is this redundant?
+		rundw.m_hashPStnodVisited.Clear(0);
+		AppendRunDependencies(*ppStnodRun, &rundw);
 
-	if (pTinproc->m_callconv != CALLCONV_Nil)
-	{
-		LLVMSetFunctionCallConv(pProc->m_pLval, CallingconvFromCallconv(pTinproc->m_callconv));
-	}
+		bool fReadsRuntimeGlobal = false;
+		for (int iStnodDep = iStnodDepMin; iStnodDep < (int)arypStnodDep.C(); ++iStnodDep)
+		{
+			CSTNode * pStnodDep = arypStnodDep[iStnodDep];
+			if (FIsRunDirective(pStnodDep))
+				continue;
 
-	const char * pChzInlineAttr = nullptr;
-	switch (pTinproc->m_inlinek)
-	{
-		case INLINEK_NoInline:		pChzInlineAttr = "noinline"; break;
-		case INLINEK_AlwaysInline:	pChzInlineAttr = "alwaysinline";	break;
-		default: break;
-	}
+			auto pSymDep = pStnodDep->PSym();
+			EmitError(pWork, &(*ppStnodRun)->m_lexloc, ERRID_BadRunDirective, 
+				"#run directive reads global '%s', which is initialized at runtime", 
+				(pSymDep) ? pSymDep->m_strName.PCoz() : "unknown");
+			fReadsRuntimeGlobal = true;
+			break;
+		}
 
-	if (pChzInlineAttr)
-	{
-		auto pLctx = LLVMGetModuleContext(m_pLmoduleCur);
-		u32 attrKind = LLVMGetEnumAttributeKindForName(pChzInlineAttr, CCh(pChzInlineAttr));
-		if (EWC_FVERIFY(attrKind != 0, "unknown inline attr kind"))
-		{ 
-			LLVMCreateEnumAttribute(pLctx, attrKind, 0);
+		if (fReadsRuntimeGlobal)
+		{
+			fReadsRuntimeGlobalAny = true;
+			continue;
 		}
-		//LLVMAddFunctionAttr(pProc->m_pLval, LLVMNoInlineAttribute);	
+
+		auto pRund = aryRund.AppendNew();
+		pRund->m_pStnod = *ppStnodRun;
+		pRund->m_iStnodDepMin = iStnodDepMin;
+		pRund->m_iStnodDepMax = (int)arypStnodDep.C();
 	}
 
-	if (!pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign))
-	{
-		pProc->m_pBlockLocals = PBlockCreate(pProc, strMangled.PCoz());
-		pProc->m_pBlockFirst = PBlockCreate(pProc, strMangled.PCoz());
+	// the #run build would have to generate the runtime initializers, which PValGenerateDecl doesn't support
+	if (fReadsRuntimeGlobalAny)
+		return;
 
-		if (EWC_FVERIFY(pTinproc, "expected type info procedure"))
+	CDynAry<CSTNode *> arypStnodReady(pWork->m_pAlloc, BK_CodeGen, (int)arypStnodRun.C());
+	while (!aryRund.FIsEmpty())
+	{
+		arypStnodReady.Clear();
+		for (size_t iRund = 0; iRund < aryRund.C(); ++iRund)
 		{
-			if (pTinproc->m_pCgvalDIType == nullptr)
+			SRunDirective * pRund = &aryRund[iRund];
+
+			bool fIsReady = true;
+			for (int iStnodDep = pRund->m_iStnodDepMin; fIsReady && iStnodDep < pRund->m_iStnodDepMax; ++iStnodDep)
 			{
-				CreateDebugInfo(pWork, this, pStnod, pTinproc);
+				fIsReady = FIsRunBaked(arypStnodDep[iStnodDep]);
 			}
 
-			pProc->m_pLvalDIFunction = PLvalCreateDebugFunction(
-											pWork,
-											this,
-											pTinproc->m_strName.PCoz(),
-											PChzVerifyAscii(pTinproc->m_strMangled.PCoz()),
-											pStnod,
-											pStnodBody,
-											(LLVMValueRef)pTinproc->m_pCgvalDIType,
-											pProc->m_pLval);
-
-			s32 iLine, iCol;
-			CalculateLinePosition(pWork, &pStnodBody->m_lexloc, &iLine, &iCol);
+			if (fIsReady)
+			{
+				arypStnodReady.Append(pRund->m_pStnod);
+				aryRund.RemoveFastByI(iRund);
+				--iRund;
+			}
+		}
 
-			pProc->m_pLvalDebugLocCur = LLVMCreateDebugLocation(m_pLbuild, iLine, iCol, pProc->m_pLvalDIFunction);
+		if (arypStnodReady.FIsEmpty())
+		{
+			auto pRundMac = aryRund.PMac();
+			for (auto pRund = aryRund.A(); pRund != pRundMac; ++pRund)
+			{
+				EmitError(pWork, &pRund->m_pStnod->m_lexloc, ERRID_BadRunDirective, 
+					"#run directive reads a value initialized by a #run directive that depends on it");
+			}
+			break;
 		}
-	}
 
-	auto pSym = pStnod->PSym();
-	if (EWC_FVERIFY(pSym, "expected symbol to be set during type check"))
-	{
-		SetSymbolValue(pSym, pProc);
+		if (!FEvaluateRunDirectives(pWork, arypStnodReady.A(), (int)arypStnodReady.C()))
+			break;
 	}
+}
 
-	return pProc;
+void CBuilderIR::ComputeDataLayout(SDataLayout * pDlay)
+{
+	auto pLtypeBool = LLVMInt1Type();
+	auto pLtypeInt = LLVMInt64Type();
+	auto pLtypeFloat = LLVMFloatType();
+
+	pDlay->m_cBBool = (s32)(LLVMSizeOfTypeInBits(m_pTargd, pLtypeBool) + 7) / 8;
+	pDlay->m_cBInt = (s32)LLVMSizeOfTypeInBits(m_pTargd, pLtypeInt) / 8;
+	pDlay->m_cBFloat = (s32)LLVMSizeOfTypeInBits(m_pTargd, pLtypeFloat) / 8;
+	pDlay->m_cBPointer = (s32)LLVMPointerSize(m_pTargd);
+	pDlay->m_cBStackAlign = pDlay->m_cBPointer;
 }
 
-void CBuilderIR::SetupParamBlock(
-	CWorkspace * pWork,
-	CIRProcedure * pProc,
-	CSTNode * pStnod,
-	CSTNode * pStnodParamList,
-	EWC::CDynAry<LLVMOpaqueType *> * parypLtype)
+static const char * PChzFeaturesFromIsalevel(ISALEVEL isalevel)
 {
-	// set up llvm argument values for our formal parameters
+	static const char * s_mpIsalevelPChzFeatures[] =
+	{
+		"",																// ISALEVEL_Baseline
+		"+sse4.2,+popcnt",												// ISALEVEL_Sse42
+		"+sse4.2,+popcnt,+avx,+avx2,+fma,+bmi,+bmi2",					// ISALEVEL_Avx2
+		"+sse4.2,+popcnt,+avx,+avx2,+fma,+bmi,+bmi2,"
+			"+avx512f,+avx512dq,+avx512cd,+avx512bw,+avx512vl",			// ISALEVEL_Avx512
+	};
+	EWC_CASSERT(EWC_DIM(s_mpIsalevelPChzFeatures) == ISALEVEL_Max, "missing ISALEVEL feature string");
+	if ((isalevel <= ISALEVEL_Nil) | (isalevel >= ISALEVEL_Max))
+		return "";
 
-	auto pStproc = PStmapDerivedCast<CSTProcedure *>(pStnod->m_pStmap);
-	int cpStnodParam = pStnodParamList->CStnodChild();
-	int cpLvalParams = LLVMCountParams(pProc->m_pLval);
+	return s_mpIsalevelPChzFeatures[isalevel];
+}
 
-	CAlloc * pAlloc = m_pAlloc;
-	LLVMValueRef * appLvalParams = (LLVMValueRef*)pAlloc->EWC_ALLOC_TYPE_ARRAY(LLVMValueRef, cpLvalParams);
-	LLVMGetParams(pProc->m_pLval, appLvalParams);
+// cpuid feature bits used by the #target_clones dispatcher
+enum CPUIDBIT
+{
+	CPUIDBIT_Ecx1Fma		= 0x1 << 12,
+	CPUIDBIT_Ecx1Sse42		= 0x1 << 20,
+	CPUIDBIT_Ecx1Popcnt		= 0x1 << 23,
+	CPUIDBIT_Ecx1Osxsave	= 0x1 << 27,
+	CPUIDBIT_Ecx1Avx		= 0x1 << 28,
 
-	auto pDif = PDifEnsure(pWork, this, pStnod->m_lexloc.m_strFilename);
+	CPUIDBIT_Ebx7Bmi1		= 0x1 << 3,
+	CPUIDBIT_Ebx7Avx2		= 0x1 << 5,
+	CPUIDBIT_Ebx7Bmi2		= 0x1 << 8,
+	CPUIDBIT_Ebx7Avx512F	= 0x1 << 16,
+	CPUIDBIT_Ebx7Avx512Dq	= 0x1 << 17,
+	CPUIDBIT_Ebx7Avx512Cd	= 0x1 << 28,
+	CPUIDBIT_Ebx7Avx512Bw	= 0x1 << 30,
+	CPUIDBIT_Ebx7Avx512Vl	= (int)(0x1u << 31),
 
-	int ipLvalParam = 0;
-	for (int ipStnodParam = 0; ipStnodParam < cpStnodParam; ++ipStnodParam)
-	{
-		CSTNode * pStnodParam = pStnodParamList->PStnodChild(ipStnodParam);
-		if (pStnodParam->m_park == PARK_VariadicArg)
-			continue;
+	CPUIDBIT_Xcr0AvxState	= 0x6,		// xmm and ymm state saved by the OS
+	CPUIDBIT_Xcr0Avx512State= 0xE6,		// xmm, ymm, opmask and zmm state saved by the OS
+};
 
-		CSTDecl * pStdecl = PStmapRtiCast<CSTDecl *>(pStnodParam->m_pStmap);
-		if (FIsTrimmedGenericParameter(pStdecl))
-			continue;
+static LLVMOpaqueValue * PLvalBuildCpuid(LLVMOpaqueBuilder * pLbuild, u32 nLeaf, const char * pChzName)
+{
+	auto pLtypeInt32 = LLVMInt32Type();
+	LLVMOpaqueType * apLtypeReg[] = { pLtypeInt32, pLtypeInt32, pLtypeInt32, pLtypeInt32 };
+	LLVMOpaqueType * apLtypeArg[] = { pLtypeInt32, pLtypeInt32 };
+	auto pLtypeAsm = LLVMFunctionType(LLVMStructType(apLtypeReg, EWC_DIM(apLtypeReg), false), apLtypeArg, EWC_DIM(apLtypeArg), false);
 
-		EWC_ASSERT(ipLvalParam < cpLvalParams, "parameter count mismatch");
+	auto pLvalAsm = LLVMConstInlineAsm(
+						pLtypeAsm,
+						"cpuid",
+						"={ax},={bx},={cx},={dx},{ax},{cx},~{dirflag},~{fpsr},~{flags}",
+						true,
+						false);
 
-		auto pSymParam = pStnodParam->PSym();
-		if (EWC_FVERIFY(pSymParam, "missing symbol for argument"))
-		{
-			LLVMValueRef  pLvalParam = appLvalParams[ipLvalParam];
-			auto strArgName = StrPunyEncode(pSymParam->m_strName.PCoz());
-			LLVMSetValueName(pLvalParam, strArgName.PCoz());
+	LLVMOpaqueValue * apLvalArg[] = { LLVMConstInt(pLtypeInt32, nLeaf, false), LLVMConstInt(pLtypeInt32, 0, false) };
+	return LLVMBuildCall(pLbuild, pLvalAsm, apLvalArg, EWC_DIM(apLvalArg), pChzName);
+}
 
-			CIRArgument * pArg = EWC_NEW(pAlloc, CIRArgument) CIRArgument();
-			AddManagedVal(pArg);
-			pArg->m_pLval = pLvalParam;
+static LLVMOpaqueValue * PLvalBuildFHasBits(LLVMOpaqueBuilder * pLbuild, LLVMOpaqueValue * pLvalReg, u32 nMask, const char * pChzName)
+{
+	auto pLvalMask = LLVMConstInt(LLVMInt32Type(), nMask, false);
+	auto pLvalAnd = LLVMBuildAnd(pLbuild, pLvalReg, pLvalMask, "");
+	return LLVMBuildICmp(pLbuild, LLVMIntEQ, pLvalAnd, pLvalMask, pChzName);
+}
 
-			auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnod->m_pTin);
-			if (EWC_FVERIFY(pTinproc, "expected procedure type") && !pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign))
-			{
-				auto pInstAlloca = PValCreateAlloca((*parypLtype)[ipLvalParam], strArgName.PCoz());
-				SetSymbolValue(pSymParam, pInstAlloca);
+struct STargetClone // tag = tclone
+{
+	LLVMOpaqueValue *	m_pLvalProc;
+	GRFISALEVEL			m_grfisa;			// instruction set levels to clone for, the baseline is always added
+};
 
-				s32 iLine;
-				s32 iCol;
-				CalculateLinePosition(pWork, &pStnodParam->m_lexloc, &iLine, &iCol);
-
-				CreateDebugInfo(pWork, this, pStnod, pStnodParam->m_pTin);
-
-				auto pLvalDIVariable = LLVMDIBuilderCreateParameterVariable(
-					m_pDib,
-					pProc->m_pLvalDIFunction,
-					strArgName.PCoz(),
-					ipLvalParam + 1,
-					pDif->m_pLvalFile,
-					iLine,
-					(LLVMValueRef)pStnodParam->m_pTin->m_pCgvalDIType,
-					true,
-					0);
-
-				(void)LLVMDIBuilderInsertDeclare(
-					m_pDib,
-					pInstAlloca->m_pLval,
-					pLvalDIVariable,
-					pProc->m_pLvalDIFunction,
-					iLine,
-					iCol,
-					m_pBlockCur->m_pLblock);
+static bool FIsX86Triple(const char * pChzTriple)
+{
+	// the dispatcher reads cpuid and xgetbv, only x86 targets can run it
+	static const char * s_apChzArch[] = { "x86_64", "x86", "amd64", "i386", "i486", "i586", "i686" };
 
-				auto pValSym = PValFromSymbol(pSymParam);
-				(void) PInstCreateStore(pValSym, pArg);
-			}
-		}
-		++ipLvalParam;
-	}
+	const char * pChzArchEnd = pChzTriple;
+	while (*pChzArchEnd != '\0' && *pChzArchEnd != '-')
+		++pChzArchEnd;
 
-	m_pAlloc->EWC_FREE(appLvalParams);
+	size_t cBArch = pChzArchEnd - pChzTriple;
+	for (const char ** ppChzArch = s_apChzArch; ppChzArch != EWC_PMAC(s_apChzArch); ++ppChzArch)
+	{
+		if (CBCoz(*ppChzArch) - 1 == cBArch && FAreCozEqual(*ppChzArch, pChzTriple, cBArch))
+			return true;
+	}
+	return false;
 }
 
-template <typename BUILD>
-typename BUILD::Value * PValCodegenPrototype(CWorkspace * pWork, BUILD * pBuild, CSTNode * pStnod)
+// returns false, leaving the module untouched, if the target triple can't dispatch on cpuid
+static bool FTryBuildTargetClones(
+	CAlloc * pAlloc,
+	LLVMOpaqueModule * pLmodule,
+	const CString & strTargetFeatures,
+	const STargetClone * aTclone,
+	int cTclone)
 {
-	auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnod->m_pTin);
+	// Procedures marked #target_clones are compiled once per instruction set level, the original symbol becomes a 
+	//  thunk that tail calls through a function pointer. The pointer starts out at the baseline clone and is 
+	//  updated by a module constructor that checks cpuid once at startup.
 
-	CSTNode * pStnodParamList = nullptr;
-	CSTNode * pStnodReturn = nullptr;
-	CSTNode * pStnodName = nullptr;
-	CSTNode * pStnodAlias = nullptr;
-	CSTNode * pStnodBody = nullptr;
-	auto pStproc = PStmapDerivedCast<CSTProcedure *>(pStnod->m_pStmap);
-	if (EWC_FVERIFY(pStproc, "Encountered procedure without CSTProcedure"))
+	if (!FIsX86Triple(LLVMGetTarget(pLmodule)))
+		return false;
+
+	if (cTclone == 0)
+		return true;
+
+	auto pLbuild = LLVMCreateBuilder();
+	auto pLtypeInt32 = LLVMInt32Type();
+
+	struct SDispatch // tag = disp
 	{
-		pStnodParamList = pStnod->PStnodChildSafe(pStproc->m_iStnodParameterList);
-		pStnodReturn = pStnod->PStnodChildSafe(pStproc->m_iStnodReturnType);
-		pStnodName = pStnod->PStnodChildSafe(pStproc->m_iStnodProcName);
-		pStnodAlias = pStnod->PStnodChildSafe(pStproc->m_iStnodForeignAlias);
-		pStnodBody = pStnod->PStnodChildSafe(pStproc->m_iStnodBody);
-	}
+		LLVMOpaqueValue *	m_pLvalGlobTarget;
+		LLVMOpaqueValue *	m_mpIsalevelPLvalClone[ISALEVEL_Max];
+	};
 
-	bool fHasVarArgs = false;
-	CDynAry<BUILD::LType *> arypLtype(pBuild->m_pAlloc, EWC::BK_CodeGen);
-	if (pStnodParamList && EWC_FVERIFY(pStnodParamList->m_park == PARK_ParameterList, "expected parameter list"))
+	CDynAry<SDispatch> aryDisp(pAlloc, BK_CodeGen, cTclone);
+
+	char aChName[1024];
+	char aChFeatures[1024];
+	auto pTcloneMac = &aTclone[cTclone];
+	for (auto pTclone = aTclone; pTclone != pTcloneMac; ++pTclone)
 	{
-		int cpStnodParams = pStnodParamList->CStnodChild();
-		for (int ipStnod = 0; ipStnod < cpStnodParams; ++ipStnod)
+		auto pLvalProc = pTclone->m_pLvalProc;
+		const char * pChzProc = LLVMGetValueName(pLvalProc);
+		GRFISALEVEL grfisa = pTclone->m_grfisa;
+		grfisa.AddFlags(FISALEVEL_Baseline);
+
+		auto pDisp = aryDisp.AppendNew();
+		for (int isalevel = ISALEVEL_Min; isalevel < ISALEVEL_Max; ++isalevel)
 		{
-			CSTNode * pStnodDecl = pStnodParamList->PStnodChild(ipStnod);
-			if (pStnodDecl->m_park == PARK_VariadicArg)
-			{
-				fHasVarArgs = true;
+			pDisp->m_mpIsalevelPLvalClone[isalevel] = nullptr;
+			if (!grfisa.FIsSet(0x1 << isalevel))
 				continue;
-			}
 
-			if (!EWC_FVERIFY(pStnodDecl->m_park == PARK_Decl, "bad parameter"))
-				continue;
+			SStringBuffer strbufName(aChName, EWC_DIM(aChName));
+			FormatCoz(&strbufName, "%s.%s", pChzProc, PChzFromIsalevel((ISALEVEL)isalevel));
 
-			auto pStdecl = PStmapRtiCast<CSTDecl *>(pStnodDecl->m_pStmap);
-			if (FIsTrimmedGenericParameter(pStdecl))
-				continue;
+			auto pLvalClone = LLVMCloneFunction(pLvalProc, aChName);
+			LLVMSetLinkage(pLvalClone, LLVMPrivateLinkage);
 
-			auto pLtype = pBuild->PLtypeFromPTin(pStnodDecl->m_pTin);
-			if (EWC_FVERIFY(pLtype, "Could not compute LLVM type for parameter"))
+			const char * pChzFeaturesIsa = PChzFeaturesFromIsalevel((ISALEVEL)isalevel);
+			if (*pChzFeaturesIsa != '\0')
 			{
-				arypLtype.Append(pLtype);
+				SStringBuffer strbufFeatures(aChFeatures, EWC_DIM(aChFeatures));
+				if (!strTargetFeatures.FIsEmpty())
+				{
+					FormatCoz(&strbufFeatures, "%s,", strTargetFeatures.PCoz());
+				}
+				AppendCoz(&strbufFeatures, pChzFeaturesIsa);
+				LLVMAddTargetDependentFunctionAttr(pLvalClone, "target-features", aChFeatures);
 			}
+
+			pDisp->m_mpIsalevelPLvalClone[isalevel] = pLvalClone;
 		}
-	}
 
-	BUILD::LType * pLtypeReturn = nullptr;
-	if (pStnodReturn)
-	{
-		pLtypeReturn = pBuild->PLtypeFromPTin(pStnodReturn->m_pTin);
-		EWC_FVERIFY(pLtypeReturn, "Could not compute LLVM type for return type");
-	}
-	if (!pLtypeReturn)
-	{
-		pLtypeReturn = pBuild->PLtypeVoid();
-	}
+		SStringBuffer strbufName(aChName, EWC_DIM(aChName));
+		FormatCoz(&strbufName, "%s.target", pChzProc);
 
-	EWC_ASSERT(pTinproc, "Exected procedure type");
+		auto pLvalGlobTarget = LLVMAddGlobal(pLmodule, LLVMTypeOf(pLvalProc), aChName);
+		LLVMSetLinkage(pLvalGlobTarget, LLVMPrivateLinkage);
+		LLVMSetInitializer(pLvalGlobTarget, pDisp->m_mpIsalevelPLvalClone[ISALEVEL_Baseline]);
+		pDisp->m_pLvalGlobTarget = pLvalGlobTarget;
 
-	char aCh[256];
-	EWC_ASSERT(!pTinproc->FHasGenericArgs(), "generic arg should not make it to codegen");
-	EWC_ASSERT(pTinproc->m_strMangled.PCoz(), "missing procedure mangled name in tinproc '%s', pStnod = %p", pTinproc->m_strName.PCoz(), pStnod);
-	CString strMangled = pTinproc->m_strMangled;
+		// replace the original body with the dispatch thunk
 
-	if (pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign))
-	{
-		if (pStnodAlias)
+		LLVMDeleteFunctionBody(pLvalProc);
+		LLVMPositionBuilderAtEnd(pLbuild, LLVMAppendBasicBlock(pLvalProc, "thunk"));
+
+		int cLvalParam = LLVMCountParams(pLvalProc);
+		auto apLvalParam = (LLVMOpaqueValue **)alloca(sizeof(LLVMOpaqueValue *) * (cLvalParam + 1));
+		LLVMGetParams(pLvalProc, apLvalParam);
+
+		auto pLvalTarget = LLVMBuildLoad(pLbuild, pLvalGlobTarget, "target");
+		auto pLvalCall = LLVMBuildCall(pLbuild, pLvalTarget, apLvalParam, cLvalParam, "");
+		LLVMSetInstructionCallConv(pLvalCall, LLVMGetFunctionCallConv(pLvalProc));
+		LLVMSetTailCall(pLvalCall, true);
+
+		auto pLtypeReturn = LLVMGetReturnType(LLVMGetElementType(LLVMTypeOf(pLvalProc)));
+		if (LLVMGetTypeKind(pLtypeReturn) == LLVMVoidTypeKind)
 		{
-			strMangled = StrFromIdentifier(pStnodAlias);
+			LLVMBuildRetVoid(pLbuild);
+		}
+		else
+		{
+			LLVMBuildRet(pLbuild, pLvalCall);
 		}
 	}
 
-	if (strMangled.FIsEmpty())
-	{
-		GenerateUniqueName(&pWork->m_unset, "__AnnonFunc__", aCh, EWC_DIM(aCh));
-		strMangled = aCh;
+	// dispatcher: find the highest supported instruction set level and point each thunk at its best clone
+
+	auto pLtypeDispatch = LLVMFunctionType(LLVMVoidType(), nullptr, 0, false);
+	auto pLvalDispatch = LLVMAddFunction(pLmodule, "__moe_dispatch_target_clones", pLtypeDispatch);
+	LLVMSetLinkage(pLvalDispatch, LLVMPrivateLinkage);
+
+	auto pLblockEntry = LLVMAppendBasicBlock(pLvalDispatch, "entry");
+	auto pLblockXsave = LLVMAppendBasicBlock(pLvalDispatch, "xsave");
+	auto pLblockSelect = LLVMAppendBasicBlock(pLvalDispatch, "select");
+
+	// sse4.2 doesn't need OS support, the avx levels are only usable if the OS saves the wider register state, which
+	//  can only be queried with xgetbv if osxsave is set.
+	LLVMPositionBuilderAtEnd(pLbuild, pLblockEntry);
+	auto pLvalLeafMax = LLVMBuildExtractValue(pLbuild, PLvalBuildCpuid(pLbuild, 0, "cpuid0"), 0, "leafMax");
+	auto pLvalEcx1 = LLVMBuildExtractValue(pLbuild, PLvalBuildCpuid(pLbuild, 1, "cpuid1"), 2, "ecx1");
+	auto pLvalFSse42 = PLvalBuildFHasBits(pLbuild, pLvalEcx1, CPUIDBIT_Ecx1Sse42 | CPUIDBIT_Ecx1Popcnt, "fSse42");
+	auto pLvalIsaSse42 = LLVMBuildSelect(
+							pLbuild,
+							pLvalFSse42,
+							LLVMConstInt(pLtypeInt32, ISALEVEL_Sse42, false),
+							LLVMConstInt(pLtypeInt32, ISALEVEL_Baseline, false),
+							"isaSse42");
+
+	auto pLvalFAvx = PLvalBuildFHasBits(pLbuild, pLvalEcx1, CPUIDBIT_Ecx1Osxsave | CPUIDBIT_Ecx1Avx | CPUIDBIT_Ecx1Fma, "fAvx");
+	pLvalFAvx = LLVMBuildAnd(pLbuild, pLvalFAvx, pLvalFSse42, "fAvx");
+	LLVMBuildCondBr(pLbuild, pLvalFAvx, pLblockXsave, pLblockSelect);
+
+	LLVMPositionBuilderAtEnd(pLbuild, pLblockXsave);
+	LLVMOpaqueType * apLtypeXgetbv[] = { pLtypeInt32, pLtypeInt32 };
+	auto pLtypeXgetbv = LLVMFunctionType(LLVMStructType(apLtypeXgetbv, EWC_DIM(apLtypeXgetbv), false), &pLtypeInt32, 1, false);
+	auto pLvalXgetbv = LLVMConstInlineAsm(pLtypeXgetbv, "xgetbv", "={ax},={dx},{cx},~{dirflag},~{fpsr},~{flags}", true, false);
+	auto pLvalZero = LLVMConstInt(pLtypeInt32, 0, false);
+	auto pLvalXcr0 = LLVMBuildExtractValue(pLbuild, LLVMBuildCall(pLbuild, pLvalXgetbv, &pLvalZero, 1, "xgetbv"), 0, "xcr0");
+
+	auto pLvalFLeaf7 = LLVMBuildICmp(pLbuild, LLVMIntUGE, pLvalLeafMax, LLVMConstInt(pLtypeInt32, 7, false), "fLeaf7");
+	auto pLvalEbx7 = LLVMBuildExtractValue(pLbuild, PLvalBuildCpuid(pLbuild, 7, "cpuid7"), 1, "ebx7");
+	pLvalEbx7 = LLVMBuildSelect(pLbuild, pLvalFLeaf7, pLvalEbx7, pLvalZero, "ebx7");
+
+	auto pLvalFAvx2 = LLVMBuildAnd(
+						pLbuild,
+						PLvalBuildFHasBits(pLbuild, pLvalXcr0, CPUIDBIT_Xcr0AvxState, "fAvxState"),
+						PLvalBuildFHasBits(pLbuild, pLvalEbx7, CPUIDBIT_Ebx7Avx2 | CPUIDBIT_Ebx7Bmi1 | CPUIDBIT_Ebx7Bmi2, ""),
+						"fAvx2");
+	auto pLvalFAvx512 = LLVMBuildAnd(
+						pLbuild,
+						PLvalBuildFHasBits(pLbuild, pLvalXcr0, CPUIDBIT_Xcr0Avx512State, "fAvx512State"),
+						PLvalBuildFHasBits(
+							pLbuild,
+							pLvalEbx7,
+							CPUIDBIT_Ebx7Avx512F | CPUIDBIT_Ebx7Avx512Dq | CPUIDBIT_Ebx7Avx512Cd | CPUIDBIT_Ebx7Avx512Bw | CPUIDBIT_Ebx7Avx512Vl,
+							""),
+						"");
+	pLvalFAvx512 = LLVMBuildAnd(pLbuild, pLvalFAvx512, pLvalFAvx2, "fAvx512");
+
+	auto pLvalIsaAvx = LLVMBuildSelect(pLbuild, pLvalFAvx2, LLVMConstInt(pLtypeInt32, ISALEVEL_Avx2, false), pLvalIsaSse42, "");
+	pLvalIsaAvx = LLVMBuildSelect(pLbuild, pLvalFAvx512, LLVMConstInt(pLtypeInt32, ISALEVEL_Avx512, false), pLvalIsaAvx, "isaAvx");
+	LLVMBuildBr(pLbuild, pLblockSelect);
+
+	LLVMPositionBuilderAtEnd(pLbuild, pLblockSelect);
+	auto pLvalIsa = LLVMBuildPhi(pLbuild, pLtypeInt32, "isa");
+	LLVMOpaqueValue * apLvalIncoming[] = { pLvalIsaSse42, pLvalIsaAvx };
+	LLVMOpaqueBasicBlock * apLblockIncoming[] = { pLblockEntry, pLblockXsave };
+	LLVMAddIncoming(pLvalIsa, apLvalIncoming, apLblockIncoming, EWC_DIM(apLvalIncoming));
+
+	auto pDispMac = aryDisp.PMac();
+	for (auto pDisp = aryDisp.A(); pDisp != pDispMac; ++pDisp)
+	{
+		auto pLvalBest = pDisp->m_mpIsalevelPLvalClone[ISALEVEL_Baseline];
+		for (int isalevel = ISALEVEL_Baseline + 1; isalevel < ISALEVEL_Max; ++isalevel)
+		{
+			auto pLvalClone = pDisp->m_mpIsalevelPLvalClone[isalevel];
+			if (!pLvalClone)
+				continue;
+
+			auto pLvalFSupported = LLVMBuildICmp(pLbuild, LLVMIntUGE, pLvalIsa, LLVMConstInt(pLtypeInt32, isalevel, false), "");
+			pLvalBest = LLVMBuildSelect(pLbuild, pLvalFSupported, pLvalClone, pLvalBest, "");
+		}
+
+		LLVMBuildStore(pLbuild, pLvalBest, pDisp->m_pLvalGlobTarget);
 	}
+	LLVMBuildRetVoid(pLbuild);
+	LLVMDisposeBuilder(pLbuild);
 
-	VerifyAscii(strMangled);
-	auto pValProc = pBuild->PValCreateProc(pWork, pTinproc, strMangled, pStnod, pStnodBody, &arypLtype, pLtypeReturn);
-	auto pBlockPrev = pBuild->m_pBlockCur;
-	auto pProcPrev = pBuild->m_pProcCur;
+	// register the dispatcher as a module constructor
 
-	if (pValProc->m_valk == VALK_Procedure && !pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign))
+	LLVMOpaqueType * apLtypeCtor[] = { pLtypeInt32, LLVMPointerType(pLtypeDispatch, 0), LLVMPointerType(LLVMInt8Type(), 0) };
+	auto pLtypeCtor = LLVMStructType(apLtypeCtor, EWC_DIM(apLtypeCtor), false);
+
+	LLVMOpaqueValue * apLvalCtor[] = 
 	{
-		auto pProc = (BUILD::Proc *)pValProc;
-		pBuild->ActivateProc(pProc, (pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign)) ? pBlockPrev : pProc->m_pBlockLocals);
-		if (pStnodParamList)
-		{
-			pBuild->SetupParamBlock(pWork, pProc, pStnod, pStnodParamList, &arypLtype);
-		}
-		pBuild->ActivateProc(pProcPrev, pBlockPrev);
-	}
+		LLVMConstInt(pLtypeInt32, 65535, false),
+		pLvalDispatch,
+		LLVMConstNull(apLtypeCtor[2])
+	};
+	auto pLvalCtor = LLVMConstStruct(apLvalCtor, EWC_DIM(apLvalCtor), false);
 
-	return pValProc;
+	auto pLvalGlobCtors = LLVMAddGlobal(pLmodule, LLVMArrayType(pLtypeCtor, 1), "llvm.global_ctors");
+	LLVMSetLinkage(pLvalGlobCtors, LLVMAppendingLinkage);
+	LLVMSetInitializer(pLvalGlobCtors, LLVMConstArray(pLtypeCtor, &pLvalCtor, 1));
+	return true;
 }
 
-enum CGEPK // Code Generation Entry Point Kind
-{
-	CGEPK_None,
-	CGEPK_ImplicitProc,	// code will be added in order to an implicit proc for unit tests
-	CGEPK_Normal,
-};
-
-CGEPK CgepkCompute(CWorkspace * pWork, CSTNode * pStnod)
+void CBuilderIR::CreateTargetClones(CWorkspace * pWork)
 {
-	if (pStnod->m_grfstnod.FIsSet(FSTNOD_NoCodeGeneration))
-		return CGEPK_None;
-
-	bool fGlobalTypeDeclaration = false;
+	if (m_aryMvproc.FIsEmpty())
+		return;
 
-	bool fImplicitFunction = pWork->m_grfunt.FIsSet(FUNT_ImplicitProc);
-	switch (pStnod->m_park)
+	CDynAry<STargetClone> aryTclone(m_pAlloc, BK_CodeGen, m_aryMvproc.C());
+	auto pMvprocMac = m_aryMvproc.PMac();
+	for (auto pMvproc = m_aryMvproc.A(); pMvproc != pMvprocMac; ++pMvproc)
 	{
-	case PARK_StructDefinition:		fGlobalTypeDeclaration = true;	break;
-	case PARK_EnumDefinition:		fGlobalTypeDeclaration = true;	break;
-	case PARK_Typedef:				fGlobalTypeDeclaration = true;	break;
-	case PARK_Nop:					fGlobalTypeDeclaration = true;	break;
-	case PARK_ProcedureDefinition:	fImplicitFunction = false;		break;
-
-	case PARK_Decl:
-	case PARK_ConstantDecl:
-		break;
-	default:
-		EWC_ASSERT(fImplicitFunction, "Unexpected top level PARK (%s)", PChzFromPark(pStnod->m_park));
-		break;
+		auto pTclone = aryTclone.AppendNew();
+		pTclone->m_pLvalProc = pMvproc->m_pProc->m_pLval;
+		pTclone->m_grfisa = pMvproc->m_pTinproc->m_grfisaClones;
 	}
 
-	if (fGlobalTypeDeclaration)
-		return CGEPK_None;
+	if (FTryBuildTargetClones(m_pAlloc, m_pLmoduleCur, m_strTargetFeatures, aryTclone.A(), (int)aryTclone.C()))
+		return;
 
-	if (fImplicitFunction)
-		return CGEPK_ImplicitProc;
-	return CGEPK_Normal;
+	// non-x86 targets keep the single baseline body for each procedure
+	for (auto pMvproc = m_aryMvproc.A(); pMvproc != pMvprocMac; ++pMvproc)
+	{
+		auto pStnod = pMvproc->m_pProc->m_pStnod;
+		EmitWarning(
+			pWork->m_pErrman,
+			(pStnod) ? &pStnod->m_lexloc : nullptr,
+			ERRID_TargetClonesIgnored,
+			"#target_clones ignored for '%s', cpu dispatch is only supported on x86 targets (triple = %s)",
+			pMvproc->m_pTinproc->m_strName.PCoz(),
+			LLVMGetTarget(m_pLmoduleCur));
+	}
 }
 
-template <typename BUILD>
-void CodeGenEntryPoints(
-	CWorkspace * pWork,
-	BUILD * pBuild, 
-	CSymbolTable * pSymtabTop,
-	BlockListEntry * pblistEntry,
-	CAry<SWorkspaceEntry *> * parypEntryOrder,
-	typename BUILD::Proc ** ppProcUnitTest)
+static bool FIsInternalDefinition(LLVMOpaqueValue * pLvalProc)
 {
-	CAlloc * pAlloc = pWork->m_pAlloc;
-	BUILD::Proc * pProcImplicit = nullptr;
+	if (LLVMIsDeclaration(pLvalProc))
+		return false;
 
-	CDynAry<CSTNode *> arypStnodUnitTest(pWork->m_pAlloc, BK_UnitTest, (int)parypEntryOrder->C());	// entry points from unit tests that are not procedure definitions
+	auto linkage = LLVMGetLinkage(pLvalProc);
+	return linkage == LLVMPrivateLinkage || linkage == LLVMInternalLinkage;
+}
 
-	// Two passes so that entry points added to an implicit procedure are added in lexical order, not 
-	//  Type-checked order.
+static bool FIsOnlyCalledDirectly(LLVMOpaqueValue * pLvalProc)
+{
+	// every use must be the callee operand of a call, a procedure whose address escapes could be called 
+	//  indirectly with the default calling convention.
 
-	SWorkspaceEntry ** ppEntryMac = parypEntryOrder->PMac();
-	for (SWorkspaceEntry ** ppEntry = parypEntryOrder->A(); ppEntry != ppEntryMac; ++ppEntry)
+	for (auto pLuse = LLVMGetFirstUse(pLvalProc); pLuse; pLuse = LLVMGetNextUse(pLuse))
 	{
-		SWorkspaceEntry * pEntry = *ppEntry;
-		CSTNode * pStnod = pEntry->m_pStnod;
-		auto cgepk = CgepkCompute(pWork, pStnod);
+		auto pLvalUser = LLVMGetUser(pLuse);
+		if (!LLVMIsACallInst(pLvalUser))
+			return false;
 
-		if (cgepk == CGEPK_Normal)
+		int cLvalOperand = LLVMGetNumOperands(pLvalUser);
+		if (LLVMGetOperand(pLvalUser, cLvalOperand - 1) != pLvalProc)
+			return false;
+
+		for (int iLvalOperand = 0; iLvalOperand < cLvalOperand - 1; ++iLvalOperand)
 		{
-			auto pSym = pStnod->PSym();
-			if (pStnod->m_park == PARK_ProcedureDefinition && pSym->m_symdep != SYMDEP_Used)
-			{
-				EWC_ASSERT(
-					pSym->m_symdep == SYMDEP_Unused,
-					"unexpected symbol dependency type (%d) for symbol '%s'",
-					pSym->m_symdep,
-					pSym->m_strName.PCoz());
+			if (LLVMGetOperand(pLvalUser, iLvalOperand) == pLvalProc)
+				return false;
+		}
+	}
+	return true;
+}
+
+void CBuilderIR::OptimizeInternalProcedures()
+{
+	// Procedures that aren't exported or foreign visible were given private linkage in PValCreateProc, we finish
+	//  the job here rather than relying on the optimizer (which doesn't run in debug builds): internal procedures 
+	//  left without references are dropped, and the ones only called directly switch to the fast calling convention.
+
+	bool fDeletedAny;
+	do
+	{
+		fDeletedAny = false;
+		auto pLvalProcNext = LLVMGetFirstFunction(m_pLmoduleCur);
+		while (pLvalProcNext)
+		{
+			auto pLvalProc = pLvalProcNext;
+			pLvalProcNext = LLVMGetNextFunction(pLvalProc);
 
-				//printf("Skipping dead code %s\n", pSym->m_strName.PCoz());
+			if (!FIsInternalDefinition(pLvalProc) || LLVMGetFirstUse(pLvalProc))
 				continue;
-			}
 
-			PValGenerate(pWork, pBuild, pStnod, VALGENK_Instance);
-
-			if (pStnod->m_park == PARK_ProcedureDefinition)
+			CIRProcedure ** ppProcMac = m_arypProcVerify.PMac();
+			for (CIRProcedure ** ppProc = m_arypProcVerify.A(); ppProc != ppProcMac; ++ppProc)
 			{
-				auto pVal = pBuild->PValFromSymbol(pSym);
-				auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnod->m_pTin);
-				if (!EWC_FVERIFY(pVal && (pTinproc->FIsForeign() || pVal->m_valk == VALK_Procedure), "Expected procedure"))
-					return;
-
-				//pEntry->m_pProc = pProc;
+				if ((*ppProc)->m_pLval == pLvalProc)
+				{
+					(*ppProc)->m_pLval = nullptr;
+				}
 			}
+
+			LLVMDeleteFunction(pLvalProc);
+			fDeletedAny = true;
 		}
-	}
+	} while (fDeletedAny);
 
-	BlockListEntry::CIterator iter(pblistEntry);
-	while (SWorkspaceEntry * pEntry = iter.Next()) 
+	for (auto pLvalProc = LLVMGetFirstFunction(m_pLmoduleCur); pLvalProc; pLvalProc = LLVMGetNextFunction(pLvalProc))
 	{
-		CSTNode * pStnod = pEntry->m_pStnod;
-		auto cgepk = CgepkCompute(pWork, pStnod);
+		if (!FIsInternalDefinition(pLvalProc) || LLVMGetFunctionCallConv(pLvalProc) != LLVMCCallConv)
+			continue;
 
-		if (cgepk == CGEPK_ImplicitProc)	
+		if (LLVMIsFunctionVarArg(LLVMGetElementType(LLVMTypeOf(pLvalProc))) || !FIsOnlyCalledDirectly(pLvalProc))
+			continue;
+
+		LLVMSetFunctionCallConv(pLvalProc, LLVMFastCallConv);
+		for (auto pLuse = LLVMGetFirstUse(pLvalProc); pLuse; pLuse = LLVMGetNextUse(pLuse))
 		{
-			arypStnodUnitTest.Append(pStnod);
+			LLVMSetInstructionCallConv(LLVMGetUser(pLuse), LLVMFastCallConv);
 		}
 	}
+}
 
-	if (!arypStnodUnitTest.FIsEmpty() && !pProcImplicit)
-	{
-		char aCh[128];
-		GenerateUniqueName(&pWork->m_unset, "__AnonFunc__", aCh, EWC_DIM(aCh));
-		auto pTinproc = PTinprocAlloc(pWork->m_pSymtab, 0, 0, aCh);
-		pProcImplicit = pBuild->PProcCreateImplicit(pWork, pTinproc, arypStnodUnitTest[0]);
-
-		GenerateMethodBody(pWork, pBuild, pProcImplicit, arypStnodUnitTest.A(), (int)arypStnodUnitTest.C(), true);
-	}
+void CBuilderIR::MergeIdenticalProcedures()
+{
+	// Generic instantiations frequently lower to identical IR (ie. a container of &Foo and a container of &Bar).
+	//  LLVM's MergeFunctions pass proves bodies equivalent, routes direct calls to one copy and replaces the others 
+	//  with aliases or thunks. This is only run for optimized builds, merged procedures confuse the debugger.
 
-	pBuild->FinalizeBuild(pWork);
+	llvm::legacy::PassManager lpm;
+	lpm.add(llvm::createMergeFunctionsPass());
+	lpm.run(*llvm::unwrap(m_pLmoduleCur));
 
-	if (ppProcUnitTest)
+	// clear out the values for any procedures the pass deleted
+	CHash<LLVMOpaqueValue *, bool> hashPLvalProcLive(m_pAlloc, BK_CodeGen, m_arypProcVerify.C());
+	for (auto pLvalProc = LLVMGetFirstFunction(m_pLmoduleCur); pLvalProc; pLvalProc = LLVMGetNextFunction(pLvalProc))
 	{
-		*ppProcUnitTest = pProcImplicit;
+		hashPLvalProcLive.Insert(pLvalProc, true);
 	}
-}
 
-void CodeGenEntryPointsLlvm(
-	CWorkspace * pWork,
-	CBuilderIR * pBuildir,
-	CSymbolTable * pSymtabTop,
-	BlockListEntry * pblistEntry,
-	EWC::CAry<SWorkspaceEntry *> * parypEntryOrder)
-{
-	CodeGenEntryPoints(pWork, pBuildir, pSymtabTop, pblistEntry, parypEntryOrder, nullptr);
+	CIRProcedure ** ppProcMac = m_arypProcVerify.PMac();
+	for (CIRProcedure ** ppProc = m_arypProcVerify.A(); ppProc != ppProcMac; ++ppProc)
+	{
+		if ((*ppProc)->m_pLval && !hashPLvalProcLive.Lookup((*ppProc)->m_pLval))
+		{
+			(*ppProc)->m_pLval = nullptr;
+		}
+	}
 }
 
-void CodeGenEntryPointsBytecode(
-	CWorkspace * pWork,
-	BCode::CBuilder * pBuildBc, 
-	CSymbolTable * pSymtabTop,
-	BlockListEntry * pblistEntry,
-	EWC::CAry<SWorkspaceEntry *> * parypEntryOrder,
-	BCode::SProcedure ** pProcUnitTest)
+void CBuilderIR::FinalizeBuild(CWorkspace * pWork)
 {
-	CodeGenEntryPoints(pWork, pBuildBc, pSymtabTop, pblistEntry, parypEntryOrder, pProcUnitTest);
-}
+	// Reflection data is only emitted for types reachable from typeinfo expressions, the type table itself is 
+	//  dropped if no live code references it.
+	bool fEmitTinTable = m_pGlobTinTable && (!m_pSymTinTable || m_pSymTinTable->m_symdep != SYMDEP_Unused);
+	if (fEmitTinTable || !m_arypTinReflectRoot.FIsEmpty())
+	{
+		auto pLvalTinTable = PLvalGenerateReflectTypeTable(pWork, this, fEmitTinTable);
+		if (fEmitTinTable)
+		{
+			SetInitializer(m_pGlobTinTable, pLvalTinTable);
+		}
+	}
 
-void CBuilderIR::ComputeDataLayout(SDataLayout * pDlay)
-{
-	auto pLtypeBool = LLVMInt1Type();
-	auto pLtypeInt = LLVMInt64Type();
-	auto pLtypeFloat = LLVMFloatType();
+	if (m_pGlobTinTable && !fEmitTinTable)
+	{
+		LLVMDeleteGlobal(m_pGlobTinTable->m_pLval);
+		m_pGlobTinTable->m_pLval = nullptr;
+	}
 
-	pDlay->m_cBBool = (s32)(LLVMSizeOfTypeInBits(m_pTargd, pLtypeBool) + 7) / 8;
-	pDlay->m_cBInt = (s32)LLVMSizeOfTypeInBits(m_pTargd, pLtypeInt) / 8;
-	pDlay->m_cBFloat = (s32)LLVMSizeOfTypeInBits(m_pTargd, pLtypeFloat) / 8;
-	pDlay->m_cBPointer = (s32)LLVMPointerSize(m_pTargd);
-	pDlay->m_cBStackAlign = pDlay->m_cBPointer;
-}
+	if (m_pDib)
+	{
+		LLVMDIBuilderFinalize(m_pDib);
+	}
 
-void CBuilderIR::FinalizeBuild(CWorkspace * pWork)
-{
-	LLVMDIBuilderFinalize(m_pDib);
+	// clones are made after the debug info is finalized so each clone gets its own copy of the subprogram
+	CreateTargetClones(pWork);
 
 	LLVMBool fHaveAnyFailed = false;
 	CIRProcedure ** ppProcVerifyEnd = m_arypProcVerify.PMac();
@@ -7747,7 +10360,15 @@ void CBuilderIR::FinalizeBuild(CWorkspace * pWork)
 		printf("\n\n LLVM IR:\n");
 		PrintDump();
 		EmitError(pWork, nullptr, ERRID_UnknownError, "Code generation for entry point is invalid");
+		return;
+	}
+
+	if (pWork->m_optlevel == OPTLEVEL_Release)
+	{
+		MergeIdenticalProcedures();
 	}
+
+	OptimizeInternalProcedures();
 }
 
 int NExecuteAndWait(
@@ -7833,6 +10454,85 @@ bool FTestUniqueNames(CAlloc * pAlloc)
 	return true;
 }
 
+bool FTestTargetClones(CAlloc * pAlloc)
+{
+	struct STestTriple // tag = testrip
+	{
+		const char *	m_pChzTriple;
+		bool			m_fExpectDispatch;
+	};
+
+	STestTriple s_aTestrip[] =
+	{
+		{ "x86_64-pc-windows-msvc",		true },
+		{ "i686-apple-darwin",			true },
+		{ "aarch64-unknown-linux-gnu",	false },
+		{ "armv7-none-eabi",			false },
+	};
+
+	bool fReturn = true;
+	for (int iTestrip = 0; iTestrip < EWC_DIM(s_aTestrip); ++iTestrip)
+	{
+		const STestTriple & testrip = s_aTestrip[iTestrip];
+		auto pLmodule = LLVMModuleCreateWithName("targetClones");
+		LLVMSetTarget(pLmodule, testrip.m_pChzTriple);
+
+		auto pLtypeInt32 = LLVMInt32Type();
+		auto pLvalProc = LLVMAddFunction(pLmodule, "Dot", LLVMFunctionType(pLtypeInt32, &pLtypeInt32, 1, false));
+		auto pLbuild = LLVMCreateBuilder();
+		LLVMPositionBuilderAtEnd(pLbuild, LLVMAppendBasicBlock(pLvalProc, "entry"));
+		LLVMBuildRet(pLbuild, LLVMGetParam(pLvalProc, 0));
+		LLVMDisposeBuilder(pLbuild);
+
+		STargetClone tclone;
+		tclone.m_pLvalProc = pLvalProc;
+		tclone.m_grfisa = FISALEVEL_Avx2;
+
+		bool fDispatch = FTryBuildTargetClones(pAlloc, pLmodule, CString(), &tclone, 1);
+
+		char aChBaseline[64];
+		char aChAvx2[64];
+		char aChSse42[64];
+		SStringBuffer strbufBaseline(aChBaseline, EWC_DIM(aChBaseline));
+		SStringBuffer strbufAvx2(aChAvx2, EWC_DIM(aChAvx2));
+		SStringBuffer strbufSse42(aChSse42, EWC_DIM(aChSse42));
+		FormatCoz(&strbufBaseline, "Dot.%s", PChzFromIsalevel(ISALEVEL_Baseline));
+		FormatCoz(&strbufAvx2, "Dot.%s", PChzFromIsalevel(ISALEVEL_Avx2));
+		FormatCoz(&strbufSse42, "Dot.%s", PChzFromIsalevel(ISALEVEL_Sse42));
+
+		bool fExpect = testrip.m_fExpectDispatch;
+		if (fDispatch != fExpect ||
+			(LLVMGetNamedFunction(pLmodule, aChBaseline) != nullptr) != fExpect ||
+			(LLVMGetNamedFunction(pLmodule, aChAvx2) != nullptr) != fExpect ||
+			(LLVMGetNamedFunction(pLmodule, "__moe_dispatch_target_clones") != nullptr) != fExpect ||
+			(LLVMGetNamedGlobal(pLmodule, "Dot.target") != nullptr) != fExpect ||
+			(LLVMGetNamedGlobal(pLmodule, "llvm.global_ctors") != nullptr) != fExpect ||
+			LLVMGetNamedFunction(pLmodule, aChSse42) != nullptr)
+		{
+			printf("bad #target_clones dispatch for triple %s\n", testrip.m_pChzTriple);
+			fReturn = false;
+		}
+
+		// non-x86 targets must keep the original body rather than a thunk
+		if (!fExpect && LLVMCountBasicBlocks(pLvalProc) != 1)
+		{
+			printf("#target_clones rewrote Dot for triple %s\n", testrip.m_pChzTriple);
+			fReturn = false;
+		}
+
+		char * pChzError = nullptr;
+		if (LLVMVerifyModule(pLmodule, LLVMReturnStatusAction, &pChzError))
+		{
+			printf("#target_clones module failed verification for triple %s\n%s\n", testrip.m_pChzTriple, pChzError);
+			fReturn = false;
+		}
+		LLVMDisposeMessage(pChzError);
+		LLVMDisposeModule(pLmodule);
+	}
+
+	return fReturn;
+}
+
 void SplitFilename(const char * pChzFilename, size_t * piBFile, size_t * piBExtension, size_t * piBEnd)
 {
 	ptrdiff_t iBFile = 0;
@@ -7888,18 +10588,23 @@ size_t CChConstructFilename(const char * pChzFilenameIn, const char * pChzExtens
 	return pChzOut - pChzFilenameOut;
 }
 
-void CompileToObjectFile(CWorkspace * pWork, CBuilderIR * pBuild, const char * pChzFilenameIn)
+static size_t CChConstructObjectFilename(CWorkspace * pWork, const char * pChzFilenameIn, char * pChzFilenameOut, size_t cChOutMax)
 {
-	char * pChzTriple = LLVMGetDefaultTargetTriple();
-
 	const char * pChzExtension;
 	if (pWork->m_targetos == TARGETOS_Windows)
       pChzExtension = ".obj";
     else
       pChzExtension = ".o";
 
+	return CChConstructFilename(pChzFilenameIn, pChzExtension, pChzFilenameOut, cChOutMax);
+}
+
+void CompileToObjectFile(CWorkspace * pWork, CBuilderIR * pBuild, const char * pChzFilenameIn)
+{
+	char * pChzTriple = LLVMGetDefaultTargetTriple();
+
 	char aChFilenameOut[CWorkspace::s_cBFilenameMax];
-	size_t cCh = CChConstructFilename(pChzFilenameIn, pChzExtension, aChFilenameOut, EWC_DIM(aChFilenameOut));
+	size_t cCh = CChConstructObjectFilename(pWork, pChzFilenameIn, aChFilenameOut, EWC_DIM(aChFilenameOut));
 	pWork->SetObjectFilename(aChFilenameOut, cCh);
 
 	char * pChzError = nullptr;
@@ -7943,10 +10648,322 @@ void ShutdownLLVM()
 	LLVMShutdown();
 }
 
+void PrintStructLayoutReport(CWorkspace * pWork)
+{
+	// lists every concrete struct's size, alignment and padding bytes, worst offenders first. cBReorder is the size
+	//  the struct would have if it were declared #reorder. Sizes come from the stub data layout used by bytecode.
+
+	struct SStructLayout // tag = stlay
+	{
+		STypeInfoStruct *	m_pTinstruct;
+		u64					m_cB;
+		u64					m_cBAlign;
+		u64					m_cBPadding;
+		u64					m_cBReorder;
+	};
+
+	SDataLayout dlay;
+	BuildStubDataLayout(&dlay);
+
+	CDynAry<SStructLayout> aryStlay(pWork->m_pAlloc, BK_CodeGen, 64);
+	for (CSymbolTable * pSymtabIt = pWork->m_pSymtab; pSymtabIt; pSymtabIt = pSymtabIt->m_pSymtabNextManaged)
+	{
+		auto ppTinMax = pSymtabIt->m_arypTinManaged.PMac();
+		for (auto ppTin = pSymtabIt->m_arypTinManaged.A(); ppTin != ppTinMax; ++ppTin)
+		{
+			auto pTinstruct = PTinRtiCast<STypeInfoStruct *>(*ppTin);
+			if (!pTinstruct || pTinstruct->FHasGenericParams() || pTinstruct->m_aryTypemembField.C() == 0)
+				continue;
+
+			bool fIsResolved = true;
+			u64 cBField = 0;
+			auto pTypemembMax = pTinstruct->m_aryTypemembField.PMac();
+			for (auto pTypememb = pTinstruct->m_aryTypemembField.A(); pTypememb != pTypemembMax; ++pTypememb)
+			{
+				if (!pTypememb->m_pTin || pTypememb->m_pTin->m_tink == TINK_Generic)
+				{
+					fIsResolved = false;
+					break;
+				}
+
+				u64 cBMember, cBAlignMember;
+				CalculateByteSizeAndAlign(&dlay, pTypememb->m_pTin, &cBMember, &cBAlignMember);
+				cBField += cBMember;
+			}
+
+			if (!fIsResolved)
+				continue;
+
+			auto pStlay = aryStlay.AppendNew();
+			pStlay->m_pTinstruct = pTinstruct;
+			CalculateByteSizeAndAlign(&dlay, pTinstruct, &pStlay->m_cB, &pStlay->m_cBAlign);
+			pStlay->m_cBPadding = pStlay->m_cB - cBField;
+
+			// member sizes are multiples of their alignment, sorting by alignment leaves only tail padding
+			pStlay->m_cBReorder = EWC::CBAlign(cBField, pStlay->m_cBAlign);
+		}
+	}
+
+	std::sort(aryStlay.A(), aryStlay.PMac(), [](const SStructLayout & stlayA, const SStructLayout & stlayB)
+		{ return stlayA.m_cBPadding > stlayB.m_cBPadding; });
+
+	u64 cBPaddingTotal = 0;
+	printf("Struct Layout:\n");
+	printf("   size  align  padding  reorder  name\n");
+	auto pStlayMax = aryStlay.PMac();
+	for (auto pStlay = aryStlay.A(); pStlay != pStlayMax; ++pStlay)
+	{
+		printf("  %5llu  %5llu  %7llu  %7llu  %s%s\n", 
+			pStlay->m_cB,
+			pStlay->m_cBAlign,
+			pStlay->m_cBPadding,
+			pStlay->m_cBReorder,
+			StrFromTypeInfo(pStlay->m_pTinstruct).PCoz(),
+			(pStlay->m_pTinstruct->FIsReorder()) ? " #reorder" : "");
+		cBPaddingTotal += pStlay->m_cBPadding;
+	}
+	printf("  %d structs, %llu padding bytes\n", (int)aryStlay.C(), cBPaddingTotal);
+}
+
+// Build manifest (tag = moedep): written next to the object file after a successful -skipUnchanged build, it
+//  records a hash of the compile options and of every source file that was parsed. If none of them have
+//  changed on the next -skipUnchanged build the object file is reused and the front end is skipped entirely.
+//  This is not incremental compilation: a change to any file reparses and rechecks the whole module, no
+//  per-file results (exported signatures, resolved types) are persisted.
+//  The #foreign_library requests are recorded too, the skipped parse can't rediscover them for the link step.
+
+static const char * s_pChzManifestExtension = ".moedep";
+static const char * s_pChzManifestLibrary = "lib";
+static const int s_nManifestVersion = 2;
+
+struct SManifestLibrary // tag = manlib
+{
+	CString					m_strName;
+	CWorkspace::FILEK		m_filek;
+};
+
+static void TrimLineEnd(char * pChz)
+{
+	size_t cCh = strlen(pChz);
+	while (cCh && (pChz[cCh-1] == '\n' || pChz[cCh-1] == '\r'))
+	{
+		pChz[--cCh] = '\0';
+	}
+}
+
+static HV HvCompileOptions(CWorkspace * pWork, GRFCOMPILE grfcompile)
+{
+	u32 aN[] = 
+	{
+		(u32)s_nManifestVersion,
+		(u32)(grfcompile.m_raw & (FCOMPILE_FastIsel | FCOMPILE_Native)),
+		(u32)pWork->m_targetos,
+		(u32)pWork->m_optlevel,
+		(u32)pWork->m_debuginfo,
+		(u32)pWork->m_fBoundsCheck,
+		(u32)pWork->m_grfunt.m_raw,
+	};
+
+	HV hv = HvFromPBFVN(aN, sizeof(aN));
+	if (pWork->m_pChzTargetCpu)
+	{
+		hv = HvConcatPBFVN(hv, pWork->m_pChzTargetCpu, CBCoz(pWork->m_pChzTargetCpu));
+	}
+	hv = HvConcatPBFVN(hv, "|", 1);
+	if (pWork->m_pChzTargetFeatures)
+	{
+		hv = HvConcatPBFVN(hv, pWork->m_pChzTargetFeatures, CBCoz(pWork->m_pChzTargetFeatures));
+	}
+	return hv;
+}
+
+static bool FTryHashSourceFile(CWorkspace * pWork, const char * pChzFilename, HV * pHv, size_t * pCB)
+{
+#if defined( _MSC_VER )
+	FILE * pFile;
+	fopen_s(&pFile, pChzFilename, "rb");
+#else
+	FILE * pFile = fopen(pChzFilename, "rb");
+#endif
+	if (!pFile)
+		return false;
+
+	fseek(pFile, 0, SEEK_END);
+	size_t cB = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+
+	char * pChzFile = (char *)pWork->m_pAlloc->EWC_ALLOC(cB + 1, 4);
+	size_t cBRead = fread(pChzFile, 1, cB, pFile);
+	fclose(pFile);
+	pChzFile[cBRead] = '\0';
+
+	// hash up to the terminator, to match the file bodies loaded by PChzLoadFile
+	*pCB = strlen(pChzFile);
+	*pHv = HvFromPBFVN(pChzFile, *pCB);
+
+	pWork->m_pAlloc->EWC_FREE(pChzFile);
+	return cBRead == cB;
+}
+
+static bool FIsBuildUpToDate(CWorkspace * pWork, GRFCOMPILE grfcompile, const char * pChzFilenameIn)
+{
+	char aChObject[CWorkspace::s_cBFilenameMax];
+	size_t cChObject = CChConstructObjectFilename(pWork, pChzFilenameIn, aChObject, EWC_DIM(aChObject));
+
+	char aChManifest[CWorkspace::s_cBFilenameMax];
+	(void) CChConstructFilename(pChzFilenameIn, s_pChzManifestExtension, aChManifest, EWC_DIM(aChManifest));
+
+#if defined( _MSC_VER )
+	FILE * pFileObject;
+	fopen_s(&pFileObject, aChObject, "rb");
+	FILE * pFileManifest;
+	fopen_s(&pFileManifest, aChManifest, "r");
+#else
+	FILE * pFileObject = fopen(aChObject, "rb");
+	FILE * pFileManifest = fopen(aChManifest, "r");
+#endif
+
+	bool fIsUpToDate = pFileObject && pFileManifest;
+	if (pFileObject)
+	{
+		fclose(pFileObject);
+	}
+
+	CDynAry<SManifestLibrary> aryManlib(pWork->m_pAlloc, BK_Workspace);
+	if (fIsUpToDate)
+	{
+		int nVersion;
+		unsigned int hvOptions;
+		if (fscanf(pFileManifest, "moedep %d %x\n", &nVersion, &hvOptions) != 2 || 
+			nVersion != s_nManifestVersion ||
+			hvOptions != HvCompileOptions(pWork, grfcompile))
+		{
+			fIsUpToDate = false;
+		}
+
+		int cFile = 0;
+		char aChLine[CWorkspace::s_cBFilenameMax + 32];
+		while (fIsUpToDate && fgets(aChLine, EWC_DIM(aChLine), pFileManifest))
+		{
+			TrimLineEnd(aChLine);
+
+			int nFilek;
+			int cChPrefix;
+			size_t cChLibrary = CBCoz(s_pChzManifestLibrary) - 1;
+			if (strncmp(aChLine, s_pChzManifestLibrary, cChLibrary) == 0 && aChLine[cChLibrary] == ' ')
+			{
+				if (sscanf(&aChLine[cChLibrary], " %d %n", &nFilek, &cChPrefix) != 1 ||
+					(nFilek != CWorkspace::FILEK_Library && nFilek != CWorkspace::FILEK_StaticLibrary))
+				{
+					fIsUpToDate = false;
+					break;
+				}
+
+				SManifestLibrary * pManlib = aryManlib.AppendNew();
+				pManlib->m_strName = CString(&aChLine[cChLibrary + cChPrefix]);
+				pManlib->m_filek = (CWorkspace::FILEK)nFilek;
+				continue;
+			}
+
+			unsigned int hvManifest;
+			unsigned long long cBManifest;
+			if (sscanf(aChLine, "%x %llu %n", &hvManifest, &cBManifest, &cChPrefix) != 2)
+			{
+				fIsUpToDate = false;
+				break;
+			}
+
+			char * pChzFilename = &aChLine[cChPrefix];
+
+			HV hv;
+			size_t cB;
+			fIsUpToDate = FTryHashSourceFile(pWork, pChzFilename, &hv, &cB) && 
+							hv == hvManifest && 
+							cB == cBManifest;
+			++cFile;
+		}
+
+		fIsUpToDate &= cFile > 0;
+	}
+
+	if (pFileManifest)
+	{
+		fclose(pFileManifest);
+	}
+
+	if (fIsUpToDate)
+	{
+		pWork->SetObjectFilename(aChObject, cChObject);
+
+		auto pManlibMac = aryManlib.PMac();
+		for (auto pManlib = aryManlib.A(); pManlib != pManlibMac; ++pManlib)
+		{
+			(void) pWork->PFileEnsure(pManlib->m_strName.PCoz(), pManlib->m_filek);
+		}
+	}
+	else
+	{
+		// drop any stale manifest so a failed build can't leave it pointing at a mismatched object file
+		(void) remove(aChManifest);
+	}
+	return fIsUpToDate;
+}
+
+static void WriteBuildManifest(CWorkspace * pWork, GRFCOMPILE grfcompile, const char * pChzFilenameIn)
+{
+	char aChManifest[CWorkspace::s_cBFilenameMax];
+	(void) CChConstructFilename(pChzFilenameIn, s_pChzManifestExtension, aChManifest, EWC_DIM(aChManifest));
+
+#if defined( _MSC_VER )
+	FILE * pFileManifest;
+	fopen_s(&pFileManifest, aChManifest, "w");
+#else
+	FILE * pFileManifest = fopen(aChManifest, "w");
+#endif
+	if (!pFileManifest)
+	{
+		printf("Warning: failed writing build manifest %s\n", aChManifest);
+		return;
+	}
+
+	fprintf(pFileManifest, "moedep %d %08x\n", s_nManifestVersion, HvCompileOptions(pWork, grfcompile));
+
+	for (size_t ipFile = 0; ipFile < pWork->m_arypFile.C(); ++ipFile)
+	{
+		CWorkspace::SFile * pFile = pWork->m_arypFile[ipFile];
+		if (pFile->m_filek == CWorkspace::FILEK_Library || pFile->m_filek == CWorkspace::FILEK_StaticLibrary)
+		{
+			fprintf(pFileManifest, "%s %d %s\n", s_pChzManifestLibrary, pFile->m_filek, pFile->m_strFilename.PCoz());
+			continue;
+		}
+
+		if (pFile->m_filek != CWorkspace::FILEK_Source || !pFile->m_pChzFileBody)
+			continue;
+
+		char aChFilename[CWorkspace::s_cBFilenameMax];
+		(void)CChConstructFilename(pFile->m_strFilename.PCoz(), CWorkspace::s_pCozSourceExtension, aChFilename, EWC_DIM(aChFilename));
+
+		size_t cB = strlen(pFile->m_pChzFileBody);
+		fprintf(pFileManifest, "%08x %llu %s\n", HvFromPBFVN(pFile->m_pChzFileBody, cB), (unsigned long long)cB, aChFilename);
+	}
+
+	fclose(pFileManifest);
+}
+
 bool FCompileModule(CWorkspace * pWork, GRFCOMPILE grfcompile, const char * pChzFilenameIn)
 {
 	SLexer lex;
 
+	bool fSkipUnchanged = pWork->m_fSkipUnchanged && 
+						grfcompile.FIsSet(FCOMPILE_Native) && 
+						!grfcompile.FIsAnySet(FCOMPILE_Bytecode | FCOMPILE_PrintIR | FCOMPILE_LayoutReport);
+	if (fSkipUnchanged && FIsBuildUpToDate(pWork, grfcompile, pChzFilenameIn))
+	{
+		printf("Up to date: %s\n", pWork->m_pChzObjectFilename);
+		printf("+++ Success: 0 errors, 0 warnings +++\n");
+		return true;
+	}
+
 	(void) pWork->PFileEnsure(pChzFilenameIn, CWorkspace::FILEK_Source);
 
 	for (size_t ipFile = 0; ipFile < pWork->m_arypFile.C(); ++ipFile)
@@ -7985,6 +11002,16 @@ bool FCompileModule(CWorkspace * pWork, GRFCOMPILE grfcompile, const char * pChz
 			&pWork->m_arypEntryChecked,
 			pWork->m_grfunt);
 
+		if (!pWork->m_pErrman->FHasErrors())
+		{
+			EvaluateRunDirectives(pWork);
+		}
+
+		if (!pWork->m_pErrman->FHasErrors() && grfcompile.FIsSet(FCOMPILE_LayoutReport))
+		{
+			PrintStructLayoutReport(pWork);
+		}
+
 		if (!pWork->m_pErrman->FHasErrors())
 		{
 			SDataLayout dlay;
@@ -8003,6 +11030,10 @@ bool FCompileModule(CWorkspace * pWork, GRFCOMPILE grfcompile, const char * pChz
 
 				CompileToObjectFile(pWork, &build, pChzFilenameIn);
 
+				if (fSkipUnchanged && !pWork->m_pErrman->FHasErrors())
+				{
+					WriteBuildManifest(pWork, grfcompile, pChzFilenameIn);
+				}
 				
 				if (grfcompile.FIsSet(FCOMPILE_PrintIR))
 				{
@@ -39,6 +39,7 @@ struct SDataLayout;
 struct SSymbol;
 struct SErrorManager;
 struct STypeInfo;
+struct STypeInfoArray;
 struct STypeInfoEnum;
 struct STypeInfoInteger;
 struct STypeInfoLiteral;
@@ -201,6 +202,16 @@ struct OpSignature // tag = opsig
 		OP(				StoreToIdx)	OPSIZE(CB, 4, 0) \
 						/* StoreAddress(RegIdx) ->iBStack */ \
 		OP(				StoreAddress)	OPSIZE(RegIdx, 0, Ptr) \
+						/* BoundsCheck(iElement, cElement) halts if iElement >= cElement (unsigned) */ \
+		OP(				BoundsCheck)	OPSIZE(CB, CB, 0) \
+						/* LaneOp(RegIdx(simd))->RegIdx  ExArgs(RegIdx(simd rhs), (irop, cLane), pred, cBLane) */ \
+		OP(				LaneOp)			OPSIZE(RegIdx, 0, 0) \
+						/* LaneShuffle(RegIdx(simd))->RegIdx  ExArgs(lane indices packed in nibbles, cBLane) */ \
+		OP(				LaneShuffle)	OPSIZE(RegIdx, 0, 0) \
+						/* LaneReduce(RegIdx(simd))->lane  ExArgs(0, (irop, cLane), pred, cBLane) min/max keep acc if pred(acc, lane) */ \
+		OP(				LaneReduce)		OPSIZE(RegIdx, 0, CB) \
+						/* LaneSelect(mask)->RegIdx  ExArgs(RegIdx(true), RegIdx(false), cBLane) */ \
+		OP(				LaneSelect)		OPSIZE(4, 0, 0) \
 						/* extra arguments for preceeding opcode */ \
 		OPMX(BCodeOp,	ExArgs)	OPSIZE(0, 0, 0) \
 
@@ -377,9 +388,10 @@ enum FCOMPILE
 	FCOMPILE_FastIsel	= 0x2,
 	FCOMPILE_Native		= 0x4,
 	FCOMPILE_Bytecode	= 0x8,
+	FCOMPILE_LayoutReport	= 0x10,
 
 	FCOMPILE_None		= 0x0,
-	FCOMPILE_All		= 0xF,
+	FCOMPILE_All		= 0x1F,
 };
 
 EWC_DEFINE_GRF(GRFCOMPILE, FCOMPILE, u32);
@@ -402,6 +414,7 @@ enum INTFUNK // INTrinsic FUNction Kind
 {
 	INTFUNK_Memset,
 	INTFUNK_Memcpy,
+	INTFUNK_Trap,
 
 	EWC_MAX_MIN_NIL(INTFUNK)
 };
@@ -416,6 +429,13 @@ struct SDIFile // tag = dif (debug info file)
 
 
 
+struct SBoundsFact // tag = bfact
+{
+	SSymbol *	m_pSymIndex;	// index variable known to be within bounds, null if invalidated
+	SSymbol *	m_pSymArray;	// ...of this array, or null if only m_cMax is known
+	s64			m_cMax;			// ...and less than this constant, -1 if unknown
+};
+
 class CBuilderBase
 {
 public:
@@ -423,7 +443,13 @@ public:
 
 
 	EWC::CAlloc *					m_pAlloc;
+	CSymbolTable *					m_pSymtab;
 	CIRBuilderErrorContext *		m_pBerrctx;
+
+	bool							m_fBoundsCheck;			// generate array bounds checks for the current procedure
+	EWC::CDynAry<SSymbol *>			m_arypSymBoundsLocal;	// locals whose address is never taken; safe to reason about
+	EWC::CDynAry<SBoundsFact>		m_aryBfact;				// index ranges proven by dominating checks or loop bounds
+	EWC::CHash<CSTNode *, bool>		m_hashPStnodDeadInit;	// declarations whose default initialization is never read
 };
 
 
@@ -477,6 +503,12 @@ public:
 		CIRGlobal *				m_pGlobInit;		// global instance to use when CGINITK_MemcpyGlobal
 	};
 
+	struct SMultiVersionProc // tag = mvproc
+	{
+		CIRProcedure *			m_pProc;
+		STypeInfoProcedure *	m_pTinproc;			// tinproc with the #target_clones instruction set levels
+	};
+
 						CBuilderIR(
 							CWorkspace * pWork,
 							const char * pChzFilename,
@@ -486,6 +518,13 @@ public:
 	void				PrintDump();
 
 	void				FinalizeBuild(CWorkspace * pWork);
+	void				CreateTargetClones(CWorkspace * pWork);
+	void				OptimizeInternalProcedures();
+	void				MergeIdenticalProcedures();
+	bool				FEmitsDebugLines() const
+							{ return m_fEmitDebugLines; }
+	bool				FEmitsDebugTypes() const
+							{ return m_fEmitDebugTypes; }
 	void				ComputeDataLayout(SDataLayout * pDlay);
 
 	CIRProcedure *		PProcCreateImplicit(CWorkspace * pWork, STypeInfoProcedure * pTinproc, CSTNode * pStnod); 
@@ -503,6 +542,7 @@ public:
 							CSTNode * pStnod,
 							CSTNode * pStnodParamList, 
 							EWC::CDynAry<LLVMOpaqueType *> * parypLtype);
+	void				AddParamAttributes(LLVMOpaqueValue * pLvalFunc, CSTNode * pStnodParamList);
 
 	CIRBlock *			PBlockCreate(CIRProcedure * pProc, const char * pChzName);
 
@@ -560,6 +600,17 @@ public:
 
 	CIRInstruction *	PInstCreateTraceStore(CIRValue * pVal, STypeInfo * pTin)
 							{ return nullptr; }
+	void				CreateBoundsCheck(CIRValue * pValIndex, CIRValue * pValCount);
+
+	CIRInstruction *	PInstCreateLaneOp(IROP irop, s32 pred, STypeInfoStruct * pTinstruct, CIRValue * pValLhs, CIRValue * pValRhs, const char * pChzName);
+	CIRInstruction *	PInstCreateLaneShuffle(STypeInfoStruct * pTinstruct, CIRValue * pVal, const s32 * aiLane, const char * pChzName);
+	CIRInstruction *	PInstCreateLaneReduce(IROP irop, s32 pred, STypeInfoStruct * pTinstruct, CIRValue * pVal, const char * pChzName);
+	CIRInstruction *	PInstCreateLaneSelect(
+							STypeInfoStruct * pTinstruct,
+							CIRValue * pValMask,
+							CIRValue * pValTrue,
+							CIRValue * pValFalse,
+							const char * pChzName);
 
 	CIRInstruction *	PInstCreateGEP(CIRValue * pValLhs, LLVMOpaqueValue ** apLvalIndices, u32 cpIndices, const char * pChzName);
 	LLVMOpaqueValue *	PGepIndex(u64 idx);
@@ -588,11 +639,15 @@ public:
 
 	LLVMOpaqueTargetMachine *			m_pLtmachine;
 	LLVMOpaqueTargetData *				m_pTargd;
+	EWC::CString						m_strTargetFeatures;	// feature string the target machine was created with
 
 	LLVMOpaqueValue *					m_mpIntfunkPLval[INTFUNK_Max];		// map from intrinsic function kind to llvm function
 
 	// Debug info
-	LLVMOpaqueDIBuilder *				m_pDib;				// Debug info builder
+	bool								m_fEmitDebugLines;	// false for -g0
+	bool								m_fEmitDebugTypes;	// false for -g0 and -gline-tables-only
+	LLVMOpaqueDIBuilder *				m_pDib;				// Debug info builder, null when building with -g0
+	LLVMOpaqueValue *					m_pLvalDITypeProcEmpty;	// shared subroutine type for -gline-tables-only subprograms
 	unsigned							m_nRuntimeLanguage;
 	LLVMOpaqueValue *					m_pLvalCompileUnit;
 	LLVMOpaqueValue *					m_pLvalScope;
@@ -602,11 +657,16 @@ public:
 	CIRBlock *							m_pBlockCur;
 
 	EWC::CDynAry<CIRProcedure *>		m_arypProcVerify;	// all the procedures that need verification.
+	EWC::CDynAry<SMultiVersionProc>		m_aryMvproc;		// procedures compiled for multiple instruction set levels
+	EWC::CDynAry<STypeInfo *>			m_arypTinReflectRoot;	// types referenced by typeinfo, roots of the reflect table
+	SSymbol *							m_pSymTinTable;		// global type table, initialized during FinalizeBuild
+	CIRGlobal *							m_pGlobTinTable;
 	EWC::CDynAry<CIRValue *> *			m_parypValManaged;
 	EWC::CDynAry<SJumpTargets>			m_aryJumptStack;
 	EWC::CHash<SSymbol *, CIRValue *>	m_hashPSymPVal;
 	EWC::CHash<STypeInfoLiteral *, CIRGlobal *>			m_hashPTinlitPGlob;
 	EWC::CHash<STypeInfoStruct *, SCodeGenStruct *>		m_hashPTinstructPCgstruct;
+	EWC::CHash<STypeInfoArray *, CIRGlobal *>			m_hashPTinaryPGlobInit;	// default element values for MemcpyGlobal arrays
 };
 
 
@@ -616,6 +676,8 @@ inline bool FIsRegisterSize(u64 cB)
 	return (cB == 1) | (cB == 2) | (cB == 4) | (cB == 8);
 }
 
+STypeInfoStruct * PTinstructEnsureSoa(CSymbolTable * pSymtab, STypeInfoArray * pTinary);
+
 void InitLLVM(EWC::CAry<const char*> * paryPCozArgs);
 void ShutdownLLVM();
 
@@ -637,6 +699,9 @@ void CodeGenEntryPointsBytecode(
 	EWC::CAry<SWorkspaceEntry *> * parypEntryOrder,
 	BCode::SProcedure ** ppProcUnitTest);
 
+void EvaluateRunDirectives(CWorkspace * pWork);
+void PrintStructLayoutReport(CWorkspace * pWork);
+
 int NExecuteAndWait(
 	const char * pChzProgram,
 	const char ** ppChzArgs,
@@ -76,6 +76,11 @@ enum ERRID
 	ERRID_OperatorNotDefined		= 2030,
 	ERRID_CannotInferGeneric		= 2031,
 	ERRID_OrderedAfterNamed         = 2032,
+	ERRID_BadSoaArray				= 2033,
+	ERRID_BadSimdStruct				= 2034,
+	ERRID_BadSimdOperand			= 2035,
+	ERRID_BadRunDirective			= 2036,
+	ERRID_BadNewType				= 2037,
 	ERRID_TypeCheckMax				= 3000,
 
 	ERRID_CodeGenMin				= ERRID_TypeCheckMax,
@@ -90,6 +95,7 @@ enum ERRID
 
 	ERRID_WarningMin				= 10000,
 	ERRID_UnknownWarning			= 10000,
+	ERRID_TargetClonesIgnored		= 10001,
 	ERRID_WarningMax				= 20000,
 
 
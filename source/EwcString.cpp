@@ -63,57 +63,65 @@ namespace EWC
 {
 
 // string table for ref-counted string class (only used by CString)
+//  Each string is interned once as an atom: the characters are prefixed by a header holding the reference count and
+//  hash, so copying or releasing a string handle never rehashes the characters or probes the table.
 class CStringTable // tag=strtab
 {
 public:
+	struct SAtom // tag = atom
+	{
+		u32		m_cRef;
+		HV		m_hv;
+	};
+
 				CStringTable(CAlloc * pAlloc)
 				:m_pAlloc(pAlloc)
-				,m_mpHvEntry(pAlloc, EWC::BK_StringTable, 128)
+				,m_mpHvPAtom(pAlloc, EWC::BK_StringTable, 128)
 					{ ; }
 
+	static SAtom * PAtomFromPCoz(const char * pCoz)
+					{ return ((SAtom *)pCoz) - 1; }
+
 	const char * PCozAlloc(const char * pCoz, size_t cB, HV hv)
 					{
-						Entry * pEntry = nullptr;
-						if (m_mpHvEntry.FinsEnsureKey(hv, &pEntry) == FINS_Inserted)
-						{
-							pEntry->m_cRef = 1;
-							pEntry->m_pCoz = (char*)m_pAlloc->EWC_ALLOC(sizeof(char) * cB, EWC_ALIGN_OF(char));
-							(void) CBCopyCoz(pCoz, pEntry->m_pCoz, cB);
-						}
-						else
+						SAtom ** ppAtom = nullptr;
+						if (m_mpHvPAtom.FinsEnsureKey(hv, &ppAtom) == FINS_Inserted)
 						{
-							++pEntry->m_cRef;
-							EWC_ASSERT(FAreCozEqual(pEntry->m_pCoz, pCoz, cB-1), "bad table lookup in CStringTable");
+							SAtom * pAtom = (SAtom *)m_pAlloc->EWC_ALLOC(sizeof(SAtom) + sizeof(char) * cB, EWC_ALIGN_OF(SAtom));
+							pAtom->m_cRef = 1;
+							pAtom->m_hv = hv;
+							(void) CBCopyCoz(pCoz, (char *)(pAtom + 1), cB);
+							*ppAtom = pAtom;
+							return (const char *)(pAtom + 1);
 						}
 
-						return pEntry->m_pCoz;
+						SAtom * pAtom = *ppAtom;
+						++pAtom->m_cRef;
+						EWC_ASSERT(FAreCozEqual((const char *)(pAtom + 1), pCoz, cB-1), "bad table lookup in CStringTable");
+						return (const char *)(pAtom + 1);
+					}
+
+	const char * PCozAddRef(const char * pCoz)
+					{
+						++PAtomFromPCoz(pCoz)->m_cRef;
+						return pCoz;
 					}
 
 	void		FreePCoz(const char * pCoz, HV hv)
 					{
-						Entry * pEntry = m_mpHvEntry.Lookup(hv);
-						if (!pEntry)
-						{
-							EWC_ASSERT(false, "failed lookup in CStringTable::FreePCoz");
-							return;
-						}
-						--pEntry->m_cRef;
+						SAtom * pAtom = PAtomFromPCoz(pCoz);
+						EWC_ASSERT(pAtom->m_hv == hv && pAtom->m_cRef > 0, "bad atom in CStringTable::FreePCoz");
 
-						if (pEntry->m_cRef <= 0)
+						--pAtom->m_cRef;
+						if (pAtom->m_cRef == 0)
 						{
-							m_pAlloc->EWC_FREE(pEntry->m_pCoz);
-							m_mpHvEntry.Remove(hv);
+							m_mpHvPAtom.Remove(pAtom->m_hv);
+							m_pAlloc->EWC_FREE(pAtom);
 						}
 					}
 
-	struct Entry
-	{
-		char *	m_pCoz;
-		u32		m_cRef;
-	};
-
 	CAlloc * 			m_pAlloc;
-	CHash<HV, Entry>	m_mpHvEntry;
+	CHash<HV, SAtom *>	m_mpHvPAtom;
 };
 
 CStringTable * CAsciString::s_pStrtab = nullptr;
@@ -223,6 +231,23 @@ void CString::SetPCoz(const char * pCozNew)
 	}
 }
 
+void CString::SetStr(const CString & strOther)
+{
+	if (m_pCoz == strOther.m_pCoz)
+		return;
+
+	// the other string is already interned, share its atom rather than rehashing the characters
+	const char * pCozNew = (strOther.m_pCoz) ? s_pStrtab->PCozAddRef(strOther.m_pCoz) : nullptr;
+
+	if(m_pCoz)
+	{
+		s_pStrtab->FreePCoz(m_pCoz, m_shash.HvRaw());
+	}
+
+	m_pCoz = pCozNew;
+	m_shash = strOther.m_shash;
+}
+
 CString StrFromConcat(const char * pCozA, const char * pCozEndA, const char * pCozB, const char * pCozEndB)
 {
 	size_t cBA = (pCozEndA - pCozA);
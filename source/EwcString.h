@@ -221,7 +221,7 @@ public:
 					CString(const CString & strOther)
 					:m_pCoz(nullptr)
 					,m_shash(0)
-						{ SetPCoz(strOther.m_pCoz); }
+						{ SetStr(strOther); }
 
 					~CString()
 						{ SetPCoz(nullptr); }
@@ -232,7 +232,10 @@ public:
 						{ return !(*this == strOther); }
 
 	CString &		operator=(const CString & strOther)
-						{ return *this = strOther.m_pCoz; }
+						{ 
+							SetStr(strOther);
+							return *this;
+						}
 	CString &		operator=(const char * pCoz)
 						{
 							if (m_pCoz != pCoz)
@@ -252,6 +255,7 @@ public:
 
 	void			SetPCoz(const char * pCozNew);
 	void			SetPCo(const char * pChNew, size_t cCodepoint);
+	void			SetStr(const CString & strOther);
 
 	size_t			CB() const
 						{ return EWC::CBCoz(m_pCoz); }
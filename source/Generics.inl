@@ -170,20 +170,26 @@ public:
 								:m_pGenmapKey(nullptr)
 								,m_pTin(nullptr)
 								,m_pInsreq(nullptr)
+								,m_iEntryNextHv(-1)
 									{ ; }
 
 		SGenericMap *			m_pGenmapKey;	// genmap used as a key to lookup this entry 
 		STypeInfo *				m_pTin;
 		SInstantiateRequest *	m_pInsreq;
+		int						m_iEntryNextHv;	// next entry whose key has the same structural hash
 	};
 
 	struct SEntryBlock	// tag = block
 	{
 								SEntryBlock (EWC::CAlloc * pAlloc)
 								:m_aryEntry(pAlloc, EWC::BK_TypeCheckGenerics)
+								,m_mpHvIEntry(pAlloc, EWC::BK_TypeCheckGenerics, 0)
+								,m_aryIEntryUnhashed(pAlloc, EWC::BK_TypeCheckGenerics)
 									{ ; }
 
 		EWC::CDynAry<SEntry>	m_aryEntry;
+		EWC::CHash<HV, int>		m_mpHvIEntry;			// genmap structural hash -> most recent entry with that hash
+		EWC::CDynAry<int>		m_aryIEntryUnhashed;	// entries keyed by a partially anchored genmap, always compared
 	};
 
 								CGenericRegistry(EWC::CAlloc * pAlloc)
@@ -200,6 +206,7 @@ public:
 	void						Cleanup();
 
 	SEntry *					PEntryLookup(CSTNode * pStnodInstFrom, SGenericMap * pGenmap);
+	SEntry *					PEntryLookup(SEntryBlock * pBlock, SGenericMap * pGenmap, bool fIsHashed, HV hvGenmap);
 	SEntry *					PEntryEnsure(CSTNode * pStnodInstFrom, SGenericMap * pGenmap);
 	SInstantiateRequest *		PInsreqNew(CSTNode * pStnodInstFrom, SGenericMap * pGenmap);
 
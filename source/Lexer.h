@@ -84,6 +84,7 @@ enum TOK
 		RW(Const) STR(const), \
 		RW(Immutable) STR(immutable), \
 		RW(InArg) STR(inarg), \
+		RW(Restrict) STR(restrict), \
 		RW(Typedef) STR(typedef), \
 		RW(Soa) STR(SOA), \
 		RW(Inline) STR(inline), \
@@ -105,14 +106,25 @@ enum TOK
 		RW(ForeignLibraryDirective) STR(#foreign_library), \
 		RW(StaticLibraryDirective) STR(#static_library), \
 		RW(DynamicLibraryDirective) STR(#dynamic_library), \
+		RW(RunDirective) STR(#run), \
 		RW(Cast) STR(cast), \
 		RW(AutoCast) STR(acast), \
 		RW(Sizeof) STR(sizeof), \
 		RW(Alignof) STR(alignof), \
 		RW(Typeof) STR(typeof), \
 		RW(Typeinfo) STR(typeinfo), \
+		RW(SimdShuffle) STR(simd_shuffle), \
+		RW(SimdSelect) STR(simd_select), \
+		RW(SimdReduceAdd) STR(simd_reduce_add), \
+		RW(SimdReduceMin) STR(simd_reduce_min), \
+		RW(SimdReduceMax) STR(simd_reduce_max), \
 		RW(CDecl) STR(#cdecl), \
-		RW(StdCall) STR(#stdcall)
+		RW(StdCall) STR(#stdcall), \
+		RW(TargetClones) STR(#target_clones), \
+		RW(BoundsCheck) STR(#bounds_check), \
+		RW(NoBoundsCheck) STR(#no_bounds_check), \
+		RW(SimdDirective) STR(#simd), \
+		RW(ReorderDirective) STR(#reorder)
 
 #define RW(x) RWORD_##x
 #define STR(x)
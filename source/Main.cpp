@@ -48,7 +48,13 @@ public:
 
 	void Parse(int cpChzArg, const char * apChzArg[])
 	{
-		HV hvLlvm = HvFromPCoz("-llvm");
+		// commands that consume the following argument as their value
+		static const char * s_apChzValueCommand[] = { "-llvm", "-mcpu", "-mattr" };
+		HV aHvValueCommand[EWC_DIM(s_apChzValueCommand)];
+		for (size_t ipChzCommand = 0; ipChzCommand < EWC_DIM(s_apChzValueCommand); ++ipChzCommand)
+		{
+			aHvValueCommand[ipChzCommand] = HvFromPCoz(s_apChzValueCommand[ipChzCommand]);
+		}
 
 		const char * pChzFilename = nullptr;
 		for (int ipChz = 1; ipChz < cpChzArg; ++ipChz)
@@ -65,11 +71,19 @@ public:
 					SCommand * pCom = m_aryCom.AppendNew();
 					pCom->m_hvName = HvFromPCoz(pChzArg);
 
-					if (pCom->m_hvName == hvLlvm)
+					pCom->m_pCozValue = nullptr;
+
+					size_t ipChzCommand = 0;
+					while (ipChzCommand < EWC_DIM(s_apChzValueCommand) && aHvValueCommand[ipChzCommand] != pCom->m_hvName)
+					{
+						++ipChzCommand;
+					}
+
+					if (ipChzCommand < EWC_DIM(s_apChzValueCommand))
 					{
 						if (ipChz + 1 >= cpChzArg)
 						{
-							printf("expected argument after -llvm\n");
+							printf("expected argument after %s\n", pChzArg);
 						}
 						else
 						{
@@ -104,6 +118,22 @@ public:
 		}
 	}
 
+	const char * PCozCommandValue(const char * pChzCommand)
+	{
+		HV hvCommand = HvFromPCoz(pChzCommand);
+
+		// last value wins, so later arguments override earlier ones
+		const char * pCozValue = nullptr;
+		for (size_t iCom = 0; iCom < m_aryCom.C(); ++iCom)
+		{
+			if (m_aryCom[iCom].m_hvName == hvCommand)
+			{
+				pCozValue = m_aryCom[iCom].m_pCozValue;
+			}
+		}
+		return pCozValue;
+	}
+
 	bool FHasCommand(const char * pChzCommand)
 	{
 		HV hvCommand = HvFromPCoz(pChzCommand);
@@ -134,6 +164,17 @@ void PrintCommandLineOptions()
 	printf("    -bytecode : compile and run input files as bytecode\n");
 	printf("    -useLLD   : Use llvm linker (rather than linke.exe) use this to emit DWARF debug data.\n");
 	printf("    -llvm cmd : run an llvm command line\n");
+	printf("    -mcpu cpu : Generate code for a specific cpu (ie. skylake), 'native' targets the host cpu\n");
+	printf("    -mattr fs : Enable/disable llvm target features (ie. +avx2,-sse4a)\n");
+	printf("    -g        : Generate full debug info (default)\n");
+	printf("    -g0       : Don't generate debug info\n");
+	printf("    -gline-tables-only : Only generate line tables, enough for symbolized stack traces\n");
+	printf("    -boundsCheck   : Check array indices at runtime\n");
+	printf("    -noBoundsCheck : Don't check array indices at runtime (default)\n");
+	printf("    -layoutReport  : Print every struct's size, alignment and padding bytes\n");
+	printf("    -tcStats       : Print type checker wait counts, timings and any stalled wait graph\n");
+	printf("    -lazyTypeCheck : Only type check procedure bodies reachable from main or public linkage procedures\n");
+	printf("    -skipUnchanged : Skip compiling when no source file or option changed since the last -skipUnchanged build\n");
 }
 
 CFileSearch::CFileSearch(EWC::CAlloc * pAlloc)
@@ -292,6 +333,11 @@ int main(int cpChzArg, const char * apChzArg[])
 		grfcompile.AddFlags(FCOMPILE_FastIsel);
 	}
 
+	if (comline.FHasCommand("-layoutReport"))
+	{
+		grfcompile.AddFlags(FCOMPILE_LayoutReport);
+	}
+
 	static const int s_cBHeap = 1000 * 1024;
 	static const int s_cBError = 100 * 1024;
 	u8 * aB = nullptr;
@@ -318,6 +364,35 @@ int main(int cpChzArg, const char * apChzArg[])
 			work.m_optlevel = OPTLEVEL_Release;
 		}
 
+		work.m_pChzTargetCpu = comline.PCozCommandValue("-mcpu");
+		work.m_pChzTargetFeatures = comline.PCozCommandValue("-mattr");
+
+		if (comline.FHasCommand("-g0"))
+		{
+			work.m_debuginfo = DEBUGINFO_None;
+		}
+		else if (comline.FHasCommand("-gline-tables-only"))
+		{
+			work.m_debuginfo = DEBUGINFO_LineTablesOnly;
+		}
+
+		work.m_fBoundsCheck = false;
+		if (comline.FHasCommand("-boundsCheck"))
+		{
+			work.m_fBoundsCheck = true;
+		}
+		else if (comline.FHasCommand("-noBoundsCheck"))
+		{
+			work.m_fBoundsCheck = false;
+		}
+
+		work.m_fReportTypeCheckStats = comline.FHasCommand("-tcStats");
+		work.m_fSkipUnchanged = comline.FHasCommand("-skipUnchanged");
+		if (comline.FHasCommand("-lazyTypeCheck"))
+		{
+			work.m_grfunt.Clear(FUNT_ResolveAllSymbols);
+		}
+
 		BeginWorkspace(&work);
 
 #ifdef EWC_TRACK_ALLOCATION
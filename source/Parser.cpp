@@ -58,6 +58,7 @@ CSTNode * PStnodParseMultiplicativeExpression(CParseContext * pParctx, SLexer *
 CSTNode * PStnodParseProcParameterList(CParseContext * pParctx, SLexer * pLex, CSymbolTable * pSymtabProc, bool fIsOpOverload);
 CSTNode * PStnodParseReturnArrow(CParseContext * pParctx, SLexer * pLex, CSymbolTable * pSymtabProc);
 CSTNode * PStnodParseStatement(CParseContext * pParctx, SLexer * pLex);
+CSTNode * PStnodParseUnaryExpression(CParseContext * pParctx, SLexer * pLex);
 CSTNode * PStnodParseTypeSpecifier(CParseContext * pParctx, SLexer * pLex, const char * pCozErrorContext, GRFPDECL grfpdecl);
 CSTNode * PStnodParseGenericTypeDecl(CParseContext * pParctx, SLexer * pLex, GRFPDECL grfpdecl);
 
@@ -93,6 +94,7 @@ struct ProcSymtabStack // tag = procss
 };
 
 static int g_nSymtabVisitId = 1; // visit index used by symbol table collision walks
+static u64 g_nSymtabGeneration = 1; // bumped whenever a symbol is added to any table, invalidates lookup caches
 
 const char * PChzFromPark(PARK park)
 {
@@ -177,6 +179,7 @@ const char * PChzFromArymemb(ARYMEMB arymemb)
 	{
 		"count",
 		"data",
+		"capacity",
 	};
 	EWC_CASSERT(EWC_DIM(s_mpArymembPChz) == ARYMEMB_Max, "missing ARYMEMB string");
 	if (arymemb == ARYMEMB_Nil)
@@ -261,6 +264,7 @@ const char * PChzFromQualk(QUALK qualk)
 	{
 		"const",
 		"inarg",
+		"restrict",
 	};
 	EWC_CASSERT(EWC_DIM(s_mpQualkPChz) == QUALK_Max, "missing QUALK string");
 	if (qualk == QUALK_Nil)
@@ -352,6 +356,36 @@ const char * PChzFromInlinek(INLINEK inlinek)
 	return s_mpInlinekPChz[inlinek];
 }
 
+static const char * s_mpIsalevelPChz[] =
+{
+	"baseline",		// ISALEVEL_Baseline
+	"sse4.2",		// ISALEVEL_Sse42
+	"avx2",			// ISALEVEL_Avx2
+	"avx512",		// ISALEVEL_Avx512
+};
+EWC_CASSERT(EWC_DIM(s_mpIsalevelPChz) == ISALEVEL_Max, "missing ISALEVEL string");
+
+const char * PChzFromIsalevel(ISALEVEL isalevel)
+{
+	if (isalevel == ISALEVEL_Nil)
+		return "Nil";
+
+	if ((isalevel < ISALEVEL_Nil) | (isalevel >= ISALEVEL_Max))
+		return "Unknown ISALEVEL";
+
+	return s_mpIsalevelPChz[isalevel];
+}
+
+ISALEVEL IsalevelFromPCoz(const char * pCoz)
+{
+	for (int isalevel = ISALEVEL_Min; isalevel < ISALEVEL_Max; ++isalevel)
+	{
+		if (FAreCozEqual(pCoz, s_mpIsalevelPChz[isalevel]))
+			return (ISALEVEL)isalevel;
+	}
+	return ISALEVEL_Nil;
+}
+
 CSTValue * PStvalExpected(CSTNode * pStnod)
 {
 	if (EWC_FVERIFY(pStnod && pStnod->m_pStval, "Expected value"))
@@ -370,6 +404,23 @@ CSTValue * PStvalCopy(CAlloc * pAlloc, CSTValue * pStval)
 	return pStvalRet;
 }
 
+CSTRun * PStrunAllocBaked(CAlloc * pAlloc, const u8 * pBResult, size_t cBResult)
+{
+	// the result bytes are allocated along with the map so they're freed when the node deletes its stmap
+
+	size_t cBStrun = CBAlign(sizeof(CSTRun), 16);
+	u8 * pB = (u8 *)pAlloc->EWC_ALLOC(cBStrun + cBResult, 16);
+
+	auto pStrun = new(pB) CSTRun();
+	if (pBResult)
+	{
+		pStrun->m_pBResult = &pB[cBStrun];
+		pStrun->m_cBResult = cBResult;
+		memcpy(pStrun->m_pBResult, pBResult, cBResult);
+	}
+	return pStrun;
+}
+
 CSTNode * PStnodCopy(CAlloc * pAlloc, CSTNode * pStnodSrc, EWC::CHash<CSTNode *, CSTNode *> * pmpPStnodSrcPStnodDst)
 {
 	auto pStnodDst = EWC_NEW(pAlloc, CSTNode) CSTNode(pAlloc, pStnodSrc->m_lexloc);
@@ -558,6 +609,92 @@ CSTNode * PStnodAllocateIdentifier(CAlloc * pAlloc, const SLexerLocation & lexlo
 	return pStnod;
 }
 
+static CSTNode * PStnodAllocateReservedWord(CAlloc * pAlloc, const SLexerLocation & lexloc, RWORD rword, CSTNode * pStnodChild)
+{
+	CSTNode * pStnodRword = EWC_NEW(pAlloc, CSTNode) CSTNode(pAlloc, lexloc);
+	pStnodRword->m_tok = TOK_ReservedWord;
+	pStnodRword->m_park = PARK_ReservedWord;
+	pStnodRword->IAppendChild(pStnodChild);
+
+	auto pStval = EWC_NEW(pAlloc, CSTValue) CSTValue();
+	pStval->m_rword = rword;
+	pStnodRword->m_pStval = pStval;
+	return pStnodRword;
+}
+
+static CSTNode * PStnodAllocateCall(
+	CAlloc * pAlloc,
+	const SLexerLocation & lexloc,
+	const char * pCozProc,
+	CSTNode ** apStnodArg,
+	int cStnodArg)
+{
+	CSTNode * pStnodCall = EWC_NEW(pAlloc, CSTNode) CSTNode(pAlloc, lexloc);
+	pStnodCall->m_tok = TOK('(');
+	pStnodCall->m_park = PARK_ProcedureCall;
+	pStnodCall->IAppendChild(PStnodAllocateIdentifier(pAlloc, lexloc, pCozProc));
+
+	for (int iStnodArg = 0; iStnodArg < cStnodArg; ++iStnodArg)
+	{
+		pStnodCall->IAppendChild(apStnodArg[iStnodArg]);
+	}
+	return pStnodCall;
+}
+
+static CSTNode * PStnodParseNewOrDelete(CParseContext * pParctx, SLexer * pLex, RWORD rword)
+{
+	// new and delete are lowered here to calls into the allocator runtime in basic.moe:
+	//   new T				-> (new T PVAllocFromContext(sizeof(T), alignof(T)))
+	//   new(allocctx) T	-> (new T PVAllocWith(allocctx, sizeof(T), alignof(T)))
+	//   delete p			-> FreeFromContext(p)
+	//   delete(allocctx) p	-> FreeWith(allocctx, p)
+	// allocctx is an SAllocatorContext, the allocator proc along with the state it allocates from.
+	// the new node is kept around so codegen can cast the result and default initialize it.
+
+	auto pAlloc = pParctx->m_pAlloc;
+	SLexerLocation lexloc(pLex);
+	TokNext(pLex);
+
+	CSTNode * pStnodAllocator = nullptr;
+	if (FConsumeToken(pLex, TOK('(')))
+	{
+		pStnodAllocator = PStnodParseExpression(pParctx, pLex);
+		if (!pStnodAllocator)
+		{
+			ParseError(pParctx, pLex, "%s missing allocator.", PCozFromRword(rword));
+		}
+		FExpect(pParctx, pLex, TOK(')'));
+	}
+
+	CSTNode * pStnodOperand = PStnodParseUnaryExpression(pParctx, pLex);
+	if (!pStnodOperand)
+	{
+		ParseError(pParctx, pLex, (rword == RWORD_New) ? "%s missing type." : "%s missing pointer.", PCozFromRword(rword));
+		return nullptr;
+	}
+
+	CSTNode * apStnodArg[3];
+	int cStnodArg = 0;
+	if (pStnodAllocator)
+	{
+		apStnodArg[cStnodArg++] = pStnodAllocator;
+	}
+
+	if (rword == RWORD_Delete)
+	{
+		apStnodArg[cStnodArg++] = pStnodOperand;
+		return PStnodAllocateCall(pAlloc, lexloc, (pStnodAllocator) ? "FreeWith" : "FreeFromContext", apStnodArg, cStnodArg);
+	}
+
+	apStnodArg[cStnodArg++] = PStnodAllocateReservedWord(pAlloc, lexloc, RWORD_Sizeof, PStnodCopy(pAlloc, pStnodOperand));
+	apStnodArg[cStnodArg++] = PStnodAllocateReservedWord(pAlloc, lexloc, RWORD_Alignof, PStnodCopy(pAlloc, pStnodOperand));
+	auto pStnodCall = PStnodAllocateCall(pAlloc, lexloc, (pStnodAllocator) ? "PVAllocWith" : "PVAllocFromContext", apStnodArg, cStnodArg);
+
+	auto pStnodNew = PStnodAllocateReservedWord(pAlloc, lexloc, RWORD_New, pStnodOperand);
+	pStnodNew->IAppendChild(pStnodCall);
+	return pStnodNew;
+}
+
 CSTNode * PStnodParseIdentifier(CParseContext * pParctx, SLexer * pLex)
 {
 	if (pLex->m_tok != TOK_Identifier)
@@ -1140,6 +1277,70 @@ CSTNode * PStnodParseUnaryExpression(CParseContext * pParctx, SLexer * pLex)
 
 					return pStnodRword;
 				} 
+			case RWORD_SimdShuffle:
+			case RWORD_SimdSelect:
+			case RWORD_SimdReduceAdd:
+			case RWORD_SimdReduceMin:
+			case RWORD_SimdReduceMax:
+				{
+					TOK tokPrev = TOK(pLex->m_tok);	
+					SLexerLocation lexloc(pLex);
+					TokNext(pLex);
+
+					FExpect(pParctx, pLex, TOK('('));
+
+					CSTNode * pStnodRword = EWC_NEW(pParctx->m_pAlloc, CSTNode) CSTNode(pParctx->m_pAlloc, lexloc);
+					pStnodRword->m_tok = tokPrev;
+					pStnodRword->m_park = PARK_ReservedWord;
+
+					do
+					{
+						CSTNode * pStnodArg = PStnodParseLogicalOrExpression(pParctx, pLex);
+						if (!pStnodArg)
+						{
+							ParseError(pParctx, pLex, "%s missing argument.", PCozFromRword(rword));
+							break;
+						}
+						pStnodRword->IAppendChild(pStnodArg);
+					} while (FConsumeToken(pLex, TOK(',')));
+
+					FExpect(pParctx, pLex, TOK(')'));
+
+					auto pStval = EWC_NEW(pParctx->m_pAlloc, CSTValue) CSTValue();
+					pStval->m_rword = rword;
+					pStnodRword->m_pStval = pStval;
+
+					return pStnodRword;
+				}
+			case RWORD_RunDirective:
+				{
+					TOK tokPrev = TOK(pLex->m_tok);	
+					SLexerLocation lexloc(pLex);
+					TokNext(pLex);
+
+					CSTNode * pStnodChild = PStnodParseUnaryExpression(pParctx, pLex);
+					if (!pStnodChild)
+					{
+						ParseError(pParctx, pLex, "%s missing procedure call.", PCozFromRword(rword));
+						return nullptr;
+					}
+
+					CSTNode * pStnodRword = EWC_NEW(pParctx->m_pAlloc, CSTNode) CSTNode(pParctx->m_pAlloc, lexloc);
+					pStnodRword->m_tok = tokPrev;
+					pStnodRword->m_park = PARK_ReservedWord;
+					pStnodRword->IAppendChild(pStnodChild);
+
+					auto pStval = EWC_NEW(pParctx->m_pAlloc, CSTValue) CSTValue();
+					pStval->m_rword = rword;
+					pStnodRword->m_pStval = pStval;
+
+					return pStnodRword;
+				}
+			case RWORD_New:
+			case RWORD_Delete:
+				{
+					return PStnodParseNewOrDelete(pParctx, pLex, rword);
+				}
 			case RWORD_Typeof:
 				{
 					ParseError(pParctx, pLex, "typeof not implemented yet.");
@@ -1534,6 +1735,12 @@ CSTNode * PStnodParseArrayDecl(CParseContext * pParctx, SLexer * pLex, GRFPDECL
 		}
 
 		FExpect(pParctx, pLex, TOK(']'));
+
+		if (RwordLookup(pLex) == RWORD_Soa)
+		{
+			TokNext(pLex);
+			pStnodArray->m_grfstnod.AddFlags(FSTNOD_Soa);
+		}
 		return pStnodArray;
 	}
 	return nullptr;
@@ -1855,7 +2062,7 @@ CSTNode * PStnodParsePointerDecl(CParseContext * pParctx, SLexer * pLex)
 CSTNode * PStnodParseQualifierDecl(CParseContext * pParctx, SLexer * pLex)
 {
 	RWORD rword = RwordLookup(pLex);
-	if (rword == RWORD_Const || rword == RWORD_InArg)
+	if (rword == RWORD_Const || rword == RWORD_InArg || rword == RWORD_Restrict)
 	{
 		SLexerLocation lexloc(pLex);
 		TokNext(pLex);	
@@ -2901,7 +3108,9 @@ CSTNode * PStnodParseDefinition(CParseContext * pParctx, SLexer * pLex)
 
 				INLINEK inlinek = INLINEK_Nil;
 				CALLCONV callconv = CALLCONV_Nil;
+				BOUNDSCHECK boundscheck = BOUNDSCHECK_Nil;
 				GRFTINPROC grftinproc;
+				GRFISALEVEL grfisaClones;
 				pStproc->m_iStnodBody = -1;
 				if (pLex->m_tok == TOK_ReservedWord)
 				{
@@ -2930,6 +3139,35 @@ CSTNode * PStnodParseDefinition(CParseContext * pParctx, SLexer * pLex)
 						case RWORD_StdCall:		callconv = CALLCONV_StdcallX86;		break;
 						case RWORD_Inline:		inlinek = INLINEK_AlwaysInline;		break;
 						case RWORD_NoInline:	inlinek = INLINEK_NoInline;			break;
+						case RWORD_BoundsCheck:		boundscheck = BOUNDSCHECK_Enabled;	break;
+						case RWORD_NoBoundsCheck:	boundscheck = BOUNDSCHECK_Disabled;	break;
+						case RWORD_TargetClones:
+							{
+								// #target_clones "sse4.2" "avx2" - the baseline version is always generated
+								grfisaClones.AddFlags(FISALEVEL_Baseline);
+								if (pLex->m_tok != TOK_Literal || pLex->m_litk != LITK_String)
+								{
+									ParseError(pParctx, pLex, "#target_clones expects one or more instruction set names");
+								}
+
+								while (pLex->m_tok == TOK_Literal && pLex->m_litk == LITK_String)
+								{
+									ISALEVEL isalevel = IsalevelFromPCoz(pLex->m_str.PCoz());
+									if (isalevel == ISALEVEL_Nil)
+									{
+										ParseError(
+											pParctx,
+											pLex,
+											"Unknown #target_clones instruction set '%s', expected sse4.2, avx2 or avx512",
+											pLex->m_str.PCoz());
+									}
+									else
+									{
+										grfisaClones.AddFlags(0x1 << isalevel);
+									}
+									TokNext(pLex);
+								}
+							} break;
 						case RWORD_Commutative:
 							{
 								if (rword == RWORD_Operator)
@@ -3007,10 +3245,18 @@ CSTNode * PStnodParseDefinition(CParseContext * pParctx, SLexer * pLex)
 					}
 				}
 
+				if (grfisaClones != FISALEVEL_None && grftinproc.FIsSet(FTINPROC_IsForeign))
+				{
+					ParseError(pParctx, pLex, "Foreign procedure '%s' cannot specify #target_clones", strName.PCoz());
+					grfisaClones = FISALEVEL_None;
+				}
+
 				pTinproc->m_grftinproc = grftinproc;
 				pTinproc->m_pStnodDefinition = pStnodProc;
 				pTinproc->m_callconv = callconv;
 				pTinproc->m_inlinek = inlinek;
+				pTinproc->m_boundscheck = boundscheck;
+				pTinproc->m_grfisaClones = grfisaClones;
 
 				CheckTinprocGenerics(pParctx, pStnodProc, pTinproc);
 
@@ -3221,6 +3467,25 @@ CSTNode * PStnodParseDefinition(CParseContext * pParctx, SLexer * pLex)
 					}
 				}
 
+				GRFSTRUCT grfstruct;
+				while (1)
+				{
+					RWORD rwordDirective = RwordLookup(pLex);
+					if (rwordDirective == RWORD_SimdDirective)
+					{
+						grfstruct.AddFlags(FSTRUCT_Simd);
+					}
+					else if (rwordDirective == RWORD_ReorderDirective)
+					{
+						grfstruct.AddFlags(FSTRUCT_Reorder);
+					}
+					else
+					{
+						break;
+					}
+					TokNext(pLex);
+				}
+
 				FExpect(pParctx, pLex, TOK('{'));
 
 				// NOTE: struct symbol tables at the global scope should be unordered.
@@ -3285,6 +3550,7 @@ CSTNode * PStnodParseDefinition(CParseContext * pParctx, SLexer * pLex)
 
 				auto pTinstruct = PTinstructAlloc(pSymtab, strIdent, cStnodField, cpStnodParam);
 				pTinstruct->m_pStnodStruct = pStnodStruct;
+				pTinstruct->m_grfstruct = grfstruct;
 
 				for ( ; ppStnodMember != ppStnodMemberMax; ++ppStnodMember)
 				{
@@ -3299,6 +3565,7 @@ CSTNode * PStnodParseDefinition(CParseContext * pParctx, SLexer * pLex)
 						{
 							auto pTypememb = pTinstruct->m_aryTypemembField.AppendNew();
 							pTypememb->m_pStnod = pStnodMember;
+							pTypememb->m_iTypemembDecl = s32(pTinstruct->m_aryTypemembField.C() - 1);
 						}
 						else
 						{
@@ -3307,6 +3574,7 @@ CSTNode * PStnodParseDefinition(CParseContext * pParctx, SLexer * pLex)
 							{
 								auto pTypememb = pTinstruct->m_aryTypemembField.AppendNew();
 								pTypememb->m_pStnod = pStnodMember->PStnodChild(iStnod);
+								pTypememb->m_iTypemembDecl = s32(pTinstruct->m_aryTypemembField.C() - 1);
 							}
 						}
 					}
@@ -4097,6 +4365,19 @@ static inline TABVIS TabvisCompute(CSymbolTable * pSymtabCur, s32 iNestingDepthQ
 	return TABVIS_Ordered;
 }
 
+static inline bool FIsSymbolVisible(SSymbol * pSym, TABVIS tabvis, const SLexerLocation & lexloc)
+{
+	if (pSym->m_grfsym.FIsSet(FSYM_VisibleWhenNested) | (tabvis == TABVIS_Unordered))
+		return true;
+	if (tabvis == TABVIS_NoInstances)
+		return false;
+
+	// compare against the definition in place, copying the location would touch the filename refcount
+	static const SLexerLocation s_lexlocNil;
+	const SLexerLocation & lexlocSym = (pSym->m_pStnodDefinition) ? pSym->m_pStnodDefinition->m_lexloc : s_lexlocNil;
+	return lexlocSym <= lexloc;
+}
+
 SSymbol * CSymbolTable::CSymbolIterator::PSymNext()
 {
 	if (!m_pSym)
@@ -4109,9 +4390,7 @@ SSymbol * CSymbolTable::CSymbolIterator::PSymNext()
 	auto pSymIt = m_pSym;
 	while (pSymIt)
 	{
-		SLexerLocation lexlocSym = (pSymIt->m_pStnodDefinition) ? pSymIt->m_pStnodDefinition->m_lexloc : SLexerLocation();
-		bool fVisibleWhenNested = pSymIt->m_grfsym.FIsSet(FSYM_VisibleWhenNested);
-		if (fVisibleWhenNested | (tabvis == TABVIS_Unordered) | ((tabvis < TABVIS_NoInstances) & (lexlocSym <= m_lexloc)))
+		if (FIsSymbolVisible(pSymIt, tabvis, m_lexloc))
 		{
 			apSym[ipSym++] = pSymIt;
 			if (pSymIt->m_pSymPrev)
@@ -4138,9 +4417,7 @@ SSymbol * CSymbolTable::CSymbolIterator::PSymNext()
 			pSymIt = *ppSym;
 			while (pSymIt)
 			{
-				SLexerLocation lexlocSym = (pSymIt->m_pStnodDefinition) ? pSymIt->m_pStnodDefinition->m_lexloc : SLexerLocation();
-				bool fVisibleWhenNested = pSymIt->m_grfsym.FIsSet(FSYM_VisibleWhenNested);
-				if (fVisibleWhenNested | (tabvis == TABVIS_Unordered) | ((tabvis < TABVIS_NoInstances) & (lexlocSym <= m_lexloc)))
+				if (FIsSymbolVisible(pSymIt, tabvis, m_lexloc))
 				{
 					apSym[ipSym++] = pSymIt;
 					if (pSymIt->m_pSymPrev)
@@ -4629,6 +4906,7 @@ SSymbol * CSymbolTable::PSymEnsure(
 	{
 		pSym = PSymNewUnmanaged(strName, pStnodDefinition, grfsym);
 		(void) m_hashHvPSym.FinsEnsureKeyAndValue(strName.Hv(), pSym);
+		++g_nSymtabGeneration;
 	}
 
 	pSym->m_pSymPrev = pSymPrev;
@@ -4779,7 +5057,6 @@ SSymbolBase * PSymbaseLookup(
 	}
 
 	CSymbolTable * pSymtabIt = (grfsymlook.FIsSet(FSYMLOOK_Ancestors)) ? pSymtab->m_pSymtabParent : nullptr;
-	SLexerLocation lexlocChild = lexloc;
 	while (pSymtabIt)
 	{
 		auto pSym = pSymtabIt->PSymLookup(str, lexloc, grfsymlook);
@@ -4816,54 +5093,85 @@ SSymbol * CSymbolTable::PSymLookup(const CString & str, const SLexerLocation & l
 	if (ppSymtabOut)
 		*ppSymtabOut = this;
 
+	HV hv = str.Hv();
+
+	// the ancestor walk is only cached if every table it probes is insensitive to the lookup location: the local
+	//  table and each ancestor missed the name entirely, and the table that resolved it is unordered.
+	bool fIsCacheable = true;
 	if (grfsymlook.FIsSet(FSYMLOOK_Local))
 	{
-		SSymbol ** ppSym = m_hashHvPSym.Lookup(str.Hv()); 
+		SSymbol ** ppSym = m_hashHvPSym.Lookup(hv); 
 		if (ppSym)
 		{
 			auto tabvis = TabvisCompute(this, m_iNestingDepth, grfsymlook);
-			SSymbol * pSym = *ppSym;
-
-			while (pSym)
+			for (SSymbol * pSym = *ppSym; pSym; pSym = pSym->m_pSymPrev)
 			{
-				SLexerLocation lexlocSym = (pSym->m_pStnodDefinition) ? pSym->m_pStnodDefinition->m_lexloc : SLexerLocation();
-				bool fVisibleWhenNested = pSym->m_grfsym.FIsSet(FSYM_VisibleWhenNested);
-				if (fVisibleWhenNested | (tabvis == TABVIS_Unordered) | ((tabvis < TABVIS_NoInstances) & (lexlocSym <= lexloc)))
-				{
+				if (FIsSymbolVisible(pSym, tabvis, lexloc))
 					return pSym;
-				}
-				pSym = pSym->m_pSymPrev;
 			}
+			fIsCacheable = false;
 		}
 	}
 
-	CSymbolTable * pSymtab = (grfsymlook.FIsSet(FSYMLOOK_Ancestors)) ? m_pSymtabParent : nullptr;
-	SLexerLocation lexlocChild = lexloc;
-	while (pSymtab)
+	if (!grfsymlook.FIsSet(FSYMLOOK_Ancestors) || !m_pSymtabParent)
+		return nullptr;
+
+	if (fIsCacheable)
 	{
-		SSymbol ** ppSym = pSymtab->m_hashHvPSym.Lookup(str.Hv()); 
+		SLookupCache * pLookc = m_hashHvLookc.Lookup(hv);
+		if (pLookc && 
+			pLookc->m_nGeneration == g_nSymtabGeneration && 
+			pLookc->m_grfsymlook == grfsymlook && 
+			pLookc->m_pSymtabParent == m_pSymtabParent)
+		{
+			if (pLookc->m_pSym && ppSymtabOut)
+				*ppSymtabOut = pLookc->m_pSymtab;
+			return pLookc->m_pSym;
+		}
+	}
 
+	SSymbol * pSymFound = nullptr;
+	CSymbolTable * pSymtab = m_pSymtabParent;
+	while (pSymtab)
+	{
+		SSymbol ** ppSym = pSymtab->m_hashHvPSym.Lookup(hv); 
 		if (ppSym)
 		{
 			auto tabvis = TabvisCompute(pSymtab, m_iNestingDepth, grfsymlook);
-			SSymbol * pSym = *ppSym;
-			while (pSym)
+			for (SSymbol * pSym = *ppSym; pSym; pSym = pSym->m_pSymPrev)
 			{
-				SLexerLocation lexlocSym = (pSym->m_pStnodDefinition) ? pSym->m_pStnodDefinition->m_lexloc : SLexerLocation();
-				bool fVisibleWhenNested = pSym->m_grfsym.FIsSet(FSYM_VisibleWhenNested);
-				if (fVisibleWhenNested | (tabvis == TABVIS_Unordered) | ((tabvis < TABVIS_NoInstances) & (lexlocSym <= lexloc)))
+				if (FIsSymbolVisible(pSym, tabvis, lexloc))
 				{
-					if (ppSymtabOut)
-						*ppSymtabOut = pSymtab;
-					return pSym;
+					pSymFound = pSym;
+					break;
 				}
-				pSym = pSym->m_pSymPrev;
 			}
+
+			if (pSymFound)
+			{
+				fIsCacheable &= (tabvis == TABVIS_Unordered);
+				break;
+			}
+			fIsCacheable = false;
 		}
 
 		pSymtab = pSymtab->m_pSymtabParent;
 	}
-	return nullptr; 
+
+	if (pSymFound && ppSymtabOut)
+		*ppSymtabOut = pSymtab;
+
+	if (fIsCacheable)
+	{
+		SLookupCache * pLookc = nullptr;
+		(void) m_hashHvLookc.FinsEnsureKey(hv, &pLookc);
+		pLookc->m_pSym = pSymFound;
+		pLookc->m_pSymtab = pSymtab;
+		pLookc->m_pSymtabParent = m_pSymtabParent;
+		pLookc->m_nGeneration = g_nSymtabGeneration;
+		pLookc->m_grfsymlook = grfsymlook;
+	}
+	return pSymFound; 
 }
 
 STypeInfoLiteral * CSymbolTable::PTinlitFromLitk(LITK litk)
@@ -4992,6 +5300,11 @@ void AppendTypeDescriptor(STypeInfo * pTin, SStringEditBuffer * pSeb)
 				EWC_ASSERT(false, "Unhandled ARYK");
 				break;
 			}
+
+			if (pTinary->m_fIsSoa)
+			{
+				pSeb->AppendCoz("SOA ");
+			}
 			AppendTypeDescriptor(pTinary->m_pTin, pSeb);
 		} break;
 	case TINK_Qualifier:
@@ -5127,16 +5440,220 @@ void CUniqueTypeRegistry::Clear()
 	m_hashHvPTinUnique.Clear(0);
 }
 
-static inline u64 HvForPTin(STypeInfo * pTin, TINK tink, u8 other = 0)
+// Types are hash-consed structurally: a type's key is computed from its kind, its own fields and the identity of its
+//  already unique component types, so uniquing a type constructor no longer builds a descriptor string for everything
+//  it wraps. Types that are never unique'd (literals, generics) fall back to their descriptor string.
+
+static inline HV HvConcatU64(HV hv, u64 n)
+{
+	return HvConcatPBFVN(hv, &n, sizeof(n));
+}
+
+static CSTNode * PStnodStructParameterList(STypeInfoStruct * pTinstruct)
+{
+	auto pStnodStruct = pTinstruct->m_pStnodStruct;
+	if (!pStnodStruct)
+	{
+		EWC_ASSERT(false, "expected an AST");
+		// may need to handle generic structs that haven't instantiated their AST yet.
+		return nullptr;
+	}
+
+	auto pStstruct = PStmapRtiCast<CSTStruct *>(pStnodStruct->m_pStmap);
+	if (!EWC_FVERIFY(pStstruct, "expected struct") || pStstruct->m_iStnodParameterList < 0)
+		return nullptr;
+
+	return pStnodStruct->PStnodChild(pStstruct->m_iStnodParameterList);
+}
+
+HV CUniqueTypeRegistry::HvConcatComponent(HV hv, STypeInfo * pTin)
+{
+	if (pTin->m_grftin.FIsSet(FTIN_IsUnique))
+		return HvConcatU64(hv, u64(uintptr_t(pTin)));
+
+	if (pTin->m_strDesc.FIsEmpty())
+	{
+		EWC::SStringEditBuffer seb(m_pAlloc);
+		AppendTypeDescriptor(pTin, &seb);
+	}
+	return HvConcatU64(hv, pTin->m_strDesc.Hv());
+}
+
+static inline bool FComponentsMatch(STypeInfo * pTinA, STypeInfo * pTinB)
 {
-	EWC_ASSERT(!pTin->m_strDesc.FIsEmpty(), "expected descriptor string");
-	return u64(u64(pTin->m_strDesc.Hv()) | (u64(tink) << 32) | (u64(other) << 40));
+	if (pTinA == pTinB)
+		return true;
+
+	// distinct unique types never match, the descriptors of non-unique components were built while hashing
+	if (pTinA->m_grftin.FIsSet(FTIN_IsUnique) | pTinB->m_grftin.FIsSet(FTIN_IsUnique))
+		return false;
+	return pTinA->m_strDesc == pTinB->m_strDesc;
 }
 
-static inline u64 HvForPTin(const CString & str, TINK tink)
+u64 CUniqueTypeRegistry::HvComputeUnique(STypeInfo * pTin)
 {
-	// really not needed, should switch back to just a string HV
-	return u64(str.Hv() ^ (u64(tink) << 56));
+	TINK tink = pTin->m_tink;
+	HV hv = HvFromPBFVN(&tink, sizeof(tink));
+
+	switch (pTin->m_tink)
+	{
+	case TINK_Pointer:
+		{
+			auto pTinptr = (STypeInfoPointer *)pTin;
+			hv = HvConcatComponent(hv, pTinptr->m_pTinPointedTo);
+		} break;
+	case TINK_Qualifier:
+		{
+			auto pTinqual = (STypeInfoQualifier *)pTin;
+			hv = HvConcatU64(hv, pTinqual->m_grfqualk.m_raw);
+			hv = HvConcatComponent(hv, pTinqual->m_pTin);
+		} break;
+	case TINK_Array:
+		{
+			auto pTinary = (STypeInfoArray *)pTin;
+			hv = HvConcatU64(hv, pTinary->m_aryk);
+			hv = HvConcatU64(hv, (pTinary->m_aryk == ARYK_Fixed) ? pTinary->m_c : 0);
+			hv = HvConcatU64(hv, pTinary->m_fIsSoa);
+			hv = HvConcatComponent(hv, pTinary->m_pTin);
+		} break;
+	case TINK_Procedure:
+		{
+			auto pTinproc = (STypeInfoProcedure *)pTin;
+			hv = HvConcatU64(hv, pTin->m_scopid);
+			hv = HvConcatU64(hv, pTin->m_strName.Hv());
+			hv = HvConcatU64(hv, pTinproc->m_arypTinParams.C());
+			for (size_t ipTin = 0; ipTin < pTinproc->m_arypTinParams.C(); ++ipTin)
+			{
+				hv = HvConcatComponent(hv, pTinproc->m_arypTinParams[ipTin]);
+			}
+
+			hv = HvConcatU64(hv, pTinproc->m_arypTinReturns.C());
+			for (size_t ipTin = 0; ipTin < pTinproc->m_arypTinReturns.C(); ++ipTin)
+			{
+				hv = HvConcatComponent(hv, pTinproc->m_arypTinReturns[ipTin]);
+			}
+
+			hv = HvConcatU64(hv, pTinproc->FHasVarArgs());
+			hv = HvConcatU64(hv, pTinproc->m_grftinproc.FIsSet(FTINPROC_IsForeign));
+			hv = HvConcatU64(hv, pTinproc->m_inlinek);
+			hv = HvConcatU64(hv, pTinproc->m_callconv);
+		} break;
+	case TINK_Struct:
+		{
+			hv = HvConcatU64(hv, pTin->m_scopid);
+			hv = HvConcatU64(hv, pTin->m_strName.Hv());
+
+			auto pStnodParamList = PStnodStructParameterList((STypeInfoStruct *)pTin);
+			if (pStnodParamList)
+			{
+				for (int iStnodParam = 0; iStnodParam < pStnodParamList->CStnodChild(); ++iStnodParam)
+				{
+					auto pStnodParam = pStnodParamList->PStnodChild(iStnodParam);
+					if (EWC_FVERIFY(pStnodParam->m_pTin, "expected type"))
+					{
+						hv = HvConcatComponent(hv, PTinMakeUnique(pStnodParam->m_pTin));
+					}
+				}
+			}
+		} break;
+	default:
+		hv = HvConcatU64(hv, pTin->m_scopid);
+		hv = HvConcatU64(hv, pTin->m_strName.Hv());
+		break;
+	}
+
+	// NOTE: the registry hash only keys on the low 32 bits, the kind is already mixed into the hash
+	return u64(hv);
+}
+
+bool CUniqueTypeRegistry::FUniqueTypesMatch(STypeInfo * pTinA, STypeInfo * pTinB)
+{
+	if (pTinA->m_tink != pTinB->m_tink)
+		return false;
+
+	switch (pTinA->m_tink)
+	{
+	case TINK_Pointer:
+		{
+			auto pTinptrA = (STypeInfoPointer *)pTinA;
+			auto pTinptrB = (STypeInfoPointer *)pTinB;
+			return FComponentsMatch(pTinptrA->m_pTinPointedTo, pTinptrB->m_pTinPointedTo);
+		}
+	case TINK_Qualifier:
+		{
+			auto pTinqualA = (STypeInfoQualifier *)pTinA;
+			auto pTinqualB = (STypeInfoQualifier *)pTinB;
+			return pTinqualA->m_grfqualk == pTinqualB->m_grfqualk && FComponentsMatch(pTinqualA->m_pTin, pTinqualB->m_pTin);
+		}
+	case TINK_Array:
+		{
+			auto pTinaryA = (STypeInfoArray *)pTinA;
+			auto pTinaryB = (STypeInfoArray *)pTinB;
+			return pTinaryA->m_aryk == pTinaryB->m_aryk &&
+				(pTinaryA->m_aryk != ARYK_Fixed || pTinaryA->m_c == pTinaryB->m_c) &&
+				pTinaryA->m_fIsSoa == pTinaryB->m_fIsSoa &&
+				FComponentsMatch(pTinaryA->m_pTin, pTinaryB->m_pTin);
+		}
+	case TINK_Procedure:
+		{
+			auto pTinprocA = (STypeInfoProcedure *)pTinA;
+			auto pTinprocB = (STypeInfoProcedure *)pTinB;
+			if (pTinA->m_scopid != pTinB->m_scopid ||
+				pTinA->m_strName != pTinB->m_strName ||
+				pTinprocA->m_arypTinParams.C() != pTinprocB->m_arypTinParams.C() ||
+				pTinprocA->m_arypTinReturns.C() != pTinprocB->m_arypTinReturns.C() ||
+				pTinprocA->FHasVarArgs() != pTinprocB->FHasVarArgs() ||
+				pTinprocA->FIsForeign() != pTinprocB->FIsForeign() ||
+				pTinprocA->m_inlinek != pTinprocB->m_inlinek ||
+				pTinprocA->m_callconv != pTinprocB->m_callconv)
+			{
+				return false;
+			}
+
+			for (size_t ipTin = 0; ipTin < pTinprocA->m_arypTinParams.C(); ++ipTin)
+			{
+				if (!FComponentsMatch(pTinprocA->m_arypTinParams[ipTin], pTinprocB->m_arypTinParams[ipTin]))
+					return false;
+			}
+
+			for (size_t ipTin = 0; ipTin < pTinprocA->m_arypTinReturns.C(); ++ipTin)
+			{
+				if (!FComponentsMatch(pTinprocA->m_arypTinReturns[ipTin], pTinprocB->m_arypTinReturns[ipTin]))
+					return false;
+			}
+			return true;
+		}
+	case TINK_Struct:
+		{
+			if (pTinA->m_scopid != pTinB->m_scopid || pTinA->m_strName != pTinB->m_strName)
+				return false;
+
+			auto pStnodParamListA = PStnodStructParameterList((STypeInfoStruct *)pTinA);
+			auto pStnodParamListB = PStnodStructParameterList((STypeInfoStruct *)pTinB);
+			int cStnodParamA = (pStnodParamListA) ? pStnodParamListA->CStnodChild() : 0;
+			int cStnodParamB = (pStnodParamListB) ? pStnodParamListB->CStnodChild() : 0;
+			if (cStnodParamA != cStnodParamB)
+				return false;
+
+			for (int iStnodParam = 0; iStnodParam < cStnodParamA; ++iStnodParam)
+			{
+				auto pTinParamA = pStnodParamListA->PStnodChild(iStnodParam)->m_pTin;
+				auto pTinParamB = pStnodParamListB->PStnodChild(iStnodParam)->m_pTin;
+				if (!pTinParamA || !pTinParamB)
+				{
+					if (pTinParamA != pTinParamB)
+						return false;
+					continue;
+				}
+
+				if (!FComponentsMatch(PTinMakeUnique(pTinParamA), PTinMakeUnique(pTinParamB)))
+					return false;
+			}
+			return true;
+		}
+	default:
+		return pTinA->m_scopid == pTinB->m_scopid && pTinA->m_strName == pTinB->m_strName;
+	}
 }
 
 STypeInfo * CUniqueTypeRegistry::PTinMakeUnique(STypeInfo * pTin)
@@ -5150,7 +5667,6 @@ STypeInfo * CUniqueTypeRegistry::PTinMakeUnique(STypeInfo * pTin)
 	if (pTin->m_grftin.FIsSet(FTIN_IsUnique))
 		return pTin;
 
-	u64 hv;
 	switch (pTin->m_tink)
 	{
 	case TINK_Literal:
@@ -5158,39 +5674,37 @@ STypeInfo * CUniqueTypeRegistry::PTinMakeUnique(STypeInfo * pTin)
 	case TINK_Type:
 		// these types are not 'unique'd
 		return pTin;
-#if 0 // probably not worth the hassle here
+
+	// make the types referred to by this type unique first, so it can be keyed by their identity
+	// NOTE: named types don't unique their members, so this recursion can't cycle.
 	case TINK_Pointer:
 		{
 			auto pTinptr = (STypeInfoPointer *)pTin;
-			auto pTinPointedTo = PTinMakeUnique(pTinptr->m_pTinPointedTo);
-			pTinptr->m_pTinPointedTo = pTinPointedTo;
-
-			hv = HvForPTin(pTinPointedTo, TINK_Pointer);
+			pTinptr->m_pTinPointedTo = PTinMakeUnique(pTinptr->m_pTinPointedTo);
 		} break;
 	case TINK_Qualifier:
 		{
 			auto pTinqual = (STypeInfoQualifier *)pTin;
-			auto pTinUnqual = PTinMakeUnique(pTinqual->m_pTin);
-			pTinqual->m_pTin = pTinUnqual;
-
-			hv = HvForPTin(pTinUnqual, TINK_Qualifier, pTinqual->m_grfqualk.m_raw);
+			pTinqual->m_pTin = PTinMakeUnique(pTinqual->m_pTin);
 		} break;
 	case TINK_Array:
 		{
 			auto pTinary = (STypeInfoArray *)pTin;
-			auto pTinElement = PTinMakeUnique(pTinary->m_pTin);
-			pTinary->m_pTin = pTinElement;
+			pTinary->m_pTin = PTinMakeUnique(pTinary->m_pTin);
+		} break;
+	case TINK_Procedure:
+		{
+			auto pTinproc = (STypeInfoProcedure *)pTin;
+			for (size_t ipTin = 0; ipTin < pTinproc->m_arypTinParams.C(); ++ipTin)
+			{
+				pTinproc->m_arypTinParams[ipTin] =  PTinMakeUnique(pTinproc->m_arypTinParams[ipTin]);
+			}
 
-			if (pTinary->m_aryk != ARYK_Fixed)
+			for (size_t ipTin = 0; ipTin < pTinproc->m_arypTinReturns.C(); ++ipTin)
 			{
-				hv = HvForPTin(pTinElement, TINK_Array, u8(pTinary->m_aryk));
+				pTinproc->m_arypTinReturns[ipTin] =  PTinMakeUnique(pTinproc->m_arypTinReturns[ipTin]);
 			}
-		} // fallthrough
-#else
-	case TINK_Pointer:
-	case TINK_Qualifier:
-	case TINK_Array:
-#endif
+		} break;
 	case TINK_Bool:
 	case TINK_Void:
 	case TINK_Null:
@@ -5198,89 +5712,44 @@ STypeInfo * CUniqueTypeRegistry::PTinMakeUnique(STypeInfo * pTin)
 	case TINK_Integer:
 	case TINK_Float:
 	case TINK_Enum:
-		{
-			EWC::SStringEditBuffer seb(m_pAlloc);
-
-			seb.Clear();
-			AppendTypeDescriptor(pTin, &seb);
-			hv = HvForPTin(pTin->m_strDesc, pTin->m_tink);
-
-		} break;
-
-	case TINK_Procedure:
 	case TINK_Struct:
-		{
-			EWC::SStringEditBuffer seb(m_pAlloc);
-
-			seb.Clear();
-			AppendTypeDescriptor(pTin, &seb);
-			hv = HvForPTin(pTin->m_strDesc, pTin->m_tink);
-		} break;
+		break;
 	default:
 		EWC_ASSERT(false, "unhandled type kind");
 		break;
 	}
 
-	STypeInfo ** ppTin;
-	FINS fins = m_hashHvPTinUnique.FinsEnsureKey(hv, &ppTin);
-	if (fins == FINS_AlreadyExisted)
-	{
-		// NOTE: doesn't delete non-unique type!
-		return *ppTin;
-	}
-
-	if (ppTin)
+	u64 hv = HvComputeUnique(pTin);
+	while (1)
 	{
-		pTin->m_grftin.AddFlags(FTIN_IsUnique);
-		if (pTin->m_pTinNative)
+		STypeInfo ** ppTin;
+		FINS fins = m_hashHvPTinUnique.FinsEnsureKey(hv, &ppTin);
+		if (fins == FINS_AlreadyExisted)
 		{
-			pTin->m_pTinNative = PTinMakeUnique(pTin->m_pTinNative);
+			// matching may unique struct parameters, don't hold on to ppTin across it
+			STypeInfo * pTinUnique = *ppTin;
+			if (FUniqueTypesMatch(pTinUnique, pTin))
+			{
+				// NOTE: doesn't delete non-unique type!
+				return pTinUnique;
+			}
+
+			// two distinct types share a hash, probe the next key
+			hv = HvConcatU64(HV(hv), hv);
+			continue;
 		}
 
-		*ppTin = pTin;
+		if (!ppTin)
+			return pTin;
 
-		// make sure the types referred to by this type are unique
-		// NOTE: cyclical references shouldn't be a problem now that we've added this type
-		switch (pTin->m_tink)
+		*ppTin = pTin;
+		pTin->m_grftin.AddFlags(FTIN_IsUnique);
+		if (pTin->m_pTinNative)
 		{
-		case TINK_Pointer:
-			{
-				auto pTinptr = (STypeInfoPointer *)pTin;
-				pTinptr->m_pTinPointedTo = PTinMakeUnique(pTinptr->m_pTinPointedTo);
-			} break;
-		case TINK_Qualifier:
-			{
-				auto pTinqual = (STypeInfoQualifier *)pTin;
-				pTinqual->m_pTin = PTinMakeUnique(pTinqual->m_pTin);
-			} break;
-		case TINK_Array:
-			{
-				auto pTinary = (STypeInfoArray *)pTin;
-				pTinary->m_pTin = PTinMakeUnique(pTinary->m_pTin);
-			} break;
-		case TINK_Procedure:
-			{
-				auto pTinproc = (STypeInfoProcedure *)pTin;
-				for (size_t ipTin = 0; ipTin < pTinproc->m_arypTinParams.C(); ++ipTin)
-				{
-					pTinproc->m_arypTinParams[ipTin] =  PTinMakeUnique(pTinproc->m_arypTinParams[ipTin]);
-				}
-
-				for (size_t ipTin = 0; ipTin < pTinproc->m_arypTinReturns.C(); ++ipTin)
-				{
-					pTinproc->m_arypTinReturns[ipTin] =  PTinMakeUnique(pTinproc->m_arypTinReturns[ipTin]);
-				}
-			} break;
-		case TINK_Struct:
-			{
-				auto pTinstruct = (STypeInfoStruct *)pTin;
-			} break;
-
-		default:
-			break;
+			pTin->m_pTinNative = PTinMakeUnique(pTin->m_pTinNative);
 		}
+		return pTin;
 	}
-	return pTin;
 }
 
 void CSymbolTable::AddManagedSymtab(CSymbolTable * pSymtab)
@@ -5488,6 +5957,11 @@ void PrintTypeInfo(EWC::SStringBuffer * pStrbuf, STypeInfo * pTin, PARK park, GR
 				break;
 			}
 
+			if (pTinary->m_fIsSoa)
+			{
+				AppendCoz(pStrbuf, "SOA ");
+			}
+
 			PrintTypeInfo(pStrbuf, pTinary->m_pTin, park, grfdbgstr);
 			return;
 		}
@@ -5775,7 +6249,7 @@ void PrintStnodName(EWC::SStringBuffer * pStrbuf, CSTNode * pStnod)
 	case PARK_ParameterList:	    AppendCoz(pStrbuf, "params");				return;
 	case PARK_If:				    AppendCoz(pStrbuf, "if");					return;
 	case PARK_Else:				    AppendCoz(pStrbuf, "else");					return;
-	case PARK_ArrayDecl:		    AppendCoz(pStrbuf, "[]");					return;
+	case PARK_ArrayDecl:		    AppendCoz(pStrbuf, (pStnod->m_grfstnod.FIsSet(FSTNOD_Soa)) ? "[]soa" : "[]");	return;
 	case PARK_ProcedureReferenceDecl:
 									AppendCoz(pStrbuf, "procref");				return;
 	case PARK_Uninitializer:		AppendCoz(pStrbuf, "---");					return;
@@ -273,6 +273,7 @@ enum STMAPK // Syntax Tree MAP  Kind
 	STMAPK_Decl,
 	STMAPK_Enum,
 	STMAPK_Struct,
+	STMAPK_Run,
 
 	EWC_MAX_MIN_NIL(STMAPK)
 };
@@ -329,6 +330,8 @@ public:
 					,m_iStnodBody(-1)
 					,m_iStnodPredicate(-1)
 					,m_iStnodIncrement(-1)
+					,m_iTypemembCounter(-1)
+					,m_iTypemembLimit(-1)
 						{ ; }
 
 	int				m_iStnodDecl;
@@ -337,6 +340,8 @@ public:
 	int				m_iStnodBody;
 	int				m_iStnodPredicate;
 	int				m_iStnodIncrement;
+	int				m_iTypemembCounter;	// counted for_each loops over SIntIterator: iterator fields used in place of
+	int				m_iTypemembLimit;	//  the iterIsDone/iterNext calls, -1 otherwise
 };
 
 enum FSTPROC
@@ -446,6 +451,23 @@ public:
 	int				m_iStnodDeclList;
 };
 
+class CSTRun : public SSyntaxTreeMap // tag = strun
+{
+public:
+	static const STMAPK s_stmapk = STMAPK_Run;
+
+					CSTRun()
+					:SSyntaxTreeMap(s_stmapk)
+					,m_pBResult(nullptr)
+					,m_cBResult(0)
+						{ ; }
+
+	u8 *			m_pBResult;		// #run result computed by the bytecode VM, laid out with BuildStubDataLayout()
+	size_t			m_cBResult;
+};
+
+CSTRun * PStrunAllocBaked(EWC::CAlloc * pAlloc, const u8 * pBResult, size_t cBResult);
+
 
 
 template <typename T>
@@ -476,6 +498,7 @@ inline SSyntaxTreeMap * PStmapCopy(EWC::CAlloc * pAlloc, SSyntaxTreeMap * pStmap
 		case STMAPK_Decl:	ALLOC_COPY_AND_RETURN(CSTDecl, pAlloc, pStmapSrc);
 		case STMAPK_Enum:	ALLOC_COPY_AND_RETURN(CSTEnum, pAlloc, pStmapSrc);
 		case STMAPK_Struct:	ALLOC_COPY_AND_RETURN(CSTStruct, pAlloc, pStmapSrc);
+		case STMAPK_Run:	return PStrunAllocBaked(pAlloc, ((CSTRun *)pStmapSrc)->m_pBResult, ((CSTRun *)pStmapSrc)->m_cBResult);
 		default: break;
 	}
 #undef ALLOC_COPY_AND_RETURN
@@ -513,9 +536,10 @@ enum FSTNOD
 	FSTNOD_CommutativeCall = 0x8,	// this function is an overloaded operator with arguments reversed.
 	FSTNOD_NoCodeGeneration = 0x10, // skip this node for codegen - used by generic definitions
 	FSTNOD_AssertOnDelete = 0x20,	// debugging tool, assert when deleted
+	FSTNOD_Soa			= 0x40,		// array declaration (PARK_ArrayDecl) stores its elements as a structure of arrays
 
 	FSTNOD_None			= 0x0,
-	FSTNOD_All			= 0x3F,
+	FSTNOD_All			= 0xFF,
 };
 EWC_DEFINE_GRF(GRFSTNOD, FSTNOD, u8);
 
@@ -580,6 +604,7 @@ public:
 									case STMAPK_Decl:	m_pStmap = EWC_NEW(pAlloc, CSTDecl) CSTDecl();				break;
 									case STMAPK_Enum:	m_pStmap = EWC_NEW(pAlloc, CSTEnum) CSTEnum();				break;
 									case STMAPK_Struct:	m_pStmap = EWC_NEW(pAlloc, CSTStruct) CSTStruct();			break;
+									case STMAPK_Run:	m_pStmap = EWC_NEW(pAlloc, CSTRun) CSTRun();				break;
 									default: 
 										EWC_ASSERT(false, "missing STMAPK");
 								}
@@ -627,6 +652,9 @@ public:
 	EWC::CDynAry<CSTNode *>	m_arypStnodChild;
 };
 
+inline bool FIsRunDirective(CSTNode * pStnod)
+	{ return pStnod->m_park == PARK_ReservedWord && pStnod->m_pStval && pStnod->m_pStval->m_rword == RWORD_RunDirective; }
+
 CSTValue * PStvalCopy(EWC::CAlloc * pAlloc, CSTValue * pStval);
 CSTNode * PStnodCopy(EWC::CAlloc * pAlloc, CSTNode * pStnodSrc, EWC::CHash<CSTNode *, CSTNode *> * pmpPStnodSrcPStnodDst = nullptr);
 CSTValue * PStvalExpected(CSTNode * pStnod);
@@ -678,6 +706,9 @@ public:
 
 	void					Clear();
 	STypeInfo *				PTinMakeUnique(STypeInfo * pTin);
+	HV						HvConcatComponent(HV hv, STypeInfo * pTin);
+	u64						HvComputeUnique(STypeInfo * pTin);
+	bool					FUniqueTypesMatch(STypeInfo * pTinA, STypeInfo * pTinB);
 	SCOPID					ScopidAlloc()
 								{ m_scopidNext = SCOPID(m_scopidNext + 1); return m_scopidNext; }
 
@@ -711,6 +742,7 @@ protected:
 							,m_pUnset(pUnset)
 							,m_pSymtabParent(nullptr)
 							,m_pSymtabNextManaged(nullptr)
+							,m_hashHvLookc(pAlloc, EWC::BK_Symbol)
 							,m_iNestingDepth(0)
 							,m_scopid(pUntyper->ScopidAlloc())
 							,m_nVisitId(0)
@@ -781,6 +813,23 @@ public:
 																// 'using' statement. Added lazily
 	};
 
+	struct SLookupCache // tag = lookc
+	{
+							SLookupCache()
+							:m_pSym(nullptr)
+							,m_pSymtab(nullptr)
+							,m_pSymtabParent(nullptr)
+							,m_nGeneration(0)
+							,m_grfsymlook(FSYMLOOK_None)
+								{ ; }
+
+		SSymbol *			m_pSym;					// resolved symbol, null if the name was not found
+		CSymbolTable *		m_pSymtab;				// table the symbol was found in
+		CSymbolTable *		m_pSymtabParent;		// parent of the querying table when this entry was stored
+		u64					m_nGeneration;			// symbol table generation when this entry was stored
+		GRFSYMLOOK			m_grfsymlook;
+	};
+
 							~CSymbolTable();
 
 	void					AddBuiltInSymbols(CWorkspace * pWork);
@@ -854,6 +903,8 @@ public:
 	CSymbolTable *					m_pSymtabParent;
 
 	CSymbolTable *					m_pSymtabNextManaged;	// next table in the global list
+	EWC::CHash<HV, SLookupCache>	m_hashHvLookc;			// ancestor lookups resolved from this scope, validated
+															//  against the global symbol generation
 	s32								m_iNestingDepth;					
 	SCOPID							m_scopid;				// unique table id, for unique type strings
 	u64								m_nVisitId;				// id to check if this table has been visited during collision check
@@ -14,10 +14,13 @@
 | OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
 #include "BigMath.h"
+#include "ByteCode.h"
 #include "Parser.h"
 #include "TypeInfo.h"
 #include "Util.h"
 #include "Workspace.h"
+#include <algorithm>
+#include <chrono>
 #include <cstdarg>
 #include <limits.h>
 #include <stdio.h>
@@ -47,8 +50,28 @@ struct STypeCheckStackEntry // tag = tcsent
 
 struct STypeCheckFrame // tag = tcfram
 {
+									STypeCheckFrame()
+									:m_ipTcframQueue(0)
+									,m_pEntry(nullptr)
+									,m_pSymWait(nullptr)
+									,m_cWait(0)
+									,m_cNsRun(0)
+									,m_cNsWaiting(0)
+									,m_nsWaitBegin(0)
+									,m_fMayDeferBody(false)
+									,m_aryTcsent()
+										{ ; }
+
 	size_t							m_ipTcframQueue;	// index in the pending/waiting queue
 	SWorkspaceEntry *				m_pEntry;
+	const SSymbol *					m_pSymWait;			// symbol this frame is blocked on, null unless waiting
+
+	s32								m_cWait;			// times this frame stopped with TCRET_WaitingForSymbolDefinition
+	s64								m_cNsRun;			// time spent checking this frame, only tracked for -tcStats
+	s64								m_cNsWaiting;		// time spent in the waiting queue, only tracked for -tcStats
+	s64								m_nsWaitBegin;
+
+	bool							m_fMayDeferBody;	// top level procedure, body can wait until something reaches it
 	CDynAry<STypeCheckStackEntry>	m_aryTcsent;
 };
 
@@ -57,8 +80,50 @@ struct SUnknownType // tag = untype
 	CDynAry<STypeCheckFrame *>	m_arypTcframDependent;		// id for frames dependent on this type
 };
 
+enum ARGORD // ARGument ORDer
+{
+	ARGORD_Normal,
+	ARGORD_Reversed,	// argument order reversed (used for checking comutative procedures)
+
+	EWC_MAX_MIN_NIL(ARGORD)
+};
+
+struct SOverloadArg // tag = ovarg
+{
+	STypeInfo *		m_pTin;
+	bool			m_fIsLiteral;		// literal arguments are keyed by value, they can promote differently
+	CSTValue		m_stval;			// copied, the call's literal node is finalized once the overload is picked
+};
+
+// Memoized result of resolving an overloaded call with a given set of argument types.
+struct SOverloadCacheEntry // tag = ovcent
+{
+					SOverloadCacheEntry(CAlloc * pAlloc)
+					:m_pSymtab(nullptr)
+					,m_strProcName()
+					,m_grfsymlook(FSYMLOOK_Default)
+					,m_aryOvarg(pAlloc, EWC::BK_TypeCheckProcmatch)
+					,m_hvCandidates(0)
+					,m_cCandidate(0)
+					,m_pSymProc(nullptr)
+					,m_argord(ARGORD_Normal)
+						{ ; }
+
+	CSymbolTable *			m_pSymtab;
+	CString					m_strProcName;
+	GRFSYMLOOK				m_grfsymlook;
+	CDynAry<SOverloadArg>	m_aryOvarg;
+
+	HV						m_hvCandidates;		// hash of every symbol the lookup visited, changes if an overload is added
+	int						m_cCandidate;
+
+	SSymbol *				m_pSymProc;			// the one procedure that matched
+	ARGORD					m_argord;
+};
+
 
 #define VALIDATE_NAME_MANGLING 1
+#define VALIDATE_TCFRAM_QUEUES 0	// O(n) check of the pending/waiting queue indices after every frame step
 
 struct STypeCheckWorkspace // tag = tcwork
 {
@@ -72,10 +137,23 @@ struct STypeCheckWorkspace // tag = tcwork
 					,m_arypTcframPending(pAlloc, EWC::BK_TypeCheck, pblistEntry->C())
 					,m_arypTcframWaiting(pAlloc, EWC::BK_TypeCheck, pblistEntry->C())
 					,m_genreg(pAlloc)
+					,m_fCollectStats(false)
+					,m_fDemandDriven(false)
+					,m_hashPSymPTcframDeferred(pAlloc, EWC::BK_TypeCheck)
+					,m_arypSymRoot(pAlloc, EWC::BK_TypeCheck, 16)
+					,m_hashHvPOvcent(pAlloc, EWC::BK_TypeCheckProcmatch)
 						{ ; }
 
 					~STypeCheckWorkspace()
-						{ ; }
+						{
+							CHash<HV, SOverloadCacheEntry *>::CIterator iter(&m_hashHvPOvcent);
+							SOverloadCacheEntry ** ppOvcent;
+							while ((ppOvcent = iter.Next()))
+							{
+								m_pAlloc->EWC_DELETE(*ppOvcent);
+							}
+							m_hashHvPOvcent.Clear(0);
+						}
 
 	CAlloc *								m_pAlloc;
 	SErrorManager *							m_pErrman;
@@ -88,8 +166,20 @@ struct STypeCheckWorkspace // tag = tcwork
 																	//  during check, not guaranteed to have all types)
 	CDynAry<STypeCheckFrame *>				m_arypTcframWaiting;	// frames waiting for one specific symbol
 	CGenericRegistry						m_genreg;				// registry of instantiated generic types
+	bool									m_fCollectStats;		// track frame timings for -tcStats
+
+	bool									m_fDemandDriven;		// only check bodies reachable from m_arypSymRoot
+	CHash<const SSymbol *, STypeCheckFrame *>	m_hashPSymPTcframDeferred;	// procedures whose body hasn't been demanded
+	CDynAry<SSymbol *>						m_arypSymRoot;			// main, public linkage procs and the global scope
+	CHash<HV, SOverloadCacheEntry *>		m_hashHvPOvcent;		// resolved overloads, keyed by call signature
 };
 
+static inline s64 NsTimestamp()
+{
+	auto dur = std::chrono::steady_clock::now().time_since_epoch();
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(dur).count();
+}
+
 enum PROCMATCH
 {
 	PROCMATCH_None,
@@ -172,14 +262,6 @@ struct SProcMatchParam // tag = pmparam
 	bool				m_fMustFindMatch;
 };
 
-enum ARGORD // ARGument ORDer
-{
-	ARGORD_Normal,
-	ARGORD_Reversed,	// argument order reversed (used for checking comutative procedures)
-
-	EWC_MAX_MIN_NIL(ARGORD)
-};
-
 
 CSymbolTable *	PSymtabFromType(STypeCheckWorkspace * pTcwork, STypeInfo * pTin, SLexerLocation * pLexloc);
 
@@ -314,6 +396,8 @@ void CNameMangler::AppendType(STypeInfo * pTin)
 				AppendCoz(&m_strbuf, "c");
 			if (pTinqual->m_grfqualk.FIsSet(FQUALK_InArg)) 
 				AppendCoz(&m_strbuf, "i");
+			if (pTinqual->m_grfqualk.FIsSet(FQUALK_Restrict)) 
+				AppendCoz(&m_strbuf, "r");
 
 			AppendType(pTinqual->m_pTin);
 
@@ -337,16 +421,22 @@ void CNameMangler::AppendType(STypeInfo * pTin)
     case TINK_Array:
 		{
 			auto pTinary = (STypeInfoArray *)pTin;
+			AppendCoz(&m_strbuf, (pTinary->m_fIsSoa) ? "AS" : "A");
 			switch (pTinary->m_aryk)
 			{
 			case ARYK_Fixed:
 				{
-					FormatCoz(&m_strbuf, "A%d", pTinary->m_c);
+					FormatCoz(&m_strbuf, "%d", pTinary->m_c);
 					AppendType(pTinary->m_pTin);
 				} break;
 			case ARYK_Reference:
 				{
-					AppendCoz(&m_strbuf, "AR");
+					AppendCoz(&m_strbuf, "R");
+					AppendType(pTinary->m_pTin);
+				} break;
+			case ARYK_Dynamic:
+				{
+					AppendCoz(&m_strbuf, "D");
 					AppendType(pTinary->m_pTin);
 				} break;
 			default: EWC_ASSERT(false, "unhandled array type");
@@ -727,7 +817,9 @@ STypeInfoProcedure * PTinprocCopy(CSymbolTable * pSymtab, STypeInfoProcedure * p
 	pTinprocNew->m_pStnodDefinition = pTinprocSrc->m_pStnodDefinition;
 	pTinprocNew->m_grftinproc = pTinprocSrc->m_grftinproc;
 	pTinprocNew->m_inlinek = pTinprocSrc->m_inlinek;
+	pTinprocNew->m_boundscheck = pTinprocSrc->m_boundscheck;
 	pTinprocNew->m_callconv = pTinprocSrc->m_callconv;
+	pTinprocNew->m_grfisaClones = pTinprocSrc->m_grfisaClones;
 
 	pTinprocNew->m_arypTinParams.Append(pTinprocSrc->m_arypTinParams.A(), pTinprocSrc->m_arypTinParams.C());
 	pTinprocNew->m_arypTinReturns.Append(pTinprocSrc->m_arypTinReturns.A(), pTinprocSrc->m_arypTinReturns.C());
@@ -784,6 +876,11 @@ STypeInfo * PTinReadType(const char ** ppCoz, CSymbolTable * pSymtab)
 			grfqualk.AddFlags(FQUALK_InArg);
 			++(*ppCoz);
 		}
+		if (**ppCoz == 'r')
+		{
+			grfqualk.AddFlags(FQUALK_Restrict);
+			++(*ppCoz);
+		}
 
 		auto pTinPointedTo = PTinReadType(ppCoz, pSymtab);
 		if (!pTinPointedTo)
@@ -810,11 +907,22 @@ STypeInfo * PTinReadType(const char ** ppCoz, CSymbolTable * pSymtab)
 		++(*ppCoz);
 		STypeInfoArray * pTinary = EWC_NEW(pSymtab->m_pAlloc, STypeInfoArray) STypeInfoArray();
 
+		if (**ppCoz == 'S') // structure of arrays
+		{
+			++(*ppCoz);
+			pTinary->m_fIsSoa = true;
+		}
+
 		if (**ppCoz == 'R') // ARYK_Reference
 		{
 			++(*ppCoz);
 			pTinary->m_aryk = ARYK_Reference;
 		}
+		else if (**ppCoz == 'D') // ARYK_Dynamic
+		{
+			++(*ppCoz);
+			pTinary->m_aryk = ARYK_Dynamic;
+		}
 		else
 		{
 			pTinary->m_aryk = ARYK_Fixed;
@@ -1105,15 +1213,114 @@ CString StrFullyQualifiedSymbol(SSymbol * pSym)
 	return CString(aCh);
 }
 
-SUnknownType * PUntypeEnsure(STypeCheckWorkspace * pTcwork, const SSymbol * pSym)
+// All scheduler bookkeeping goes through ScheduleTcfram, WaitForSymbol and OnTypeResolve (plus the run loop in
+//  PerformTypeCheck) so frame queues are only touched in one place.
+//
+// BB - frames still run one at a time on the calling thread, running them on worker threads is deferred until
+//  the state they share is safe to touch concurrently:
+//   - CAlloc's stb_malloc heap is built without mutexes
+//   - CSymbolTable's hashes, the symbol lookup cache and PTinMakeUnique are unsynchronized
+//   - EmitError appends to the shared error manager, errors would need per-frame buffers sorted by entry to
+//     keep their order deterministic
+//   - generic instantiation appends to the shared entry block list and pending queue
+
+void ScheduleTcfram(STypeCheckWorkspace * pTcwork, STypeCheckFrame * pTcfram)
+{
+	pTcfram->m_ipTcframQueue = pTcwork->m_arypTcframPending.C();
+	pTcwork->m_arypTcframPending.Append(pTcfram);
+}
+
+void WaitForSymbol(STypeCheckWorkspace * pTcwork, STypeCheckFrame * pTcfram, const SSymbol * pSym)
 {
+	EWC_ASSERT(pTcfram->m_pSymWait == nullptr, "type check frame is already waiting on '%s'", pTcfram->m_pSymWait->m_strName.PCoz());
+
 	SUnknownType * pUntype = pTcwork->m_hashPSymUntype.Lookup(pSym);
 	if (!pUntype)
 	{
 		pTcwork->m_hashPSymUntype.FinsEnsureKey(pSym, &pUntype);
 		pUntype->m_arypTcframDependent.SetAlloc(pTcwork->m_pAlloc, EWC::BK_TypeCheck);
 	}
-	return pUntype;
+
+	pUntype->m_arypTcframDependent.Append(pTcfram);
+	pTcfram->m_pSymWait = pSym;
+}
+
+bool FShouldDeferBody(STypeCheckWorkspace * pTcwork, STypeCheckFrame * pTcfram, CSTNode * pStnod, CSTProcedure * pStproc)
+{
+	// Only bodies of top level procedure entries are deferred, nested and generic instantiated procedures are 
+	//  checked as soon as they're created.
+
+	if (!pTcfram->m_fMayDeferBody || pTcfram->m_aryTcsent.C() != 1 || pTcfram->m_pEntry->m_pStnod != pStnod)
+		return false;
+
+	SSymbol * pSym = pStnod->PSym();
+	if (pStproc->m_grfstproc.FIsSet(FSTPROC_PublicLinkage))
+	{
+		pTcwork->m_arypSymRoot.Append(pSym);
+		return false;
+	}
+
+	SSymbol ** ppSymMac = pTcwork->m_arypSymRoot.PMac();
+	for (SSymbol ** ppSym = pTcwork->m_arypSymRoot.A(); ppSym != ppSymMac; ++ppSym)
+	{
+		if (*ppSym == pSym)
+			return false;
+	}
+
+	return true;
+}
+
+bool FScheduleDemandedProcedures(STypeCheckWorkspace * pTcwork)
+{
+	// Called when the pending queue runs dry: schedule every deferred body that is now reachable from a root through
+	//  the references recorded so far, along with any that another frame is stuck waiting on. Checking those bodies 
+	//  adds new references, so we'll be called again until nothing new is reached.
+
+	if (!pTcwork->m_hashPSymPTcframDeferred.C())
+		return false;
+
+	CAlloc * pAlloc = pTcwork->m_pAlloc;
+	CDynAry<const SSymbol *> arypSymDemanded(pAlloc, BK_Dependency, 64);
+	CHash<const SSymbol *, bool> hashPSymVisited(pAlloc, BK_Dependency, 1024);
+	CDynAry<SSymbol *> arypSymStack(pAlloc, BK_Dependency, 128);
+
+	arypSymStack.Append(pTcwork->m_arypSymRoot.A(), pTcwork->m_arypSymRoot.C());
+	while (!arypSymStack.FIsEmpty())
+	{
+		auto pSym = arypSymStack.Last();
+		arypSymStack.PopLast();
+		if (hashPSymVisited.FinsEnsureKeyAndValue(pSym, true) == FINS_AlreadyExisted)
+			continue;
+
+		if (pTcwork->m_hashPSymPTcframDeferred.Lookup(pSym))
+		{
+			arypSymDemanded.Append(pSym);
+		}
+
+		arypSymStack.Append(pSym->m_aryPSymHasRefTo.A(), pSym->m_aryPSymHasRefTo.C());
+	}
+
+	CHash<const SSymbol *, STypeCheckFrame *>::CIterator iter(&pTcwork->m_hashPSymPTcframDeferred);
+	const SSymbol ** ppSym;
+	while (iter.Next(&ppSym))
+	{
+		if (!hashPSymVisited.Lookup(*ppSym) && pTcwork->m_hashPSymUntype.Lookup(*ppSym))
+		{
+			arypSymDemanded.Append(*ppSym);
+		}
+	}
+
+	auto ppSymMac = arypSymDemanded.PMac();
+	for (auto ppSymDemanded = arypSymDemanded.A(); ppSymDemanded != ppSymMac; ++ppSymDemanded)
+	{
+		STypeCheckFrame * pTcfram = *pTcwork->m_hashPSymPTcframDeferred.Lookup(*ppSymDemanded);
+		pTcwork->m_hashPSymPTcframDeferred.Remove(*ppSymDemanded);
+
+		pTcfram->m_fMayDeferBody = false;
+		ScheduleTcfram(pTcwork, pTcfram);
+	}
+
+	return !arypSymDemanded.FIsEmpty();
 }
 
 STypeCheckStackEntry * PTcsentPush(STypeCheckFrame * pTcfram, STypeCheckStackEntry ** ppTcsentTop, CSTNode * pStnod)
@@ -1150,6 +1357,7 @@ enum TCRET
 	TCRET_Complete,
 	TCRET_StoppingError,
 	TCRET_WaitingForSymbolDefinition,
+	TCRET_Deferred,						// procedure body is postponed until something reachable references it
 };
 
 inline u64 NUnsignedLiteralCast(STypeCheckWorkspace * pTcwork, CSTNode * pStnod, const CSTValue * pStval)
@@ -1288,6 +1496,51 @@ inline void SetIntegerValue(STypeCheckWorkspace * pTcwork, CSTNode * pStnod, CST
 	}
 }
 
+// Wrap an integer constant to the width of a sized (finalized) literal, ie. the value the target would compute.
+inline SBigInt BintWrapToLitty(const SBigInt & bint, const SLiteralType & litty)
+{
+	if (litty.m_litk != LITK_Integer || litty.m_cBit <= 0 || litty.m_cBit > 64)
+		return bint;
+
+	u64 nMask = (litty.m_cBit == 64) ? ~0ULL : (1ULL << litty.m_cBit) - 1;
+	u64 nTwos = ((bint.m_fIsNegative) ? (0ULL - bint.m_nAbs) : bint.m_nAbs) & nMask;
+
+	if (litty.m_fIsSigned && (nTwos & (1ULL << (litty.m_cBit - 1))))
+	{
+		return BintFromInt((s64)(nTwos | ~nMask));
+	}
+	return BintFromUint(nTwos);
+}
+
+// Round a float constant to the precision of a sized literal.
+inline f64 GRoundToLitty(f64 g, const SLiteralType & litty)
+{
+	if (litty.m_litk == LITK_Float && litty.m_cBit == 32)
+		return (f64)(f32)g;
+	return g;
+}
+
+// pick the literal type for an arithmetic result, typed (sized) operands win over unsized ones and two sized operands
+//  promote like OptypeFromPark: the wider type wins, integers of mixed signedness have no result type (returns null)
+inline STypeInfoLiteral * PTinlitArithmeticResult(STypeInfoLiteral * pTinlitLhs, STypeInfoLiteral * pTinlitRhs, LITK litk)
+{
+	bool fLhsIsSized = pTinlitLhs->m_litty.m_litk == litk && pTinlitLhs->m_litty.m_cBit > 0;
+	bool fRhsIsSized = pTinlitRhs->m_litty.m_litk == litk && pTinlitRhs->m_litty.m_cBit > 0;
+	if (fLhsIsSized && fRhsIsSized)
+	{
+		if (litk == LITK_Integer && pTinlitLhs->m_litty.m_fIsSigned != pTinlitRhs->m_litty.m_fIsSigned)
+			return nullptr;
+
+		return (pTinlitLhs->m_litty.m_cBit < pTinlitRhs->m_litty.m_cBit) ? pTinlitRhs : pTinlitLhs;
+	}
+
+	if (!fLhsIsSized && fRhsIsSized)
+		return pTinlitRhs;
+	if (pTinlitLhs->m_litty.m_litk != litk && pTinlitRhs->m_litty.m_litk == litk)
+		return pTinlitRhs;
+	return pTinlitLhs;
+}
+
 inline bool FComputeUnaryOpOnLiteral(
 	STypeCheckWorkspace * pTcwork,
 	CSTNode * pStnodOperator,
@@ -1319,7 +1572,7 @@ inline bool FComputeUnaryOpOnLiteral(
 		f64 g = GLiteralCast(pStvalOperand);
 		switch ((u32)tokOperator)
 		{
-		case '-':         g = -g; break;
+		case '-':         g = GRoundToLitty(-g, littyOperand); break;
 		case '!':         f = !g; break;
 		default: return false;
 		}
@@ -1349,8 +1602,7 @@ inline bool FComputeUnaryOpOnLiteral(
 	} 
 	else // LITK_Integer
 	{
-		EWC_ASSERT(littyOperand.m_cBit == -1, "expected unsized literal here");
-
+		// sized operands come from typed constants and folded casts, their result wraps like the target type
 		SBigInt bintOperand(BintFromStval(pStvalOperand));
 
 		auto pTinenum = PTinRtiCast<STypeInfoEnum *>(pTinlitOperand->m_pTinSource);
@@ -1393,7 +1645,7 @@ inline bool FComputeUnaryOpOnLiteral(
 		}
 		else
 		{
-			SetIntegerValue(pTcwork, pStnodOperand, pStvalStnod, bintOperand);
+			SetIntegerValue(pTcwork, pStnodOperand, pStvalStnod, BintWrapToLitty(bintOperand, littyOperand));
 
 			if (pTinlitOperand->m_litty.m_litk == LITK_Enum)
 			{
@@ -1475,6 +1727,9 @@ inline bool FComputeBinaryOpOnLiterals(
 		default: return false;
 		}
 
+		auto pTinlitFloat = PTinlitArithmeticResult(pTinlitLhs, pTinlitRhs, LITK_Float);
+		g = GRoundToLitty(g, pTinlitFloat->m_litty);
+
 		CSTValue * pStvalStnod = EWC_NEW(pSymtab->m_pAlloc, CSTValue) CSTValue();
 		*ppStval = pStvalStnod;
 
@@ -1492,7 +1747,6 @@ inline bool FComputeBinaryOpOnLiterals(
 		{
 			SetFloatValue(pStvalStnod, g);
 
-			auto pTinlitFloat = (pTinlitLhs->m_litty.m_litk == LITK_Float) ? pTinlitLhs : pTinlitRhs;
 			*ppTinReturn = pTinlitFloat;
 			*ppTinOperand = pTinlitFloat;
 		}
@@ -1503,9 +1757,19 @@ inline bool FComputeBinaryOpOnLiterals(
 		// may not be unsized literal in compound expressions, ie a == b == c
 		// turns into (a == b) == c which ends up being bool == unsized comparison
 
+		auto pTinlitInt = PTinlitArithmeticResult(pTinlitLhs, pTinlitRhs, LITK_Integer);
+		if (!pTinlitInt)
+			return false;
+
 		SBigInt bintLhs(BintFromStval(pStvalLhs));
 		SBigInt bintRhs(BintFromStval(pStvalRhs));
 
+		if ((tokOperator == TOK('/') || tokOperator == TOK('%')) && bintRhs.m_nAbs == 0)
+		{
+			EmitError(pTcwork, pStnodOperator, "Integer division by zero in constant expression");
+			bintRhs = BintFromUint(1);
+		}
+
 		SBigInt bintOut;
 		bool f;
 		switch ((u32)tokOperator)
@@ -1548,10 +1812,10 @@ inline bool FComputeBinaryOpOnLiterals(
 		}
 		else
 		{
-			SetIntegerValue(pTcwork, pStnodLhs, pStvalStnod, bintOut);
-
 			if (pTinlitLhs->m_litty.m_litk == LITK_Enum)
 			{
+				SetIntegerValue(pTcwork, pStnodLhs, pStvalStnod, bintOut);
+
 				// We need to make an unfinalized integer literal
 				auto pTinlitInt = EWC_NEW(pSymtab->m_pAlloc, STypeInfoLiteral) STypeInfoLiteral();
 				pTinlitInt->m_litty.m_litk = LITK_Integer;
@@ -1563,14 +1827,120 @@ inline bool FComputeBinaryOpOnLiterals(
 			else
 			{
 				EWC_ASSERT(pTinlitLhs->m_litty.m_litk == LITK_Integer || pTinlitLhs->m_litty.m_litk == LITK_Bool, "unexpected literal kind");
-				*ppTinReturn = pTinlitLhs;
-				*ppTinOperand = pTinlitLhs;
+				SetIntegerValue(pTcwork, pStnodLhs, pStvalStnod, BintWrapToLitty(bintOut, pTinlitInt->m_litty));
+
+				*ppTinReturn = pTinlitInt;
+				*ppTinOperand = pTinlitInt;
 			}
 		}
 		return true;
 	}
 }
 
+// Explicit casts of numeric constants fold into a literal of the destination type, so the expression around the cast
+//  can keep folding. Float to integer casts that don't fit the destination are undefined and are left to the target.
+bool FTryFoldConstantCast(STypeCheckWorkspace * pTcwork, CSymbolTable * pSymtab, CSTNode * pStnodCast, CSTNode * pStnodInit)
+{
+	CSTValue * pStvalInit = pStnodInit->m_pStval;
+	if (!pStvalInit || !pStnodInit->m_pTin || pStnodInit->m_pTin->m_tink != TINK_Literal || pStnodCast->m_pStval)
+		return false;
+
+	bool fIsFloatInit = false;
+	switch (pStvalInit->m_stvalk)
+	{
+	case STVALK_Float:			fIsFloatInit = true;	break;
+	case STVALK_SignedInt:
+	case STVALK_UnsignedInt:							break;
+	case STVALK_ReservedWord:
+		{
+			if (pStvalInit->m_litkLex != LITK_Integer && pStvalInit->m_litkLex != LITK_Bool)
+				return false;
+		} break;
+	default: 
+		return false;
+	}
+
+	f64 gInit = (fIsFloatInit) ? pStvalInit->m_g : 0.0;
+	SBigInt bintInit;
+	if (fIsFloatInit)
+	{
+		// NaN and values outside of 64 bits can't be represented by any integer destination
+		if (gInit != gInit || gInit <= -9223372036854775809.0 || gInit >= 18446744073709551616.0)
+		{
+			bintInit = BintFromUint(0);
+		}
+		else
+		{
+			bintInit = (gInit < 0) ? BintFromInt((s64)gInit) : BintFromUint((u64)gInit);
+		}
+	}
+	else
+	{
+		bintInit = BintFromStval(pStvalInit);
+		gInit = (bintInit.m_fIsNegative) ? -(f64)bintInit.m_nAbs : (f64)bintInit.m_nAbs;
+	}
+
+	STypeInfo * pTinDst = PTinStripQualifiers(pStnodCast->m_pTin);
+	STypeInfoLiteral * pTinlit = nullptr;
+	CSTValue stval;
+	switch (pTinDst->m_tink)
+	{
+	case TINK_Integer:
+		{
+			auto pTinint = (STypeInfoInteger *)pTinDst;
+			pTinlit = pSymtab->PTinlitFromLitk(LITK_Integer, pTinint->m_cBit, pTinint->m_fIsSigned);
+			if (!pTinlit)
+				return false;
+
+			SBigInt bint = BintWrapToLitty(bintInit, pTinlit->m_litty);
+			if (fIsFloatInit)
+			{
+				if (gInit != gInit)
+					return false;
+
+				f64 gTrunc = (bintInit.m_fIsNegative) ? -(f64)bintInit.m_nAbs : (f64)bintInit.m_nAbs;
+				if (!FAreEqual(bint, bintInit) || gInit - gTrunc <= -1.0 || gInit - gTrunc >= 1.0)
+					return false;
+			}
+
+			if (bint.m_fIsNegative)
+			{
+				SetSignedIntValue(&stval, bint.S64Coerce());
+			}
+			else
+			{
+				SetUnsignedIntValue(&stval, bint.m_nAbs);
+			}
+		} break;
+	case TINK_Float:
+		{
+			auto pTinfloat = (STypeInfoFloat *)pTinDst;
+			pTinlit = pSymtab->PTinlitFromLitk(LITK_Float, pTinfloat->m_cBit, true);
+			if (!pTinlit)
+				return false;
+
+			SetFloatValue(&stval, GRoundToLitty(gInit, pTinlit->m_litty));
+		} break;
+	case TINK_Bool:
+		{
+			pTinlit = pSymtab->PTinlitFromLitk(LITK_Bool);
+			if (!pTinlit)
+				return false;
+
+			SetBoolValue(&stval, (fIsFloatInit) ? gInit != 0.0 : bintInit.m_nAbs != 0);
+		} break;
+	default:
+		return false;
+	}
+
+	CSTValue * pStval = EWC_NEW(pSymtab->m_pAlloc, CSTValue) CSTValue();
+	*pStval = stval;
+
+	pStnodCast->m_pStval = pStval;
+	pStnodCast->m_pTin = pTinlit;
+	return true;
+}
+
 void FinalizeCompoundLiteralType(
 STypeCheckWorkspace * pTcwork,
 CSymbolTable * pSymtab,
@@ -1718,14 +2088,16 @@ CSTNode * pStnodLit)
 						return;
 					}
 
-					if (iStnod > pTinstruct->m_aryTypemembField.C())
+					// positional initializers follow declaration order, which #reorder structs don't keep
+					int iTypememb = ITypemembFromDeclIndex(pTinstruct, iStnod);
+					if (iTypememb < 0)
 					{
 						EmitError(pTcwork, pStnodLit, "too many initializers for struct '%s'", pTinstruct->m_strName.PCoz());
 						return;
 					}
 					else
 					{
-						arypStnodInit[iStnod] = pStnodIt;
+						arypStnodInit[iTypememb] = pStnodIt;
 					}
 				}
 			}
@@ -2529,7 +2901,8 @@ bool FTypesAreSame(STypeInfo * pTinLhs, STypeInfo * pTinRhs)
 			EWC_ASSERT(pTinaryLhs->m_pStnodBakedDim == nullptr && pTinaryRhs->m_pStnodBakedDim == nullptr, 
 				"generic array should be instantiated before calling FTypesAreSame()");
 
-			return (pTinaryLhs->m_aryk == pTinaryRhs->m_aryk) & (pTinaryLhs->m_c == pTinaryRhs->m_c) &&
+			return (pTinaryLhs->m_aryk == pTinaryRhs->m_aryk) & (pTinaryLhs->m_c == pTinaryRhs->m_c) &
+				(pTinaryLhs->m_fIsSoa == pTinaryRhs->m_fIsSoa) &&
 				FTypesAreSame(pTinaryLhs->m_pTin, pTinaryRhs->m_pTin);
 		}
 	case TINK_Struct:
@@ -2784,6 +3157,18 @@ SOpTypes OptypeFromPark(
 		}
 	}
 
+	bool fIsSimdOp = FIsSimdStruct(pTinUnqualLhs) | FIsSimdStruct(pTinUnqualRhs);
+	if (fIsSimdOp && (parkOperator != PARK_AssignmentOp || tok != TOK('=')))
+	{
+		// SIMD structures operate lane-wise, comparisons return a mask with one bit per lane
+		if (!FTypesAreSame(pTinUnqualLhs, pTinUnqualRhs))
+			return SOpTypes();
+
+		if (parkOperator == PARK_RelationalOp)
+			return SOpTypes(pTinUnqualLhs, pTinUnqualLhs, pSymtab->PTinBuiltin(CSymbolTable::s_strU32));
+		return SOpTypes(pTinUnqualLhs, pTinUnqualLhs, pTinUnqualLhs);
+	}
+
 	if (pTinLhs->m_tink == pTinRhs->m_tink)
 	{
 		switch(pTinLhs->m_tink)
@@ -2888,52 +3273,177 @@ inline bool FIsNumericTink(TINK tink)
 	}
 }
 
-static bool FCanImplicitCast(STypeInfo * pTinSrc, STypeInfo * pTinDst)
+static bool FCheckSimdStruct(STypeCheckWorkspace * pTcwork, CSTNode * pStnod, STypeInfoStruct * pTinstruct)
 {
-	if (!pTinSrc)
-		return false;	 // NOTE: this can happen after an error has occurred, don't assert - just return.
+	int cLane = pTinstruct->CLane();
+	if ((cLane < 2) | (cLane > s_cLaneSimdMax))
+	{
+		EmitError(pTcwork, pStnod, ERRID_BadSimdStruct, 
+			"#simd structure '%s' has %d fields, expected between 2 and %d lanes", 
+			pTinstruct->m_strName.PCoz(), cLane, s_cLaneSimdMax);
+		return false;
+	}
 
-	EWC_ASSERT(pTinSrc->m_tink != TINK_Literal, "literals should be promoted before calling FCanImplicitCast()");
+	auto pTinLane = PTinStripQualifiers(pTinstruct->PTinLane());
+	if (!pTinLane || ((pTinLane->m_tink != TINK_Integer) & (pTinLane->m_tink != TINK_Float)))
+	{
+		CString strTin = (pTinLane) ? StrFromTypeInfo(pTinLane) : CString("unknown");
+		EmitError(pTcwork, pStnod, ERRID_BadSimdStruct, 
+			"#simd structure '%s' lanes must be integer or float, not %s", pTinstruct->m_strName.PCoz(), strTin.PCoz());
+		return false;
+	}
 
-	if (pTinDst->m_tink == TINK_Qualifier)
+	auto pTypemembMax = pTinstruct->m_aryTypemembField.PMac();
+	for (auto pTypememb = pTinstruct->m_aryTypemembField.A(); pTypememb != pTypemembMax; ++pTypememb)
 	{
-		STypeInfo * pTinSrcAdj = (pTinSrc->m_tink == TINK_Qualifier) ? ((STypeInfoQualifier *)pTinSrc)->m_pTin : pTinSrc;
-		auto pTinqualDst = (STypeInfoQualifier *)pTinDst;
+		if (!FTypesAreSame(PTinStripQualifiers(pTypememb->m_pTin), pTinLane))
+		{
+			CString strTinMember = StrFromTypeInfo(pTypememb->m_pTin);
+			CString strTinLane = StrFromTypeInfo(pTinLane);
+			EmitError(pTcwork, pStnod, ERRID_BadSimdStruct, 
+				"#simd structure '%s' field '%s' is %s, all lanes must be %s", 
+				pTinstruct->m_strName.PCoz(), pTypememb->m_strName.PCoz(), strTinMember.PCoz(), strTinLane.PCoz());
+			return false;
+		}
+	}
+	return true;
+}
 
-		return FCanImplicitCast(pTinSrcAdj, pTinqualDst->m_pTin);
+static bool FCheckSimdIntrinsic(STypeCheckWorkspace * pTcwork, CSymbolTable * pSymtab, CSTNode * pStnod, RWORD rword)
+{
+	// simd_select takes the lane mask first, the rest of the intrinsics start with the vector operand
+	int iStnodVector = (rword == RWORD_SimdSelect) ? 1 : 0;
+	auto pStnodVector = pStnod->PStnodChildSafe(iStnodVector);
+	auto pTinVector = (pStnodVector) ? PTinStripQualifiers(pStnodVector->m_pTin) : nullptr;
+	if (!FIsSimdStruct(pTinVector))
+	{
+		CString strTin = (pTinVector) ? StrFromTypeInfo(pTinVector) : CString("nothing");
+		EmitError(pTcwork, pStnod, ERRID_BadSimdOperand, 
+			"%s expects a #simd structure operand, not %s", PCozFromRword(rword), strTin.PCoz());
+		return false;
 	}
 
-	if (pTinSrc->m_tink == pTinDst->m_tink)
+	auto pTinstruct = (STypeInfoStruct *)pTinVector;
+	int cLane = pTinstruct->CLane();
+	switch (rword)
 	{
-		// Note - can't just compare pointers directly as tins are not unique. (but they should be)
-		switch (pTinSrc->m_tink)
+	case RWORD_SimdShuffle:
 		{
-		case TINK_Integer:
+			if (pStnod->CStnodChild() != cLane + 1)
 			{
-				auto pTinintSrc = (STypeInfoInteger *)pTinSrc;
-				auto pTinintDst = (STypeInfoInteger *)pTinDst;
-
-				if ((pTinintDst->m_cBit >= pTinintSrc->m_cBit) & (pTinintDst->m_fIsSigned == pTinintSrc->m_fIsSigned))
-					return true;
+				EmitError(pTcwork, pStnod, ERRID_BadSimdOperand, 
+					"simd_shuffle of %s expects %d lane indices", pTinstruct->m_strName.PCoz(), cLane);
+				return false;
+			}
 
-				// Allow unsigned->signed conversions if a higher cBit
-				return ((pTinintDst->m_fIsSigned == true) & (pTinintDst->m_cBit > pTinintSrc->m_cBit));
+			auto pTinS32 = pSymtab->PTinBuiltin(CSymbolTable::s_strS32);
+			for (int iStnodLane = 1; iStnodLane <= cLane; ++iStnodLane)
+			{
+				auto pStnodLane = pStnod->PStnodChild(iStnodLane);
+				auto pTinlit = PTinRtiCast<STypeInfoLiteral *>(pStnodLane->m_pTin);
+				if (!pTinlit || pTinlit->m_litty.m_litk != LITK_Integer || !pStnodLane->m_pStval ||
+					(pStnodLane->m_pStval->m_nSigned < 0) | (pStnodLane->m_pStval->m_nSigned >= cLane))
+				{
+					EmitError(pTcwork, pStnodLane, ERRID_BadSimdOperand, 
+						"simd_shuffle lane index must be a constant between 0 and %d", cLane - 1);
+					return false;
+				}
+				FinalizeLiteralType(pTcwork, pSymtab, pTinS32, pStnodLane);
 			}
-		case TINK_Float:
+		} break;
+	case RWORD_SimdSelect:
+		{
+			if (pStnod->CStnodChild() != 3)
 			{
-				auto pTinfloatSrc = (STypeInfoFloat *)pTinSrc;
-				auto pTinfloatDst = (STypeInfoFloat *)pTinDst;
-				return pTinfloatDst->m_cBit >= pTinfloatSrc->m_cBit;
+				EmitError(pTcwork, pStnod, ERRID_BadSimdOperand, "simd_select expects a lane mask and two operands");
+				return false;
 			}
-		case TINK_Bool: return true;
-		case TINK_Pointer:
+
+			auto pStnodMask = pStnod->PStnodChild(0);
+			auto pTinU32 = pSymtab->PTinBuiltin(CSymbolTable::s_strU32);
+			auto pTinMask = PTinPromoteUntypedRvalueTightest(pTcwork, pSymtab, pStnodMask, pTinU32);
+			if (!FCanImplicitCast(pTinMask, pTinU32))
 			{
-				auto pTinptrSrc = (STypeInfoPointer *)pTinSrc;
-				auto pTinptrDst = (STypeInfoPointer *)pTinDst;
-				if (pTinptrDst->m_pTinPointedTo->m_tink == TINK_Void)
-					return true;
+				CString strTin = StrFromTypeInfo(pTinMask);
+				EmitError(pTcwork, pStnod, ERRID_BadSimdOperand, "simd_select mask must be a u32 lane mask, not %s", strTin.PCoz());
+				return false;
+			}
 
-				STypeInfo * pTinChildSrc = pTinptrSrc->m_pTinPointedTo;
+			auto pTinFalse = PTinStripQualifiers(pStnod->PStnodChild(2)->m_pTin);
+			if (!FTypesAreSame(pTinFalse, pTinstruct))
+			{
+				CString strTinTrue = StrFromTypeInfo(pTinstruct);
+				CString strTinFalse = StrFromTypeInfo(pTinFalse);
+				EmitError(pTcwork, pStnod, ERRID_BadSimdOperand, 
+					"simd_select operands must be the same type, not %s and %s", strTinTrue.PCoz(), strTinFalse.PCoz());
+				return false;
+			}
+
+			FinalizeLiteralType(pTcwork, pSymtab, pTinU32, pStnodMask);
+		} break;
+	default:
+		{
+			if (pStnod->CStnodChild() != 1)
+			{
+				EmitError(pTcwork, pStnod, ERRID_BadSimdOperand, "%s expects a single operand", PCozFromRword(rword));
+				return false;
+			}
+
+			pStnod->m_pTin = pTinstruct->PTinLane();
+			return true;
+		}
+	}
+
+	pStnod->m_pTin = pTinstruct;
+	return true;
+}
+
+static bool FCanImplicitCast(STypeInfo * pTinSrc, STypeInfo * pTinDst)
+{
+	if (!pTinSrc)
+		return false;	 // NOTE: this can happen after an error has occurred, don't assert - just return.
+
+	EWC_ASSERT(pTinSrc->m_tink != TINK_Literal, "literals should be promoted before calling FCanImplicitCast()");
+
+	if (pTinDst->m_tink == TINK_Qualifier)
+	{
+		STypeInfo * pTinSrcAdj = (pTinSrc->m_tink == TINK_Qualifier) ? ((STypeInfoQualifier *)pTinSrc)->m_pTin : pTinSrc;
+		auto pTinqualDst = (STypeInfoQualifier *)pTinDst;
+
+		return FCanImplicitCast(pTinSrcAdj, pTinqualDst->m_pTin);
+	}
+
+	if (pTinSrc->m_tink == pTinDst->m_tink)
+	{
+		// Note - can't just compare pointers directly as tins are not unique. (but they should be)
+		switch (pTinSrc->m_tink)
+		{
+		case TINK_Integer:
+			{
+				auto pTinintSrc = (STypeInfoInteger *)pTinSrc;
+				auto pTinintDst = (STypeInfoInteger *)pTinDst;
+
+				if ((pTinintDst->m_cBit >= pTinintSrc->m_cBit) & (pTinintDst->m_fIsSigned == pTinintSrc->m_fIsSigned))
+					return true;
+
+				// Allow unsigned->signed conversions if a higher cBit
+				return ((pTinintDst->m_fIsSigned == true) & (pTinintDst->m_cBit > pTinintSrc->m_cBit));
+			}
+		case TINK_Float:
+			{
+				auto pTinfloatSrc = (STypeInfoFloat *)pTinSrc;
+				auto pTinfloatDst = (STypeInfoFloat *)pTinDst;
+				return pTinfloatDst->m_cBit >= pTinfloatSrc->m_cBit;
+			}
+		case TINK_Bool: return true;
+		case TINK_Pointer:
+			{
+				auto pTinptrSrc = (STypeInfoPointer *)pTinSrc;
+				auto pTinptrDst = (STypeInfoPointer *)pTinDst;
+				if (pTinptrDst->m_pTinPointedTo->m_tink == TINK_Void)
+					return true;
+
+				STypeInfo * pTinChildSrc = pTinptrSrc->m_pTinPointedTo;
 				STypeInfo * pTinChildDst = pTinptrDst->m_pTinPointedTo;
 				GRFQUALK grfqualkSrc;
 				GRFQUALK grfqualkDst;
@@ -2962,6 +3472,10 @@ static bool FCanImplicitCast(STypeInfo * pTinSrc, STypeInfo * pTinDst)
 				auto pTinaryDst = (STypeInfoArray *)pTinDst;
 				auto pTinarySrc = (STypeInfoArray *)pTinSrc;
 
+				// SOA and AOS arrays have different memory layouts, they never alias
+				if (pTinaryDst->m_fIsSoa != pTinarySrc->m_fIsSoa)
+					return false;
+
 				STypeInfo * pTinChildSrc = pTinarySrc->m_pTin;
 				STypeInfo * pTinChildDst = pTinaryDst->m_pTin;
 				GRFQUALK grfqualkSrc;
@@ -3006,6 +3520,9 @@ static bool FCanImplicitCast(STypeInfo * pTinSrc, STypeInfo * pTinDst)
 		auto pTinarySrc = (STypeInfoArray *)pTinSrc;
 		auto pTinptrDst = (STypeInfoPointer *)pTinDst;
 		auto pTinPointedTo = pTinptrDst->m_pTinPointedTo;
+		if (pTinarySrc->m_fIsSoa)
+			return false;
+
 		if (pTinPointedTo->m_tink == TINK_Void)
 			return true;
 		return FCanImplicitCast(pTinarySrc->m_pTin, pTinPointedTo);	
@@ -3136,7 +3653,7 @@ bool FIsValidLhs(const CSTNode * pStnod)
 	if (tink == TINK_Array)
 	{
 		auto pTinary = (STypeInfoArray *)pTin;
-		return pTinary->m_aryk == ARYK_Reference;
+		return pTinary->m_aryk != ARYK_Fixed;
 	}
 
 	return (tink != TINK_Null) & (tink != TINK_Void) & (tink != TINK_Literal);
@@ -3191,6 +3708,7 @@ QUALK QualkFromRword(RWORD rword)
 	{
 	case RWORD_Const: return QUALK_Const;
 	case RWORD_InArg: return QUALK_InArg;
+	case RWORD_Restrict: return QUALK_Restrict;
 	default: 
 		EWC_ASSERT(false, "unexpected RWORD for qualk");
 		return QUALK_Nil;
@@ -3229,6 +3747,78 @@ bool FIsCompileTimeConstant(CSTNode * pStnod)
 	return false;
 }
 
+static bool FIsBakeableRunType(STypeInfo * pTin)
+{
+	// #run results are copied out of the bytecode VM's memory, so they can't reference anything in it
+
+	pTin = PTinStripQualifiers(pTin);
+	switch (pTin->m_tink)
+	{
+	case TINK_Integer:	return true;
+	case TINK_Float:	return true;
+	case TINK_Bool:		return true;
+	case TINK_Enum:		return true;
+	case TINK_Array:
+		{
+			auto pTinary = (STypeInfoArray *)pTin;
+			return (pTinary->m_aryk == ARYK_Fixed) && !pTinary->m_fIsSoa && FIsBakeableRunType(pTinary->m_pTin);
+		}
+	case TINK_Struct:
+		{
+			auto pTinstruct = (STypeInfoStruct *)pTin;
+			if (FIsGenericType(pTinstruct))
+				return false;
+
+			auto pTypemembMax = pTinstruct->m_aryTypemembField.PMac();
+			for (auto pTypememb = pTinstruct->m_aryTypemembField.A(); pTypememb != pTypemembMax; ++pTypememb)
+			{
+				if (!FIsBakeableRunType(pTypememb->m_pTin))
+					return false;
+			}
+			return true;
+		}
+	default: return false;
+	}
+}
+
+static bool FCheckRunDirective(STypeCheckWorkspace * pTcwork, CSTNode * pStnod)
+{
+	auto pStnodCall = pStnod->PStnodChildSafe(0);
+	if (!pStnodCall || pStnodCall->m_park != PARK_ProcedureCall)
+	{
+		EmitError(pTcwork, pStnod, ERRID_BadRunDirective, "#run expects a procedure call");
+		return false;
+	}
+
+	// the call is executed on its own during compilation, there are no locals to pass along
+	for (int iStnodArg = 1; iStnodArg < pStnodCall->CStnodChild(); ++iStnodArg)
+	{
+		auto pStnodArg = pStnodCall->PStnodChild(iStnodArg);
+		if (pStnodArg->m_park == PARK_ArgumentLabel)
+		{
+			pStnodArg = pStnodArg->PStnodChildSafe(1);
+		}
+
+		if (pStnodArg && !FIsCompileTimeConstant(pStnodArg))
+		{
+			EmitError(pTcwork, pStnodArg, ERRID_BadRunDirective, "#run procedure arguments must be compile time constants");
+			return false;
+		}
+	}
+
+	auto pTinResult = pStnodCall->m_pTin;
+	if (!pTinResult || !FIsBakeableRunType(pTinResult))
+	{
+		CString strTin = (pTinResult) ? StrFromTypeInfo(pTinResult) : CString("void");
+		EmitError(pTcwork, pStnod, ERRID_BadRunDirective, 
+			"#run result must be a scalar, fixed array or plain struct, not %s", strTin.PCoz());
+		return false;
+	}
+
+	pStnod->m_pTin = pTinResult;
+	return true;
+}
+
 STypeInfo * PTinFromTypeArgument(CSTNode * pStnod)
 {
 	if (!EWC_FVERIFY(pStnod->m_park == PARK_TypeArgument, "expected type argument"))
@@ -3725,6 +4315,7 @@ STypeInfo * PTinSubstituteGenerics(
 				
 				pTinstructNew->m_pGenmap = pGenmapTrim;
 				pTinstructNew->m_pTinstructInstFrom = pTinstructUnsub;
+				pTinstructNew->m_grfstruct = pTinstructUnsub->m_grfstruct;
 
 				for (int iTypememb = 0; iTypememb < cTypememb; ++iTypememb)
 				{
@@ -4014,6 +4605,7 @@ SInstantiateRequest * PInsreqInstantiateGenericStruct(
 
 	auto cTypememb = pTinstructSrc->m_aryTypemembField.C();
 	auto pTinstructNew = PTinstructAlloc(pSymtabNew, pTinstructSrc->m_strName, cTypememb, cGenericValue + cGenericType);
+	pTinstructNew->m_grfstruct = pTinstructSrc->m_grfstruct;
 
 	for (int iTypememb = 0; iTypememb < cTypememb; ++iTypememb)
 	{
@@ -4100,8 +4692,7 @@ SInstantiateRequest * PInsreqInstantiateGenericStruct(
 	}
 
 	STypeCheckFrame * pTcfram = pTcwork->m_blistTcfram.AppendNew();
-	pTcfram->m_ipTcframQueue = pTcwork->m_arypTcframPending.C();
-	pTcwork->m_arypTcframPending.Append(pTcfram);
+	ScheduleTcfram(pTcwork, pTcfram);
 
 	SWorkspaceEntry * pEntry = pTcwork->m_pblistEntry->AppendNew();
 	pEntry->m_pStnod = pStnodStructCopy;
@@ -4474,6 +5065,41 @@ void PopTinSpecStack(CDynAry<STinSpecEntry> * paryTinse, STypeInfo * pTin, SType
 	}
 }
 
+// SOA storage is zero filled per lane, so element types can't rely on member default values
+static bool FHasMemberDefaults(STypeInfo * pTin)
+{
+	pTin = PTinStripQualifiers(pTin);
+	if (!pTin)
+		return false;
+
+	if (pTin->m_tink == TINK_Array)
+	{
+		auto pTinary = (STypeInfoArray *)pTin;
+		return pTinary->m_aryk == ARYK_Fixed && FHasMemberDefaults(pTinary->m_pTin);
+	}
+
+	auto pTinstruct = PTinRtiCast<STypeInfoStruct *>(pTin);
+	if (!pTinstruct)
+		return false;
+
+	auto pTypemembMax = pTinstruct->m_aryTypemembField.PMac();
+	for (auto pTypememb = pTinstruct->m_aryTypemembField.A(); pTypememb != pTypemembMax; ++pTypememb)
+	{
+		CSTNode * pStnodDecl = pTypememb->m_pStnod;
+		auto pStdecl = (pStnodDecl) ? PStmapRtiCast<CSTDecl *>(pStnodDecl->m_pStmap) : nullptr;
+		if (pStdecl)
+		{
+			auto pStnodInit = pStnodDecl->PStnodChildSafe(pStdecl->m_iStnodInit);
+			if (pStnodInit && pStnodInit->m_park != PARK_Uninitializer)
+				return true;
+		}
+
+		if (FHasMemberDefaults(pTypememb->m_pTin))
+			return true;
+	}
+	return false;
+}
+
 STypeInfo * PTinFromTypeSpecification(
 	STypeCheckWorkspace * pTcwork,
 	CSymbolTable * pSymtabRoot,
@@ -4641,9 +5267,30 @@ STypeInfo * PTinFromTypeSpecification(
 						pTinary->m_aryk = (pStnod->m_tok == TOK_PeriodPeriod) ? ARYK_Dynamic : ARYK_Reference;
 					}
 
-					if (pTinary->m_aryk == ARYK_Dynamic)
+					if (pStnod->m_grfstnod.FIsSet(FSTNOD_Soa))
 					{
-						EmitError(pTcwork, pStnod, ERRID_NotYetSupported, "Dynamic arrays are not yet supported");
+						pTinary->m_fIsSoa = true;
+						if (pTinary->m_aryk == ARYK_Dynamic)
+						{
+							EmitError(pTcwork, pStnod, ERRID_BadSoaArray, "SOA arrays cannot be dynamic"); 
+							*pFIsValidTypeSpec = false;
+						}
+
+						auto pTinElement = pTinary->m_pTin;
+						if (pTinElement && pTinElement->m_tink != TINK_Struct && pTinElement->m_tink != TINK_Generic)
+						{
+							EmitError(pTcwork, pStnod, ERRID_BadSoaArray, 
+								"SOA arrays must have a structure element type, not '%s'", 
+								StrFromTypeInfo(pTinary->m_pTin).PCoz());
+							*pFIsValidTypeSpec = false;
+						}
+						else if (FHasMemberDefaults(pTinElement))
+						{
+							EmitError(pTcwork, pStnod, ERRID_BadSoaArray, 
+								"SOA element type '%s' has member default values, SOA storage is zero initialized", 
+								StrFromTypeInfo(pTinary->m_pTin).PCoz());
+							*pFIsValidTypeSpec = false;
+						}
 					}
 
 					pStnod->m_pTin = pTinary;
@@ -4733,6 +5380,172 @@ int ITypemembLookup(STypeInfoStruct * pTinstruct, const CString & strMemberName)
 	return -1;
 }
 
+int ITypemembFromDeclIndex(STypeInfoStruct * pTinstruct, int iTypemembDecl)
+{
+	int cTypememb = (int)pTinstruct->m_aryTypemembField.C();
+	if (iTypemembDecl < 0 || iTypemembDecl >= cTypememb)
+		return -1;
+
+	// fields are only out of declaration order in #reorder structs
+	if (pTinstruct->m_aryTypemembField[iTypemembDecl].m_iTypemembDecl == iTypemembDecl)
+		return iTypemembDecl;
+
+	for (int iTypememb = 0; iTypememb < cTypememb; ++iTypememb)
+	{
+		if (pTinstruct->m_aryTypemembField[iTypememb].m_iTypemembDecl == iTypemembDecl)
+			return iTypememb;
+	}
+	return -1;
+}
+
+struct SIteratorProc // tag = iterproc
+{
+	STypeInfoStruct *	m_pTinstruct;	// iterator type the procedure takes a pointer to
+	CString				m_strParam;		// name of that parameter
+	CSTNode *			m_pStnodStmt;	// the body's only statement, ignoring a trailing empty return
+};
+
+static bool FTryFindIteratorProc(CSTNode * pStnodCall, SIteratorProc * pIterproc)
+{
+	// pStnodCall must resolve to a procedure taking a single struct pointer whose body is a single statement
+
+	if (!pStnodCall || pStnodCall->m_park != PARK_ProcedureCall || pStnodCall->CStnodChild() != 2)
+		return false;
+
+	auto pTinproc = PTinRtiCast<STypeInfoProcedure *>(pStnodCall->PStnodChild(0)->m_pTin);
+	if (!pTinproc || pTinproc->m_arypTinParams.C() != 1 || !pTinproc->m_pStnodDefinition)
+		return false;
+
+	auto pTinptr = PTinRtiCast<STypeInfoPointer *>(PTinStripQualifiers(pTinproc->m_arypTinParams[0]));
+	auto pTinstruct = (pTinptr) ? PTinRtiCast<STypeInfoStruct *>(PTinStripQualifiers(pTinptr->m_pTinPointedTo)) : nullptr;
+	if (!pTinstruct)
+		return false;
+
+	CSTNode * pStnodDef = pTinproc->m_pStnodDefinition;
+	auto pStproc = PStmapRtiCast<CSTProcedure *>(pStnodDef->m_pStmap);
+	if (!pStproc)
+		return false;
+
+	auto pStnodParams = pStnodDef->PStnodChildSafe(pStproc->m_iStnodParameterList);
+	auto pStnodBody = pStnodDef->PStnodChildSafe(pStproc->m_iStnodBody);
+	if (!pStnodParams || pStnodParams->CStnodChild() != 1 || !pStnodBody || pStnodBody->m_park != PARK_List)
+		return false;
+
+	int cStnodStmt = pStnodBody->CStnodChild();
+	if (cStnodStmt == 2)
+	{
+		auto pStnodLast = pStnodBody->PStnodChild(1);
+		if (!FIsReservedWord(pStnodLast, RWORD_Return) || pStnodLast->CStnodChild() != 0)
+			return false;
+	}
+	else if (cStnodStmt != 1)
+	{
+		return false;
+	}
+
+	pIterproc->m_pTinstruct = pTinstruct;
+	pIterproc->m_strParam = StrIdentifierFromDecl(pStnodParams->PStnodChild(0));
+	pIterproc->m_pStnodStmt = pStnodBody->PStnodChild(0);
+	return true;
+}
+
+static int ITypemembFromParamLookup(SIteratorProc * pIterproc, CSTNode * pStnod)
+{
+	// returns the member index if pStnod is 'param.member'
+
+	if (!pStnod || pStnod->m_park != PARK_MemberLookup || pStnod->CStnodChild() != 2)
+		return -1;
+
+	auto pStnodParam = pStnod->PStnodChild(0);
+	if (pStnodParam->m_park != PARK_Identifier || StrFromIdentifier(pStnodParam) != pIterproc->m_strParam)
+		return -1;
+
+	auto pStnodMember = pStnod->PStnodChild(1);
+	if (pStnodMember->m_park != PARK_Identifier)
+		return -1;
+
+	return ITypemembLookup(pIterproc->m_pTinstruct, StrFromIdentifier(pStnodMember));
+}
+
+static void RecognizeCountedForEach(CSTNode * pStnodFor, CSTFor * pStfor)
+{
+	// for_each over an int range iterator is lowered to a counted loop, codegen compares and increments the
+	//  iterator's fields directly instead of calling iterIsDone/iterNext. This keeps the loop canonical for LLVM
+	//  and saves two calls per iteration in the bytecode VM.
+	// The match is on what the calls resolve to, not their names: iterIsDone must be 'return p.counter >= p.limit'
+	//  and iterNext must be '++p.counter' over the same iterator type, like basic.moe's SIntIterator. Any other 
+	//  iterator keeps its calls.
+
+	SIteratorProc iterprocDone;
+	SIteratorProc iterprocNext;
+	if (!FTryFindIteratorProc(pStnodFor->PStnodChildSafe(pStfor->m_iStnodPredicate), &iterprocDone) ||
+		!FTryFindIteratorProc(pStnodFor->PStnodChildSafe(pStfor->m_iStnodIncrement), &iterprocNext) ||
+		iterprocDone.m_pTinstruct != iterprocNext.m_pTinstruct)
+		return;
+
+	auto pStnodReturn = iterprocDone.m_pStnodStmt;
+	if (!FIsReservedWord(pStnodReturn, RWORD_Return) || pStnodReturn->CStnodChild() != 1)
+		return;
+
+	auto pStnodCompare = pStnodReturn->PStnodChild(0);
+	if (pStnodCompare->m_park != PARK_RelationalOp || pStnodCompare->m_tok != TOK_GreaterEqual || pStnodCompare->CStnodChild() != 2)
+		return;
+
+	int iTypememb = ITypemembFromParamLookup(&iterprocDone, pStnodCompare->PStnodChild(0));
+	int iTypemembMax = ITypemembFromParamLookup(&iterprocDone, pStnodCompare->PStnodChild(1));
+	if (iTypememb < 0 || iTypemembMax < 0 || iTypememb == iTypemembMax)
+		return;
+
+	auto pStnodIncrement = iterprocNext.m_pStnodStmt;
+	if (pStnodIncrement->m_park != PARK_UnaryOp || pStnodIncrement->m_tok != TOK_PlusPlus || pStnodIncrement->CStnodChild() != 1)
+		return;
+
+	if (ITypemembFromParamLookup(&iterprocNext, pStnodIncrement->PStnodChild(0)) != iTypememb)
+		return;
+
+	auto pTinstruct = iterprocDone.m_pTinstruct;
+
+	auto pTinCounter = pTinstruct->m_aryTypemembField[iTypememb].m_pTin;
+	auto pTinLimit = pTinstruct->m_aryTypemembField[iTypemembMax].m_pTin;
+	if (!pTinCounter || pTinCounter->m_tink != TINK_Integer || !FTypesAreSame(pTinCounter, pTinLimit))
+		return;
+
+	pStfor->m_iTypemembCounter = iTypememb;
+	pStfor->m_iTypemembLimit = iTypemembMax;
+}
+
+static void ReorderStructMembers(STypeInfoStruct * pTinstruct)
+{
+	// #reorder structs are laid out by decreasing alignment, sizes are multiples of alignment so this leaves
+	//  no interior padding. The sort is stable so equally aligned fields keep their declaration order. This runs
+	//  before anything computes offsets (m_dBOffset, LLVM struct types) so every backend sees the same layout.
+
+	SDataLayout dlay;
+	BuildStubDataLayout(&dlay);
+
+	int cTypememb = (int)pTinstruct->m_aryTypemembField.C();
+	auto aTypememb = pTinstruct->m_aryTypemembField.A();
+	for (int iTypememb = 1; iTypememb < cTypememb; ++iTypememb)
+	{
+		STypeStructMember typememb = aTypememb[iTypememb];
+
+		u64 cB, cBAlign;
+		CalculateByteSizeAndAlign(&dlay, typememb.m_pTin, &cB, &cBAlign);
+
+		int iTypemembIns = iTypememb;
+		for ( ; iTypemembIns > 0; --iTypemembIns)
+		{
+			u64 cBPrev, cBAlignPrev;
+			CalculateByteSizeAndAlign(&dlay, aTypememb[iTypemembIns - 1].m_pTin, &cBPrev, &cBAlignPrev);
+			if (cBAlignPrev >= cBAlign)
+				break;
+
+			aTypememb[iTypemembIns] = aTypememb[iTypemembIns - 1];
+		}
+		aTypememb[iTypemembIns] = typememb;
+	}
+}
+
 const char * PChzFromIvalk(IVALK ivalk)
 {
 	static const char * s_mpIvalkPChz[] =
@@ -4797,6 +5610,19 @@ IVALK IvalkCompute(CSTNode * pStnod)
 			return IVALK_RValue;
 		}
 
+		// dynamic array members are assignable, growing the array is implemented in moe code
+		auto pTinaryDynamic = PTinRtiCast<STypeInfoArray *>(pTinLhs);
+		if (pTinLhs && pTinLhs->m_tink == TINK_Pointer)
+		{
+			pTinaryDynamic = PTinRtiCast<STypeInfoArray *>(((STypeInfoPointer *)pTinLhs)->m_pTinPointedTo);
+		}
+		if (pTinaryDynamic && pTinaryDynamic->m_aryk == ARYK_Dynamic)
+		{
+			if (pTinLhs->m_tink == TINK_Pointer || IvalkCompute(pStnodLhs) == IVALK_LValue)
+				return IVALK_LValue;
+			return IVALK_RValue;
+		}
+
 		if (pTinLhs && (pTinLhs->m_tink == TINK_Array || pTinLhs->m_tink == TINK_Literal))
 		{
 			return IVALK_RValue;
@@ -4828,6 +5654,13 @@ IVALK IvalkCompute(CSTNode * pStnod)
 		{
 			return IVALK_RValue;
 		}
+
+		// SOA elements are gathered into a temporary, only their members are addressable
+		auto pTinary = PTinRtiCast<STypeInfoArray *>(PTinStripQualifiers(pStnodArray->m_pTin));
+		if (pTinary && pTinary->m_fIsSoa)
+		{
+			return IVALK_RValue;
+		}
 		return (pStnodArray->m_pTin->m_tink == TINK_Literal) ? IVALK_RValue : IVALK_LValue;
 	}
 	else if (pStnod->m_park == PARK_UnaryOp && pStnod->m_tok == TOK_Dereference)
@@ -5060,8 +5893,7 @@ TCRET TcretWaitForTypeSymbol(STypeCheckWorkspace * pTcwork, STypeCheckFrame * pT
 	else
 	{
 		// wait for this type to be resolved.
-		SUnknownType * pUntype = PUntypeEnsure(pTcwork, pSymType);
-		pUntype->m_arypTcframDependent.Append(pTcfram);
+		WaitForSymbol(pTcwork, pTcfram, pSymType);
 		return TCRET_WaitingForSymbolDefinition;
 	}
 }
@@ -5639,6 +6471,7 @@ ERRID ErridComputeDefinedGenerics(
 					{
 						fArykMatches |= pTinaryDock->m_aryk == pTinaryRef->m_aryk;
 						fArykMatches |= pTinaryDock->m_aryk == ARYK_Reference;	// other aryk types can implicit convert to a reference
+						fArykMatches &= pTinaryDock->m_fIsSoa == pTinaryRef->m_fIsSoa;
 					}
 
 					if (!pTinaryRef || !fArykMatches)
@@ -6182,13 +7015,12 @@ void ResolveProcCallArguments(STypeCheckWorkspace * pTcwork, CSTNode * pStnodCal
 	}
 }
 
-bool FLiteralsAreSame(CSTNode * pStnodA, CSTNode * pStnodB)
+static bool FLiteralValuesAreSame(
+	STypeInfoLiteral * pTinlitA,
+	const CSTValue * pStvalA,
+	STypeInfoLiteral * pTinlitB,
+	const CSTValue * pStvalB)
 {
-	CSTValue * pStvalA = pStnodA->m_pStval;
-	CSTValue * pStvalB = pStnodB->m_pStval;
-	STypeInfoLiteral * pTinlitA = (STypeInfoLiteral *)pStnodA->m_pTin;
-	STypeInfoLiteral * pTinlitB = (STypeInfoLiteral *)pStnodB->m_pTin;
-
 	if (pTinlitA->m_litty.m_litk != pTinlitB->m_litty.m_litk)
 		return false;
 
@@ -6224,6 +7056,22 @@ bool FLiteralsAreSame(CSTNode * pStnodA, CSTNode * pStnodB)
 
 			return pStvalA->m_nUnsigned == pStvalB->m_nUnsigned;
 		}
+	default:
+		EWC_ASSERT(false, "Unhandled LITK");
+	}
+	return false;
+}
+
+bool FLiteralsAreSame(CSTNode * pStnodA, CSTNode * pStnodB)
+{
+	STypeInfoLiteral * pTinlitA = (STypeInfoLiteral *)pStnodA->m_pTin;
+	STypeInfoLiteral * pTinlitB = (STypeInfoLiteral *)pStnodB->m_pTin;
+
+	if (pTinlitA->m_litty.m_litk != pTinlitB->m_litty.m_litk)
+		return false;
+
+	switch (pTinlitA->m_litty.m_litk)
+	{
 	case LITK_Compound:
 		{
 			if (pTinlitA->m_pTinSource != pTinlitB->m_pTinSource)
@@ -6252,9 +7100,8 @@ bool FLiteralsAreSame(CSTNode * pStnodA, CSTNode * pStnodB)
 			return true;
 		}
 	default:
-		EWC_ASSERT(false, "Unhandled LITK");
+		return FLiteralValuesAreSame(pTinlitA, pStnodA->m_pStval, pTinlitB, pStnodB->m_pStval);
 	}
-	return false;
 }
 
 bool FAnchorsAreSame(SAnchor * pAncA, SAnchor * pAncB)
@@ -6337,61 +7184,237 @@ void CGenericRegistry::Cleanup()
 	m_aryInsreq.Clear();
 }
 
-CGenericRegistry::SEntry * CGenericRegistry::PEntryLookup(CSTNode * pStnodInstFrom, SGenericMap * pGenmap)
+static inline HV HvConcatN(HV hv, u64 n)
 {
-	SEntryBlock ** ppBlock = m_mpStnodInstFromBlock.Lookup(pStnodInstFrom);
-	if (ppBlock == nullptr)
-		return nullptr;
+	return HvConcatPBFVN(hv, &n, sizeof(n));
+}
 
-	SEntryBlock * pBlock = *ppBlock;
-	auto pEntryMac = pBlock->m_aryEntry.PMac();
-	for (auto pEntryIt = pBlock->m_aryEntry.A(); pEntryIt != pEntryMac; ++pEntryIt)
+// Structural hashes for generic map keys: anything FTypesAreSame/FLiteralsAreSame considers equal must hash equally.
+
+static HV HvConcatTypeStructure(HV hv, STypeInfo * pTin)
+{
+	if (!pTin)
+		return HvConcatN(hv, 0);
+
+	hv = HvConcatN(hv, pTin->m_tink);
+	switch (pTin->m_tink)
+	{
+	case TINK_Float:	return HvConcatN(hv, ((STypeInfoFloat *)pTin)->m_cBit);
+	case TINK_Integer:
+		{
+			auto pTinint = (STypeInfoInteger *)pTin;
+			return HvConcatN(HvConcatN(hv, pTinint->m_cBit), pTinint->m_fIsSigned);
+		}
+	case TINK_Qualifier:
+		{
+			auto pTinqual = (STypeInfoQualifier *)pTin;
+			return HvConcatTypeStructure(HvConcatN(hv, pTinqual->m_grfqualk.m_raw), pTinqual->m_pTin);
+		}
+	case TINK_Pointer:
+		{
+			auto pTinptr = (STypeInfoPointer *)pTin;
+			return HvConcatTypeStructure(HvConcatN(hv, pTinptr->m_fIsImplicitRef), pTinptr->m_pTinPointedTo);
+		}
+	case TINK_Array:
+		{
+			auto pTinary = (STypeInfoArray *)pTin;
+			hv = HvConcatN(hv, pTinary->m_aryk);
+			hv = HvConcatN(hv, pTinary->m_c);
+			hv = HvConcatN(hv, pTinary->m_fIsSoa);
+			return HvConcatTypeStructure(hv, pTinary->m_pTin);
+		}
+	case TINK_Struct:	return HvConcatN(hv, (uintptr_t)((STypeInfoStruct *)pTin)->m_pStnodStruct);
+	case TINK_Procedure:
+		{
+			auto pTinproc = (STypeInfoProcedure *)pTin;
+			hv = HvConcatN(hv, pTinproc->m_grftinproc.m_raw);
+			hv = HvConcatN(hv, pTinproc->m_arypTinParams.C());
+			for (STypeInfo ** ppTin = pTinproc->m_arypTinParams.A(); ppTin != pTinproc->m_arypTinParams.PMac(); ++ppTin)
+			{
+				hv = HvConcatTypeStructure(hv, *ppTin);
+			}
+			hv = HvConcatN(hv, pTinproc->m_arypTinReturns.C());
+			for (STypeInfo ** ppTin = pTinproc->m_arypTinReturns.A(); ppTin != pTinproc->m_arypTinReturns.PMac(); ++ppTin)
+			{
+				hv = HvConcatTypeStructure(hv, *ppTin);
+			}
+			return hv;
+		}
+	case TINK_Generic:	return HvConcatN(hv, pTin->m_strName.Hv());
+	default:			
+		// FTypesAreSame only matches other kinds (enums, etc.) by identity
+		return HvConcatN(hv, (uintptr_t)pTin);
+	}
+}
+
+static HV HvConcatLiteralValue(HV hv, CSTNode * pStnod)
+{
+	CSTValue * pStval = pStnod->m_pStval;
+	STypeInfoLiteral * pTinlit = (STypeInfoLiteral *)pStnod->m_pTin;
+
+	hv = HvConcatN(hv, pTinlit->m_litty.m_litk);
+	switch (pTinlit->m_litty.m_litk)
 	{
-		auto pGenmapKey = pEntryIt->m_pGenmapKey;
-		if (pGenmapKey == pGenmap)
-			return pEntryIt;
+	case LITK_Integer:
+		hv = HvConcatN(hv, pTinlit->m_litty.m_cBit);
+		hv = HvConcatN(hv, pTinlit->m_litty.m_fIsSigned);
+		return HvConcatN(hv, pStval->m_nUnsigned);
+	case LITK_Float:
+		{
+			// -0.0 == 0.0, so they need to hash the same
+			f64 g = (pStval->m_g == 0.0) ? 0.0 : pStval->m_g;
+			hv = HvConcatN(hv, pTinlit->m_litty.m_cBit);
+			return HvConcatPBFVN(hv, &g, sizeof(g));
+		}
+	case LITK_Char:
+	case LITK_Bool:		return HvConcatN(hv, pStval->m_nUnsigned);
+	case LITK_String:	return HvConcatN(hv, pStval->m_str.Hv());
+	case LITK_Null:		return hv;
+	case LITK_Enum:
+		hv = HvConcatN(hv, (uintptr_t)pTinlit->m_pTinSource);
+		return HvConcatN(hv, pStval->m_nUnsigned);
+	case LITK_Compound:
+		{
+			hv = HvConcatN(hv, (uintptr_t)pTinlit->m_pTinSource);
 
-		if (pGenmap->m_mpStrAnc.C() != pGenmapKey->m_mpStrAnc.C())
-			continue;
+			CSTDecl * pStdecl = PStmapRtiCast<CSTDecl *>(pStnod->m_pStmap);
+			if (!pStdecl || pStdecl->m_iStnodInit < 0)
+				return hv;
+
+			auto pStnodList = pStnod->PStnodChild(pStdecl->m_iStnodInit);
+			hv = HvConcatN(hv, pStnodList->CStnodChild());
+			for (int ipStnod = 0; ipStnod < pStnodList->CStnodChild(); ++ipStnod)
+			{
+				hv = HvConcatLiteralValue(hv, pStnodList->PStnodChild(ipStnod));
+			}
+			return hv;
+		}
+	default:
+		return hv;
+	}
+}
 
-		EWC::CHash<CString, SAnchor>::CIterator iterIt(&pGenmapKey->m_mpStrAnc);
-		EWC::CHash<CString, SAnchor>::CIterator iterArg(&pGenmap->m_mpStrAnc);
+// returns false if any anchor is unmapped or baked to a non-literal value; FAnchorsAreSame treats those as
+//  wildcards, so they can't be hashed.
+static bool FTryComputeGenmapHv(SGenericMap * pGenmap, HV * pHv)
+{
+	// anchors are combined with a sum so the hash doesn't depend on hash table iteration order
+	HV hvSum = HvConcatN(HvFromPBFVN(nullptr, 0), pGenmap->m_mpStrAnc.C());
 
-		// NOTE: This generic registry is used to avoid endless looping while instantiating generic types!
-		//  Sidestepping it will cause the compiler to crash.
+	EWC::CHash<CString, SAnchor>::CIterator iter(&pGenmap->m_mpStrAnc);
+	CString * pStr;
+	SAnchor * pAnc;
+	while ((pAnc = iter.Next(&pStr)))
+	{
+		if (pAnc->FIsNull())
+			return false;
 
-		bool fAreTheSame = true;
-		CString * pStrIt;
-		CString * pStrArg;
-		SAnchor * pAncIt;
-		SAnchor * pAncArg;
-		while ((pAncIt = iterIt.Next(&pStrIt)))
+		HV hvAnc = HvConcatN(HvFromPBFVN(nullptr, 0), pStr->Hv());
+		if (pAnc->m_pTin)
 		{
-			pAncArg = iterArg.Next(&pStrArg);
-			if (!EWC_FVERIFY(pAncArg, "hash value mismatch"))
-				break;	
+			hvAnc = HvConcatTypeStructure(hvAnc, pAnc->m_pTin);
+		}
+		else
+		{
+			auto pStnodBaked = pAnc->m_pStnodBaked;
+			if (!pStnodBaked->m_pTin || pStnodBaked->m_pTin->m_tink != TINK_Literal)
+				return false;
 
-			fAreTheSame &= (*pStrIt == *pStrArg && FAnchorsAreSame(pAncIt, pAncArg));
-			if (!fAreTheSame)
-				break;
+			hvAnc = HvConcatLiteralValue(hvAnc, pStnodBaked);
+		}
+		hvSum += hvAnc;
+	}
+
+	*pHv = hvSum;
+	return true;
+}
+
+static bool FGenmapKeysAreSame(SGenericMap * pGenmapKey, SGenericMap * pGenmap)
+{
+	if (pGenmapKey == pGenmap)
+		return true;
+
+	if (pGenmap->m_mpStrAnc.C() != pGenmapKey->m_mpStrAnc.C())
+		return false;
+
+	EWC::CHash<CString, SAnchor>::CIterator iterIt(&pGenmapKey->m_mpStrAnc);
+	EWC::CHash<CString, SAnchor>::CIterator iterArg(&pGenmap->m_mpStrAnc);
+
+	// NOTE: This generic registry is used to avoid endless looping while instantiating generic types!
+	//  Sidestepping it will cause the compiler to crash.
+
+	bool fAreTheSame = true;
+	CString * pStrIt;
+	CString * pStrArg;
+	SAnchor * pAncIt;
+	SAnchor * pAncArg;
+	while ((pAncIt = iterIt.Next(&pStrIt)))
+	{
+		pAncArg = iterArg.Next(&pStrArg);
+		if (!EWC_FVERIFY(pAncArg, "hash value mismatch"))
+			break;	
+
+		fAreTheSame &= (*pStrIt == *pStrArg && FAnchorsAreSame(pAncIt, pAncArg));
+		if (!fAreTheSame)
+			break;
+	}
+
+	return fAreTheSame;
+}
+
+CGenericRegistry::SEntry * CGenericRegistry::PEntryLookup(CSTNode * pStnodInstFrom, SGenericMap * pGenmap)
+{
+	SEntryBlock ** ppBlock = m_mpStnodInstFromBlock.Lookup(pStnodInstFrom);
+	if (ppBlock == nullptr)
+		return nullptr;
+
+	HV hvGenmap = 0;
+	bool fIsHashed = FTryComputeGenmapHv(pGenmap, &hvGenmap);
+	return PEntryLookup(*ppBlock, pGenmap, fIsHashed, hvGenmap);
+}
+
+CGenericRegistry::SEntry * CGenericRegistry::PEntryLookup(SEntryBlock * pBlock, SGenericMap * pGenmap, bool fIsHashed, HV hvGenmap)
+{
+	if (!fIsHashed)
+	{
+		// a partially anchored lookup key has to be compared against everything
+		auto pEntryMac = pBlock->m_aryEntry.PMac();
+		for (auto pEntryIt = pBlock->m_aryEntry.A(); pEntryIt != pEntryMac; ++pEntryIt)
+		{
+			if (FGenmapKeysAreSame(pEntryIt->m_pGenmapKey, pGenmap))
+				return pEntryIt;
 		}
+		return nullptr;
+	}
 
-		if (fAreTheSame)
+	// entries are checked in the order they were registered, matching a linear scan
+	SEntry * pEntryBest = nullptr;
+	int * piEntry = pBlock->m_mpHvIEntry.Lookup(hvGenmap);
+	for (int iEntry = (piEntry) ? *piEntry : -1; iEntry >= 0; iEntry = pBlock->m_aryEntry[iEntry].m_iEntryNextHv)
+	{
+		SEntry * pEntry = &pBlock->m_aryEntry[iEntry];
+		if (FGenmapKeysAreSame(pEntry->m_pGenmapKey, pGenmap))
 		{
-			return pEntryIt;
+			pEntryBest = pEntry;
 		}
 	}
 
-	return nullptr;
+	auto piEntryMac = pBlock->m_aryIEntryUnhashed.PMac();
+	for (auto piEntryIt = pBlock->m_aryIEntryUnhashed.A(); piEntryIt != piEntryMac; ++piEntryIt)
+	{
+		SEntry * pEntry = &pBlock->m_aryEntry[*piEntryIt];
+		if (pEntryBest && pEntryBest < pEntry)
+			break;
+
+		if (FGenmapKeysAreSame(pEntry->m_pGenmapKey, pGenmap))
+			return pEntry;
+	}
+
+	return pEntryBest;
 }
 
 CGenericRegistry::SEntry * CGenericRegistry::PEntryEnsure(CSTNode * pStnodInstFrom, SGenericMap * pGenmap)
 {
-	// if this double lookup is a perf problem we could inline the lookup here, and just duplicate a bunch of code
-	auto pEntry = PEntryLookup(pStnodInstFrom, pGenmap);
-	if (pEntry)
-		return pEntry;
-
 	SEntryBlock ** ppBlock;
 	FINS fins = m_mpStnodInstFromBlock.FinsEnsureKey(pStnodInstFrom, &ppBlock);
 	if (fins == FINS_Inserted)
@@ -6399,9 +7422,31 @@ CGenericRegistry::SEntry * CGenericRegistry::PEntryEnsure(CSTNode * pStnodInstFr
 		*ppBlock = EWC_NEW(m_pAlloc, SEntryBlock) SEntryBlock(m_pAlloc);
 	}
 
-	// we don't need to search for a matching entry, it would have been found by pEntryLookup
-	auto pEntryNew = (*ppBlock)->m_aryEntry.AppendNew();
+	SEntryBlock * pBlock = *ppBlock;
+	HV hvGenmap = 0;
+	bool fIsHashed = FTryComputeGenmapHv(pGenmap, &hvGenmap);
+
+	auto pEntry = PEntryLookup(pBlock, pGenmap, fIsHashed, hvGenmap);
+	if (pEntry)
+		return pEntry;
+
+	int iEntryNew = (int)pBlock->m_aryEntry.C();
+	auto pEntryNew = pBlock->m_aryEntry.AppendNew();
 	pEntryNew->m_pGenmapKey = pGenmap;
+
+	if (fIsHashed)
+	{
+		int * piEntry;
+		if (pBlock->m_mpHvIEntry.FinsEnsureKey(hvGenmap, &piEntry) == FINS_AlreadyExisted)
+		{
+			pEntryNew->m_iEntryNextHv = *piEntry;
+		}
+		*piEntry = iEntryNew;
+	}
+	else
+	{
+		pBlock->m_aryIEntryUnhashed.Append(iEntryNew);
+	}
 	return pEntryNew;
 }
 
@@ -6975,49 +8020,220 @@ SInstantiateRequest * PInsreqInstantiateGenericProcedure(
 					// pStnodChild is a type argugment decl, the type stnode child will be referenced 
 					//  by the type's SSymbol::m_pStnodDefinition - it's symbol & type will be remapped properly
 
-					pGenmap->m_aryPStnodManaged.Append(pStnodChild);
-				}
-				else
-				{
-					pTcwork->m_pAlloc->EWC_DELETE(pStnodChild);
-				}
-				continue;
-			}
-			pStnodParamList->m_arypStnodChild[ipStnodDst] = pStnodChild;
-			++ipStnodDst;
+					pGenmap->m_aryPStnodManaged.Append(pStnodChild);
+				}
+				else
+				{
+					pTcwork->m_pAlloc->EWC_DELETE(pStnodChild);
+				}
+				continue;
+			}
+			pStnodParamList->m_arypStnodChild[ipStnodDst] = pStnodChild;
+			++ipStnodDst;
+		}
+
+		while (pStnodParamList->m_arypStnodChild.C() > ipStnodDst)
+		{
+			pStnodParamList->m_arypStnodChild.PopLast();
+		}
+	}
+
+	STypeCheckFrame * pTcfram = pTcwork->m_blistTcfram.AppendNew();
+	ScheduleTcfram(pTcwork, pTcfram);
+
+	SWorkspaceEntry * pEntry = pTcwork->m_pblistEntry->AppendNew();
+	pEntry->m_pStnod = pStnodProcCopy;
+	pEntry->m_pSymtab = pSymtabNew;
+	pTcfram->m_pEntry = pEntry;
+
+	pTcfram->m_aryTcsent.SetAlloc(pTcwork->m_pAlloc, EWC::BK_TypeCheckStack);
+	if (!pTinprocNew->FHasGenericArgs())
+	{
+		STypeCheckStackEntry * pTcsent = pTcfram->m_aryTcsent.AppendNew();
+		pTcsent->m_nState = 0;
+		pTcsent->m_pStnod = pStnodBodyCopy;
+		pTcsent->m_pSymtab = pSymtabNew;
+		pTcsent->m_pStnodProcedure = pStnodProcCopy;
+		pTcsent->m_pSymContext = pInsreq->m_pSym;
+		pTcsent->m_grfsymlook = FSYMLOOK_Default;
+		pTcsent->m_parkDeclContext = PARK_Nil;
+		pTcsent->m_fAllowForwardDecl = false;
+		pTcsent->m_tcctx = TCCTX_Normal;
+	}
+
+	return pInsreq;
+}
+
+// Overload cache: calls are keyed on (scope, name, argument types, literal argument values). Only plain positional
+//  arguments are cached, and only when every candidate is a non-generic procedure without implicit reference params,
+//  so that skipping the losing candidates can't skip any side effects of matching them.
+
+static bool FTryComputeOverloadKey(
+	CSymbolTable * pSymtab,
+	const CString & strProcName,
+	GRFSYMLOOK grfsymlook,
+	SProcMatchParam * pPmparam,
+	HV * pHv)
+{
+	HV hv = HvConcatN(HvFromPBFVN(nullptr, 0), (uintptr_t)pSymtab);
+	hv = HvConcatN(hv, strProcName.Hv());
+	hv = HvConcatN(hv, grfsymlook.m_raw);
+	hv = HvConcatN(hv, pPmparam->m_cpStnodCall);
+
+	for (size_t ipStnod = 0; ipStnod < pPmparam->m_cpStnodCall; ++ipStnod)
+	{
+		CSTNode * pStnodArg = pPmparam->m_ppStnodCall[ipStnod];
+		if (!pStnodArg || !pStnodArg->m_pTin ||
+			pStnodArg->m_park == PARK_ArgumentLabel || pStnodArg->m_park == PARK_TypeArgument)
+			return false;
+
+		if (pStnodArg->m_pTin->m_tink == TINK_Literal)
+		{
+			auto pTinlit = (STypeInfoLiteral *)pStnodArg->m_pTin;
+			if (!pStnodArg->m_pStval || pTinlit->m_litty.m_litk == LITK_Compound)
+				return false;
+
+			hv = HvConcatN(hv, pTinlit->m_fIsFinalized);
+			hv = HvConcatN(hv, (uintptr_t)pTinlit->m_pTinSource);
+			hv = HvConcatLiteralValue(hv, pStnodArg);
+		}
+		else
+		{
+			hv = HvConcatTypeStructure(hv, pStnodArg->m_pTin);
+		}
+	}
+
+	*pHv = hv;
+	return true;
+}
+
+static bool FOverloadArgTypesMatch(STypeInfo * pTinA, STypeInfo * pTinB)
+{
+	if (pTinA == pTinB)
+		return true;
+	if (pTinA->m_tink != pTinB->m_tink)
+		return false;
+
+	switch (pTinA->m_tink)
+	{
+	case TINK_Integer:
+	case TINK_Float:
+	case TINK_Qualifier:
+	case TINK_Pointer:
+	case TINK_Array:
+	case TINK_Struct:
+	case TINK_Procedure:
+	case TINK_Generic:
+		return FTypesAreSame(pTinA, pTinB);
+	default:
+		return false;
+	}
+}
+
+static bool FOverloadKeyMatches(
+	SOverloadCacheEntry * pOvcent,
+	CSymbolTable * pSymtab,
+	const CString & strProcName,
+	GRFSYMLOOK grfsymlook,
+	SProcMatchParam * pPmparam)
+{
+	if (pOvcent->m_pSymtab != pSymtab || pOvcent->m_grfsymlook != grfsymlook ||
+		pOvcent->m_aryOvarg.C() != pPmparam->m_cpStnodCall || pOvcent->m_strProcName != strProcName)
+		return false;
+
+	for (size_t ipStnod = 0; ipStnod < pPmparam->m_cpStnodCall; ++ipStnod)
+	{
+		CSTNode * pStnodArg = pPmparam->m_ppStnodCall[ipStnod];
+		SOverloadArg * pOvarg = &pOvcent->m_aryOvarg[ipStnod];
+
+		bool fIsLiteral = pStnodArg->m_pTin->m_tink == TINK_Literal;
+		if (fIsLiteral != pOvarg->m_fIsLiteral)
+			return false;
+
+		if (fIsLiteral)
+		{
+			// m_pTin is the argument type from before finalizing, scalar literal types are shared and never modified
+			auto pTinlit = (STypeInfoLiteral *)pStnodArg->m_pTin;
+			auto pTinlitCached = (STypeInfoLiteral *)pOvarg->m_pTin;
+			if (pTinlit->m_fIsFinalized != pTinlitCached->m_fIsFinalized || 
+				pTinlit->m_pTinSource != pTinlitCached->m_pTinSource ||
+				!FLiteralValuesAreSame(pTinlit, pStnodArg->m_pStval, pTinlitCached, &pOvarg->m_stval))
+				return false;
 		}
-
-		while (pStnodParamList->m_arypStnodChild.C() > ipStnodDst)
+		else if (!FOverloadArgTypesMatch(pStnodArg->m_pTin, pOvarg->m_pTin))
 		{
-			pStnodParamList->m_arypStnodChild.PopLast();
+			return false;
 		}
 	}
 
-	STypeCheckFrame * pTcfram = pTcwork->m_blistTcfram.AppendNew();
-	pTcfram->m_ipTcframQueue = pTcwork->m_arypTcframPending.C();
-	pTcwork->m_arypTcframPending.Append(pTcfram);
+	return true;
+}
 
-	SWorkspaceEntry * pEntry = pTcwork->m_pblistEntry->AppendNew();
-	pEntry->m_pStnod = pStnodProcCopy;
-	pEntry->m_pSymtab = pSymtabNew;
-	pTcfram->m_pEntry = pEntry;
+static bool FIsOverloadCacheable(STypeInfoProcedure * pTinproc)
+{
+	if (pTinproc->FHasGenericArgs())
+		return false;
 
-	pTcfram->m_aryTcsent.SetAlloc(pTcwork->m_pAlloc, EWC::BK_TypeCheckStack);
-	if (!pTinprocNew->FHasGenericArgs())
+	for (size_t iParmq = 0; iParmq < pTinproc->m_mpIptinGrfparmq.C(); ++iParmq)
 	{
-		STypeCheckStackEntry * pTcsent = pTcfram->m_aryTcsent.AppendNew();
-		pTcsent->m_nState = 0;
-		pTcsent->m_pStnod = pStnodBodyCopy;
-		pTcsent->m_pSymtab = pSymtabNew;
-		pTcsent->m_pStnodProcedure = pStnodProcCopy;
-		pTcsent->m_pSymContext = pInsreq->m_pSym;
-		pTcsent->m_grfsymlook = FSYMLOOK_Default;
-		pTcsent->m_parkDeclContext = PARK_Nil;
-		pTcsent->m_fAllowForwardDecl = false;
-		pTcsent->m_tcctx = TCCTX_Normal;
+		if (pTinproc->m_mpIptinGrfparmq[iParmq].FIsSet(FPARMQ_ImplicitRef))
+			return false;
 	}
+	return true;
+}
 
-	return pInsreq;
+static HV HvOverloadCandidates(CSymbolTable::CSymbolIterator symiter, int * pCCandidate)
+{
+	HV hv = HvFromPBFVN(nullptr, 0);
+	int cCandidate = 0;
+	while (SSymbol * pSym = symiter.PSymNext())
+	{
+		hv = HvConcatN(hv, (uintptr_t)pSym);
+		++cCandidate;
+	}
+
+	*pCCandidate = cCandidate;
+	return hv;
+}
+
+static void StoreOverloadCacheEntry(
+	STypeCheckWorkspace * pTcwork,
+	HV hvKey,
+	CSymbolTable * pSymtab,
+	const CString & strProcName,
+	GRFSYMLOOK grfsymlook,
+	SProcMatchParam * pPmparam,
+	HV hvCandidates,
+	int cCandidate,
+	SSymbol * pSymProc,
+	ARGORD argord)
+{
+	SOverloadCacheEntry ** ppOvcent;
+	if (pTcwork->m_hashHvPOvcent.FinsEnsureKey(hvKey, &ppOvcent) == FINS_Inserted)
+	{
+		*ppOvcent = EWC_NEW(pTcwork->m_pAlloc, SOverloadCacheEntry) SOverloadCacheEntry(pTcwork->m_pAlloc);
+	}
+
+	// on a hash collision the newer signature replaces the old one
+	SOverloadCacheEntry * pOvcent = *ppOvcent;
+	pOvcent->m_pSymtab = pSymtab;
+	pOvcent->m_strProcName = strProcName;
+	pOvcent->m_grfsymlook = grfsymlook;
+	pOvcent->m_hvCandidates = hvCandidates;
+	pOvcent->m_cCandidate = cCandidate;
+	pOvcent->m_pSymProc = pSymProc;
+	pOvcent->m_argord = argord;
+
+	pOvcent->m_aryOvarg.Clear();
+	for (size_t ipStnod = 0; ipStnod < pPmparam->m_cpStnodCall; ++ipStnod)
+	{
+		CSTNode * pStnodArg = pPmparam->m_ppStnodCall[ipStnod];
+
+		SOverloadArg * pOvarg = pOvcent->m_aryOvarg.AppendNew();
+		pOvarg->m_pTin = pStnodArg->m_pTin;
+		pOvarg->m_fIsLiteral = pStnodArg->m_pTin->m_tink == TINK_Literal;
+		pOvarg->m_stval = (pOvarg->m_fIsLiteral) ? *pStnodArg->m_pStval : CSTValue();
+	}
 }
 
 TCRET TcretTryFindMatchingProcedureCall(
@@ -7046,6 +8262,42 @@ TCRET TcretTryFindMatchingProcedureCall(
 		return TCRET_StoppingError;
 	}
 
+	HV hvKey = 0;
+	bool fIsCacheable = FTryComputeOverloadKey(pSymtab, strProcName, grfsymlook, pPmparam, &hvKey);
+	if (fIsCacheable)
+	{
+		SOverloadCacheEntry ** ppOvcent = pTcwork->m_hashHvPOvcent.Lookup(hvKey);
+		SOverloadCacheEntry * pOvcent = (ppOvcent) ? *ppOvcent : nullptr;
+		if (pOvcent && FOverloadKeyMatches(pOvcent, pSymtab, strProcName, grfsymlook, pPmparam))
+		{
+			int cCandidate;
+			HV hvCandidates = HvOverloadCandidates(symiter, &cCandidate);
+
+			// rerun the match against the cached winner to rebuild the argument fit
+			SSymbol * pSymProc = pOvcent->m_pSymProc;
+			if (hvCandidates == pOvcent->m_hvCandidates && cCandidate == pOvcent->m_cCandidate &&
+				ProcmatchCheckProcArguments(
+					pTcwork,
+					pSymtab,
+					(STypeInfoProcedure *)pSymProc->m_pTin,
+					pPmparam,
+					ERREP_HideErrors,
+					pOvcent->m_argord,
+					pSymProc) != PROCMATCH_None)
+			{
+				STypeCheckStackEntry * pTcsentTop = pTcfram->m_aryTcsent.PLast();
+				AddSymbolReference(pTcsentTop->m_pSymContext, pSymProc);
+
+				*ppSym = pSymProc;
+				*pArgord = pOvcent->m_argord;
+				return TCRET_Complete;
+			}
+		}
+	}
+
+	HV hvCandidates = HvFromPBFVN(nullptr, 0);
+	int cCandidate = 0;
+
 	// the first argument is index 1, (the procedure's identifier is element zero)
 
 	int cSymOptions = 0;
@@ -7065,6 +8317,9 @@ TCRET TcretTryFindMatchingProcedureCall(
 	SSymbol * pSymIt;
 	while ((pSymIt = symiter.PSymNext()))
 	{
+		hvCandidates = HvConcatN(hvCandidates, (uintptr_t)pSymIt);
+		++cCandidate;
+
 		CSTNode * pStnodDefinition = pSymIt->m_pStnodDefinition;
 		if (!pStnodDefinition)
 			continue;
@@ -7090,6 +8345,7 @@ TCRET TcretTryFindMatchingProcedureCall(
 		if (pSymIt->m_pTin->m_tink == TINK_Struct)
 		{
 			++cSymOptions;
+			fIsCacheable = false;
 
 			auto pTinstructSym = PTinRtiCast<STypeInfoStruct  *>(pSymIt->m_pTin);
 			if (!EWC_FVERIFY(pTinstructSym, "expected type info procedure"))
@@ -7124,6 +8380,8 @@ TCRET TcretTryFindMatchingProcedureCall(
 			if (!EWC_FVERIFY(pTinprocSym, "expected type info procedure"))
 				continue;
 
+			fIsCacheable &= FIsOverloadCacheable(pTinprocSym);
+
 			int argordMax = ARGORD_Normal+1;
 			if (pTinprocSym->m_grftinproc.FIsSet(FTINPROC_IsCommutative))
 			{
@@ -7258,6 +8516,12 @@ TCRET TcretTryFindMatchingProcedureCall(
 
 		*ppSym = pSymProc;
 		*pArgord = pSymmatch->m_argord;
+
+		if (fIsCacheable && pSymProc->m_pTin->m_tink == TINK_Procedure)
+		{
+			StoreOverloadCacheEntry(
+				pTcwork, hvKey, pSymtab, strProcName, grfsymlook, pPmparam, hvCandidates, cCandidate, pSymProc, pSymmatch->m_argord);
+		}
 	}
 	else // cSymmatch > 1 
 	{	
@@ -7345,8 +8609,7 @@ SOverloadCheck OvcheckTryCheckOverload(
 	if (pTinproc && tcret == TCRET_WaitingForSymbolDefinition)
 	{
 		// wait for this procedure's signature to be type checked.
-		SUnknownType * pUntype = PUntypeEnsure(pTcwork, pSymProc);
-		pUntype->m_arypTcframDependent.Append(pTcfram);
+		WaitForSymbol(pTcwork, pTcfram, pSymProc);
 
 		return SOverloadCheck(pTinproc, tcret, argord);
 	}
@@ -7612,9 +8875,24 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 							return TCRET_Complete;
 						}
 
+						if (pTcwork->m_fDemandDriven)
+						{
+							// the signature is all callers need, don't make them wait for the body
+							OnTypeResolve(pTcwork, pSymProc);
+						}
+					}break;
+				case 3:
+					{
 						// push the body subtree
 						if (pStproc->m_iStnodBody >= 0)
 						{
+							if (FShouldDeferBody(pTcwork, pTcfram, pStnod, pStproc))
+							{
+								pTcsentTop->m_nState = 3; // push the body when we're resumed
+								pTcwork->m_hashPSymPTcframDeferred.Insert(pStnod->PSym(), pTcfram);
+								return TCRET_Deferred;
+							}
+
 							CSTNode * pStnodBody = pStnod->PStnodChild(pStproc->m_iStnodBody);
 							auto pTcsentPushed = PTcsentPush(pTcfram, &pTcsentTop, pStnodBody);
 
@@ -7625,7 +8903,7 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 							}
 						}
 					}break;
-				case 3:
+				case 4:
 					{
 						pTinproc->m_strMangled = StrComputeMangled(pTcwork, pStnod, pTcsentTop->m_pSymtab);
 						PopTcsent(pTcfram, &pTcsentTop, pStnod);
@@ -7794,8 +9072,7 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 
 						if (pSymStruct->m_pStnodDefinition->m_strees < STREES_TypeChecked)
 						{
-							SUnknownType * pUntype = PUntypeEnsure(pTcwork, pSymStruct);
-							pUntype->m_arypTcframDependent.Append(pTcfram);
+							WaitForSymbol(pTcwork, pTcfram, pSymStruct);
 							return TCRET_WaitingForSymbolDefinition;
 						}
 
@@ -7810,8 +9087,7 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 						{
 							// wait for this procedure's signature to be type checked.
 							// BB - We'll redo the work to find our matching procedure once this definition is checked. 
-							SUnknownType * pUntype = PUntypeEnsure(pTcwork, pSymProc);
-							pUntype->m_arypTcframDependent.Append(pTcfram);
+							WaitForSymbol(pTcwork, pTcfram, pSymProc);
 							return tcret;
 						}
 					case TCRET_StoppingError:
@@ -7875,6 +9151,12 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 								}
 							}
 						} break;
+					case TCRET_Deferred:
+						{
+							// only procedure definitions defer their bodies, overload resolution waits on signatures
+							EWC_ASSERT(false, "unexpected deferred result from overload resolution");
+							return TCRET_StoppingError;
+						}
 					}
 				}
 				else // callee is not an identifier - proc indirect call 
@@ -8391,6 +9673,17 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 					pTypememb->m_pTin = pTypememb->m_pStnod->m_pTin;
 				}
 
+				if (pTinstruct->FIsSimd() && !pTinstruct->FHasGenericParams())
+				{
+					if (!FCheckSimdStruct(pTcwork, pStnod, pTinstruct))
+						return TCRET_StoppingError;
+				}
+
+				if (pTinstruct->FIsReorder() && !pTinstruct->FHasGenericParams())
+				{
+					ReorderStructMembers(pTinstruct);
+				}
+
 				SSymbol * pSymStruct = pStnod->PSym();
 				if (!EWC_FVERIFY(pSymStruct, "struct symbol should be created during parse"))
 					return TCRET_StoppingError;
@@ -8485,8 +9778,7 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 							{
 								// set up dependency for either the definition or the type...
 								
-								SUnknownType * pUntype = PUntypeEnsure(pTcwork, pSymLast);
-								pUntype->m_arypTcframDependent.Append(pTcfram);
+								WaitForSymbol(pTcwork, pTcfram, pSymLast);
 								return TCRET_WaitingForSymbolDefinition;
 							}
 						}
@@ -8540,8 +9832,7 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 					auto pSymInst = pStnod->PSym();
 					if (pSymInst->m_pStnodDefinition->m_strees < STREES_TypeChecked)
 					{
-						SUnknownType * pUntype = PUntypeEnsure(pTcwork, pSymInst);
-						pUntype->m_arypTcframDependent.Append(pTcfram);
+						WaitForSymbol(pTcwork, pTcfram, pSymInst);
 						return TCRET_WaitingForSymbolDefinition;
 					}
 				}
@@ -8694,6 +9985,14 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 					return TCRET_StoppingError;
 				}
 
+				if (FIsRunDirective(pStnodInit))
+				{
+					// #run executes after type checking, too late to be folded into other constants
+					EmitError(pTcwork, pStnod, ERRID_BadRunDirective, 
+						"Cannot initialize constant '%s' with #run, use a global variable instead.", strIdent.PCoz());
+					return TCRET_StoppingError;
+				}
+
 				auto pSymtab = pTcsentTop->m_pSymtab;
 				auto pStnodType = pStnod->PStnodChildSafe(pStdecl->m_iStnodType);
 				if (pStnodType)
@@ -8902,6 +10201,8 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 					{
 						FinalizeLiteralType(pTcwork, pSymtab, pStnod->m_pTin, pStnodInit);
 						pTinInit = pStnod->m_pTin;
+
+						(void) FTryFoldConstantCast(pTcwork, pSymtab, pStnod, pStnodInit);
 					}
 					else
 					{
@@ -9160,6 +10461,37 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 
 							bool fAllowFinalizing = pTcsentTop->m_parkDeclContext != PARK_ParameterList;
 
+							auto pTinaryDecl = PTinRtiCast<STypeInfoArray *>(PTinStripQualifiers(pStnod->m_pTin));
+							if (pTinaryDecl && pTinaryDecl->m_fIsSoa && pStnodInit->m_pTin && pStnodInit->m_pTin->m_tink == TINK_Literal)
+							{
+								CString strIdent = StrFromIdentifier(pStnodIdent);
+								EmitError(pTcwork, pStnod, ERRID_BadSoaArray, 
+									"SOA array '%s' cannot be initialized with an array literal", 
+									strIdent.PCoz());
+							}
+
+							if (pTinaryDecl && pTinaryDecl->m_aryk == ARYK_Dynamic && 
+								pStnodInit->m_pTin && pStnodInit->m_pTin->m_tink == TINK_Literal)
+							{
+								CString strIdent = StrFromIdentifier(pStnodIdent);
+								EmitError(pTcwork, pStnod, ERRID_InitTypeMismatch, 
+									"Dynamic array '%s' cannot be initialized with an array literal", 
+									strIdent.PCoz());
+							}
+
+							if (pStnod->m_pTin && FIsRunDirective(pStnodInit) && 
+								!FTypesAreSame(PTinStripQualifiers(pStnodInit->m_pTin), PTinStripQualifiers(pStnod->m_pTin)))
+							{
+								// baked #run results are emitted as-is, no implicit conversion is applied
+								CString strIdent = StrFromIdentifier(pStnodIdent);
+								EmitError(pTcwork, pStnod, ERRID_BadRunDirective, 
+									"#run result type '%s' does not match type '%s' of '%s'", 
+									StrFromTypeInfo(pStnodInit->m_pTin).PCoz(),
+									StrFromTypeInfo(pStnod->m_pTin).PCoz(),
+									strIdent.PCoz());
+								return TCRET_StoppingError;
+							}
+
 							if (pStnod->m_pTin && pStnodInit->m_park != PARK_Uninitializer)
 							{
 								// just make sure the init type fits the specified one
@@ -9572,8 +10904,7 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 								if (pStnodStruct->m_strees != STREES_TypeChecked)
 								{
 									// wait for this type to be resolved.
-									SUnknownType * pUntype = PUntypeEnsure(pTcwork, pSymStruct);
-									pUntype->m_arypTcframDependent.Append(pTcfram);
+									WaitForSymbol(pTcwork, pTcfram, pSymStruct);
 									return TCRET_WaitingForSymbolDefinition;
 								}
 							}
@@ -9662,8 +10993,23 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 
 									//auto pTinptr = pSymtab->PTinptrAllocate(pTinary->m_pTin);
 									//pTinMember = pSymtab->PTinqualEnsure(pTinptr, FQUALK_Const);
+									if (pTinary->m_fIsSoa)
+									{
+										EmitError(pTcwork, pStnod, ERRID_BadSoaArray, 
+											"SOA arrays do not store their elements contiguously, '%s' has no data member",
+											StrFromTypeInfo(pTinary).PCoz());
+									}
 									pTinMember = pSymtab->PTinptrAllocate(pTinary->m_pTin);
 								} break;
+							case ARYMEMB_Capacity:
+								{
+									if (pTinary->m_aryk != ARYK_Dynamic)
+									{
+										EmitError(pTcwork, pStnod, "only dynamic arrays have a '%s' member", strMemberName.PCoz());
+										return TCRET_StoppingError;
+									}
+									pTinMember = pSymtab->PTinBuiltin(CSymbolTable::s_strS64);
+								} break;
 							default: 
 								EmitError(pTcwork, pStnod, "unknown array member '%s'", strMemberName.PCoz());
 								return TCRET_StoppingError;
@@ -9811,8 +11157,8 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 
 							if (rword == RWORD_Typeinfo)
 							{
-								// Make sure the type table is already resoved, this ensures that it will codegen before
-								//  this typeInfo statement is generated
+								// Make sure the type table is already resolved, reflection data is emitted lazily at the
+								//  end of codegen but it's needed to lay out the table for the types typeinfo references.
 								auto pSymTinTable = pSymtab->PSymLookup(STypeInfo::s_pChzGlobalTinTable, SLexerLocation());
 								if (!pSymTinTable )
 								{
@@ -9833,6 +11179,66 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 								pStnod->m_pTin = pSymtab->PTinBuiltin(CSymbolTable::s_strUsize);
 							}
 
+							pStnod->m_strees = STREES_TypeChecked;
+							PopTcsent(pTcfram, &pTcsentTop, pStnod);
+						} break;
+					case RWORD_SimdShuffle:
+					case RWORD_SimdSelect:
+					case RWORD_SimdReduceAdd:
+					case RWORD_SimdReduceMin:
+					case RWORD_SimdReduceMax:
+						{
+							if (pTcsentTop->m_nState < pStnod->CStnodChild())
+							{
+								(void) PTcsentPush(pTcfram, &pTcsentTop, pStnod->PStnodChild(pTcsentTop->m_nState++));
+								break;
+							}
+
+							if (!FCheckSimdIntrinsic(pTcwork, pTcsentTop->m_pSymtab, pStnod, rword))
+								return TCRET_StoppingError;
+
+							pStnod->m_strees = STREES_TypeChecked;
+							PopTcsent(pTcfram, &pTcsentTop, pStnod);
+						} break;
+					case RWORD_RunDirective:
+						{
+							if (pTcsentTop->m_nState < pStnod->CStnodChild())
+							{
+								(void) PTcsentPush(pTcfram, &pTcsentTop, pStnod->PStnodChild(pTcsentTop->m_nState++));
+								break;
+							}
+
+							// the call is executed after type checking finishes, see EvaluateRunDirectives()
+							if (!FCheckRunDirective(pTcwork, pStnod))
+								return TCRET_StoppingError;
+
+							pStnod->m_strees = STREES_TypeChecked;
+							PopTcsent(pTcfram, &pTcsentTop, pStnod);
+						} break;
+					case RWORD_New:
+						{
+							// (new type allocCall), the allocator call was built by the parser
+							if (pTcsentTop->m_nState < pStnod->CStnodChild())
+							{
+								(void) PTcsentPush(pTcfram, &pTcsentTop, pStnod->PStnodChild(pTcsentTop->m_nState++));
+								break;
+							}
+
+							auto pStnodType = pStnod->PStnodChild(0);
+							if (!pStnodType->m_pTin || !FIsType(pStnodType))
+							{
+								EmitError(pTcwork, pStnod, ERRID_BadNewType, "new expects a type, not '%s'", StrFromTypeInfo(pStnodType->m_pTin).PCoz());
+								return TCRET_StoppingError;
+							}
+
+							auto pTinNew = pStnodType->m_pTin;
+							if (pTinNew->m_tink == TINK_Void || pTinNew->m_tink == TINK_Generic)
+							{
+								EmitError(pTcwork, pStnod, ERRID_BadNewType, "cannot allocate an instance of '%s' with new", StrFromTypeInfo(pTinNew).PCoz());
+								return TCRET_StoppingError;
+							}
+
+							pStnod->m_pTin = pTcsentTop->m_pSymtab->PTinptrAllocate(pTinNew);
 							pStnod->m_strees = STREES_TypeChecked;
 							PopTcsent(pTcfram, &pTcsentTop, pStnod);
 						} break;
@@ -9962,6 +11368,8 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 								}
 							}
 
+							RecognizeCountedForEach(pStnod, pStfor);
+
 							pStnod->m_strees = STREES_TypeChecked;
 							PopTcsent(pTcfram, &pTcsentTop, pStnod);
 						} break;
@@ -10633,7 +12041,16 @@ TcretDebug TcretTypeCheckSubtree(STypeCheckWorkspace * pTcwork, STypeCheckFrame
 																fIsFloat;
 										bool fIsValidBasicEnumOp = ((tok == TOK_PlusPlus) | (tok == TOK_MinusMinus)) & fIsBasicEnum;
 										bool fIsValidFlagEnumOp = (tok == TOK('~')) & fIsFlagEnum;
-										bool fIsSupported = fIsInteger | fIsValidPtrOp | fIsValidFloatOp | fIsValidBasicEnumOp | fIsValidFlagEnumOp;
+
+										bool fIsValidSimdOp = false;
+										if (FIsSimdStruct(pTinOperand))
+										{
+											auto pTinLane = PTinStripQualifiers(((STypeInfoStruct *)pTinOperand)->PTinLane());
+											auto pTinintLane = PTinRtiCast<STypeInfoInteger *>(pTinLane);
+											fIsValidSimdOp = ((tok == TOK('-')) & ((pTinLane->m_tink == TINK_Float) | (pTinintLane && pTinintLane->m_fIsSigned))) |
+															 ((tok == TOK('~')) & (pTinintLane != nullptr));
+										}
+										bool fIsSupported = fIsInteger | fIsValidPtrOp | fIsValidFloatOp | fIsValidBasicEnumOp | fIsValidFlagEnumOp | fIsValidSimdOp;
 
 										// BB - we should be checking for negating a signed literal here, but we can't really
 										//  do operations on literals until we know the resolved type
@@ -10733,6 +12150,12 @@ void OnTypeResolve(STypeCheckWorkspace * pTcwork, const SSymbol * pSym)
 
 		if (EWC_FVERIFY(pTcwork->m_arypTcframWaiting[pTcfram->m_ipTcframQueue] == pTcfram, "bookkeeping error (OnTypeResolve)"))
 		{
+			EWC_ASSERT(pTcfram->m_pSymWait == pSym, "frame woken by the wrong symbol");
+			pTcfram->m_pSymWait = nullptr;
+			if (pTcwork->m_fCollectStats)
+			{
+				pTcfram->m_cNsWaiting += NsTimestamp() - pTcfram->m_nsWaitBegin;
+			}
 			RelocateTcfram(pTcfram, &pTcwork->m_arypTcframWaiting, &pTcwork->m_arypTcframPending);
 		}
 	}
@@ -10889,6 +12312,130 @@ void ComputeSymbolDependencies(CAlloc * pAlloc, SErrorManager * pErrman, CSymbol
 	}
 }
 
+static void PrintEntryLocation(CWorkspace * pWork, SWorkspaceEntry * pEntry)
+{
+	CSTNode * pStnod = (pEntry) ? pEntry->m_pStnod : nullptr;
+	if (!pStnod)
+	{
+		printf("<unknown entry>");
+		return;
+	}
+
+	s32 iLine;
+	s32 iCol;
+	CalculateLinePosition(pWork, &pStnod->m_lexloc, &iLine, &iCol);
+
+	SSymbol * pSym = pStnod->PSym();
+	printf("%s %s %s(%d,%d)", 
+		PChzFromPark(pStnod->m_park),
+		(pSym) ? pSym->m_strName.PCoz() : "",
+		pStnod->m_lexloc.m_strFilename.PCoz(),
+		iLine,
+		iCol);
+}
+
+template <typename FCMP>
+static void PrintTcframTable(CWorkspace * pWork, CDynAry<STypeCheckFrame *> * parypTcfram, const char * pChzTitle, FCMP fcmp)
+{
+	static const size_t s_cTcframReportMax = 32;
+
+	std::sort(parypTcfram->A(), parypTcfram->PMac(), fcmp);
+
+	printf("%s:\n", pChzTitle);
+	printf("     run(ms)  waiting(ms)  waits  entry\n");
+	size_t cTcfram = ewcMin(parypTcfram->C(), s_cTcframReportMax);
+	for (size_t ipTcfram = 0; ipTcfram < cTcfram; ++ipTcfram)
+	{
+		auto pTcfram = (*parypTcfram)[ipTcfram];
+		printf("  %10.3f  %11.3f  %5d  ", pTcfram->m_cNsRun / 1.0e6, pTcfram->m_cNsWaiting / 1.0e6, pTcfram->m_cWait);
+		PrintEntryLocation(pWork, pTcfram->m_pEntry);
+		printf("\n");
+	}
+	printf("\n");
+}
+
+static void PrintTypeCheckStats(STypeCheckWorkspace * pTcwork)
+{
+	// Frames that are still waiting haven't had their final wait added, they are reported by the wait graph.
+
+	CWorkspace * pWork = pTcwork->m_pErrman->m_pWork;
+	CDynAry<STypeCheckFrame *> arypTcfram(pTcwork->m_pAlloc, BK_TypeCheck, pTcwork->m_blistTcfram.C());
+
+	s64 cNsRun = 0;
+	s64 cNsWaiting = 0;
+	s64 cWait = 0;
+	CBlockList<STypeCheckFrame, 128>::CIterator iter(&pTcwork->m_blistTcfram);
+	while (STypeCheckFrame * pTcfram = iter.Next())
+	{
+		cNsRun += pTcfram->m_cNsRun;
+		cNsWaiting += pTcfram->m_cNsWaiting;
+		cWait += pTcfram->m_cWait;
+		arypTcfram.Append(pTcfram);
+	}
+
+	printf("Type Check Stats: %zd frames, %lld waits, %.3f ms checking, %.3f ms spent waiting\n\n",
+		arypTcfram.C(), cWait, cNsRun / 1.0e6, cNsWaiting / 1.0e6);
+
+	PrintTcframTable(pWork, &arypTcfram, "Slowest entries", [](STypeCheckFrame * pTcframA, STypeCheckFrame * pTcframB)
+		{ return pTcframA->m_cNsRun > pTcframB->m_cNsRun; });
+
+	PrintTcframTable(pWork, &arypTcfram, "Most waits", [](STypeCheckFrame * pTcframA, STypeCheckFrame * pTcframB)
+		{ return pTcframA->m_cWait > pTcframB->m_cWait; });
+}
+
+static void PrintTypeCheckWaitGraph(STypeCheckWorkspace * pTcwork)
+{
+	// The scheduler stalled: every remaining frame is blocked on a symbol that will never resolve. Print each 
+	//  blocked frame with the symbol it wants and the entry (if any) that defines that symbol, which is also 
+	//  stuck when the wait is part of a cycle.
+
+	CWorkspace * pWork = pTcwork->m_pErrman->m_pWork;
+	printf("Type Check stalled, %zd frames waiting:\n", pTcwork->m_arypTcframWaiting.C());
+
+	auto ppTcframMac = pTcwork->m_arypTcframWaiting.PMac();
+	for (auto ppTcfram = pTcwork->m_arypTcframWaiting.A(); ppTcfram != ppTcframMac; ++ppTcfram)
+	{
+		auto pTcfram = *ppTcfram;
+		printf("  ");
+		PrintEntryLocation(pWork, pTcfram->m_pEntry);
+
+		const SSymbol * pSymWait = pTcfram->m_pSymWait;
+		if (!pSymWait)
+		{
+			printf("\n    -> <unrecorded symbol>\n");
+			continue;
+		}
+
+		printf("\n    -> '%s'", pSymWait->m_strName.PCoz());
+
+		STypeCheckFrame * pTcframDefinition = nullptr;
+		for (auto ppTcframDef = pTcwork->m_arypTcframWaiting.A(); ppTcframDef != ppTcframMac; ++ppTcframDef)
+		{
+			if ((*ppTcframDef)->m_pEntry && (*ppTcframDef)->m_pEntry->m_pStnod == pSymWait->m_pStnodDefinition)
+			{
+				pTcframDefinition = *ppTcframDef;
+				break;
+			}
+		}
+
+		if (pTcframDefinition)
+		{
+			printf(" defined by waiting entry ");
+			PrintEntryLocation(pWork, pTcframDefinition->m_pEntry);
+		}
+		else if (pSymWait->m_pStnodDefinition)
+		{
+			s32 iLine;
+			s32 iCol;
+			auto pLexloc = &pSymWait->m_pStnodDefinition->m_lexloc;
+			CalculateLinePosition(pWork, pLexloc, &iLine, &iCol);
+			printf(" defined at %s(%d,%d)", pLexloc->m_strFilename.PCoz(), iLine, iCol);
+		}
+		printf("\n");
+	}
+	printf("\n");
+}
+
 void PerformTypeCheck(
 	CAlloc * pAlloc,
 	SErrorManager * pErrman,
@@ -10898,6 +12445,7 @@ void PerformTypeCheck(
 	GRFUNT grfunt)
 {
 	auto pTcwork = EWC_NEW(pAlloc, STypeCheckWorkspace) STypeCheckWorkspace(pAlloc, pErrman, pblistEntry);
+	pTcwork->m_fCollectStats = pErrman->m_pWork && pErrman->m_pWork->m_fReportTypeCheckStats;
 
 	SSymbol * pSymRoot = nullptr;
 	// if we're in a unit test we spoof a top level implicit function symbol
@@ -10906,14 +12454,31 @@ void PerformTypeCheck(
 		pSymRoot = pSymtabTop->PSymEnsure(pErrman, "__ImplicitMethod", nullptr);
 	}
 
-	int ipTcfram = 0;
+	// When we're not resolving every symbol, procedure bodies are only checked once they are reachable from main,
+	//  a public linkage procedure or a global scope reference (which is collected by a spoofed global symbol).
+	pTcwork->m_fDemandDriven = !grfunt.FIsSet(FUNT_ResolveAllSymbols);
+	if (pTcwork->m_fDemandDriven)
+	{
+		if (!pSymRoot)
+		{
+			pSymRoot = pSymtabTop->PSymEnsure(pErrman, "__GlobalScope", nullptr);
+		}
+		pTcwork->m_arypSymRoot.Append(pSymRoot);
+
+		SLexerLocation lexloc;
+		for (auto pSymMain = pSymtabTop->PSymLookup("main", lexloc); pSymMain; pSymMain = pSymMain->m_pSymPrev)
+		{
+			pTcwork->m_arypSymRoot.Append(pSymMain);
+		}
+	}
+
 	BlockListEntry::CIterator iterEntry(pblistEntry);
 	while (SWorkspaceEntry * pEntry = iterEntry.Next())
 	{
 		EWC_ASSERT(pEntry->m_pSymtab, "entry point without symbol table");
 		STypeCheckFrame * pTcfram = pTcwork->m_blistTcfram.AppendNew();
-		pTcfram->m_ipTcframQueue = ipTcfram;
 		pTcfram->m_pEntry = pEntry;
+		pTcfram->m_fMayDeferBody = pTcwork->m_fDemandDriven && pEntry->m_pStnod->m_park == PARK_ProcedureDefinition;
 
 		pTcfram->m_aryTcsent.SetAlloc(pAlloc, EWC::BK_TypeCheckStack);
 		STypeCheckStackEntry * pTcsent = pTcfram->m_aryTcsent.AppendNew();
@@ -10927,15 +12492,21 @@ void PerformTypeCheck(
 		pTcsent->m_fAllowForwardDecl = false;
 		pTcsent->m_tcctx = TCCTX_Normal;
 
-		pTcwork->m_arypTcframPending.Append(pTcfram);
-		++ipTcfram;
+		ScheduleTcfram(pTcwork, pTcfram);
 	}
 
 	int cStoppingError = 0;
-	while (pTcwork->m_arypTcframPending.C())
+	while (pTcwork->m_arypTcframPending.C() || FScheduleDemandedProcedures(pTcwork))
 	{
 		STypeCheckFrame * pTcfram = pTcwork->m_arypTcframPending[0];
+
+		s64 nsRunBegin = (pTcwork->m_fCollectStats) ? NsTimestamp() : 0;
 		TCRET tcret = TcretTypeCheckSubtree(pTcwork, pTcfram);
+		if (pTcwork->m_fCollectStats)
+		{
+			pTcfram->m_nsWaitBegin = NsTimestamp();
+			pTcfram->m_cNsRun += pTcfram->m_nsWaitBegin - nsRunBegin;
+		}
 
 		if (tcret == TCRET_StoppingError)
 		{
@@ -10983,15 +12554,32 @@ void PerformTypeCheck(
 		}
 		else if (tcret == TCRET_WaitingForSymbolDefinition)
 		{
+			++pTcfram->m_cWait;
 			RelocateTcfram(pTcfram, &pTcwork->m_arypTcframPending, &pTcwork->m_arypTcframWaiting);
 		}
+		else if (tcret == TCRET_Deferred)
+		{
+			// parked in m_hashPSymPTcframDeferred until FScheduleDemandedProcedures finds it reachable
+			RelocateTcfram(pTcfram, &pTcwork->m_arypTcframPending, nullptr);
+		}
 		else
 		{
 			EWC_ASSERT(false, "Unhandled type check return value.")	
 		}
 
+#if VALIDATE_TCFRAM_QUEUES
 		ValidateTcframArray(&pTcwork->m_arypTcframPending);
 		ValidateTcframArray(&pTcwork->m_arypTcframWaiting);
+#endif
+	}
+
+	if (pTcwork->m_fCollectStats)
+	{
+		PrintTypeCheckStats(pTcwork);
+		if (pTcwork->m_arypTcframWaiting.C())
+		{
+			PrintTypeCheckWaitGraph(pTcwork);
+		}
 	}
 
 	CHash<const SSymbol *, SUnknownType>::CIterator iter(&pTcwork->m_hashPSymUntype);
@@ -11025,6 +12613,22 @@ void PerformTypeCheck(
 		}
 	}
 
+	// bodies nothing reached are never checked, make sure we don't try to generate code for them
+	{
+		CHash<const SSymbol *, STypeCheckFrame *>::CIterator iterDeferred(&pTcwork->m_hashPSymPTcframDeferred);
+		while (STypeCheckFrame ** ppTcfram = iterDeferred.Next())
+		{
+			auto pTcfram = *ppTcfram;
+			pTcfram->m_pEntry->m_pStnod->m_grfstnod.AddFlags(FSTNOD_NoCodeGeneration);
+
+			while (pTcfram->m_aryTcsent.C())
+			{
+				STypeCheckStackEntry * pTcsentTop = pTcfram->m_aryTcsent.PLast();
+				PopTcsent(pTcfram, &pTcsentTop, nullptr);
+			}
+		}
+	}
+
 	//PerformFlushResolvedLiteralsPass(pTcwork, paryEntry);
 
 	//check for top level collisions
@@ -11083,6 +12687,10 @@ void PerformTypeCheck(
 	}
 	else
 	{
+		if (pSymRoot)
+		{
+			MarkSymbolsUsed(pSymRoot, pAlloc);
+		}
 		ComputeSymbolDependencies(pAlloc, pErrman, pSymtabTop);
 	}
 
@@ -214,6 +214,10 @@ enum QUALK : s8
 	QUALK_InArg,		// procedure arguments, variable can't be changed, but not transitive
 						// - non arguments can currently be declared as inarg for testing, but I'm not sure I'll keep that.
 
+	QUALK_Restrict,		// pointer is the only way its target is reached while it is live, not transitive
+						// - procedure arguments are emitted as noalias nocapture, the pointer must not outlive the call
+						// - unchecked, like c's restrict
+
 	EWC_MAX_MIN_NIL(QUALK)
 };
 
@@ -223,9 +227,10 @@ enum FQUALK
 {
 	FQUALK_Const	= 0x1 << QUALK_Const,
 	FQUALK_InArg	= 0x1 << QUALK_InArg,
+	FQUALK_Restrict	= 0x1 << QUALK_Restrict,
 
 	FQUALK_None		= 0x0,
-	FQUALK_All		= FQUALK_Const | FQUALK_InArg
+	FQUALK_All		= FQUALK_Const | FQUALK_InArg | FQUALK_Restrict
 };
 
 
@@ -266,6 +271,38 @@ enum INLINEK
 };
 const char * PChzFromInlinek(INLINEK inlinek);
 
+enum BOUNDSCHECK // per procedure override of the workspace bounds check setting
+{
+	BOUNDSCHECK_Enabled	 = 0,	// #bounds_check
+	BOUNDSCHECK_Disabled = 1,	// #no_bounds_check
+
+	EWC_MAX_MIN_NIL(BOUNDSCHECK)
+};
+
+enum ISALEVEL // instruction set levels a procedure can be multi-versioned for
+{
+	ISALEVEL_Baseline,
+	ISALEVEL_Sse42,
+	ISALEVEL_Avx2,
+	ISALEVEL_Avx512,
+
+	EWC_MAX_MIN_NIL(ISALEVEL)
+};
+const char * PChzFromIsalevel(ISALEVEL isalevel);
+ISALEVEL IsalevelFromPCoz(const char * pCoz);
+
+enum FISALEVEL
+{
+	FISALEVEL_Baseline	= 0x1 << ISALEVEL_Baseline,
+	FISALEVEL_Sse42		= 0x1 << ISALEVEL_Sse42,
+	FISALEVEL_Avx2		= 0x1 << ISALEVEL_Avx2,
+	FISALEVEL_Avx512	= 0x1 << ISALEVEL_Avx512,
+
+	FISALEVEL_None		= 0x0,
+	FISALEVEL_All		= 0xF,
+};
+EWC_DEFINE_GRF(GRFISALEVEL, FISALEVEL, u8);
+
 enum FPARMQ	// Flags for ARGument Qualifiers
 {
 	FPARMQ_ImplicitRef		= 0x1,		// convert LValue argument and pass into procedure's pointer argument
@@ -321,6 +358,8 @@ struct STypeInfoProcedure : public STypeInfo	// tag = 	tinproc
 						,m_grftinproc(FTINPROC_None)
 						,m_inlinek(INLINEK_Nil)
 						,m_callconv(CALLCONV_Nil)
+						,m_boundscheck(BOUNDSCHECK_Nil)
+						,m_grfisaClones(FISALEVEL_None)
 							{ ; }
 
 	bool				FHasVarArgs() const
@@ -340,6 +379,8 @@ struct STypeInfoProcedure : public STypeInfo	// tag = 	tinproc
 	GRFTINPROC					m_grftinproc;
 	INLINEK						m_inlinek;
 	CALLCONV					m_callconv;
+	BOUNDSCHECK					m_boundscheck;		// nil uses the workspace setting
+	GRFISALEVEL					m_grfisaClones;		// #target_clones, extra instruction set levels to compile and dispatch to
 
 	// BB - need names for named argument matching?
 };
@@ -396,14 +437,29 @@ struct STypeStructMember	// tag = typememb
 					,m_pTin(nullptr)
 					,m_pStnod(nullptr)
 					,m_dBOffset(-1)
+					,m_iTypemembDecl(-1)
 						{ ;}
 
 	EWC::CString	m_strName;
 	STypeInfo *		m_pTin;
 	CSTNode *		m_pStnod;		// syntax tree node for this member
 	s32				m_dBOffset;		// for bytecode GEP
+	s32				m_iTypemembDecl;	// declaration order index, differs from the field index in #reorder structs
+};
+
+enum FSTRUCT
+{
+	FSTRUCT_Simd		= 0x1,		// fields are lanes of a vector, arithmetic operators are lane-wise
+	FSTRUCT_Reorder		= 0x2,		// fields may be reordered to minimize padding
+
+	FSTRUCT_None		= 0x0,
+	FSTRUCT_All			= 0x3,
 };
 
+EWC_DEFINE_GRF(GRFSTRUCT, FSTRUCT, u8);
+
+static const int s_cLaneSimdMax = 16;	// lane masks and bytecode shuffle indices are packed into a single word
+
 struct STypeInfoStruct : public STypeInfo	// tag = tinstruct
 {
 	static const TINK s_tink = TINK_Struct;
@@ -416,6 +472,7 @@ struct STypeInfoStruct : public STypeInfo	// tag = tinstruct
 										,m_aryTypemembField()
 										,m_pTinprocInit(nullptr)
 										,m_grftingen(FTINGEN_None)
+										,m_grfstruct(FSTRUCT_None)
 										,m_cB(-1)
 										,m_cBAlign(-1)
 											{ ; }
@@ -426,6 +483,15 @@ struct STypeInfoStruct : public STypeInfo	// tag = tinstruct
 	STypeInfoStruct *					PTinstructInstFrom()
 											{ return m_pTinstructInstFrom; }
 
+	bool								FIsSimd() const
+											{ return m_grfstruct.FIsSet(FSTRUCT_Simd); }
+	bool								FIsReorder() const
+											{ return m_grfstruct.FIsSet(FSTRUCT_Reorder); }
+	int									CLane() const
+											{ return (int)m_aryTypemembField.C(); }
+	STypeInfo *							PTinLane() const
+											{ return m_aryTypemembField[0].m_pTin; }
+
 	CSTNode *							m_pStnodStruct;			// node that defined this struct (or struct instantiation)
 
 	SGenericMap *						m_pGenmap;				// generic mapping this was instantiated with	
@@ -436,11 +502,18 @@ struct STypeInfoStruct : public STypeInfo	// tag = tinstruct
 	STypeInfoProcedure *				m_pTinprocInit;			// procedure used when cginitk == CGINITK_InitializerProc
 
 	GRFTINGEN							m_grftingen;
+	GRFSTRUCT							m_grfstruct;
 	s64									m_cB;
 	s64									m_cBAlign;
 };
 
 int ITypemembLookup(STypeInfoStruct * pTinstruct, const EWC::CString & strMemberName);
+int ITypemembFromDeclIndex(STypeInfoStruct * pTinstruct, int iTypemembDecl);
+
+inline bool FIsSimdStruct(STypeInfo * pTin)
+{
+	return pTin && pTin->m_tink == TINK_Struct && ((STypeInfoStruct *)pTin)->FIsSimd();
+}
 
 struct STypeInfoEnumConstant // tag = tinecon
 {
@@ -493,6 +566,7 @@ enum ARYMEMB
 {
 	ARYMEMB_Count,
 	ARYMEMB_Data,
+	ARYMEMB_Capacity,	// dynamic arrays only, laid out after the reference array members
 
 	EWC_MAX_MIN_NIL(ARYMEMB)
 };
@@ -508,18 +582,26 @@ struct STypeInfoArray : public STypeInfo	// tag = tinary
 					:STypeInfo("", SCOPID_Nil, s_tink)
 					,m_pTin(nullptr)
 					,m_pTinstructImplicit(nullptr)
+					,m_pTinstructSoa(nullptr)
 					,m_c(0)
 					,m_aryk(ARYK_Fixed)
 					,m_pStnodBakedDim(nullptr)
+					,m_fIsSoa(false)
 					{ ; }
 
 	STypeInfo *			m_pTin;
 	STypeInfoStruct *	m_pTinstructImplicit;
+	STypeInfoStruct *	m_pTinstructSoa;	// per-member storage layout, built lazily during codegen
 	s64					m_c;
 	CSTNode *			m_pStnodBakedDim; // workaround for arrays with unspecialized baked constant
 	ARYK				m_aryk;
+	bool				m_fIsSoa;			// each struct member is stored in its own contiguous array
 };
 
+// number of members in a (non-fixed) array's storage struct: { count, data } or { count, data, capacity }
+inline int CArymembFromAryk(ARYK aryk)
+	{ return (aryk == ARYK_Dynamic) ? ARYMEMB_Max : ARYMEMB_Capacity; }
+
 void DeleteTypeInfo(EWC::CAlloc * pAlloc, STypeInfo * pTin);
 bool FTypesAreSame(STypeInfo * pTinLhs, STypeInfo * pTinRhs);
 
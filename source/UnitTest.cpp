@@ -36,6 +36,7 @@ extern bool FTestLexing();
 extern bool FTestSigned65();
 extern bool FTestUnicode();
 extern bool FTestUniqueNames(CAlloc * pAlloc);
+extern bool FTestTargetClones(CAlloc * pAlloc);
 
 
 static const int s_cErridOptionMax = 4; //max error ids per option
@@ -928,6 +929,16 @@ TESTRES TestresRunUnitTest(
 		}
 	}
 
+	if (testres == TESTRES_Success && !work.m_pErrman->FHasHiddenErrors())
+	{
+		EvaluateRunDirectives(&work);
+		if (work.m_pErrman->FHasErrors())
+		{
+			printf("Unexpected error evaluating #run directives for test %s\n", pUtest->m_strName.PCoz());
+			testres = TESTRES_CodeGenFailure;
+		}
+	}
+
 	if (testres == TESTRES_Success && !work.m_pErrman->FHasHiddenErrors())
 	{
 
@@ -1034,6 +1045,7 @@ void TestPermutation(STestContext * pTesctx, SPermutation * pPerm, SUnitTest * p
 	static const char * s_pChzTestFlags = "testflags";
 	static const char * s_pChzGlobalFlag = "global";
 	static const char * s_pChzLocalFlag = "local";
+	static const char * s_pChzLazyFlag = "lazy";
 	bool fIsFlagPermutation = (pPerm->m_strVar == s_pChzTestFlags);
 
 	char * pCozSub = nullptr;
@@ -1054,6 +1066,11 @@ void TestPermutation(STestContext * pTesctx, SPermutation * pPerm, SUnitTest * p
 			{
 				grfunt.AddFlags(FUNT_ImplicitProc);
 			}
+			else if (FAreCozEqual(pSub->m_pOpt->m_pCozOption, s_pChzLazyFlag))
+			{
+				// same as -lazyTypeCheck, procedure bodies are only checked once something reachable references them
+				grfunt.Clear(FUNT_ResolveAllSymbols);
+			}
 			else
 			{
 				printf("unhandled permutation '%s' in '%s' \n", pSub->m_pOpt->m_pCozOption, s_pChzTestFlags);
@@ -1245,6 +1262,37 @@ bool FTestBlockList(CAlloc * pAlloc)
 	return true;
 }
 
+bool FTestStringAtoms()
+{
+	char aChBuffer[] = "atomTest";
+	CString strA(aChBuffer);
+	CString strB(strA);
+	CString strC;
+	strC = strB;
+
+	// copies share the interned characters, they are not rehashed or reallocated
+	if (strB.PCoz() != strA.PCoz() || strC.PCoz() != strA.PCoz()) { printf("string copy did not share atom\n"); return false; }
+	if (strC.Hv() != strA.Hv() || strC != strA) { printf("string copy hash mismatch\n"); return false; }
+
+	CString strD("atomTest");
+	if (strD.PCoz() != strA.PCoz()) { printf("matching string was not interned\n"); return false; }
+
+	strA = CString();
+	strB = strA;
+	strD = strB;
+	if (!EWC::FAreCozEqual(strC.PCoz(), aChBuffer)) { printf("released string freed shared atom\n"); return false; }
+
+	strC = "atomOther";
+	CString strE("atomTest");
+	if (!EWC::FAreCozEqual(strE.PCoz(), aChBuffer) || strE.Hv() != HvFromPCoz(aChBuffer)) 
+	{ 
+		printf("string was not re-interned after release\n"); 
+		return false; 
+	}
+
+	return true;
+}
+
 bool FRunBuiltinTest(const CString & strName, CAlloc * pAlloc)
 {
 	bool fReturn;
@@ -1268,6 +1316,14 @@ bool FRunBuiltinTest(const CString & strName, CAlloc * pAlloc)
 	{
 		fReturn = FTestBlockList(pAlloc);
 	}
+	else if (strName == "StringAtoms")
+	{
+		fReturn = FTestStringAtoms();
+	}
+	else if (strName == "TargetClones")
+	{
+		fReturn = FTestTargetClones(pAlloc);
+	}
 	else
 	{
 		printf("ERROR: Unknown built in test %s\n", strName.PCoz());
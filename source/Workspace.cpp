@@ -407,6 +407,12 @@ CWorkspace::CWorkspace(CAlloc * pAlloc, SErrorManager * pErrman)
 ,m_cbFreePrev(-1)
 ,m_targetos(TARGETOS_Nil)
 ,m_optlevel(OPTLEVEL_Debug)
+,m_debuginfo(DEBUGINFO_Full)
+,m_fBoundsCheck(false)
+,m_fReportTypeCheckStats(false)
+,m_fSkipUnchanged(false)
+,m_pChzTargetCpu(nullptr)
+,m_pChzTargetFeatures(nullptr)
 ,m_grfunt(GRFUNT_Default)
 {
 	m_pErrman->SetWorkspace(this);
@@ -173,6 +173,13 @@ enum OPTLEVEL
 	OPTLEVEL_Release,
 };
 
+enum DEBUGINFO
+{
+	DEBUGINFO_None,				// -g0
+	DEBUGINFO_LineTablesOnly,	// -gline-tables-only: subprograms and line locations, no types or variables
+	DEBUGINFO_Full,				// -g
+};
+
 enum TARGETOS
 {
 	TARGETOS_Nil = -1,
@@ -316,6 +323,12 @@ public:
 
 	TARGETOS						m_targetos;
 	OPTLEVEL						m_optlevel;
+	DEBUGINFO						m_debuginfo;
+	bool							m_fBoundsCheck;			// emit array bounds checks unless a procedure overrides it
+	bool							m_fReportTypeCheckStats;	// print frame scheduler statistics after type checking
+	bool							m_fSkipUnchanged;		// reuse the object file when its build manifest is unchanged
+	const char *					m_pChzTargetCpu;		// -mcpu value, nullptr for the triple's default cpu
+	const char *					m_pChzTargetFeatures;	// -mattr value, comma separated llvm feature list
 	GRFUNT							m_grfunt;
 };
 